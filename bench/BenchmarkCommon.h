@@ -0,0 +1,118 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file BenchmarkCommon.h
+ *
+ * Helpers shared by the benchmarks: test signals, allocation counting, and throughput reporting.
+ */
+
+#ifndef NimbleDSP_BenchmarkCommon_h
+#define NimbleDSP_BenchmarkCommon_h
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+#include "benchmark/benchmark.h"
+#include "Instrumentation.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Number of calls to the global operator new on the calling thread since it started.
+ *      Counted by the replacement operator new in src/AllocationCounter.cpp.
+ */
+inline uint64_t allocationCount() {
+    return threadAllocationCounts().allocations;
+}
+
+/**
+ * \brief Deterministic test signal value for sample "n".  Scaled for fixed point types.
+ */
+template <class T>
+inline T benchmarkSample(unsigned n) {return (T) (std::sin(0.0123 * n) + 0.25 * std::cos(0.731 * n));}
+
+template <>
+inline int16_t benchmarkSample<int16_t>(unsigned n) {return (int16_t) (8000 * (std::sin(0.0123 * n) + 0.25 * std::cos(0.731 * n)));}
+
+template <>
+inline std::complex<float> benchmarkSample< std::complex<float> >(unsigned n)
+        {return std::complex<float>(benchmarkSample<float>(n), benchmarkSample<float>(n + 17));}
+
+template <>
+inline std::complex<double> benchmarkSample< std::complex<double> >(unsigned n)
+        {return std::complex<double>(benchmarkSample<double>(n), benchmarkSample<double>(n + 17));}
+
+/**
+ * \brief Returns "len" samples of the test signal.
+ */
+template <class T>
+std::vector<T> benchmarkSignal(unsigned len) {
+    std::vector<T> signal(len);
+    for (unsigned n=0; n<len; n++) {
+        signal[n] = benchmarkSample<T>(n);
+    }
+    return signal;
+}
+
+/**
+ * \brief Returns "numTaps" low pass filter taps (a windowed sinc with cutoff 0.2).
+ */
+template <class T>
+std::vector<T> benchmarkTaps(unsigned numTaps) {
+    std::vector<T> taps(numTaps);
+    double center = (numTaps - 1) / 2.0;
+    for (unsigned n=0; n<numTaps; n++) {
+        double x = 0.2 * M_PI * (n - center);
+        double sinc = (x == 0) ? 1 : std::sin(x) / x;
+        taps[n] = (T) (0.2 * sinc * (0.54 - 0.46 * std::cos(2 * M_PI * n / (numTaps > 1 ? numTaps - 1 : 1))));
+    }
+    return taps;
+}
+
+/**
+ * \brief Counts allocations over the timed loop and reports the throughput.
+ *
+ * Construct it just before the "for (auto _ : state)" loop and call \ref finish right after it.
+ * Reports "items_per_second" (input samples per second) and an "allocs" counter, the average
+ * number of heap allocations per call.
+ */
+class BenchmarkReport {
+    benchmark::State & state;
+    uint64_t startAllocations;
+    
+ public:
+    BenchmarkReport(benchmark::State & benchState) : state(benchState), startAllocations(allocationCount()) {}
+    
+    void finish(uint64_t samplesPerCall) {
+        uint64_t allocations = allocationCount() - startAllocations;
+        state.SetItemsProcessed(state.iterations() * samplesPerCall);
+        state.counters["allocs"] = benchmark::Counter((double) allocations / state.iterations());
+    }
+};
+
+};
+
+#endif
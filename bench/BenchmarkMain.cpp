@@ -0,0 +1,38 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Entry point for the NimbleDspBenchmarks executable.  The allocations in the "allocs" column are
+ * counted by src/AllocationCounter.cpp, which is linked in.
+ *
+ * Every benchmark reports input samples per second ("items_per_second") and heap allocations per
+ * call ("allocs").  To compare two commits, save each run as JSON and use compare.py from the
+ * Google Benchmark tools directory:
+ *
+ *      NimbleDspBenchmarks --benchmark_out=before.json --benchmark_out_format=json
+ *      NimbleDspBenchmarks --benchmark_out=after.json --benchmark_out_format=json
+ *      compare.py benchmarks before.json after.json
+ */
+
+#include "BenchmarkCommon.h"
+
+BENCHMARK_MAIN();
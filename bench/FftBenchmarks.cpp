@@ -0,0 +1,113 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Benchmarks of the FFTs, the spectral estimator and the correlator.  The argument is the FFT
+ * size, except for the correlator.
+ */
+
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "SpectralEstimator.h"
+#include "Correlator.h"
+#include "BenchmarkCommon.h"
+
+using namespace NimbleDSP;
+
+static const int64_t FFT_SIZE_ARGS[] = {64, 1024, 16384, 1000};
+static const std::vector<int64_t> FFT_SIZES(FFT_SIZE_ARGS, FFT_SIZE_ARGS + 4);
+
+template <class T>
+static void BM_ComplexFft(benchmark::State & state) {
+    ComplexVector<T> input(benchmarkSignal< std::complex<T> >(state.range(0)));
+    ComplexVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        data.fft();
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_ComplexFft, float)->ArgsProduct({FFT_SIZES});
+BENCHMARK_TEMPLATE(BM_ComplexFft, double)->ArgsProduct({FFT_SIZES});
+
+template <class T>
+static void BM_RealFft(benchmark::State & state) {
+    RealVector<T> data(benchmarkSignal<T>(state.range(0)));
+    ComplexVector<T> spectrum;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data.fft(spectrum);
+        benchmark::DoNotOptimize(spectrum.vec.data());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_RealFft, float)->ArgsProduct({FFT_SIZES});
+BENCHMARK_TEMPLATE(BM_RealFft, double)->ArgsProduct({FFT_SIZES});
+
+template <class T>
+static void BM_Welch(benchmark::State & state) {
+    SpectralEstimator<T> estimator(state.range(0), state.range(0) / 2);
+    RealVector<T> data(benchmarkSignal<T>(16384));
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        estimator.welch(data);
+    }
+    report.finish(data.size());
+}
+BENCHMARK_TEMPLATE(BM_Welch, float)->Arg(256)->Arg(2048);
+BENCHMARK_TEMPLATE(BM_Welch, double)->Arg(256)->Arg(2048);
+
+/**
+ * Correlation of 16384 samples with a reference.  Arguments are the reference length, the
+ * ConvolutionAlgorithmType (0 = direct, 1 = FFT) and whether the fused detector is used instead of
+ * returning the correlation.
+ */
+template <class T>
+static void BM_Correlate(benchmark::State & state) {
+    Correlator<T> correlator(benchmarkSignal< std::complex<T> >(state.range(0)));
+    correlator.convAlgorithm = (ConvolutionAlgorithmType) state.range(1);
+    ComplexVector<T> input(benchmarkSignal< std::complex<T> >(16384));
+    ComplexVector<T> data = input;
+    std::vector<long> peaks;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        if (state.range(2)) {
+            peaks.clear();
+            correlator.detect(input, peaks, (T) 0.9);
+            benchmark::DoNotOptimize(peaks.data());
+        }
+        else {
+            data = input;
+            correlator.correlateComplex(data);
+            benchmark::DoNotOptimize(data.vec.data());
+        }
+    }
+    report.finish(input.size());
+}
+BENCHMARK_TEMPLATE(BM_Correlate, float)->ArgsProduct({{127, 2047}, {0, 1}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_Correlate, double)->ArgsProduct({{127, 2047}, {1}, {0, 1}});
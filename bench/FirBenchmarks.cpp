@@ -0,0 +1,378 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Benchmarks of the FIR filters: convolution, decimation, interpolation and resampling.
+ *
+ * Arguments are, in order: number of taps, block size, then the rate(s) if any, then the
+ * FilterOperationType (0 = STREAMING, 2 = ONE_SHOT_TRIM_TAILS).  Each call filters one block, and
+ * the time includes copying the block into the buffer being filtered.
+ */
+
+#include "RealFirFilter.h"
+#include "ComplexFirFilter.h"
+#include "FixedPtFirFilter.h"
+#include "HalfBandFilter.h"
+#include "MultiStageDecimator.h"
+#include "PfbChannelizer.h"
+#include "FarrowResampler.h"
+#include "FixedFirFilter.h"
+#include "BenchmarkCommon.h"
+
+using namespace NimbleDSP;
+
+/**
+ * \brief The vector and FIR filter classes for samples of type S.
+ */
+template <class S>
+struct FirTypes {
+    typedef RealVector<S> Data;
+    typedef RealFirFilter<S> Filter;
+};
+
+template <class T>
+struct FirTypes< std::complex<T> > {
+    typedef ComplexVector<T> Data;
+    typedef ComplexFirFilter<T> Filter;
+};
+
+static const int64_t MODE_ARGS[] = {STREAMING, ONE_SHOT_TRIM_TAILS};
+static const std::vector<int64_t> MODES(MODE_ARGS, MODE_ARGS + 2);
+
+
+template <class S>
+static void BM_FirConv(benchmark::State & state) {
+    typename FirTypes<S>::Filter filt(benchmarkTaps<S>(state.range(0)), (FilterOperationType) state.range(2));
+    typename FirTypes<S>::Data input(benchmarkSignal<S>(state.range(1)));
+    typename FirTypes<S>::Data data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.conv(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirConv, float)->ArgsProduct({{16, 64, 256}, {256, 4096}, MODES});
+BENCHMARK_TEMPLATE(BM_FirConv, double)->ArgsProduct({{16, 64, 256}, {256, 4096}, MODES});
+BENCHMARK_TEMPLATE(BM_FirConv, std::complex<float>)->ArgsProduct({{16, 64, 256}, {256, 4096}, MODES});
+BENCHMARK_TEMPLATE(BM_FirConv, std::complex<double>)->ArgsProduct({{16, 64, 256}, {256, 4096}, MODES});
+
+/**
+ * Real taps on complex data, interleaved (RealFirFilter::convComplex) against split
+ * (RealFirFilter::convSplit).  Arguments are the number of taps, block size and whether the data is
+ * split.  Streaming and direct form only, so the two differ only in the data layout.
+ */
+template <class T>
+static void BM_FirConvComplexLayout(benchmark::State & state) {
+    RealFirFilter<T> filt(benchmarkTaps<T>(state.range(0)));
+    filt.convAlgorithm = DIRECT_CONVOLUTION;
+    ComplexVector<T> input(benchmarkSignal< std::complex<T> >(state.range(1)));
+    ComplexVector<T> data = input;
+    SplitComplexVector<T> splitInput(input);
+    SplitComplexVector<T> splitData = splitInput;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        if (state.range(2)) {
+            splitData = splitInput;
+            filt.convSplit(splitData);
+            benchmark::DoNotOptimize(splitData.re.data());
+        }
+        else {
+            data = input;
+            filt.convComplex(data);
+            benchmark::DoNotOptimize(data.vec.data());
+        }
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirConvComplexLayout, float)->ArgsProduct({{16, 64}, {4096}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_FirConvComplexLayout, double)->ArgsProduct({{16, 64}, {4096}, {0, 1}});
+
+/**
+ * Compile time taps (FixedFirFilter) against run time taps (RealFirFilter, streaming, direct form).
+ * Arguments are the block size and whether the filter is the fixed one.
+ */
+template <class T, unsigned NumTaps>
+static void BM_FixedFirConv(benchmark::State & state) {
+    RealVector<T> taps(benchmarkTaps<T>(NumTaps));
+    RealFirFilter<T> filt(taps.vec);
+    filt.convAlgorithm = DIRECT_CONVOLUTION;
+    FixedFirFilter<T, NumTaps> fixedFilt(taps.vec.data());
+    RealVector<T> input(benchmarkSignal<T>(state.range(0)));
+    RealVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        if (state.range(1)) {
+            fixedFilt.conv(data);
+        }
+        else {
+            filt.conv(data);
+        }
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_FixedFirConv, float, 8)->ArgsProduct({{4096}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_FixedFirConv, float, 31)->ArgsProduct({{4096}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_FixedFirConv, float, 100)->ArgsProduct({{4096}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_FixedFirConv, double, 31)->ArgsProduct({{4096}, {0, 1}});
+
+template <class S>
+static void BM_FirDecimate(benchmark::State & state) {
+    typename FirTypes<S>::Filter filt(benchmarkTaps<S>(state.range(0)), (FilterOperationType) state.range(3));
+    typename FirTypes<S>::Data input(benchmarkSignal<S>(state.range(1)));
+    typename FirTypes<S>::Data data = input;
+    int rate = (int) state.range(2);
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.decimate(data, rate);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirDecimate, float)->ArgsProduct({{32, 128}, {4096}, {2, 8}, MODES});
+BENCHMARK_TEMPLATE(BM_FirDecimate, double)->ArgsProduct({{32, 128}, {4096}, {2, 8}, MODES});
+BENCHMARK_TEMPLATE(BM_FirDecimate, std::complex<float>)->ArgsProduct({{32, 128}, {4096}, {2, 8}, MODES});
+
+template <class S>
+static void BM_FirInterp(benchmark::State & state) {
+    typename FirTypes<S>::Filter filt(benchmarkTaps<S>(state.range(0)), (FilterOperationType) state.range(3));
+    typename FirTypes<S>::Data input(benchmarkSignal<S>(state.range(1)));
+    typename FirTypes<S>::Data data = input;
+    int rate = (int) state.range(2);
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.interp(data, rate);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirInterp, float)->ArgsProduct({{32, 128}, {1024}, {2, 8}, MODES});
+BENCHMARK_TEMPLATE(BM_FirInterp, double)->ArgsProduct({{32, 128}, {1024}, {2, 8}, MODES});
+BENCHMARK_TEMPLATE(BM_FirInterp, std::complex<float>)->ArgsProduct({{32, 128}, {1024}, {2, 8}, MODES});
+
+template <class S>
+static void BM_FirResample(benchmark::State & state) {
+    typename FirTypes<S>::Filter filt(benchmarkTaps<S>(state.range(0)), (FilterOperationType) state.range(3));
+    typename FirTypes<S>::Data input(benchmarkSignal<S>(state.range(1)));
+    typename FirTypes<S>::Data data = input;
+    // Interpolate by L, decimate by L - 1.
+    int interpRate = (int) state.range(2);
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.resample(data, interpRate, interpRate - 1);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirResample, float)->ArgsProduct({{32, 128}, {4096}, {3, 5}, MODES});
+BENCHMARK_TEMPLATE(BM_FirResample, double)->ArgsProduct({{32, 128}, {4096}, {3, 5}, MODES});
+
+static const int64_t SYMMETRY_ARGS[] = {NO_SYMMETRY, SYMMETRIC_TAPS};
+static const std::vector<int64_t> SYMMETRIES(SYMMETRY_ARGS, SYMMETRY_ARGS + 2);
+
+/**
+ * Streaming decimation (rate 1 is plain convolution) with the tap folding off and on.  Arguments
+ * are the number of taps, block size, rate and TapSymmetryType.
+ */
+template <class S>
+static void BM_FirDecimateFolded(benchmark::State & state) {
+    typename FirTypes<S>::Filter filt(benchmarkTaps<S>(state.range(0)));
+    typename FirTypes<S>::Data input(benchmarkSignal<S>(state.range(1)));
+    typename FirTypes<S>::Data data = input;
+    filt.convAlgorithm = DIRECT_CONVOLUTION;
+    filt.symmetry = (TapSymmetryType) state.range(3);
+    int rate = (int) state.range(2);
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        if (rate == 1) {
+            filt.conv(data);
+        }
+        else {
+            filt.decimate(data, rate);
+        }
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirDecimateFolded, float)->ArgsProduct({{127, 255}, {4096}, {1, 4}, SYMMETRIES});
+BENCHMARK_TEMPLATE(BM_FirDecimateFolded, double)->ArgsProduct({{127, 255}, {4096}, {1, 4}, SYMMETRIES});
+BENCHMARK_TEMPLATE(BM_FirDecimateFolded, std::complex<float>)->ArgsProduct({{127, 255}, {4096}, {1, 4}, SYMMETRIES});
+
+/**
+ * Streaming interpolation with the tap folding off and on.  Arguments are the number of taps (a
+ * multiple of the rate, so that it folds), block size, rate and TapSymmetryType.
+ */
+template <class S>
+static void BM_FirInterpFolded(benchmark::State & state) {
+    typename FirTypes<S>::Filter filt(benchmarkTaps<S>(state.range(0)));
+    typename FirTypes<S>::Data input(benchmarkSignal<S>(state.range(1)));
+    typename FirTypes<S>::Data data = input;
+    filt.symmetry = (TapSymmetryType) state.range(3);
+    int rate = (int) state.range(2);
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.interp(data, rate);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FirInterpFolded, float)->ArgsProduct({{64, 256}, {1024}, {4, 8}, SYMMETRIES});
+BENCHMARK_TEMPLATE(BM_FirInterpFolded, double)->ArgsProduct({{64, 256}, {1024}, {4, 8}, SYMMETRIES});
+
+static void BM_FixedPtFirConv(benchmark::State & state) {
+    std::vector<double> doubleTaps = benchmarkTaps<double>(state.range(0));
+    std::vector<int16_t> taps(doubleTaps.size());
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] = (int16_t) std::floor(doubleTaps[i] * 32768 + 0.5);
+    }
+    FixedPtFirFilter<int16_t> filt(taps, 15, (FilterOperationType) state.range(2));
+    RealVector<int16_t> input(benchmarkSignal<int16_t>(state.range(1)));
+    RealVector<int16_t> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.conv(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK(BM_FixedPtFirConv)->ArgsProduct({{16, 64, 256}, {256, 4096}, MODES});
+
+/**
+ * Decimation by 2 with a half-band filter.  Arguments are the number of taps and block size.
+ * Compare with BM_FirDecimate at the same taps and rate 2.
+ */
+template <class S>
+static void BM_HalfBandDecimate(benchmark::State & state) {
+    RealFirFilter<double> designer;
+    designer.halfBandFilter((int) state.range(0), 0.4);
+    HalfBandDecimator<S> filt(designer.vec);
+    RealVector<S> input(benchmarkSignal<S>(state.range(1)));
+    RealVector<S> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filt.decimate(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_HalfBandDecimate, float)->ArgsProduct({{31, 131}, {4096}});
+BENCHMARK_TEMPLATE(BM_HalfBandDecimate, double)->ArgsProduct({{31, 131}, {4096}});
+
+static void BM_CicDecimate(benchmark::State & state) {
+    CicDecimator<int16_t> cic((int) state.range(0), 4);
+    RealVector<int16_t> input(benchmarkSignal<int16_t>(state.range(1)));
+    RealVector<int16_t> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        cic.decimate(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK(BM_CicDecimate)->ArgsProduct({{16, 256}, {16384}});
+
+/**
+ * Planned multi-stage decimation with a passband edge of 0.8 and 80 dB of attenuation.  Arguments
+ * are the rate, block size and whether a CIC stage is allowed.
+ */
+template <class S>
+static void BM_MultiStageDecimate(benchmark::State & state) {
+    MultiStageDecimator<S> decimator;
+    decimator.design((int) state.range(0), 0.8, 80, state.range(2) != 0);
+    RealVector<S> input(benchmarkSignal<S>(state.range(1)));
+    RealVector<S> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        decimator.decimate(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_MultiStageDecimate, float)->ArgsProduct({{64, 1024}, {16384}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_MultiStageDecimate, double)->ArgsProduct({{64, 1024}, {16384}, {0, 1}});
+
+/**
+ * Polyphase filter bank channelizer with 8 taps per branch.  Arguments are the number of
+ * channels, block size and oversampling factor.
+ */
+template <class S>
+static void BM_PfbChannelize(benchmark::State & state) {
+    int numChannels = (int) state.range(0);
+    PfbChannelizer<S> channelizer(benchmarkTaps<S>(8 * numChannels), numChannels, (int) state.range(2));
+    ComplexVector<S> input(benchmarkSignal< std::complex<S> >(state.range(1)));
+    ComplexVector<S> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        channelizer.channelize(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_PfbChannelize, float)->ArgsProduct({{16, 256}, {16384}, {1, 2}});
+BENCHMARK_TEMPLATE(BM_PfbChannelize, double)->ArgsProduct({{16, 256}, {16384}, {1, 2}});
+
+/**
+ * Farrow resampling with 8 taps per branch at a ratio that isn't a ratio of small integers.
+ * Arguments are the polynomial order and block size.
+ */
+template <class S>
+static void BM_FarrowResample(benchmark::State & state) {
+    FarrowResampler<S> resampler(8, (int) state.range(0), 0.8, 1.0001);
+    RealVector<S> input(benchmarkSignal<S>(state.range(1)));
+    RealVector<S> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        resampler.resample(data);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_FarrowResample, float)->ArgsProduct({{3, 5}, {4096}});
+BENCHMARK_TEMPLATE(BM_FarrowResample, double)->ArgsProduct({{3, 5}, {4096}});
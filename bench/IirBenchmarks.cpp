@@ -0,0 +1,119 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Benchmarks of the IIR filters.  Arguments are the filter order and the block size.
+ */
+
+#include "RealIirFilter.h"
+#include "SosFilter.h"
+#include "RealVector.h"
+#include "BenchmarkCommon.h"
+
+using namespace NimbleDSP;
+
+/**
+ * \brief Fills "num" and "den" with a stable low pass filter of order "order", with unity gain at
+ *      DC.  The zeros are all at -1 and the poles are spread between 0.3 and 0.7, so that the
+ *      roots SosFilter finds are well conditioned.
+ */
+static void benchmarkIirCoefficients(unsigned order, std::vector<double> & num, std::vector<double> & den) {
+    num.assign(order + 1, 0.0);
+    den.assign(order + 1, 0.0);
+    num[0] = den[0] = 1;
+    for (unsigned k=0; k<order; k++) {
+        for (unsigned i=k+1; i>0; i--) {
+            num[i] += num[i - 1];
+            den[i] -= (0.3 + 0.4 * k / order) * den[i - 1];
+        }
+    }
+    double gain = 0, denSum = 0;
+    for (unsigned i=0; i<=order; i++) {
+        gain += num[i];
+        denSum += den[i];
+    }
+    for (unsigned i=0; i<=order; i++) {
+        num[i] *= denSum / gain;
+    }
+}
+
+template <class T>
+static void BM_IirFilter(benchmark::State & state) {
+    std::vector<double> num, den;
+    benchmarkIirCoefficients(state.range(0), num, den);
+    RealIirFilter<T> filt(num, den);
+    RealVector<T> input(benchmarkSignal<T>(state.range(1)));
+    RealVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filter(data, filt);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_IirFilter, float)->ArgsProduct({{2, 8}, {256, 4096}});
+BENCHMARK_TEMPLATE(BM_IirFilter, double)->ArgsProduct({{2, 8}, {256, 4096}});
+
+/*
+ * Third argument is the IirAlgorithmType, so the serial and block recursions can be compared on
+ * the same long block.
+ */
+template <class T>
+static void BM_IirFilterAlgorithm(benchmark::State & state) {
+    std::vector<double> num, den;
+    benchmarkIirCoefficients(state.range(0), num, den);
+    RealIirFilter<T> filt(num, den);
+    filt.filterAlgorithm = (IirAlgorithmType) state.range(2);
+    RealVector<T> input(benchmarkSignal<T>(state.range(1)));
+    RealVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filter(data, filt);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_IirFilterAlgorithm, float)->ArgsProduct({{2, 8}, {1 << 16}, {SERIAL_IIR, BLOCK_IIR}});
+BENCHMARK_TEMPLATE(BM_IirFilterAlgorithm, double)->ArgsProduct({{2, 8}, {1 << 16}, {SERIAL_IIR, BLOCK_IIR}});
+
+template <class T>
+static void BM_SosFilter(benchmark::State & state) {
+    std::vector<double> num, den;
+    benchmarkIirCoefficients(state.range(0), num, den);
+    SosFilter<T> filt(num, den);
+    RealVector<T> input(benchmarkSignal<T>(state.range(1)));
+    RealVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        filter(data, filt);
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(1));
+}
+BENCHMARK_TEMPLATE(BM_SosFilter, float)->ArgsProduct({{2, 8}, {256, 4096}});
+BENCHMARK_TEMPLATE(BM_SosFilter, double)->ArgsProduct({{2, 8}, {256, 4096}});
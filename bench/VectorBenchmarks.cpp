@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Benchmarks of element-wise and statistics methods on the vectors.  The argument is the vector
+ * size.
+ */
+
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "BenchmarkCommon.h"
+
+using namespace NimbleDSP;
+
+template <class T>
+static void BM_RealVectorMultiply(benchmark::State & state) {
+    RealVector<T> input(benchmarkSignal<T>(state.range(0)));
+    RealVector<T> other(benchmarkSignal<T>(state.range(0) + 5));
+    other.vec.erase(other.vec.begin(), other.vec.begin() + 5);
+    RealVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        data *= other;
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_RealVectorMultiply, float)->Arg(256)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_RealVectorMultiply, double)->Arg(256)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_RealVectorMultiply, int16_t)->Arg(256)->Arg(16384);
+
+template <class T>
+static void BM_RealVectorMedian(benchmark::State & state) {
+    RealVector<T> data(benchmarkSignal<T>(state.range(0)));
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.median());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_RealVectorMedian, float)->Arg(256)->Arg(16384);
+
+template <class T>
+static void BM_ComplexVectorMagSq(benchmark::State & state) {
+    ComplexVector<T> input(benchmarkSignal< std::complex<T> >(state.range(0)));
+    ComplexVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        data.magSq();
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_ComplexVectorMagSq, float)->Arg(256)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_ComplexVectorMagSq, double)->Arg(256)->Arg(16384);
+
+/**
+ * Second argument: 0 = EXACT_MATH, 1 = FAST_MATH.
+ */
+template <class T>
+static void BM_ComplexVectorAngle(benchmark::State & state) {
+    ComplexVector<T> input(benchmarkSignal< std::complex<T> >(state.range(0)));
+    ComplexVector<T> data = input;
+    
+    BenchmarkReport report(state);
+    for (auto _ : state) {
+        data = input;
+        data.angle((MathAccuracyType) state.range(1));
+        benchmark::DoNotOptimize(data.vec.data());
+    }
+    report.finish(state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_ComplexVectorAngle, float)->ArgsProduct({{256, 16384}, {EXACT_MATH, FAST_MATH}});
+BENCHMARK_TEMPLATE(BM_ComplexVectorAngle, double)->ArgsProduct({{256, 16384}, {EXACT_MATH, FAST_MATH}});
@@ -0,0 +1,381 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file Allocators.h
+ *
+ * Definition of the aligned and arena allocators and the per-thread scratch workspace.
+ */
+
+#ifndef NimbleDSP_Allocators_h
+#define NimbleDSP_Allocators_h
+
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+#include <new>
+#include <stdint.h>
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Alignment, in bytes, of the memory that the library's aligned buffers use.  A cache line,
+ *      and enough for any SIMD register the kernels load.
+ */
+const std::size_t DEFAULT_ALIGNMENT = 64;
+
+/**
+ * \brief Returns "ptr" rounded up to a multiple of "alignment", which must be a power of two.
+ */
+inline char *alignPointer(char *ptr, std::size_t alignment) {
+    return (char *) (((uintptr_t) ptr + alignment - 1) & ~((uintptr_t) alignment - 1));
+}
+
+/**
+ * \brief Standard library allocator whose memory starts on an "Alignment" byte boundary.
+ *
+ * std::allocator only guarantees the alignment of the element type, so a std::vector<float> can
+ * start anywhere on a 4 byte boundary and every SIMD load from it may straddle a cache line.
+ * Use it as std::vector<T, AlignedAllocator<T> >.  All instances are interchangeable.
+ */
+template <class T, std::size_t Alignment = DEFAULT_ALIGNMENT>
+class AlignedAllocator {
+ public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator<T, Alignment>() {}
+    template <class U>
+    AlignedAllocator<T, Alignment>(const AlignedAllocator<U, Alignment> &) {}
+
+    /**
+     * \brief Allocates room for "n" elements.  The pointer that malloc returned is kept just below
+     *      the aligned block so that \ref deallocate can find it.
+     */
+    T *allocate(std::size_t n) {
+        void *raw = std::malloc(n * sizeof(T) + Alignment + sizeof(void *));
+        if (raw == NULL) {
+            throw std::bad_alloc();
+        }
+        char *aligned = alignPointer((char *) raw + sizeof(void *), Alignment);
+        ((void **) aligned)[-1] = raw;
+        return (T *) aligned;
+    }
+
+    void deallocate(T *ptr, std::size_t) {
+        if (ptr != NULL) {
+            std::free(((void **) ptr)[-1]);
+        }
+    }
+
+    template <class U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const {return true;}
+    template <class U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const {return false;}
+};
+
+
+/**
+ * \brief Bump allocator that hands out pieces of large blocks.
+ *
+ * Allocating is a pointer increment, and nothing is freed individually.  Instead \ref mark
+ * records a position and \ref rewind returns everything allocated since then at once, keeping the
+ * blocks for reuse, so a processing loop that rewinds every iteration stops touching the heap as
+ * soon as the arena has grown to its working set.  See ArenaScope and ArenaAllocator.
+ *
+ * An arena isn't thread safe.  \ref threadArena returns one per thread.
+ */
+class BlockArena {
+ protected:
+    std::vector<char *> blocks;
+    std::vector<std::size_t> blockSizes;
+
+    /**
+     * \brief The block being allocated from and the offset of its first free byte.
+     */
+    std::size_t currentBlock;
+    std::size_t offset;
+
+    std::size_t minBlockSize;
+
+    BlockArena(const BlockArena &);
+    BlockArena & operator=(const BlockArena &);
+
+ public:
+    /**
+     * \brief A position in the arena, from \ref mark.
+     */
+    struct Mark {
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.  Memory isn't allocated until it is asked for.
+     *
+     * \param blockSize Size of each block in bytes.  Requests bigger than this get a block of
+     *      their own.
+     */
+    BlockArena(std::size_t blockSize = 1 << 20) : currentBlock(0), offset(0), minBlockSize(blockSize) {}
+
+    ~BlockArena() {
+        for (unsigned i=0; i<blocks.size(); i++) {
+            std::free(blocks[i]);
+        }
+    }
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns "bytes" bytes aligned to "alignment", which must be a power of two.
+     */
+    void *allocate(std::size_t bytes, std::size_t alignment = DEFAULT_ALIGNMENT) {
+        for (; currentBlock < blocks.size(); currentBlock++, offset = 0) {
+            char *start = blocks[currentBlock];
+            char *ptr = alignPointer(start + offset, alignment);
+            if (ptr + bytes <= start + blockSizes[currentBlock]) {
+                offset = ptr + bytes - start;
+                return ptr;
+            }
+        }
+
+        std::size_t size = (bytes + alignment > minBlockSize) ? bytes + alignment : minBlockSize;
+        char *block = (char *) std::malloc(size);
+        if (block == NULL) {
+            throw std::bad_alloc();
+        }
+        blocks.push_back(block);
+        blockSizes.push_back(size);
+        currentBlock = blocks.size() - 1;
+        char *ptr = alignPointer(block, alignment);
+        offset = ptr + bytes - block;
+        return ptr;
+    }
+
+    /**
+     * \brief Returns the current position, for \ref rewind.
+     */
+    Mark mark() const {Mark position = {currentBlock, offset}; return position;}
+
+    /**
+     * \brief Frees everything allocated since "position" was marked.  The blocks are kept.
+     */
+    void rewind(const Mark & position) {
+        assert(position.block < currentBlock || (position.block == currentBlock && position.offset <= offset));
+        currentBlock = position.block;
+        offset = position.offset;
+    }
+
+    /**
+     * \brief Frees everything that has been allocated.  The blocks are kept.
+     */
+    void reset() {currentBlock = 0; offset = 0;}
+
+    /**
+     * \brief Returns the total size of the blocks, in bytes.
+     */
+    std::size_t capacity() const {
+        std::size_t total = 0;
+        for (unsigned i=0; i<blockSizes.size(); i++) {
+            total += blockSizes[i];
+        }
+        return total;
+    }
+};
+
+/**
+ * \brief Returns the calling thread's arena.
+ */
+inline BlockArena & threadArena() {
+    static thread_local BlockArena arena;
+    return arena;
+}
+
+/**
+ * \brief Marks an arena when constructed and rewinds it to the mark when destroyed, so that
+ *      everything allocated from the arena in a scope is freed when the scope ends.
+ */
+class ArenaScope {
+ protected:
+    BlockArena & arena;
+    BlockArena::Mark position;
+
+    ArenaScope(const ArenaScope &);
+    ArenaScope & operator=(const ArenaScope &);
+
+ public:
+    ArenaScope(BlockArena & scopeArena = threadArena()) : arena(scopeArena), position(scopeArena.mark()) {}
+    ~ArenaScope() {arena.rewind(position);}
+};
+
+/**
+ * \brief Standard library allocator that allocates from a BlockArena.
+ *
+ * Deallocating does nothing; the memory comes back when the arena is rewound.  So a container
+ * that uses it must not outlive the ArenaScope (or rewind) that it was filled in, and one that
+ * grows a step at a time leaves its old storage in the arena until then, so reserve up front.
+ * Allocations are \ref DEFAULT_ALIGNMENT aligned.
+ */
+template <class T>
+class ArenaAllocator {
+ public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+
+    /**
+     * \brief The arena that memory comes from.
+     */
+    BlockArena *arena;
+
+    /**
+     * \brief Allocates from "source", by default the calling thread's arena.
+     */
+    ArenaAllocator<T>(BlockArena & source = threadArena()) : arena(&source) {}
+    template <class U>
+    ArenaAllocator<T>(const ArenaAllocator<U> & other) : arena(other.arena) {}
+
+    T *allocate(std::size_t n) {return (T *) arena->allocate(n * sizeof(T));}
+    void deallocate(T *, std::size_t) {}
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U> & other) const {return arena == other.arena;}
+    template <class U>
+    bool operator!=(const ArenaAllocator<U> & other) const {return arena != other.arena;}
+};
+
+
+/**
+ * \brief Pool of scratch buffers.
+ *
+ * Methods that need a temporary buffer use the data's scratch buffer when it has one and
+ * otherwise borrow one from the calling thread's workspace (see ScratchBuffer) instead of
+ * constructing a local std::vector.  A returned buffer keeps its capacity, so once the pool has
+ * buffers as big as the blocks being processed those methods don't allocate.  Because every
+ * thread has its own workspace there is nothing to share or lock, unlike a scratch buffer passed
+ * to several vectors' constructors.
+ */
+template <class T>
+class Workspace {
+ protected:
+    /**
+     * \brief The buffers that aren't borrowed.
+     */
+    std::vector< std::vector<T> * > available;
+
+ public:
+    ~Workspace() {clear();}
+
+    /**
+     * \brief Borrows a buffer.  Its contents are unspecified.
+     */
+    std::vector<T> *acquire() {
+        if (available.empty()) {
+            return new std::vector<T>();
+        }
+        std::vector<T> *buf = available.back();
+        available.pop_back();
+        return buf;
+    }
+
+    /**
+     * \brief Returns a buffer that \ref acquire handed out.
+     */
+    void release(std::vector<T> *buf) {available.push_back(buf);}
+
+    /**
+     * \brief Frees the buffers that aren't borrowed.
+     */
+    void clear() {
+        for (unsigned i=0; i<available.size(); i++) {
+            delete available[i];
+        }
+        available.clear();
+    }
+
+    /**
+     * \brief Returns the number of buffers that aren't borrowed.
+     */
+    unsigned numAvailable() const {return available.size();}
+};
+
+/**
+ * \brief Returns the calling thread's workspace for buffers of T.
+ */
+template <class T>
+Workspace<T> & threadWorkspace() {
+    static thread_local Workspace<T> workspace;
+    return workspace;
+}
+
+/**
+ * \brief Borrows a buffer from the calling thread's workspace for the lifetime of the object.
+ *
+ * A buffer can also be lent to a vector's constructor as its scratch buffer, as long as the
+ * vector doesn't outlive the ScratchBuffer.
+ */
+template <class T>
+class ScratchBuffer {
+ protected:
+    std::vector<T> *buf;
+
+    ScratchBuffer(const ScratchBuffer &);
+    ScratchBuffer & operator=(const ScratchBuffer &);
+
+ public:
+    ScratchBuffer<T>() : buf(threadWorkspace<T>().acquire()) {}
+    ~ScratchBuffer() {threadWorkspace<T>().release(buf);}
+
+    std::vector<T> *get() const {return buf;}
+    std::vector<T> & operator*() const {return *buf;}
+    std::vector<T> *operator->() const {return buf;}
+};
+
+};
+
+#endif
@@ -0,0 +1,527 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file CicFilter.h
+ *
+ * Definition of the template classes CicDecimator and CicInterpolator.
+ */
+
+#ifndef NimbleDSP_CicFilter_h
+#define NimbleDSP_CicFilter_h
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cassert>
+#include <stdint.h>
+#include <type_traits>
+#include "RealFixedPtVector.h"
+#include "RealFirFilter.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Magnitude response of a CIC filter, normalized to a gain of 1 at DC.
+ *
+ * \param freq Frequency normalized so that 1.0 is the Nyquist frequency of the low rate side of the
+ *      filter, i.e. the output of a decimator or the input of an interpolator.
+ * \param numStages Number of integrator and comb stages.
+ * \param rate The decimation or interpolation rate.
+ * \param diffDelay The differential delay of the combs.
+ */
+inline double cicMagnitude(double freq, int numStages, int rate, int diffDelay) {
+    // Half of the angular frequency at the high rate.
+    double halfOmega = M_PI * freq / (2 * rate);
+    if (halfOmega == 0) {
+        return 1;
+    }
+    double boxcar = std::sin(rate * diffDelay * halfOmega) / (rate * diffDelay * std::sin(halfOmega));
+    return std::pow(std::abs(boxcar), numStages);
+}
+
+/**
+ * \brief Designs a linear phase FIR filter that flattens the passband droop of a CIC filter.
+ *
+ * The filter runs at the low rate side of the CIC filter (after a decimator, or before an
+ * interpolator).  Its response is a least squares fit to 1 / \ref cicMagnitude in the passband
+ * and to 0 in the stopband, normalized to a gain of 1 at DC.
+ *
+ * \param taps Set to the filter taps.
+ * \param numTaps Number of taps.  Must be odd.
+ * \param numStages Number of stages in the CIC filter.
+ * \param rate Rate of the CIC filter.
+ * \param diffDelay Differential delay of the CIC filter.
+ * \param passbandEdge Edge of the passband, normalized so that 1.0 is the Nyquist frequency.
+ * \param stopbandEdge Start of the stopband.  Must be greater than passbandEdge.
+ */
+inline void cicCompensationTaps(std::vector<double> & taps, int numTaps, int numStages, int rate, int diffDelay,
+                                double passbandEdge, double stopbandEdge) {
+    assert(numTaps % 2 == 1);
+    assert(passbandEdge > 0 && passbandEdge < stopbandEdge && stopbandEdge <= 1);
+    
+    // The amplitude response of the symmetric filter is sum(a[k] * cos(k * w)), so the normal
+    // equations for a[] are accumulated over a dense grid that skips the transition band.
+    int numCoefs = numTaps / 2 + 1;
+    std::vector<double> normal(numCoefs * numCoefs, 0), rhs(numCoefs, 0), cosines(numCoefs);
+    int gridLen = 16 * numTaps;
+    for (int g=0; g<=gridLen; g++) {
+        double freq = (double) g / gridLen;
+        if (freq > passbandEdge && freq < stopbandEdge) {
+            continue;
+        }
+        double desired = (freq <= passbandEdge) ? 1 / cicMagnitude(freq, numStages, rate, diffDelay) : 0;
+        for (int k=0; k<numCoefs; k++) {
+            cosines[k] = std::cos(k * M_PI * freq);
+        }
+        for (int j=0; j<numCoefs; j++) {
+            for (int k=0; k<numCoefs; k++) {
+                normal[j * numCoefs + k] += cosines[j] * cosines[k];
+            }
+            rhs[j] += desired * cosines[j];
+        }
+    }
+    
+    // Gaussian elimination with partial pivoting.
+    for (int col=0; col<numCoefs; col++) {
+        int pivot = col;
+        for (int row=col+1; row<numCoefs; row++) {
+            if (std::abs(normal[row * numCoefs + col]) > std::abs(normal[pivot * numCoefs + col])) {
+                pivot = row;
+            }
+        }
+        for (int k=0; k<numCoefs; k++) {
+            std::swap(normal[col * numCoefs + k], normal[pivot * numCoefs + k]);
+        }
+        std::swap(rhs[col], rhs[pivot]);
+        for (int row=col+1; row<numCoefs; row++) {
+            double factor = normal[row * numCoefs + col] / normal[col * numCoefs + col];
+            for (int k=col; k<numCoefs; k++) {
+                normal[row * numCoefs + k] -= factor * normal[col * numCoefs + k];
+            }
+            rhs[row] -= factor * rhs[col];
+        }
+    }
+    std::vector<double> coefs(numCoefs);
+    for (int row=numCoefs-1; row>=0; row--) {
+        double sum = rhs[row];
+        for (int k=row+1; k<numCoefs; k++) {
+            sum -= normal[row * numCoefs + k] * coefs[k];
+        }
+        coefs[row] = sum / normal[row * numCoefs + row];
+    }
+    
+    int center = numTaps / 2;
+    taps.resize(numTaps);
+    taps[center] = coefs[0];
+    for (int k=1; k<numCoefs; k++) {
+        taps[center - k] = taps[center + k] = coefs[k] / 2;
+    }
+    double dcGain = 0;
+    for (int i=0; i<numTaps; i++) {
+        dcGain += taps[i];
+    }
+    for (int i=0; i<numTaps; i++) {
+        taps[i] /= dcGain;
+    }
+}
+
+
+/**
+ * \brief State and sample conversions shared by CicDecimator and CicInterpolator.
+ *
+ * A cascaded integrator-comb (CIC) filter changes the rate by "rate" with a response equal to
+ * numStages boxcar filters of rate * diffDelay taps each, without any multiplies.  The integrators
+ * run at the high rate and the combs at the low rate.  The integrators overflow on any input with
+ * a DC component, so the arithmetic is done modulo 2^(bits in A), just as it is in hardware.  The
+ * result is still exact as long as the output fits in A.
+ *
+ * Integer samples go into the registers as they are.  The outputs are shifted down by
+ * \ref outputShift bits, rounded as \ref rounding says, and saturated to the range of T.  The
+ * default shift is \ref bitGrowth, which makes the gain at DC (rate * diffDelay)^numStages /
+ * 2^bitGrowth (the interpolator's gain is a further factor of rate less), i.e. 1 when that is a
+ * power of two and less than 1 otherwise.
+ *
+ * Floating point samples are quantized to A first, with the full scale value \ref fullScale at
+ * the largest magnitude that leaves room for the bit growth, and the outputs are scaled back to a
+ * gain of 1 at DC.  Samples greater in magnitude than fullScale are saturated.  This is what a
+ * hardware front end does, and unlike floating point integrators it doesn't drift.
+ */
+template <class T, class A = int64_t>
+class CicFilter {
+ protected:
+    /**
+     * \brief The register type.  Unsigned so that wrapping around is well defined.
+     */
+    typedef typename std::make_unsigned<A>::type Register;
+    
+    std::vector<Register> integrators;
+    
+    /**
+     * \brief The comb delay lines, diffDelay registers per stage, one stage after another.
+     */
+    std::vector<Register> combDelays;
+    
+    /**
+     * \brief Position of the oldest register in each comb delay line.
+     */
+    int combIndex;
+    
+    int filterRate;
+    int stages;
+    int delay;
+    int growth;
+    
+    /**
+     * \brief DC gain of the integrators and combs, without any scaling.
+     */
+    double gain;
+    
+    CicFilter<T, A>(int rate, int numStages, int diffDelay, double dcGain);
+    
+    /**
+     * \brief Multiplier that quantizes floating point samples.
+     */
+    double inputScale() const {return std::ldexp(1.0, 8 * (int) sizeof(A) - 2 - growth) / fullScale;}
+    
+    Register toRegister(T sample, double scale, std::true_type) const;
+    Register toRegister(T sample, double, std::false_type) const {return (Register) (A) sample;}
+    T fromRegister(Register value, double scale, std::true_type) const
+            {return (T) ((double) (A) value / (scale * gain));}
+    T fromRegister(Register value, double scale, std::false_type) const;
+    
+    /**
+     * \brief Runs "value" through the combs.
+     */
+    Register combs(Register value);
+    
+    /**
+     * \brief Runs a block of "len" samples through the integrators in place, one stage at a time.
+     */
+    void integrate(Register *block, int len);
+    
+    /**
+     * \brief Working buffer for a block of samples at the high rate.  Keeps its capacity from call
+     *      to call.
+     */
+    std::vector<Register> registerBuf;
+    
+ public:
+    /**
+     * \brief Number of bits the outputs are shifted down by.  Only used for integer samples.
+     */
+    int outputShift;
+    
+    /**
+     * \brief How the bits that are shifted off are rounded.  Defaults to NimbleDSP::ROUND_HALF_UP.
+     *      Only used for integer samples.
+     */
+    FixedPtRoundingType rounding;
+    
+    /**
+     * \brief Largest magnitude of the floating point samples.  Defaults to 1.  Only used for
+     *      floating point samples.
+     */
+    double fullScale;
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    int rate() const {return filterRate;}
+    int numStages() const {return stages;}
+    int diffDelay() const {return delay;}
+    
+    /**
+     * \brief Returns the number of bits the outputs grow by, i.e. log2 of the DC gain rounded up.
+     */
+    int bitGrowth() const {return growth;}
+    
+    /**
+     * \brief Clears the streaming state, as if no data had been filtered.
+     */
+    void reset();
+    
+    /**
+     * \brief Designs a filter that flattens this filter's passband droop.  See \ref cicCompensationTaps.
+     *
+     * \param filter Set to the compensation filter.
+     * \param numTaps Number of taps.  Must be odd.
+     * \param passbandEdge Edge of the passband, normalized so that 1.0 is the Nyquist frequency of
+     *      the low rate side.
+     * \param stopbandEdge Start of the stopband.
+     */
+    template <class U>
+    void compensationFilter(RealFirFilter<U> & filter, int numTaps, double passbandEdge, double stopbandEdge) const;
+};
+
+/**
+ * \brief CIC decimator.  See CicFilter.
+ *
+ * The results are the same as a RealFirFilter in NimbleDSP::STREAMING mode, with numStages
+ * boxcars of rate * diffDelay taps convolved together as its taps, decimating by "rate", and
+ * then scaled.
+ */
+template <class T, class A = int64_t>
+class CicDecimator : public CicFilter<T, A> {
+ protected:
+    /**
+     * \brief Number of input samples since the last output.
+     */
+    int phase;
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param rate The decimation rate.
+     * \param numStages Number of integrator and comb stages.
+     * \param diffDelay Differential delay of the combs.  Defaults to 1.
+     */
+    CicDecimator<T, A>(int rate, int numStages, int diffDelay = 1) :
+            CicFilter<T, A>(rate, numStages, diffDelay, std::pow((double) rate * diffDelay, numStages)) {phase = 0;}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Clears the streaming state, as if no data had been filtered.
+     */
+    void reset() {CicFilter<T, A>::reset(); phase = 0;}
+    
+    /**
+     * \brief Decimates "data" in place, continuing from the previous call.
+     *
+     * \param data Buffer to decimate.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    RealVector<T> & decimate(RealVector<T> & data);
+};
+
+/**
+ * \brief CIC interpolator.  See CicFilter.
+ *
+ * The results are the same as a RealFirFilter in NimbleDSP::STREAMING mode, with numStages
+ * boxcars of rate * diffDelay taps convolved together as its taps, interpolating by "rate", and
+ * then scaled.
+ */
+template <class T, class A = int64_t>
+class CicInterpolator : public CicFilter<T, A> {
+ protected:
+    std::vector<T> outBuf;
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param rate The interpolation rate.
+     * \param numStages Number of integrator and comb stages.
+     * \param diffDelay Differential delay of the combs.  Defaults to 1.
+     */
+    CicInterpolator<T, A>(int rate, int numStages, int diffDelay = 1) :
+            CicFilter<T, A>(rate, numStages, diffDelay, std::pow((double) rate * diffDelay, numStages) / rate) {}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Interpolates "data" in place, continuing from the previous call.
+     *
+     * \param data Buffer to interpolate.  Its size is multiplied by the rate.
+     * \return Reference to "data".
+     */
+    RealVector<T> & interp(RealVector<T> & data);
+};
+
+
+template <class T, class A>
+CicFilter<T, A>::CicFilter(int rate, int numStages, int diffDelay, double dcGain) {
+    assert(rate > 0 && numStages > 0 && diffDelay > 0);
+    filterRate = rate;
+    stages = numStages;
+    delay = diffDelay;
+    gain = dcGain;
+    growth = (int) std::ceil(std::log2(dcGain) - 1e-9);
+    if (std::is_floating_point<T>::value) {
+        // Keep at least as many bits of precision as a float has.
+        assert(8 * (int) sizeof(A) - 2 - growth >= 24);
+    }
+    else {
+        assert(growth + 8 * (int) sizeof(T) <= 8 * (int) sizeof(A));
+    }
+    outputShift = growth;
+    rounding = ROUND_HALF_UP;
+    fullScale = 1;
+    integrators.resize(stages);
+    combDelays.resize(stages * delay);
+    reset();
+}
+
+template <class T, class A>
+void CicFilter<T, A>::reset() {
+    std::fill(integrators.begin(), integrators.end(), 0);
+    std::fill(combDelays.begin(), combDelays.end(), 0);
+    combIndex = 0;
+}
+
+template <class T, class A>
+inline typename CicFilter<T, A>::Register CicFilter<T, A>::toRegister(T sample, double scale, std::true_type) const {
+    double limit = scale * fullScale;
+    double quantized = std::floor(sample * scale + 0.5);
+    if (quantized > limit) {
+        quantized = limit;
+    }
+    else if (quantized < -limit) {
+        quantized = -limit;
+    }
+    return (Register) (A) quantized;
+}
+
+template <class T, class A>
+inline T CicFilter<T, A>::fromRegister(Register value, double, std::false_type) const {
+    A scaled = roundedShift((A) value, outputShift, rounding);
+    A limit = (A) std::numeric_limits<T>::max();
+    if (scaled > limit) {
+        scaled = limit;
+    }
+    else if (scaled < -limit) {
+        scaled = -limit;
+    }
+    return (T) scaled;
+}
+
+template <class T, class A>
+inline typename CicFilter<T, A>::Register CicFilter<T, A>::combs(Register value) {
+    for (int s=0; s<stages; s++) {
+        Register delayed = combDelays[s * delay + combIndex];
+        combDelays[s * delay + combIndex] = value;
+        value -= delayed;
+    }
+    if (++combIndex == delay) {
+        combIndex = 0;
+    }
+    return value;
+}
+
+template <class T, class A>
+void CicFilter<T, A>::integrate(Register *block, int len) {
+    for (int s=0; s<stages; s++) {
+        Register sum = integrators[s];
+        for (int i=0; i<len; i++) {
+            sum += block[i];
+            block[i] = sum;
+        }
+        integrators[s] = sum;
+    }
+}
+
+template <class T, class A>
+template <class U>
+void CicFilter<T, A>::compensationFilter(RealFirFilter<U> & filter, int numTaps, double passbandEdge,
+                                         double stopbandEdge) const {
+    std::vector<double> taps;
+    cicCompensationTaps(taps, numTaps, stages, filterRate, delay, passbandEdge, stopbandEdge);
+    filter = RealVector<U>(taps);
+}
+
+template <class T, class A>
+RealVector<T> & CicDecimator<T, A>::decimate(RealVector<T> & data) {
+    typename std::is_floating_point<T>::type isFloat;
+    double scale = this->inputScale();
+    int dataLen = data.size();
+    int rate = this->filterRate;
+    
+    std::vector<typename CicFilter<T, A>::Register> & block = this->registerBuf;
+    block.resize(dataLen);
+    for (int i=0; i<dataLen; i++) {
+        block[i] = this->toRegister(data[i], scale, isFloat);
+    }
+    this->integrate(VECTOR_TO_ARRAY(block), dataLen);
+    
+    // An output is produced whenever "phase" is 0, i.e. at inputs rate apart.
+    unsigned numOut = 0;
+    for (int i=(rate - phase) % rate; i<dataLen; i+=rate) {
+        data[numOut++] = this->fromRegister(this->combs(block[i]), scale, isFloat);
+    }
+    phase = (phase + dataLen) % rate;
+    data.vec.resize(numOut);
+    return data;
+}
+
+/**
+ * \brief Decimates "data" in place with "cic", continuing from the previous call.
+ *
+ * \param data Buffer to decimate.
+ * \param cic The decimator.  Holds the rate and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T, class A>
+inline RealVector<T> & decimate(RealVector<T> & data, CicDecimator<T, A> & cic) {
+    return cic.decimate(data);
+}
+
+template <class T, class A>
+RealVector<T> & CicInterpolator<T, A>::interp(RealVector<T> & data) {
+    typename std::is_floating_point<T>::type isFloat;
+    double scale = this->inputScale();
+    int dataLen = data.size();
+    int rate = this->filterRate;
+    
+    // The zeros that are stuffed between the samples don't change the combs' state, so the combs
+    // run at the low rate.
+    std::vector<typename CicFilter<T, A>::Register> & block = this->registerBuf;
+    block.assign(dataLen * rate, 0);
+    for (int i=0; i<dataLen; i++) {
+        block[i * rate] = this->combs(this->toRegister(data[i], scale, isFloat));
+    }
+    this->integrate(VECTOR_TO_ARRAY(block), dataLen * rate);
+    
+    outBuf.resize(dataLen * rate);
+    for (int i=0; i<dataLen*rate; i++) {
+        outBuf[i] = this->fromRegister(block[i], scale, isFloat);
+    }
+    data.vec.swap(outBuf);
+    return data;
+}
+
+/**
+ * \brief Interpolates "data" in place with "cic", continuing from the previous call.
+ *
+ * \param data Buffer to interpolate.
+ * \param cic The interpolator.  Holds the rate and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T, class A>
+inline RealVector<T> & interp(RealVector<T> & data, CicInterpolator<T, A> & cic) {
+    return cic.interp(data);
+}
+
+};
+
+#endif
@@ -33,6 +33,9 @@ THE SOFTWARE.
 #include <complex>
 #include <math.h>
 #include "ComplexVector.h"
+#include "FastConvolver.h"
+#include "SimdKernels.h"
+#include "VectorView.h"
 
 
 namespace NimbleDSP {
@@ -44,10 +47,19 @@ template <class T>
 class ComplexFirFilter : public ComplexVector<T> {
  protected:
     /**
-     * \brief Saved data that is used for stream filtering.
+     * \brief Saved data that is used for stream filtering.  It is double length, 2 * (size() - 1)
+     *      samples, so that \ref streamingFirInPlace can use the back half to stitch the start of
+     *      a block onto the end of the previous one.
      */
     std::vector<char> savedData;
     
+    /**
+     * \brief Working buffer used when the data has no scratch buffer of its own.  It keeps its
+     *      capacity from call to call, so streaming doesn't allocate once it has grown to the
+     *      block size.
+     */
+    std::vector< std::complex<T> > workBuf;
+    
     /**
      * \brief Indicates how many samples are in \ref savedData.  Used for stream filtering.
      */
@@ -58,6 +70,70 @@ class ComplexFirFilter : public ComplexVector<T> {
      */
     int phase;
     
+    /**
+     * \brief The taps in reverse order, so the direct form inner loops can run forward through
+     *      contiguous memory with \ref dotProduct.  Refreshed by \ref reverseTaps.
+     */
+    std::vector< std::complex<T> > reversedTaps;
+    
+    /**
+     * \brief Symmetry of the current taps, as found by the last \ref reverseTaps or \ref foldInterp.
+     */
+    TapSymmetryType foldSymmetry;
+    
+    /**
+     * \brief Table from \ref foldInterpTaps for streaming interpolation.  Refreshed by \ref foldInterp.
+     */
+    std::vector< std::complex<T> > foldedInterpTaps;
+    
+    /**
+     * \brief The taps split into polyphase branches by \ref buildPhaseBanks.  Refreshed by
+     *      \ref polyphaseBanks.
+     */
+    std::vector< std::complex<T> > phaseBanks;
+    
+    /**
+     * \brief Copies the current taps into \ref reversedTaps and works out their symmetry.
+     */
+    void reverseTaps() {reversedTaps.resize(this->size());
+                        std::reverse_copy(this->vec.begin(), this->vec.end(), reversedTaps.begin());
+                        foldSymmetry = tapSymmetry();}
+    
+    /**
+     * \brief Works out the symmetry of the taps and folds them for interpolating by "rate".
+     *
+     * \return The folded table for \ref streamingFirInterp, or NULL if the taps can't be folded.
+     */
+    const std::complex<T> *foldInterp(int rate) {foldSymmetry = tapSymmetry();
+            return foldInterpTaps(VECTOR_TO_ARRAY(this->vec), this->size(), rate, foldSymmetry, foldedInterpTaps) ?
+                   VECTOR_TO_ARRAY(foldedInterpTaps) : NULL;}
+    
+    /**
+     * \brief Splits the taps into "rate" polyphase branches for interpolation and resampling.
+     */
+    const std::complex<T> *polyphaseBanks(int rate)
+            {buildPhaseBanks(VECTOR_TO_ARRAY(this->vec), this->size(), rate, phaseBanks); return VECTOR_TO_ARRAY(phaseBanks);}
+    
+    /**
+     * \brief FFT convolution engine.  Caches the spectrum of the taps between calls.
+     */
+    FastConvolver<typename FftScalar<T>::type> fastConvolver;
+    
+    /**
+     * \brief Decides whether a convolution should be done with \ref fastConvolver.
+     *
+     * \param numOutputs Number of outputs the convolution will produce.
+     */
+    bool useFftConvolution(int numOutputs);
+    
+    /**
+     * \brief Streaming convolution of "dataLen" samples at "data", in place.  Shared by the vector
+     *      and view versions of conv.  The taps must already be reversed.
+     *
+     * \param work Buffer for the FFT path to stitch the saved samples onto the new ones.
+     */
+    void streamingConv(std::complex<T> *data, int dataLen, std::vector< std::complex<T> > & work);
+    
  public:
     /**
      * \brief Determines how the filter should filter.
@@ -68,6 +144,43 @@ class ComplexFirFilter : public ComplexVector<T> {
      *      filtered one continuous set of data.
      */
     FilterOperationType filtOperation;
+    
+    /**
+     * \brief Determines how the \ref conv method computes the convolution.
+     *
+     * NimbleDSP::DIRECT_CONVOLUTION always uses the direct form.
+     * NimbleDSP::FFT_CONVOLUTION always uses overlap-save FFT convolution (floating point types only).
+     * NimbleDSP::AUTO_CONVOLUTION uses FFT convolution when the filter has at least
+     *      NimbleDSP::FFT_CONVOLUTION_MIN_TAPS taps and it is estimated to be faster.  This is the default.
+     * The results are the same either way, to within floating point rounding.
+     */
+    ConvolutionAlgorithmType convAlgorithm;
+    
+    /**
+     * \brief Says whether the taps are symmetric (h[i] == h[N-1-i]) or antisymmetric
+     *      (h[i] == -h[N-1-i]), as linear phase filters are.
+     *
+     * The direct form convolution, decimation and streaming interpolation fold symmetric and
+     * antisymmetric taps, adding each pair of samples that share a tap before multiplying, which
+     * halves the multiplies.  Convolution and decimation fold filters with at least
+     * NimbleDSP::FOLD_MIN_TAPS taps, and interpolation folds when the number of taps is a multiple
+     * of the rate.
+     * NimbleDSP::DETECT_SYMMETRY checks the taps each time they are used.  This is the default.
+     * NimbleDSP::SYMMETRIC_TAPS and NimbleDSP::ANTISYMMETRIC_TAPS declare the symmetry and skip the
+     *      check.  The filter then acts as if one half of the taps were the mirror image of the
+     *      other, so the declaration has to be true.
+     * NimbleDSP::NO_SYMMETRY never folds.
+     * Assigning new taps with operator= sets it back to NimbleDSP::DETECT_SYMMETRY.
+     */
+    TapSymmetryType symmetry;
+#if defined(NIMBLEDSP_INSTRUMENTATION)
+    /**
+     * \brief This filter's own call counts, samples, time and allocations, across all of its
+     *      filtering methods.  Only there when NIMBLEDSP_INSTRUMENTATION is defined (see
+     *      Instrumentation.h).
+     */
+    InstrumentationCounts instrumentation;
+#endif
 
     /*****************************************************************************************
                                         Constructors
@@ -81,12 +194,14 @@ class ComplexFirFilter : public ComplexVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then the vector methods that require one borrow one from the calling thread's
+     *      workspace (see ScratchBuffer), and the filtering methods use a work buffer that the
+     *      filter keeps between calls.
      */
-    ComplexFirFilter<T>(unsigned size = DEFAULT_BUF_LEN, FilterOperationType operation = STREAMING, std::vector<T> *scratch = NULL) : ComplexVector<T>(size, scratch)
-            {if (size > 0) {savedData.resize((size - 1) * sizeof(std::complex<T>)); numSavedSamples = size - 1;}
-             else {savedData.resize(0); numSavedSamples = 0;} phase = 0; filtOperation = operation;}
+    ComplexFirFilter<T>(unsigned size = DEFAULT_BUF_LEN, FilterOperationType operation = STREAMING, std::vector< std::complex<T> > *scratch = NULL) : ComplexVector<T>(size, scratch)
+            {if (size > 0) {savedData.resize(2 * (size - 1) * sizeof(std::complex<T>)); numSavedSamples = size - 1;}
+             else {savedData.resize(0); numSavedSamples = 0;} phase = 0; filtOperation = operation;
+             convAlgorithm = AUTO_CONVOLUTION; symmetry = DETECT_SYMMETRY;}
     
     /**
      * \brief Vector constructor.
@@ -98,12 +213,14 @@ class ComplexFirFilter : public ComplexVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then the vector methods that require one borrow one from the calling thread's
+     *      workspace (see ScratchBuffer), and the filtering methods use a work buffer that the
+     *      filter keeps between calls.
      */
     template <typename U>
-    ComplexFirFilter<T>(std::vector<U> data, FilterOperationType operation = STREAMING, std::vector<T> *scratch = NULL) : ComplexVector<T>(data, scratch)
-            {savedData.resize((data.size() - 1) * sizeof(std::complex<T>)); numSavedSamples = data.size() - 1; phase = 0; filtOperation = operation;}
+    ComplexFirFilter<T>(std::vector<U> data, FilterOperationType operation = STREAMING, std::vector< std::complex<T> > *scratch = NULL) : ComplexVector<T>(data, NimbleDSP::TIME_DOMAIN, scratch)
+            {savedData.resize(2 * (data.size() - 1) * sizeof(std::complex<T>)); numSavedSamples = data.size() - 1; phase = 0; filtOperation = operation;
+             convAlgorithm = AUTO_CONVOLUTION; symmetry = DETECT_SYMMETRY;}
     
     /**
      * \brief Array constructor.
@@ -116,18 +233,29 @@ class ComplexFirFilter : public ComplexVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then the vector methods that require one borrow one from the calling thread's
+     *      workspace (see ScratchBuffer), and the filtering methods use a work buffer that the
+     *      filter keeps between calls.
      */
     template <typename U>
     ComplexFirFilter<T>(U *data, unsigned dataLen, FilterOperationType operation = STREAMING, std::vector< std::complex<T> > *scratch = NULL) : ComplexVector<T>(data, dataLen, NimbleDSP::TIME_DOMAIN, scratch)
-            {savedData.resize((dataLen - 1) * sizeof(std::complex<T>)); numSavedSamples = dataLen - 1; phase = 0; filtOperation = operation;}
+            {savedData.resize(2 * (dataLen - 1) * sizeof(std::complex<T>)); numSavedSamples = dataLen - 1; phase = 0; filtOperation = operation;
+             convAlgorithm = AUTO_CONVOLUTION; symmetry = DETECT_SYMMETRY;}
     
     /**
      * \brief Copy constructor.
      */
-    ComplexFirFilter<T>(const ComplexFirFilter<T>& other) {this->vec = other.vec; savedData = other.savedData;
-            numSavedSamples = other.numSavedSamples; phase = other.phase; filtOperation = other.filtOperation;}
+    ComplexFirFilter<T>(const ComplexFirFilter<T>& other) : ComplexVector<T>(other) {savedData = other.savedData;
+            numSavedSamples = other.numSavedSamples; phase = other.phase; filtOperation = other.filtOperation;
+            convAlgorithm = other.convAlgorithm; symmetry = other.symmetry; fastConvolver = other.fastConvolver;}
+    
+    /**
+     * \brief Move constructor.  Takes over the taps and the filter state of "other" without
+     *      copying them.
+     */
+    ComplexFirFilter<T>(ComplexFirFilter<T>&& other) : ComplexVector<T>(std::move(other)) {savedData = std::move(other.savedData);
+            numSavedSamples = other.numSavedSamples; phase = other.phase; filtOperation = other.filtOperation;
+            convAlgorithm = other.convAlgorithm; symmetry = other.symmetry; fastConvolver = std::move(other.fastConvolver);}
     
     /*****************************************************************************************
                                             Operators
@@ -135,11 +263,42 @@ class ComplexFirFilter : public ComplexVector<T> {
     /**
      * \brief Assignment operator.
      */
-    ComplexFirFilter<T>& operator=(const Vector<T>& rhs) {this->vec = rhs.vec; savedData.resize(this->size() - 1); phase = 0; filtOperation = STREAMING; return *this;}
+    ComplexFirFilter<T>& operator=(const Vector<T>& rhs) {this->vec = rhs.vec;
+            savedData.assign(2 * (this->size() > 0 ? this->size() - 1 : 0) * sizeof(std::complex<T>), 0);
+            numSavedSamples = this->size() > 0 ? this->size() - 1 : 0; phase = 0; filtOperation = STREAMING;
+            symmetry = DETECT_SYMMETRY; return *this;}
+    
+    /**
+     * \brief Copy assignment operator.  Copies the taps and the filter state.
+     */
+    ComplexFirFilter<T>& operator=(const ComplexFirFilter<T>& rhs) {ComplexVector<T>::operator=(rhs); savedData = rhs.savedData;
+            numSavedSamples = rhs.numSavedSamples; phase = rhs.phase; filtOperation = rhs.filtOperation;
+            convAlgorithm = rhs.convAlgorithm; symmetry = rhs.symmetry; fastConvolver = rhs.fastConvolver; return *this;}
+    
+    /**
+     * \brief Move assignment operator.
+     */
+    ComplexFirFilter<T>& operator=(ComplexFirFilter<T>&& rhs) {ComplexVector<T>::operator=(std::move(rhs)); savedData = std::move(rhs.savedData);
+            numSavedSamples = rhs.numSavedSamples; phase = rhs.phase; filtOperation = rhs.filtOperation;
+            convAlgorithm = rhs.convAlgorithm; symmetry = rhs.symmetry; fastConvolver = std::move(rhs.fastConvolver); return *this;}
     
     /*****************************************************************************************
                                             Methods
     *****************************************************************************************/
+    /**
+     * \brief Clears the streaming state, so that the next call starts a new stream as if the
+     *      filter had just been constructed.  The taps and settings are kept.
+     */
+    void reset() {savedData.assign(savedData.size(), 0); numSavedSamples = this->size() > 0 ? this->size() - 1 : 0;
+            phase = 0;}
+    
+    /**
+     * \brief Returns the symmetry the filter will use: \ref symmetry if it has been declared,
+     *      otherwise what \ref detectTapSymmetry finds in the current taps.
+     */
+    TapSymmetryType tapSymmetry() const {return (symmetry == DETECT_SYMMETRY) ?
+            detectTapSymmetry(VECTOR_TO_ARRAY(this->vec), this->size()) : symmetry;}
+    
     /**
      * \brief Convolution method.
      *
@@ -181,7 +340,12 @@ class ComplexFirFilter : public ComplexVector<T> {
      * \brief Resample method.
      *
      * This method is equivalent to upsampling by "interpRate", filtering, and downsampling
-     *      by "decimateRate", but is much more efficient.
+     *      by "decimateRate", but is much more efficient.  NimbleDSP::STREAMING operation uses the
+     *      same polyphase kernel as PolyphaseResampler, and each call returns every output whose
+     *      newest input sample has arrived.  The stream of outputs doesn't depend on how the input
+     *      is split into blocks.  Before the kernel was shared an output was held back until the
+     *      first sample of its window arrived, so when the number of taps isn't a multiple of
+     *      "interpRate" some outputs now come one call earlier than they used to.
      *
      * \param data The buffer that will be filtered.
      * \param interpRate Indicates how much to upsample.
@@ -191,108 +355,125 @@ class ComplexFirFilter : public ComplexVector<T> {
      * \return Reference to "data", which holds the result of the resampling.
      */
     virtual ComplexVector<T> & resample(ComplexVector<T> & data, int interpRate, int decimateRate, bool trimTails = false);
+    
+    /**
+     * \brief Convolution method for data that the filter doesn't own.
+     *
+     * The view versions of conv, decimate, and interp only support NimbleDSP::STREAMING operation,
+     * since the one-shot modes produce more results than there are inputs.  They share the filter
+     * state with the vector versions, so the two can be mixed in one stream.
+     *
+     * \param data The samples to filter.  They are overwritten with the results.
+     * \return "data".
+     */
+    VectorView< std::complex<T> > conv(VectorView< std::complex<T> > data);
+    
+    /**
+     * \brief Decimate method for data that the filter doesn't own.  Streaming only.
+     *
+     * \param data The samples to filter.  The results are written over the start of it.
+     * \param rate Indicates how much to downsample.
+     * \return View of the results at the start of "data".
+     */
+    VectorView< std::complex<T> > decimate(VectorView< std::complex<T> > data, int rate);
+    
+    /**
+     * \brief Interpolation method for data that the filter doesn't own.  Streaming only.
+     *
+     * \param data The samples to filter.
+     * \param rate Indicates how much to upsample.
+     * \param results Where the results go.  It must hold at least data.size() * rate samples, and
+     *      may be the same memory as "data".
+     * \return View of the results at the start of "results".
+     */
+    VectorView< std::complex<T> > interp(VectorView< std::complex<T> > data, int rate,
+                                         VectorView< std::complex<T> > results);
 };
 
 
+template <class T>
+bool ComplexFirFilter<T>::useFftConvolution(int numOutputs) {
+    if (!std::is_floating_point<T>::value || convAlgorithm == DIRECT_CONVOLUTION || numOutputs <= 0) {
+        return false;
+    }
+    if (convAlgorithm == AUTO_CONVOLUTION && this->size() < FFT_CONVOLUTION_MIN_TAPS) {
+        return false;
+    }
+    
+    fastConvolver.setTaps(this->vec);
+    if (convAlgorithm == FFT_CONVOLUTION) {
+        return true;
+    }
+    return fastConvolver.isFasterThanDirect(numOutputs, false, 8);
+}
+
+template <class T>
+void ComplexFirFilter<T>::streamingConv(std::complex<T> *data, int dataLen, std::vector< std::complex<T> > & work) {
+    std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
+    
+    if (useFftConvolution(dataLen)) {
+        int numHistory = (int) this->size() - 1;
+        work.resize(numHistory + dataLen);
+        for (int i=0; i<numHistory; i++) {
+            work[i] = savedDataArray[i];
+        }
+        for (int i=0; i<dataLen; i++) {
+            work[i + numHistory] = data[i];
+        }
+        fastConvolver.conv(VECTOR_TO_ARRAY(work), work.size(), numHistory, dataLen, data);
+        for (int i=0; i<numHistory; i++) {
+            savedDataArray[i] = work[i + dataLen];
+        }
+    }
+    else {
+        streamingFirInPlace(data, dataLen, VECTOR_TO_ARRAY(reversedTaps), this->size(), savedDataArray, foldSymmetry);
+    }
+}
+
 template <class T>
 ComplexVector<T> & ComplexFirFilter<T>::conv(ComplexVector<T> & data, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::conv", data.size());
     std::vector< std::complex<T> > *dataTmp;
-    std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
     }
 
+    reverseTaps();
     switch (filtOperation) {
 
     case STREAMING:
-        dataTmp->resize((this->size() - 1) + data.size());
-        for (int i=0; i<this->size()-1; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + this->size() - 1] = data[i];
-        }
-        
-        for (resultIndex=0; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex, filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        for (int i=0; i<this->size()-1; i++) {
-            savedDataArray[i] = (*dataTmp)[i + data.size()];
-        }
+        streamingConv(VECTOR_TO_ARRAY(data.vec), data.size(), *dataTmp);
         break;
 
     case ONE_SHOT_RETURN_ALL_RESULTS:
         *dataTmp = data.vec;
         data.resize(data.size() + this->size() - 1);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
+        if (useFftConvolution(data.size())) {
+            fastConvolver.conv(VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), 0, data.size(), VECTOR_TO_ARRAY(data.vec));
+            break;
         }
         
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), 1, 0, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
 
     case ONE_SHOT_TRIM_TAILS:
         *dataTmp = data.vec;
 
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<((int)this->size()-1) - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size() - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        if (useFftConvolution(data.size())) {
+            fastConvolver.conv(VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), initialTrim, data.size(),
+                               VECTOR_TO_ARRAY(data.vec));
+            break;
+        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), 1, initialTrim, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
     }
     return data;
@@ -300,109 +481,43 @@ ComplexVector<T> & ComplexFirFilter<T>::conv(ComplexVector<T> & data, bool trimT
 
 template <class T>
 ComplexVector<T> & ComplexFirFilter<T>::decimate(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::decimate", data.size());
     std::vector< std::complex<T> > *dataTmp;
     std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
     }
 
+    reverseTaps();
     switch (filtOperation) {
 
-    case STREAMING: {
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        data.resize((data.size() + numSavedSamples - (this->size() - 1) + rate - 1)/rate);
-        for (resultIndex=0; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate, filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        int nextResultDataPoint = resultIndex * rate;
-        numSavedSamples = dataTmp->size() - nextResultDataPoint;
-
-        for (int i=0; i<numSavedSamples; i++) {
-            savedDataArray[i] = (*dataTmp)[i + nextResultDataPoint];
-        }
-        }
+    case STREAMING:
+        data.resize(streamingFirDecimate(VECTOR_TO_ARRAY(data.vec), data.size(), rate, VECTOR_TO_ARRAY(reversedTaps),
+                                         this->size(), savedDataArray, numSavedSamples, *dataTmp,
+                                         VECTOR_TO_ARRAY(data.vec), foldSymmetry));
         break;
 
     case ONE_SHOT_RETURN_ALL_RESULTS:
         *dataTmp = data.vec;
         data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
         
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<((int)this->size()-1+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), rate, 0, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
 
     case ONE_SHOT_TRIM_TAILS:
         *dataTmp = data.vec;
         data.resize((data.size() + rate - 1) / rate);
         
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<(((int)this->size()-1) - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size() - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), rate, initialTrim, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
     }
     return data;
@@ -410,16 +525,12 @@ ComplexVector<T> & ComplexFirFilter<T>::decimate(ComplexVector<T> & data, int ra
 
 template <class T>
 ComplexVector<T> & ComplexFirFilter<T>::interp(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector< std::complex<T> > scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::interp", data.size());
     std::vector< std::complex<T> > *dataTmp;
     std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
@@ -428,48 +539,12 @@ ComplexVector<T> & ComplexFirFilter<T>::interp(ComplexVector<T> & data, int rate
     switch (filtOperation) {
 
     case STREAMING: {
-        int numTaps = (this->size() + rate - 1) / rate;
-        if (numSavedSamples >= numTaps) {
-            // First call to interp, have too many "saved" (really just the initial zeros) samples
-            numSavedSamples = numTaps - 1;
-            phase = (numTaps - 1) * rate;
-        }
-        
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        data.resize(dataTmp->size() * rate);
-        bool keepGoing = true;
-        for (resultIndex=0, dataStart=0, filterStart=phase; keepGoing; ++resultIndex) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-                if (dataTmp->size() - dataStart == numSavedSamples) {
-                    keepGoing = false;
-                    phase = filterStart;
-                }
-            }
-        }
-        data.resize(resultIndex);
-
-        int i;
-        for (i=0; dataStart<dataTmp->size(); i++, dataStart++) {
-            savedDataArray[i] = (*dataTmp)[dataStart];
-        }
-        numSavedSamples = i;
+        int dataLen = data.size();
+        data.resize(dataLen * rate);
+        const std::complex<T> *folded = foldInterp(rate);
+        data.resize(streamingFirInterp(VECTOR_TO_ARRAY(data.vec), dataLen, rate, polyphaseBanks(rate),
+                                       this->size(), savedDataArray, numSavedSamples, phase, *dataTmp,
+                                       VECTOR_TO_ARRAY(data.vec), folded, foldSymmetry));
         }
         break;
 
@@ -477,91 +552,16 @@ ComplexVector<T> & ComplexFirFilter<T>::interp(ComplexVector<T> & data, int rate
         *dataTmp = data.vec;
         data.resize(data.size() * rate + this->size() - 1 - (rate - 1));
         
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (dataStart=0, filterStart=resultIndex; resultIndex<(int)dataTmp->size()*rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int) this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
 
     case ONE_SHOT_TRIM_TAILS:
         *dataTmp = data.vec;
         data.resize(data.size() * rate);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1 - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-       
-        // Middle full overlap
-        for (dataStart=0, filterStart=(int)this->size()-1; resultIndex<(int)dataTmp->size()*rate - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
     }
     return data;
@@ -569,17 +569,13 @@ ComplexVector<T> & ComplexFirFilter<T>::interp(ComplexVector<T> & data, int rate
 
 template <class T>
 ComplexVector<T> & ComplexFirFilter<T>::resample(ComplexVector<T> & data, int interpRate, int decimateRate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::resample", data.size());
     int interpLen, resampLen;
-    std::vector< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
@@ -590,48 +586,16 @@ ComplexVector<T> & ComplexFirFilter<T>::resample(ComplexVector<T> & data, int in
     case STREAMING: {
         int numTaps = (this->size() + interpRate - 1) / interpRate;
         if (numSavedSamples >= numTaps) {
-            // First call to interp, have too many "saved" (really just the initial zeros) samples
+            // First call to resample, have too many "saved" (really just the initial zeros) samples
             numSavedSamples = numTaps - 1;
-            phase = (numTaps - 1) * interpRate;
-        }
-        
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
+            phase = 0;
         }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        interpLen = dataTmp->size() * interpRate;
-        resampLen = (interpLen + decimateRate - 1) / decimateRate;
-        data.resize(resampLen);
-        bool keepGoing = true;
-        for (resultIndex=0, dataStart=0, filterStart=phase; keepGoing; ++resultIndex) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-            if (dataTmp->size() - dataStart == numSavedSamples) {
-                keepGoing = false;
-                phase = filterStart;
-            }
-        }
-        data.resize(resultIndex);
         
-        int i;
-        for (i=0; dataStart<dataTmp->size(); i++, dataStart++) {
-            savedDataArray[i] = (*dataTmp)[dataStart];
-        }
-        numSavedSamples = i;
+        dataTmp->resize(((long) data.size() * interpRate + decimateRate - 1) / decimateRate + 1);
+        dataTmp->resize(streamingPolyphaseResample(data.vec.data(), data.size(), interpRate, decimateRate,
+                                                   polyphaseBanks(interpRate), numTaps, savedDataArray, phase,
+                                                   VECTOR_TO_ARRAY(*dataTmp)));
+        data.vec.swap(*dataTmp);
         }
         break;
 
@@ -641,52 +605,8 @@ ComplexVector<T> & ComplexFirFilter<T>::resample(ComplexVector<T> & data, int in
         resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
         
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0, filterStart=0; resultIndex<((int)this->size()-1+decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
 
     case ONE_SHOT_TRIM_TAILS:
@@ -694,60 +614,70 @@ ComplexVector<T> & ComplexFirFilter<T>::resample(ComplexVector<T> & data, int in
         interpLen = data.size() * interpRate;
         resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0, filterStart=initialTrim;
-             resultIndex<((int)this->size()-1 - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
     }
     return data;
 }
 
+template <class T>
+VectorView< std::complex<T> > ComplexFirFilter<T>::conv(VectorView< std::complex<T> > data) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::conv", data.size());
+    assert(filtOperation == STREAMING);
+    reverseTaps();
+    streamingConv(data.data(), data.size(), workBuf);
+    return data;
+}
+
+template <class T>
+VectorView< std::complex<T> > ComplexFirFilter<T>::decimate(VectorView< std::complex<T> > data, int rate) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::decimate", data.size());
+    assert(filtOperation == STREAMING);
+    reverseTaps();
+    return data.subview(0, streamingFirDecimate(data.data(), data.size(), rate, VECTOR_TO_ARRAY(reversedTaps),
+                        this->size(), (std::complex<T> *) VECTOR_TO_ARRAY(savedData), numSavedSamples, workBuf,
+                        data.data(), foldSymmetry));
+}
+
+template <class T>
+VectorView< std::complex<T> > ComplexFirFilter<T>::interp(VectorView< std::complex<T> > data, int rate,
+                                                         VectorView< std::complex<T> > results) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexFirFilter::interp", data.size());
+    assert(filtOperation == STREAMING);
+    assert(results.size() >= data.size() * rate);
+    const std::complex<T> *folded = foldInterp(rate);
+    return results.subview(0, streamingFirInterp(data.data(), data.size(), rate, polyphaseBanks(rate),
+                           this->size(), (std::complex<T> *) VECTOR_TO_ARRAY(savedData), numSavedSamples, phase,
+                           workBuf, results.data(), folded, foldSymmetry));
+}
+
+/**
+ * \brief Streaming convolution of a view.  See ComplexFirFilter::conv.
+ */
+template <class T>
+inline VectorView< std::complex<T> > conv(VectorView< std::complex<T> > data, ComplexFirFilter<T> & filter) {
+    return filter.conv(data);
+}
+
+/**
+ * \brief Streaming decimation of a view.  See ComplexFirFilter::decimate.
+ */
+template <class T>
+inline VectorView< std::complex<T> > decimate(VectorView< std::complex<T> > data, int rate, ComplexFirFilter<T> & filter) {
+    return filter.decimate(data, rate);
+}
+
+/**
+ * \brief Streaming interpolation of a view.  See ComplexFirFilter::interp.
+ */
+template <class T>
+inline VectorView< std::complex<T> > interp(VectorView< std::complex<T> > data, int rate,
+                                            VectorView< std::complex<T> > results, ComplexFirFilter<T> & filter) {
+    return filter.interp(data, rate, results);
+}
+
 
 };
 
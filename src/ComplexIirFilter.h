@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include <vector>
 #include "ComplexVector.h"
+#include "IirKernels.h"
 
 
 namespace NimbleDSP {
@@ -58,6 +59,33 @@ class ComplexIirFilter {
     std::vector< std::complex<T> > numerator;
     std::vector< std::complex<T> > denominator;
     
+    /**
+     * \brief Determines how \ref filter runs the recursion.
+     *
+     * NimbleDSP::SERIAL_IIR filters one sample after another.
+     * NimbleDSP::BLOCK_IIR splits the data into segments and filters them side by side, and across
+     *      \ref threadPool if there is one, fixing up the state at the start of each segment (see
+     *      \ref blockIirFilter).  Data shorter than two segments is filtered serially anyway.
+     * NimbleDSP::AUTO_IIR uses NimbleDSP::BLOCK_IIR for blocks of at least
+     *      NimbleDSP::IIR_BLOCK_MIN_LEN samples.  This is the default.
+     * The results are the same either way, to within floating point rounding, for stable filters.
+     */
+    IirAlgorithmType filterAlgorithm;
+
+    /**
+     * \brief Threads to spread block filtering across, or NULL (the default) to filter on the
+     *      calling thread.  See Vector::threadPool.
+     */
+    ThreadPool *threadPool;
+#if defined(NIMBLEDSP_INSTRUMENTATION)
+    /**
+     * \brief This filter's own call counts, samples, time and allocations, across all of its
+     *      filtering methods.  Only there when NIMBLEDSP_INSTRUMENTATION is defined (see
+     *      Instrumentation.h).
+     */
+    InstrumentationCounts instrumentation;
+#endif
+    
     /*****************************************************************************************
                                         Constructors
     *****************************************************************************************/
@@ -74,7 +102,8 @@ class ComplexIirFilter {
      *      returns.
      */
     ComplexIirFilter<T>(unsigned order = 2) {numerator = std::vector< std::complex<T> >(order + 1);
-            denominator = std::vector< std::complex<T> >(order + 1); state = std::vector< std::complex<T> >(order + 1);}
+            denominator = std::vector< std::complex<T> >(order + 1); state = std::vector< std::complex<T> >(order + 1);
+            filterAlgorithm = AUTO_IIR; threadPool = NULL;}
     
     /**
      * \brief Vector constructor.
@@ -114,14 +143,40 @@ class ComplexIirFilter {
                                             Methods
     *****************************************************************************************/
     /**
-     * \brief Convolution method.
+     * \brief Returns the order of the filter, max(numerator.size(), denominator.size()) - 1.
+     */
+    unsigned order() const {return state.size() - 1;}
+
+    /**
+     * \brief Returns the filter state, which is what \ref filter picks up from on its next call.
      *
-     * \param data The vector that will be filtered.
-     * \param trimTails "False" tells the method to return the entire convolution, which is
-     *      the length of "data" plus the length of "this" (the filter) - 1.  "True" tells the
-     *      method to retain the size of "data" by trimming the tails at both ends of
-     *      the convolution.
-     * \return Reference to "data", which holds the result of the convolution.
+     * This is the final state of the last call (the "zf" of other tools) or what \ref setState
+     * set.  It has \ref order values, the most recent direct form II intermediate values first:
+     * w[n], w[n-1], ..., where w[n] = x[n] - denominator[1]*w[n-1] - ... and
+     * y[n] = numerator[0]*w[n] + numerator[1]*w[n-1] + ....  That isn't the transposed direct form
+     * state that some other tools use, but a state saved here can always be restored here.
+     */
+    std::vector< std::complex<T> > getState() const {return std::vector< std::complex<T> >(state.begin(), state.begin() + order());}
+
+    /**
+     * \brief Sets the state that \ref filter picks up from (the "zi" of other tools), in the
+     *      format \ref getState returns.  Lets a stream be checkpointed and resumed, or filtering
+     *      started from something other than rest.
+     */
+    void setState(const std::vector< std::complex<T> > & initialState) {assert(initialState.size() == order());
+            std::copy(initialState.begin(), initialState.end(), state.begin()); state.back() = 0;}
+
+    /**
+     * \brief Clears the state, as if the filter had only ever seen zeros.
+     */
+    void reset() {std::fill(state.begin(), state.end(), 0);}
+
+    /**
+     * \brief Filtering method.  The state carries over from call to call, so data can be filtered
+     *      in blocks as if it were a continuous stream.  See \ref filterAlgorithm.
+     *
+     * \param data The vector that will be filtered, in place.
+     * \return Reference to "data", which holds the filtered samples.
      */
     template <class U>
     ComplexVector<U> & filter(ComplexVector<U> & data);
@@ -143,14 +198,24 @@ void ComplexIirFilter<T>::initArray(U *num, unsigned numLen, U *den, unsigned de
     }
     
     state = std::vector< std::complex<T> >(std::max(numLen, denLen));
+    filterAlgorithm = AUTO_IIR;
+    threadPool = NULL;
 }
 
 template <class T>
 template <class U>
 ComplexVector<U> & ComplexIirFilter<T>::filter(ComplexVector<U> & data) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("ComplexIirFilter::filter", data.size());
     unsigned resultIndex, i;
     std::complex<U> newState0;
     
+    if (data.size() > 0 && (filterAlgorithm == BLOCK_IIR || (filterAlgorithm == AUTO_IIR && data.size() >= IIR_BLOCK_MIN_LEN))) {
+        assert(state.size() == std::max(numerator.size(), denominator.size()));
+        blockIirFilter(threadPool, VECTOR_TO_ARRAY(data.vec), data.size(), VECTOR_TO_ARRAY(numerator), numerator.size(),
+                       VECTOR_TO_ARRAY(denominator), denominator.size(), VECTOR_TO_ARRAY(state));
+        return data;
+    }
+
     for (resultIndex=0; resultIndex<data.size(); resultIndex++) {
         newState0 = data[resultIndex];
         
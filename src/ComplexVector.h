@@ -32,7 +32,10 @@ THE SOFTWARE.
 
 #include <complex>
 #include "Vector.h"
-#include "kissfft.hh"
+#include "FftPlan.h"
+#include "VectorExpression.h"
+#include "SimdKernels.h"
+#include "FastMath.h"
 
 
 
@@ -46,9 +49,11 @@ enum DomainType {TIME_DOMAIN, FREQUENCY_DOMAIN};
  * The template type should be the "plain old data" type that you want to use, not "std::complex"
  * or your own custom complex class.  The object will automatically convert the buffer type to
  * std::complex<POD_type> for you.
+ *
+ * \tparam Allocator Allocator for the samples (see Vector).
  */
-template <class T>
-class ComplexVector : public Vector< std::complex<T> > {
+template <class T, class Allocator = std::allocator< std::complex<T> > >
+class ComplexVector : public Vector< std::complex<T>, Allocator > {
  public:
     /**
      * \brief Indicates whether the data in \ref buf is time domain data or frequency domain.
@@ -67,11 +72,11 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
-    ComplexVector<T>(unsigned size = DEFAULT_BUF_LEN, std::vector< std::complex<T> > *scratch = NULL) :
-            Vector< std::complex<T> >(size, scratch) {domain = TIME_DOMAIN;}
+    ComplexVector<T, Allocator>(unsigned size = DEFAULT_BUF_LEN, std::vector< std::complex<T> > *scratch = NULL) :
+            Vector< std::complex<T>, Allocator >(size, scratch) {domain = TIME_DOMAIN;}
             
     /**
      * \brief Vector constructor.
@@ -83,14 +88,14 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      * \param dataDomain Indicates whether the data is time domain data or frequency domain.
      *      Valid values are NimbleDSP::TIME_DOMAIN and NimbleDSP::FREQUENCY_DOMAIN.
      */
     template <typename U>
-    ComplexVector<T>(std::vector<U> data, DomainType dataDomain=TIME_DOMAIN,
-                std::vector< std::complex<T> > *scratch = NULL) : Vector< std::complex<T> >(data, scratch)
+    ComplexVector<T, Allocator>(std::vector<U> data, DomainType dataDomain=TIME_DOMAIN,
+                std::vector< std::complex<T> > *scratch = NULL) : Vector< std::complex<T>, Allocator >(data, scratch)
                     {domain = dataDomain;}
     
     /**
@@ -104,21 +109,40 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      * \param dataDomain Indicates whether the data is time domain data or frequency domain.
      *      Valid values are NimbleDSP::TIME_DOMAIN and NimbleDSP::FREQUENCY_DOMAIN.
      */
     template <typename U>
-    ComplexVector<T>(U *data, unsigned dataLen, DomainType dataDomain=TIME_DOMAIN,
-                std::vector< std::complex<T> > *scratch = NULL) : Vector< std::complex<T> >(data, dataLen, scratch)
+    ComplexVector<T, Allocator>(U *data, unsigned dataLen, DomainType dataDomain=TIME_DOMAIN,
+                std::vector< std::complex<T> > *scratch = NULL) : Vector< std::complex<T>, Allocator >(data, dataLen, scratch)
                     {domain = dataDomain;}
     
     /**
      * \brief Copy constructor.
      */
-    ComplexVector<T>(const ComplexVector<T>& other)
-            {this->vec = other.vec; domain = other.domain; this->scratchBuf = other.scratchBuf;}
+    ComplexVector<T, Allocator>(const ComplexVector<T, Allocator>& other) :
+            Vector< std::complex<T>, Allocator >(other), domain(other.domain) {}
+    
+    /**
+     * \brief Move constructor.  Takes over the contents of "other" without copying them.
+     */
+    ComplexVector<T, Allocator>(ComplexVector<T, Allocator>&& other) :
+            Vector< std::complex<T>, Allocator >(std::move(other)),
+            domain(other.domain) {}
+    
+    /**
+     * \brief Expression constructor.  Evaluates "expr" (see \ref lazy) in a single pass.
+     *
+     * \param expr The expression.
+     * \param dataDomain Indicates whether the data is time domain data or frequency domain.
+     * \param scratch Pointer to a scratch buffer.
+     */
+    template <class E>
+    ComplexVector<T, Allocator>(const VectorExpression<E> & expr, DomainType dataDomain=TIME_DOMAIN,
+                std::vector< std::complex<T> > *scratch = NULL) : Vector< std::complex<T>, Allocator >(0, scratch)
+                    {domain = dataDomain; evaluate(expr, this->vec);}
     
     /*****************************************************************************************
                                             Operators
@@ -127,71 +151,118 @@ class ComplexVector : public Vector< std::complex<T> > {
      * \brief Assignment operator from ComplexVector.
      * \return Reference to "this".
      */
-    ComplexVector<T>& operator=(const ComplexVector<T>& rhs);
+    ComplexVector<T, Allocator>& operator=(const ComplexVector<T, Allocator>& rhs);
     
     /**
      * \brief Assignment operator from Vector.
      * \return Reference to "this".
      */
-    ComplexVector<T>& operator=(const Vector<T>& rhs);
+    ComplexVector<T, Allocator>& operator=(const Vector<T>& rhs);
+    
+    /**
+     * \brief Move assignment operator.
+     * \return Reference to "this".
+     */
+    ComplexVector<T, Allocator>& operator=(ComplexVector<T, Allocator>&& rhs)
+            {this->vec = std::move(rhs.vec); domain = rhs.domain; return *this;}
+    
+    /**
+     * \brief Expression assignment operator.  Evaluates "expr" (see \ref lazy) in a single pass.
+     *      "this" may appear in the expression.
+     * \return Reference to "this".
+     */
+    template <class E>
+    ComplexVector<T, Allocator>& operator=(const VectorExpression<E> & expr) {evaluate(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Adds an expression to "this" in a single pass.
+     * \return Reference to "this".
+     */
+    template <class E>
+    ComplexVector<T, Allocator>& operator+=(const VectorExpression<E> & expr)
+            {evaluateWith<AddOperation>(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Subtracts an expression from "this" in a single pass.
+     * \return Reference to "this".
+     */
+    template <class E>
+    ComplexVector<T, Allocator>& operator-=(const VectorExpression<E> & expr)
+            {evaluateWith<SubtractOperation>(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Multiplies "this" by an expression in a single pass.
+     * \return Reference to "this".
+     */
+    template <class E>
+    ComplexVector<T, Allocator>& operator*=(const VectorExpression<E> & expr)
+            {evaluateWith<MultiplyOperation>(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Divides "this" by an expression in a single pass.
+     * \return Reference to "this".
+     */
+    template <class E>
+    ComplexVector<T, Allocator>& operator/=(const VectorExpression<E> & expr)
+            {evaluateWith<DivideOperation>(expr, this->vec); return *this;}
     
     /**
      * \brief Unary minus (negation) operator.
      * \return Reference to "this".
      */
-    ComplexVector<T> & operator-();
+    ComplexVector<T, Allocator> & operator-();
     
     /**
      * \brief Add Buffer/Assignment operator.
      * \return Reference to "this".
      */
-    template <class U>
-    ComplexVector<T> & operator+=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    ComplexVector<T, Allocator> & operator+=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Add Scalar/Assignment operator.
      * \return Reference to "this".
      */
-    ComplexVector<T> & operator+=(const std::complex<T> &rhs);
+    ComplexVector<T, Allocator> & operator+=(const std::complex<T> &rhs);
     
     /**
      * \brief Subtract Buffer/Assignment operator.
      * \return Reference to "this".
      */
-    template <class U>
-    ComplexVector<T> & operator-=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    ComplexVector<T, Allocator> & operator-=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Subtract Scalar/Assignment operator.
      * \return Reference to "this".
      */
-    ComplexVector<T> & operator-=(const std::complex<T> &rhs);
+    ComplexVector<T, Allocator> & operator-=(const std::complex<T> &rhs);
     
     /**
      * \brief Multiply Buffer/Assignment operator.
      * \return Reference to "this".
      */
-    template <class U>
-    ComplexVector<T> & operator*=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    ComplexVector<T, Allocator> & operator*=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Multiply Scalar/Assignment operator.
      * \return Reference to "this".
      */
-    ComplexVector<T> & operator*=(const std::complex<T> &rhs);
+    ComplexVector<T, Allocator> & operator*=(const std::complex<T> &rhs);
     
     /**
      * \brief Divide Buffer/Assignment operator.
      * \return Reference to "this".
      */
-    template <class U>
-    ComplexVector<T> & operator/=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    ComplexVector<T, Allocator> & operator/=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Divide Scalar/Assignment operator.
      * \return Reference to "this".
      */
-    ComplexVector<T> & operator/=(const std::complex<T> &rhs);
+    ComplexVector<T, Allocator> & operator/=(const std::complex<T> &rhs);
     
     /*****************************************************************************************
                                             Methods
@@ -209,22 +280,31 @@ class ComplexVector : public Vector< std::complex<T> > {
      * \param exponent Exponent to use.
      * \return Reference to "this".
      */
-    ComplexVector<T> & pow(const std::complex<SLICKDSP_FLOAT_TYPE> & exponent);
+    ComplexVector<T, Allocator> & pow(const std::complex<typename FloatTypeTraits<T>::type> & exponent);
     
     /**
      * \brief Returns the mean (average) of the data in \ref buf.
+     *
+     * \tparam A The type that the sum is accumulated in and returned in.  See FloatTypeTraits.
      */
-    const std::complex<SLICKDSP_FLOAT_TYPE> mean() const;
+    template <class A = typename FloatTypeTraits<T>::type>
+    const std::complex<A> mean() const;
     
     /**
      * \brief Returns the variance of the data in \ref buf.
+     *
+     * \tparam A The type that the sums are accumulated in and returned in.  See FloatTypeTraits.
      */
-    const SLICKDSP_FLOAT_TYPE var() const;
+    template <class A = typename FloatTypeTraits<T>::type>
+    const A var() const;
     
     /**
      * \brief Returns the standard deviation of the data in \ref buf.
+     *
+     * \tparam A The type that the sums are accumulated in and returned in.  See FloatTypeTraits.
      */
-    const SLICKDSP_FLOAT_TYPE stdDev() const {return std::sqrt(this->var());}
+    template <class A = typename FloatTypeTraits<T>::type>
+    const A stdDev() const {return std::sqrt(this->template var<A>());}
     
     /**
      * \brief Sets the upper and lower limit of the values in \ref buf.
@@ -235,71 +315,119 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      independently on the real and imaginary elements of \ref buf.
      * \return Reference to "this".
      */
-    ComplexVector<T> & saturate(const std::complex<T> & val);
+    ComplexVector<T, Allocator> & saturate(const std::complex<T> & val);
     
     /**
      * \brief Conjugates the data in \ref buf.
      * \return Reference to "this".
      */
-    ComplexVector<T> & conj();
+    ComplexVector<T, Allocator> & conj();
     
     /**
      * \brief Sets each element of \ref buf equal to its magnitude squared.
      * \return Reference to "this".
      */
-    ComplexVector<T> & magSq();
+    ComplexVector<T, Allocator> & magSq();
     
     /**
      * \brief Sets each element of \ref buf equal to its angle.
      *
      * The angle is held in the real portion of \ref buf.
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastAtan2.  Defaults to NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    ComplexVector<T> & angle();
+    ComplexVector<T, Allocator> & angle(MathAccuracyType accuracy = EXACT_MATH);
+    
+    /**
+     * \brief Polar discriminator.  Sets each element equal to the angle of itself times the conjugate
+     *      of the element before it, i.e. the phase change from one sample to the next.
+     *
+     * This is what FM demodulation needs, and unlike angle followed by diff the result never has to
+     * be unwrapped.  It is computed in one pass over the data.  The angle is held in the real portion
+     * of \ref buf.
+     * \param previous The sample before the first element.  On return it holds the last element
+     *      (before it was replaced), so that the next block carries on where this one left off.
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastAtan2.  Defaults to NimbleDSP::EXACT_MATH.
+     * \return Reference to "this".
+     */
+    ComplexVector<T, Allocator> & angleDiff(std::complex<T> & previous, MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Sets \ref buf equal to the FFT of the data in \ref buf.
      *
+     * Uses the calling thread's cached plan for this size (see NimbleDSP::fftPlan).  Sets
+     * \ref domain equal to NimbleDSP::FREQUENCY_DOMAIN.
+     * \return Reference to "this".
+     */
+    ComplexVector<T, Allocator> & fft() {return fft(fftPlan<T>(this->size(), false));}
+    
+    /**
+     * \brief Sets \ref buf equal to the FFT of the data in \ref buf using "plan".
+     *
+     * The results are computed into the scratch buffer and swapped into \ref buf, so if a
+     * scratch buffer was provided and has already grown to this size nothing is allocated.
      * Sets \ref domain equal to NimbleDSP::FREQUENCY_DOMAIN.
+     * \param plan Forward FFT plan with the same size as \ref buf.
      * \return Reference to "this".
      */
-    ComplexVector<T> & fft();
+    ComplexVector<T, Allocator> & fft(FftPlan<T> & plan);
     
     /**
      * \brief Sets \ref buf equal to the inverse FFT of the data in \ref buf.
      *
+     * Uses the calling thread's cached plan for this size (see NimbleDSP::fftPlan).  Sets
+     * \ref domain equal to NimbleDSP::TIME_DOMAIN.
+     * \return Reference to "this".
+     */
+    ComplexVector<T, Allocator> & ifft() {return ifft(fftPlan<T>(this->size(), true));}
+    
+    /**
+     * \brief Sets \ref buf equal to the inverse FFT of the data in \ref buf using "plan".
+     *
+     * The results are computed into the scratch buffer and swapped into \ref buf, so if a
+     * scratch buffer was provided and has already grown to this size nothing is allocated.
      * Sets \ref domain equal to NimbleDSP::TIME_DOMAIN.
+     * \param plan Inverse FFT plan with the same size as \ref buf.
      * \return Reference to "this".
      */
-    ComplexVector<T> & ifft();
+    ComplexVector<T, Allocator> & ifft(FftPlan<T> & plan);
     
     /**
      * \brief Changes the elements of \ref vec to their absolute value.
      *
+     * \param accuracy NimbleDSP::FAST_MATH takes the square root of the squared magnitude directly
+     *      rather than going through std::hypot, which guards against overflow.  Defaults to
+     *      NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    ComplexVector<T> & abs();
+    ComplexVector<T, Allocator> & abs(MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Sets each element of \ref vec to e^(element).
      *
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastExp and \ref fastPolar.  Defaults to
+     *      NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    ComplexVector<T> & exp();
+    ComplexVector<T, Allocator> & exp(MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Sets each element of \ref vec to the natural log of the element.
      *
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastLog and \ref fastAtan2.  Defaults to
+     *      NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    ComplexVector<T> & log();
+    ComplexVector<T, Allocator> & log(MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Sets each element of \ref vec to the base 10 log of the element.
      *
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastLog and \ref fastAtan2.  Defaults to
+     *      NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    ComplexVector<T> & log10();
+    ComplexVector<T, Allocator> & log10(MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Circular rotation.
@@ -310,14 +438,14 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      the left, and negative values shift it to the right.
      * \return Reference to "this".
      */
-    ComplexVector<T> & rotate(int numToShift);
+    ComplexVector<T, Allocator> & rotate(int numToShift);
     
     /**
      * \brief Reverses the order of the elements in \ref vec.
      *
      * \return Reference to "this".
      */
-    ComplexVector<T> & reverse();
+    ComplexVector<T, Allocator> & reverse();
     
     /**
      * \brief Sets the length of \ref vec to "len".
@@ -328,7 +456,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      * \param val The value to set any new elements to.  Defaults to 0.
      * \return Reference to "this".
      */
-    ComplexVector<T> & resize(unsigned len, T val = (T) 0) {this->vec.resize(len, val); return *this;}
+    ComplexVector<T, Allocator> & resize(unsigned len, T val = (T) 0) {this->vec.resize(len, val); return *this;}
     
     /**
      * \brief Lengthens \ref vec by "len" elements.
@@ -337,7 +465,8 @@ class ComplexVector : public Vector< std::complex<T> > {
      * \param val The value to set the new elements to.  Defaults to 0.
      * \return Reference to "this".
      */
-    ComplexVector<T> & pad(unsigned len, T val = (T) 0) {this->vec.resize(this->size()+len, val); return *this;}
+    ComplexVector<T, Allocator> & pad(unsigned len, T val = (T) 0)
+            {this->vec.resize(this->size()+len, val); return *this;}
     
     /**
      * \brief Inserts rate-1 zeros between samples.
@@ -347,7 +476,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      after).  Valid values are 0 to "rate"-1.  Defaults to 0.
      * \return Reference to "this".
      */
-    ComplexVector<T> & upsample(int rate, int phase = 0);
+    ComplexVector<T, Allocator> & upsample(int rate, int phase = 0);
     
     /**
      * \brief Removes rate-1 samples out of every rate samples.
@@ -357,7 +486,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      are 0 to "rate"-1.  Defaults to 0.
      * \return Reference to "this".
      */
-    ComplexVector<T> & downsample(int rate, int phase = 0);
+    ComplexVector<T, Allocator> & downsample(int rate, int phase = 0);
     
     /**
      * \brief Replaces \ref vec with the cumulative sum of the samples in \ref vec.
@@ -365,7 +494,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      * \param initialVal Initializing value for the cumulative sum.  Defaults to zero.
      * \return Reference to "this".
      */
-	ComplexVector<T> & cumsum(T initialVal = 0);
+	ComplexVector<T, Allocator> & cumsum(T initialVal = 0);
     
     /**
      * \brief Replaces \ref vec with the difference between successive samples in vec.
@@ -373,7 +502,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      * The resulting \ref vec is one element shorter than it was previously.
      * \return Reference to "this".
      */
-	ComplexVector<T> & diff();
+	ComplexVector<T, Allocator> & diff();
     
     /**
      * \brief Replaces \ref vec with the difference between successive samples in vec.
@@ -383,7 +512,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      previous vec.
      * \return Reference to "this".
      */
-    ComplexVector<T> & diff(std::complex<T> & previousVal);
+    ComplexVector<T, Allocator> & diff(std::complex<T> & previousVal);
     
     /**
      * \brief Convolution method.
@@ -395,7 +524,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      the convolution.
      * \return Reference to "data", which holds the result of the convolution.
      */
-    virtual ComplexVector<T> & conv(ComplexVector<T> & data, bool trimTails = false);
+    virtual ComplexVector<T, Allocator> & conv(ComplexVector<T, Allocator> & data, bool trimTails = false);
     
     /**
      * \brief Decimate method.
@@ -410,7 +539,8 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      ends of the convolution.
      * \return Reference to "data", which holds the result of the decimation.
      */
-    virtual ComplexVector<T> & decimate(ComplexVector<T> & data, int rate, bool trimTails = false);
+    virtual ComplexVector<T, Allocator> & decimate(ComplexVector<T, Allocator> & data, int rate,
+                bool trimTails = false);
     
     /**
      * \brief Interpolation method.
@@ -424,7 +554,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      ends of the convolution.
      * \return Reference to "data", which holds the result of the interpolation.
      */
-    virtual ComplexVector<T> & interp(ComplexVector<T> & data, int rate, bool trimTails = false);
+    virtual ComplexVector<T, Allocator> & interp(ComplexVector<T, Allocator> & data, int rate, bool trimTails = false);
     
     /**
      * \brief Resample method.
@@ -440,7 +570,7 @@ class ComplexVector : public Vector< std::complex<T> > {
      *      ends of the convolution.
      * \return Reference to "data", which holds the result of the resampling.
      */
-    virtual ComplexVector<T> & resample(ComplexVector<T> & data, int interpRate, int decimateRate, bool trimTails = false);
+    virtual ComplexVector<T, Allocator> & resample(ComplexVector<T, Allocator> & data, int interpRate, int decimateRate, bool trimTails = false);
     
     /**
      * \brief Generates a complex tone.
@@ -466,16 +596,16 @@ class ComplexVector : public Vector< std::complex<T> > {
 };
 
 
-template <class T>
-ComplexVector<T>& ComplexVector<T>::operator=(const ComplexVector<T>& rhs)
+template <class T, class Allocator>
+ComplexVector<T, Allocator>& ComplexVector<T, Allocator>::operator=(const ComplexVector<T, Allocator>& rhs)
 {
     this->vec = rhs.vec;
     domain = rhs.domain;
     return *this;
 }
 
-template <class T>
-ComplexVector<T>& ComplexVector<T>::operator=(const Vector<T> & rhs)
+template <class T, class Allocator>
+ComplexVector<T, Allocator>& ComplexVector<T, Allocator>::operator=(const Vector<T> & rhs)
 {
     this->vec.resize(rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -485,8 +615,8 @@ ComplexVector<T>& ComplexVector<T>::operator=(const Vector<T> & rhs)
     return *this;
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::operator-()
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator-()
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = -(this->vec[i]);
@@ -494,9 +624,9 @@ ComplexVector<T> & ComplexVector<T>::operator-()
     return *this;
 }
 
-template <class T>
-template <class U>
-ComplexVector<T> & ComplexVector<T>::operator+=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator+=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -505,8 +635,8 @@ ComplexVector<T> & ComplexVector<T>::operator+=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::operator+=(const std::complex<T> & rhs)
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator+=(const std::complex<T> & rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] += rhs;
@@ -517,8 +647,8 @@ ComplexVector<T> & ComplexVector<T>::operator+=(const std::complex<T> & rhs)
 /**
  * \brief Buffer addition operator.
  */
-template <class T, class U>
-inline ComplexVector<T> operator+(ComplexVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline ComplexVector<T, Allocator> operator+(ComplexVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs += rhs;
     return lhs;
@@ -527,16 +657,16 @@ inline ComplexVector<T> operator+(ComplexVector<T> lhs, const Vector<U>& rhs)
 /**
  * \brief Scalar addition operator.
  */
-template <class T>
-inline ComplexVector<T> operator+(ComplexVector<T> lhs, const std::complex<T> & rhs)
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> operator+(ComplexVector<T, Allocator> lhs, const std::complex<T> & rhs)
 {
     lhs += rhs;
     return lhs;
 }
 
-template <class T>
-template <class U>
-ComplexVector<T> & ComplexVector<T>::operator-=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator-=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -545,8 +675,8 @@ ComplexVector<T> & ComplexVector<T>::operator-=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::operator-=(const std::complex<T> &rhs)
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator-=(const std::complex<T> &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] -= rhs;
@@ -557,8 +687,8 @@ ComplexVector<T> & ComplexVector<T>::operator-=(const std::complex<T> &rhs)
 /**
  * \brief Buffer subtraction operator.
  */
-template <class T, class U>
-inline ComplexVector<T> operator-(ComplexVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline ComplexVector<T, Allocator> operator-(ComplexVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs -= rhs;
     return lhs;
@@ -567,16 +697,16 @@ inline ComplexVector<T> operator-(ComplexVector<T> lhs, const Vector<U>& rhs)
 /**
  * \brief Scalar subtraction operator.
  */
-template <class T>
-inline ComplexVector<T> operator-(ComplexVector<T> lhs, const std::complex<T> & rhs)
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> operator-(ComplexVector<T, Allocator> lhs, const std::complex<T> & rhs)
 {
     lhs -= rhs;
     return lhs;
 }
 
-template <class T>
-template <class U>
-ComplexVector<T> & ComplexVector<T>::operator*=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator*=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -585,8 +715,8 @@ ComplexVector<T> & ComplexVector<T>::operator*=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::operator*=(const std::complex<T> &rhs)
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator*=(const std::complex<T> &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] *= rhs;
@@ -597,8 +727,8 @@ ComplexVector<T> & ComplexVector<T>::operator*=(const std::complex<T> &rhs)
 /**
  * \brief Buffer multiplication operator.
  */
-template <class T, class U>
-inline ComplexVector<T> operator*(ComplexVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline ComplexVector<T, Allocator> operator*(ComplexVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs *= rhs;
     return lhs;
@@ -607,16 +737,16 @@ inline ComplexVector<T> operator*(ComplexVector<T> lhs, const Vector<U>& rhs)
 /**
  * \brief Scalar multiplication operator.
  */
-template <class T>
-inline ComplexVector<T> operator*(ComplexVector<T> lhs, const std::complex<T> & rhs)
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> operator*(ComplexVector<T, Allocator> lhs, const std::complex<T> & rhs)
 {
     lhs *= rhs;
     return lhs;
 }
 
-template <class T>
-template <class U>
-ComplexVector<T> & ComplexVector<T>::operator/=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator/=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -625,8 +755,8 @@ ComplexVector<T> & ComplexVector<T>::operator/=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::operator/=(const std::complex<T> &rhs)
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::operator/=(const std::complex<T> &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] /= rhs;
@@ -637,8 +767,8 @@ ComplexVector<T> & ComplexVector<T>::operator/=(const std::complex<T> &rhs)
 /**
  * \brief Buffer division operator.
  */
-template <class T, class U>
-inline ComplexVector<T> operator/(ComplexVector<T> lhs, const Vector<U> & rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline ComplexVector<T, Allocator> operator/(ComplexVector<T, Allocator> lhs, const Vector<U, UAllocator> & rhs)
 {
     lhs /= rhs;
     return lhs;
@@ -647,23 +777,23 @@ inline ComplexVector<T> operator/(ComplexVector<T> lhs, const Vector<U> & rhs)
 /**
  * \brief Scalar division operator.
  */
-template <class T>
-inline ComplexVector<T> operator/(ComplexVector<T> lhs, const std::complex<T> & rhs)
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> operator/(ComplexVector<T, Allocator> lhs, const std::complex<T> & rhs)
 {
     lhs /= rhs;
     return lhs;
 }
  /*
-template <class T>
-Vector< std::complex<T> > & ComplexVector<T>::exp() {
+template <class T, class Allocator>
+Vector< std::complex<T>, Allocator > & ComplexVector<T, Allocator>::exp() {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = std::exp(this->vec[i]);
     }
     return *this;
 }
    */
-template <class T>
-ComplexVector<T> & ComplexVector<T>::pow(const std::complex<SLICKDSP_FLOAT_TYPE> & exponent) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::pow(const std::complex<typename FloatTypeTraits<T>::type> & exponent) {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = std::pow(this->vec[i], exponent);
     }
@@ -677,59 +807,61 @@ ComplexVector<T> & ComplexVector<T>::pow(const std::complex<SLICKDSP_FLOAT_TYPE>
  * \param exponent Exponent to use.
  * \return Reference to "buffer".
  */
-template <class T>
-inline ComplexVector<T> & pow(ComplexVector<T> & buffer, const std::complex<SLICKDSP_FLOAT_TYPE> exponent) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & pow(ComplexVector<T, Allocator> & buffer, const std::complex<typename FloatTypeTraits<T>::type> exponent) {
     return buffer.pow(exponent);
 }
 
-template <class T>
-const std::complex<SLICKDSP_FLOAT_TYPE> ComplexVector<T>::mean() const {
+template <class T, class Allocator>
+template <class A>
+const std::complex<A> ComplexVector<T, Allocator>::mean() const {
     assert(this->size() > 0);
-    std::complex<SLICKDSP_FLOAT_TYPE> sum = 0;
+    std::complex<A> sum = 0;
     for (unsigned i=0; i<this->size(); i++) {
-        sum += this->vec[i];
+        sum += std::complex<A>(this->vec[i].real(), this->vec[i].imag());
     }
-    return sum / ((SLICKDSP_FLOAT_TYPE) this->size());
+    return sum / ((A) this->size());
 }
 
 /**
  * \brief Returns the mean (average) of the data in "buffer".
  */
-template <class T>
-inline const std::complex<SLICKDSP_FLOAT_TYPE> mean(ComplexVector<T> & buffer) {
+template <class T, class Allocator>
+inline const std::complex<typename FloatTypeTraits<T>::type> mean(ComplexVector<T, Allocator> & buffer) {
     return buffer.mean();
 }
 
-template <class T>
-const SLICKDSP_FLOAT_TYPE ComplexVector<T>::var() const {
+template <class T, class Allocator>
+template <class A>
+const A ComplexVector<T, Allocator>::var() const {
     assert(this->size() > 1);
-    std::complex<SLICKDSP_FLOAT_TYPE> meanVal = this->mean();
-    std::complex<SLICKDSP_FLOAT_TYPE> sum = 0;
+    std::complex<A> meanVal = this->template mean<A>();
+    A sum = 0;
     for (unsigned i=0; i<this->size(); i++) {
-        std::complex<SLICKDSP_FLOAT_TYPE> varDiff = this->vec[i] - meanVal;
-        sum += varDiff * std::conj(varDiff);
+        std::complex<A> varDiff = std::complex<A>(this->vec[i].real(), this->vec[i].imag()) - meanVal;
+        sum += std::norm(varDiff);
     }
-    return sum.real() / (this->size() - 1);
+    return sum / (A) (this->size() - 1);
 }
 
 /**
  * \brief Returns the variance of the data in "buffer".
  */
-template <class T>
-inline const SLICKDSP_FLOAT_TYPE var(ComplexVector<T> & buffer) {
+template <class T, class Allocator>
+inline const typename FloatTypeTraits<T>::type var(ComplexVector<T, Allocator> & buffer) {
     return buffer.var();
 }
 
 /**
  * \brief Returns the standard deviation of the data in "buffer".
  */
-template <class T>
-inline const SLICKDSP_FLOAT_TYPE stdDev(ComplexVector<T> & buffer) {
+template <class T, class Allocator>
+inline const typename FloatTypeTraits<T>::type stdDev(ComplexVector<T, Allocator> & buffer) {
     return buffer.stdDev();
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::saturate(const std::complex<T> & val) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::saturate(const std::complex<T> & val) {
     for (unsigned i=0; i<this->size(); i++) {
         if (this->vec[i].real() > val.real())
             this->vec[i].real(val.real());
@@ -753,20 +885,29 @@ ComplexVector<T> & ComplexVector<T>::saturate(const std::complex<T> & val) {
  *      independently on the real and imaginary elements of "vector".
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & saturate(ComplexVector<T> & vector, const std::complex<T> & val) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & saturate(ComplexVector<T, Allocator> & vector, const std::complex<T> & val) {
     return vector.saturate(val);
 }
     
-template <class T>
-ComplexVector<T> & ComplexVector<T>::fft() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::fft(FftPlan<T> & plan) {
+    NIMBLEDSP_INSTRUMENT("ComplexVector::fft", this->size());
     assert(domain == TIME_DOMAIN);
-    kissfft<T> fftEngine = kissfft<T>(this->size(), false);
-    std::vector< std::complex<T> > fftResults(this->size());
+    assert(plan.size() == this->size() && !plan.isInverse());
+    ScratchBuffer< std::complex<T> > scratch;
+    std::vector< std::complex<T> > *fftResults;
+    
+    if (this->scratchBuf == NULL) {
+        fftResults = scratch.get();
+    }
+    else {
+        fftResults = this->scratchBuf;
+    }
+    fftResults->resize(this->size());
     
-    fftEngine.transform((typename kissfft_utils::traits<T>::cpx_type *) VECTOR_TO_ARRAY(this->vec),
-                        (typename kissfft_utils::traits<T>::cpx_type *) VECTOR_TO_ARRAY(fftResults));
-    this->vec = fftResults;
+    plan.transform(VECTOR_TO_ARRAY(this->vec), VECTOR_TO_ARRAY(*fftResults));
+    takeResults(this->vec, *fftResults);
     domain = FREQUENCY_DOMAIN;
     return *this;
 }
@@ -778,13 +919,26 @@ ComplexVector<T> & ComplexVector<T>::fft() {
  * \param buffer Buffer to operate on.
  * \return Reference to "buffer".
  */
-template <class T>
-inline ComplexVector<T> & fft(ComplexVector<T> &buffer) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & fft(ComplexVector<T, Allocator> &buffer) {
     return buffer.fft();
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::conj() {
+/**
+ * \brief Sets "buffer" equal to the FFT of the data in buffer using "plan".
+ *
+ * Sets \ref domain equal to NimbleDSP::FREQUENCY_DOMAIN.
+ * \param buffer Buffer to operate on.
+ * \param plan Forward FFT plan with the same size as "buffer".
+ * \return Reference to "buffer".
+ */
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & fft(ComplexVector<T, Allocator> &buffer, FftPlan<T> &plan) {
+    return buffer.fft(plan);
+}
+
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::conj() {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i].imag(-this->vec[i].imag());
     }
@@ -795,8 +949,8 @@ ComplexVector<T> & ComplexVector<T>::conj() {
  * \brief Conjugates the data in "buffer".
  * \return Reference to "buffer".
  */
-template <class T>
-inline ComplexVector<T> & conj(ComplexVector<T> & buffer) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & conj(ComplexVector<T, Allocator> & buffer) {
     return buffer.conj();
 }
 
@@ -808,8 +962,8 @@ inline T magSq(const std::complex<T> &val) {
     return val.real() * val.real() + val.imag() * val.imag();
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::magSq() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::magSq() {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i].real(NimbleDSP::magSq(this->vec[i]));
         this->vec[i].imag(0);
@@ -821,20 +975,29 @@ ComplexVector<T> & ComplexVector<T>::magSq() {
  * \brief Sets each element of "buffer" equal to its magnitude squared.
  * \return Reference to "buffer".
  */
-template <class T>
-inline ComplexVector<T> & magSq(ComplexVector<T> & buffer) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & magSq(ComplexVector<T, Allocator> & buffer) {
     return buffer.magSq();
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::ifft() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::ifft(FftPlan<T> & plan) {
+    NIMBLEDSP_INSTRUMENT("ComplexVector::ifft", this->size());
     assert(domain == FREQUENCY_DOMAIN);
-    kissfft<T> fftEngine = kissfft<T>(this->size(), true);
-    std::vector< std::complex<T> > fftResults(this->size());
+    assert(plan.size() == this->size() && plan.isInverse());
+    ScratchBuffer< std::complex<T> > scratch;
+    std::vector< std::complex<T> > *fftResults;
     
-    fftEngine.transform((typename kissfft_utils::traits<T>::cpx_type *) VECTOR_TO_ARRAY(this->vec),
-                        (typename kissfft_utils::traits<T>::cpx_type *) VECTOR_TO_ARRAY(fftResults));
-    this->vec = fftResults;
+    if (this->scratchBuf == NULL) {
+        fftResults = scratch.get();
+    }
+    else {
+        fftResults = this->scratchBuf;
+    }
+    fftResults->resize(this->size());
+    
+    plan.transform(VECTOR_TO_ARRAY(this->vec), VECTOR_TO_ARRAY(*fftResults));
+    takeResults(this->vec, *fftResults);
     domain = TIME_DOMAIN;
     return *this;
 }
@@ -846,13 +1009,30 @@ ComplexVector<T> & ComplexVector<T>::ifft() {
  * \param buffer Buffer to operate on.
  * \return Reference to "buffer".
  */
-template <class T>
-inline ComplexVector<T> & ifft(ComplexVector<T> &buffer) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & ifft(ComplexVector<T, Allocator> &buffer) {
     return buffer.ifft();
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::angle() {
+/**
+ * \brief Sets "buffer" equal to the inverse FFT of the data in buffer using "plan".
+ *
+ * Sets \ref domain equal to NimbleDSP::TIME_DOMAIN.
+ * \param buffer Buffer to operate on.
+ * \param plan Inverse FFT plan with the same size as "buffer".
+ * \return Reference to "buffer".
+ */
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & ifft(ComplexVector<T, Allocator> &buffer, FftPlan<T> &plan) {
+    return buffer.ifft(plan);
+}
+
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::angle(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        fastAngle(this->vec.data(), this->size());
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i].real(std::arg(this->vec[i]));
         this->vec[i].imag(0);
@@ -864,11 +1044,56 @@ ComplexVector<T> & ComplexVector<T>::angle() {
  * \brief Sets each element of "buffer" equal to its angle.
  *
  * The angle is held in the real portion of "buffer".
+ * \param accuracy NimbleDSP::FAST_MATH uses \ref fastAtan2.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "buffer".
  */
-template <class T>
-inline ComplexVector<T> & angle(ComplexVector<T> & buffer) {
-    return buffer.angle();
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & angle(ComplexVector<T, Allocator> & buffer,
+            MathAccuracyType accuracy = EXACT_MATH) {
+    return buffer.angle(accuracy);
+}
+
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::angleDiff(std::complex<T> & previous,
+            MathAccuracyType accuracy) {
+    // Work in blocks small enough to stay in cache between the product and the angle.
+    const int blockLen = 256;
+    std::complex<T> *data = this->vec.data();
+    std::complex<T> last = previous;
+    for (int start=0; start<(int)this->size(); start+=blockLen) {
+        int len = std::min(blockLen, (int)this->size() - start);
+        for (int i=start; i<start+len; i++) {
+            std::complex<T> current = data[i];
+            data[i] = std::complex<T>(current.real() * last.real() + current.imag() * last.imag(),
+                                      current.imag() * last.real() - current.real() * last.imag());
+            last = current;
+        }
+        if (accuracy == FAST_MATH) {
+            fastAngle(data + start, len);
+        }
+        else {
+            for (int i=start; i<start+len; i++) {
+                data[i] = std::complex<T>(std::arg(data[i]), 0);
+            }
+        }
+    }
+    previous = last;
+    return *this;
+}
+
+/**
+ * \brief Polar discriminator.  Sets each element of "buffer" equal to the phase change from the
+ *      element before it.
+ *
+ * \param buffer Buffer to operate on.
+ * \param previous The sample before the first element.  Updated to the last element on return.
+ * \param accuracy NimbleDSP::FAST_MATH uses \ref fastAtan2.  Defaults to NimbleDSP::EXACT_MATH.
+ * \return Reference to "buffer".
+ */
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & angleDiff(ComplexVector<T, Allocator> & buffer, std::complex<T> & previous,
+            MathAccuracyType accuracy = EXACT_MATH) {
+    return buffer.angleDiff(previous, accuracy);
 }
 
 /**
@@ -881,8 +1106,14 @@ inline T angle(std::complex<T> &val) {
     return std::arg(val);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::abs() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::abs(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        for (unsigned i=0; i<this->size(); i++) {
+            this->vec[i] = (T) std::sqrt(NimbleDSP::magSq(this->vec[i]));
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = (T) std::abs(this->vec[i]);
     }
@@ -893,15 +1124,24 @@ ComplexVector<T> & ComplexVector<T>::abs() {
  * \brief Changes the elements of \ref vec to their absolute value.
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See ComplexVector::abs.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & abs(ComplexVector<T> & vector) {
-    return vector.abs();
-}
-
-template <class T>
-ComplexVector<T> & ComplexVector<T>::exp() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & abs(ComplexVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.abs(accuracy);
+}
+
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::exp(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        for (unsigned i=0; i<this->size(); i++) {
+            std::complex<T> phasor = fastPolar(this->vec[i].imag());
+            T magnitude = fastExp(this->vec[i].real());
+            this->vec[i] = std::complex<T>(magnitude * phasor.real(), magnitude * phasor.imag());
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = (std::complex<T>) std::exp(this->vec[i]);
     }
@@ -912,15 +1152,23 @@ ComplexVector<T> & ComplexVector<T>::exp() {
  * \brief Sets each element of \ref vec to e^(element).
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See ComplexVector::exp.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & exp(ComplexVector<T> & vector) {
-    return vector.exp();
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & exp(ComplexVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.exp(accuracy);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::log() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::log(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        for (unsigned i=0; i<this->size(); i++) {
+            this->vec[i] = std::complex<T>(fastLog(NimbleDSP::magSq(this->vec[i])) / 2,
+                                           fastAtan2(this->vec[i].imag(), this->vec[i].real()));
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
 		this->vec[i] = (std::complex<T>) std::log(this->vec[i]);
     }
@@ -931,15 +1179,23 @@ ComplexVector<T> & ComplexVector<T>::log() {
  * \brief Sets each element of \ref vec to the natural log of the element.
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See ComplexVector::log.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & log(ComplexVector<T> & vector) {
-    return vector.log();
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & log(ComplexVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.log(accuracy);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::log10() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::log10(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        log(FAST_MATH);
+        for (unsigned i=0; i<this->size(); i++) {
+            this->vec[i] *= (T) 0.4342944819032518;
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
 		this->vec[i] = (std::complex<T>) std::log10(this->vec[i]);
     }
@@ -950,15 +1206,16 @@ ComplexVector<T> & ComplexVector<T>::log10() {
  * \brief Sets each element of \ref vec to the base 10 log of the element.
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See ComplexVector::log10.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & log10(ComplexVector<T> & vector) {
-    return vector.log10();
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & log10(ComplexVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.log10(accuracy);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::rotate(int numToShift) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::rotate(int numToShift) {
     while (numToShift < 0)
         numToShift += this->size();
     
@@ -982,13 +1239,13 @@ ComplexVector<T> & ComplexVector<T>::rotate(int numToShift) {
  *      the left, and negative values shift it to the right.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & rotate(ComplexVector<T> & vector, int numToShift) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & rotate(ComplexVector<T, Allocator> & vector, int numToShift) {
     return vector.rotate(numToShift);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::reverse() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::reverse() {
     std::reverse(this->vec.begin(), this->vec.end());
     return *this;
 }
@@ -999,8 +1256,8 @@ ComplexVector<T> & ComplexVector<T>::reverse() {
  * \param vector Buffer to operate on.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & reverse(ComplexVector<T> & vector) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & reverse(ComplexVector<T, Allocator> & vector) {
     return vector.reverse();
 }
 
@@ -1014,8 +1271,8 @@ ComplexVector<T> & reverse(ComplexVector<T> & vector) {
  * \param val The value to set any new elements to.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & resize(ComplexVector<T> & vector, int len, T val = 0) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & resize(ComplexVector<T, Allocator> & vector, int len, T val = 0) {
     return vector.resize(len, val);
 }
 
@@ -1027,13 +1284,13 @@ ComplexVector<T> & resize(ComplexVector<T> & vector, int len, T val = 0) {
  * \param val The value to set the new elements to.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & pad(ComplexVector<T> & vector, int len, T val = 0) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & pad(ComplexVector<T, Allocator> & vector, int len, T val = 0) {
     return vector.pad(len, val);
 }
     
-template <class T>
-ComplexVector<T> & ComplexVector<T>::upsample(int rate, int phase) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::upsample(int rate, int phase) {
 	assert(rate > 0);
 	assert(phase >= 0 && phase < rate);
 	if (rate == 1)
@@ -1058,13 +1315,13 @@ ComplexVector<T> & ComplexVector<T>::upsample(int rate, int phase) {
  *      after).  Valid values are 0 to "rate"-1.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & upsample(ComplexVector<T> & vector, int rate, int phase = 0) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & upsample(ComplexVector<T, Allocator> & vector, int rate, int phase = 0) {
     return vector.upsample(rate, phase);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::downsample(int rate, int phase) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::downsample(int rate, int phase) {
 	assert(rate > 0);
 	assert(phase >= 0 && phase < rate);
 	if (rate == 1)
@@ -1088,13 +1345,13 @@ ComplexVector<T> & ComplexVector<T>::downsample(int rate, int phase) {
  *      are 0 to "rate"-1.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & downsample(ComplexVector<T> & vector, int rate, int phase = 0) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & downsample(ComplexVector<T, Allocator> & vector, int rate, int phase = 0) {
     return vector.downsample(rate, phase);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::cumsum(T initialVal) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::cumsum(T initialVal) {
     T sum = initialVal;
     for (unsigned i=0; i<this->size(); i++) {
         sum += this->vec[i];
@@ -1110,13 +1367,13 @@ ComplexVector<T> & ComplexVector<T>::cumsum(T initialVal) {
  * \param initialVal Initializing value for the cumulative sum.  Defaults to zero.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & cumsum(ComplexVector<T> & vector, T initialVal = 0) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & cumsum(ComplexVector<T, Allocator> & vector, T initialVal = 0) {
     return vector.cumsum(initialVal);
 }
     
-template <class T>
-ComplexVector<T> & ComplexVector<T>::diff() {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::diff() {
 	assert(this->size() > 1);
 	for (unsigned i=0; i<(this->size()-1); i++) {
 		this->vec[i] = this->vec[i + 1] - this->vec[i];
@@ -1132,13 +1389,13 @@ ComplexVector<T> & ComplexVector<T>::diff() {
  * \param vector Buffer to operate on.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & diff(ComplexVector<T> & vector) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & diff(ComplexVector<T, Allocator> & vector) {
     return vector.diff();
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::diff(std::complex<T> & previousVal) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::diff(std::complex<T> & previousVal) {
 	assert(this->size() > 0);
     std::complex<T> nextPreviousVal = this->vec[this->size()-1];
 	for (unsigned i=this->size()-1; i>0; i--) {
@@ -1158,83 +1415,36 @@ ComplexVector<T> & ComplexVector<T>::diff(std::complex<T> & previousVal) {
  *      previous vec.
  * \return Reference to "vector".
  */
-template <class T>
-ComplexVector<T> & diff(ComplexVector<T> & vector, std::complex<T> & previousVal) {
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & diff(ComplexVector<T, Allocator> & vector, std::complex<T> & previousVal) {
     return vector.diff(previousVal);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::conv(ComplexVector<T> & data, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::conv(ComplexVector<T, Allocator> & data, bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
+    ScratchBuffer< std::complex<T> > reversedTaps;
+    reversedTaps->assign(this->vec.rbegin(), this->vec.rend());
     if (trimTails) {
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<((int)this->size()-1) - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size() - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), 1, initialTrim,
+                   data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(data.size() + this->size() - 1);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1250,85 +1460,39 @@ ComplexVector<T> & ComplexVector<T>::conv(ComplexVector<T> & data, bool trimTail
  *      the convolution.
  * \return Reference to "data", which holds the result of the convolution.
  */
-template <class T>
-inline ComplexVector<T> & conv(ComplexVector<T> & data, ComplexVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & conv(ComplexVector<T, Allocator> & data, ComplexVector<T, Allocator> & filter,
+            bool trimTails = false) {
     return filter.conv(data, trimTails);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::decimate(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::decimate(ComplexVector<T, Allocator> & data, int rate,
+            bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
+    ScratchBuffer< std::complex<T> > reversedTaps;
+    reversedTaps->assign(this->vec.rbegin(), this->vec.rend());
     if (trimTails) {
         data.resize((data.size() + rate - 1) / rate);
-        
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<(((int)this->size()-1) - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size() - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), rate, initialTrim,
+                   data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<((int)this->size()-1+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), rate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1347,114 +1511,35 @@ ComplexVector<T> & ComplexVector<T>::decimate(ComplexVector<T> & data, int rate,
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the decimation.
  */
-template <class T>
-inline ComplexVector<T> & decimate(ComplexVector<T> & data, int rate, ComplexVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & decimate(ComplexVector<T, Allocator> & data, int rate, ComplexVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.decimate(data, rate, trimTails);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::interp(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::interp(ComplexVector<T, Allocator> & data, int rate,
+            bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
     if (trimTails) {
         data.resize(data.size() * rate);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1 - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-       
-        // Middle full overlap
-        for (dataStart=0, filterStart=(int)this->size()-1; resultIndex<(int)dataTmp->size()*rate - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(data.size() * rate + this->size() - 1 - (rate - 1));
-        
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (dataStart=0, filterStart=resultIndex; resultIndex<(int)dataTmp->size()*rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int) this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1472,133 +1557,39 @@ ComplexVector<T> & ComplexVector<T>::interp(ComplexVector<T> & data, int rate, b
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the interpolation.
  */
-template <class T>
-inline ComplexVector<T> & interp(ComplexVector<T> & data, int rate, ComplexVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & interp(ComplexVector<T, Allocator> & data, int rate,
+            ComplexVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.interp(data, rate, trimTails);
 }
 
-template <class T>
-ComplexVector<T> & ComplexVector<T>::resample(ComplexVector<T> & data, int interpRate, int decimateRate,  bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T, Allocator> & ComplexVector<T, Allocator>::resample(ComplexVector<T, Allocator> & data, int interpRate, int decimateRate,  bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
     if (trimTails) {
         int interpLen = data.size() * interpRate;
         int resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0, filterStart=initialTrim;
-             resultIndex<((int)this->size()-1 - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         int interpLen = data.size() * interpRate + this->size() - 1 - (interpRate - 1);
         int resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-        
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0, filterStart=0; resultIndex<((int)this->size()-1+decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1618,14 +1609,14 @@ ComplexVector<T> & ComplexVector<T>::resample(ComplexVector<T> & data, int inter
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the resampling.
  */
-template <class T>
-inline ComplexVector<T> & resample(ComplexVector<T> & data, int interpRate, int decimateRate,
-            ComplexVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T, Allocator> & resample(ComplexVector<T, Allocator> & data, int interpRate, int decimateRate,
+            ComplexVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.resample(data, interpRate, decimateRate, trimTails);
 }
 
-template <class T>
-T ComplexVector<T>::tone(T freq, T sampleFreq, T phase, unsigned numSamples) {
+template <class T, class Allocator>
+T ComplexVector<T, Allocator>::tone(T freq, T sampleFreq, T phase, unsigned numSamples) {
     assert(sampleFreq > 0.0);
     
     if (numSamples && numSamples != this->size()) {
@@ -1652,13 +1643,13 @@ T ComplexVector<T>::tone(T freq, T sampleFreq, T phase, unsigned numSamples) {
  *      this->size() samples.  Defaults to 0.
  * \return Reference to "this".
  */
-template <class T>
-T tone(ComplexVector<T> & vec, T freq, T sampleFreq = 1.0, T phase = 0.0, unsigned numSamples = 0) {
+template <class T, class Allocator>
+T tone(ComplexVector<T, Allocator> & vec, T freq, T sampleFreq = 1.0, T phase = 0.0, unsigned numSamples = 0) {
     return vec.tone(freq, sampleFreq, phase, numSamples);
 }
 
-template <class T>
-T ComplexVector<T>::modulate(T freq, T sampleFreq, T phase) {
+template <class T, class Allocator>
+T ComplexVector<T, Allocator>::modulate(T freq, T sampleFreq, T phase) {
     assert(sampleFreq > 0.0);
     
     T phaseInc = (freq / sampleFreq) * 2 * M_PI;
@@ -1677,8 +1668,8 @@ T ComplexVector<T>::modulate(T freq, T sampleFreq, T phase) {
  * \param phase The modulating tone's starting phase, in radians.  Defaults to 0.
  * \return The next phase if the tone were to continue.
  */
- template <class T>
-T modulate(ComplexVector<T> &data, T freq, T sampleFreq, T phase) {
+ template <class T, class Allocator>
+T modulate(ComplexVector<T, Allocator> &data, T freq, T sampleFreq, T phase) {
     return data.modulate(freq, sampleFreq, phase);
 }
 
@@ -0,0 +1,428 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file Correlator.h
+ *
+ * Definition of the template class Correlator.
+ */
+
+#ifndef NimbleDSP_Correlator_h
+#define NimbleDSP_Correlator_h
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <type_traits>
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "FastConvolver.h"
+#include "SimdKernels.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Streaming cross-correlator and matched filter detector.
+ *
+ * Correlating against a reference is convolving with its conjugated, time reversed taps.  This
+ * class keeps those taps, and their spectrum in a FastConvolver, from construction on, so a long
+ * reference (a preamble, a sync word) is transformed once rather than on every call.  Output n of
+ * a stream is
+ *
+ *      r[n] = sum(x[n - (size() - 1) + k] * conj(reference[k]), k = 0 ... size() - 1)
+ *
+ * i.e. the correlation with the reference starting at input n - (size() - 1), with zero history
+ * before the first input.
+ *
+ * \ref detect fuses the magnitude squared, the optional normalization and the threshold and peak
+ * search into one pass over the correlation, so only the peak indices come back to the caller.
+ */
+template <class T>
+class Correlator {
+ protected:
+    /**
+     * \brief The conjugated reference, in normal order, for direct form correlation.
+     */
+    std::vector< std::complex<T> > conjReference;
+    std::vector<T> realReference;
+
+    /**
+     * \brief Indicates that all of the reference's imaginary parts are zero, so the correlator can
+     *      be used on real data.
+     */
+    bool isRealReference;
+
+    /**
+     * \brief Sum of the reference's magnitudes squared.
+     */
+    T referenceEnergy;
+
+    /**
+     * \brief Holds the spectrum of the conjugated, time reversed reference.
+     */
+    FastConvolver<T> fastConvolver;
+
+    /**
+     * \brief The last size() - 1 input samples.  Sized for complex data so that the same buffer
+     *      works for either kind of data.
+     */
+    std::vector<char> savedData;
+
+    /**
+     * \brief Number of inputs the correlator has seen since it was constructed or reset.
+     */
+    long numInputs;
+
+    /**
+     * \brief Peak search state.  While a peak is being searched for \ref inPeak is set and
+     *      \ref peakValue and \ref peakIndex hold the largest metric so far and where it was.
+     */
+    bool inPeak;
+    T peakValue;
+    long peakIndex;
+
+    /**
+     * \brief Working buffers.  The output buffers are swapped with the caller's data, so once they
+     *      have grown to the block size correlating doesn't allocate.
+     */
+    std::vector<T> workBuf;
+    std::vector<T> outBuf;
+    std::vector< std::complex<T> > complexWorkBuf;
+    std::vector< std::complex<T> > complexOutBuf;
+
+    const T *directTaps(const T *) const {return VECTOR_TO_ARRAY(realReference);}
+    const std::complex<T> *directTaps(const std::complex<T> *) const {return VECTOR_TO_ARRAY(conjReference);}
+
+    template <class U>
+    void correlateBlock(const U *dataIn, int dataLen, U *history, std::vector<U> & buf, std::vector<U> & out);
+
+    template <class U>
+    int findPeaks(const std::vector<U> & buf, const std::vector<U> & corr, T threshold, bool normalize,
+                  std::vector<long> & peaks);
+
+ public:
+    /**
+     * \brief Determines how the correlation is computed.
+     *
+     * NimbleDSP::DIRECT_CONVOLUTION always uses the direct form.
+     * NimbleDSP::FFT_CONVOLUTION always uses overlap-save FFT convolution.
+     * NimbleDSP::AUTO_CONVOLUTION uses the FFT when the reference has at least
+     *      NimbleDSP::FFT_CONVOLUTION_MIN_TAPS samples and it is estimated to be faster.  This is the
+     *      default.
+     */
+    ConvolutionAlgorithmType convAlgorithm;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param reference The signal to correlate against.  Can be real or std::complex.
+     */
+    template <typename U>
+    Correlator<T>(const std::vector<U> & reference)
+            {assert(reference.size() > 0); setReference(VECTOR_TO_ARRAY(reference), reference.size());}
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param reference Array holding the signal to correlate against.
+     * \param referenceLen Number of elements in "reference".
+     */
+    template <typename U>
+    Correlator<T>(const U *reference, unsigned referenceLen) {setReference(reference, referenceLen);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Replaces the reference and clears the streaming state.
+     */
+    template <typename U>
+    void setReference(const U *reference, unsigned referenceLen);
+
+    /**
+     * \brief Clears the streaming state, as if no data had been correlated yet.
+     */
+    void reset();
+
+    /**
+     * \brief Returns the number of samples in the reference.
+     */
+    int size() const {return (int) conjReference.size();}
+
+    /**
+     * \brief Correlates "data" in place, continuing from the previous call.  The reference must be
+     *      real.
+     *
+     * \param data Buffer to correlate.  On return element i holds r[n] for the n'th input, which
+     *      was data[i].  See Correlator.
+     * \return Reference to "data".
+     */
+    RealVector<T> & correlate(RealVector<T> & data);
+
+    /**
+     * \brief Correlates complex "data" in place, continuing from the previous call.
+     *
+     * A correlator should be used for either real or complex data, not both, since they share the
+     * streaming state.
+     * \param data Buffer to correlate.
+     * \return Reference to "data".
+     */
+    ComplexVector<T> & correlateComplex(ComplexVector<T> & data);
+
+    /**
+     * \brief Searches "data" for the reference, continuing from the previous call.  The reference
+     *      must be real.
+     *
+     * The metric is |r[n]|^2, or with "normalize" set |r[n]|^2 divided by the energies of the
+     * reference and of the input it lines up with, which is between 0 and 1 whatever the signal
+     * level.  Once the metric reaches "threshold", the largest metric so far is reported as a peak
+     * when size() start indices go by without a larger one.  Sidelobes are within size() of their
+     * peak, so one occurrence of the reference gives one peak.  The peak is reported once that
+     * search is over, which can be in a later call than the one that contained it, or in
+     * \ref flush at the end of the stream.  Only correlations with the whole reference inside
+     * the stream are searched.  The correlation isn't returned, and "data" isn't changed.
+     *
+     * \param data Buffer to search.
+     * \param peaks The input indices, counted from the start of the stream, that the reference
+     *      starts at in each peak are appended to it.
+     * \param threshold The metric threshold.
+     * \param normalize Normalizes the metric when true.
+     * \return Number of peaks appended to "peaks".
+     */
+    int detect(const RealVector<T> & data, std::vector<long> & peaks, T threshold, bool normalize = true);
+
+    /**
+     * \brief Searches complex "data" for the reference, continuing from the previous call.  See the
+     *      real version.
+     */
+    int detect(const ComplexVector<T> & data, std::vector<long> & peaks, T threshold, bool normalize = true);
+
+    /**
+     * \brief Ends the peak search at the end of the stream.
+     *
+     * A peak that \ref detect found in the last size() start indices is still waiting to see if
+     * a larger one follows, so it hasn't been reported yet.  Call this after the last block to
+     * report it.
+     * \param peaks The pending peak's input index, if there is one, is appended to it.
+     * \return Number of peaks appended to "peaks", 0 or 1.
+     */
+    int flush(std::vector<long> & peaks);
+};
+
+
+template <class T>
+template <typename U>
+void Correlator<T>::setReference(const U *reference, unsigned referenceLen) {
+    assert(referenceLen > 0);
+    conjReference.resize(referenceLen);
+    realReference.resize(referenceLen);
+    std::vector< std::complex<T> > reversed(referenceLen);
+    isRealReference = true;
+    referenceEnergy = 0;
+    for (unsigned k=0; k<referenceLen; k++) {
+        std::complex<T> sample = std::complex<T>(reference[k]);
+        conjReference[k] = std::conj(sample);
+        reversed[referenceLen - 1 - k] = conjReference[k];
+        realReference[k] = sample.real();
+        isRealReference = isRealReference && (sample.imag() == 0);
+        referenceEnergy += std::norm(sample);
+    }
+    fastConvolver.setTaps(reversed);
+    convAlgorithm = AUTO_CONVOLUTION;
+    savedData.resize((referenceLen - 1) * sizeof(std::complex<T>));
+    reset();
+}
+
+template <class T>
+void Correlator<T>::reset() {
+    std::fill(savedData.begin(), savedData.end(), 0);
+    numInputs = 0;
+    inPeak = false;
+    peakValue = 0;
+    peakIndex = 0;
+}
+
+template <class T>
+template <class U>
+void Correlator<T>::correlateBlock(const U *dataIn, int dataLen, U *history, std::vector<U> & buf,
+                                   std::vector<U> & out) {
+    bool realData = std::is_arithmetic<U>::value;
+    assert(isRealReference || !realData);
+    int numHistory = size() - 1;
+    buf.resize(numHistory + dataLen);
+    for (int i=0; i<numHistory; i++) {
+        buf[i] = history[i];
+    }
+    for (int i=0; i<dataLen; i++) {
+        buf[i + numHistory] = dataIn[i];
+    }
+
+    out.resize(dataLen);
+    bool useFft = (convAlgorithm == FFT_CONVOLUTION) ||
+            (convAlgorithm == AUTO_CONVOLUTION && size() >= (int) FFT_CONVOLUTION_MIN_TAPS &&
+             fastConvolver.isFasterThanDirect(dataLen, realData, realData ? 2 : (isRealReference ? 4 : 8)));
+    if (useFft) {
+        fastConvolver.conv(VECTOR_TO_ARRAY(buf), buf.size(), numHistory, dataLen, VECTOR_TO_ARRAY(out));
+    }
+    else {
+        // Output i lines the reference up with buf[i] through buf[i + size() - 1].
+        const U *taps = directTaps(VECTOR_TO_ARRAY(buf));
+        for (int i=0; i<dataLen; i++) {
+            out[i] = dotProduct(VECTOR_TO_ARRAY(buf) + i, taps, size());
+        }
+    }
+
+    for (int i=0; i<numHistory; i++) {
+        history[i] = buf[dataLen + i];
+    }
+}
+
+template <class T>
+template <class U>
+int Correlator<T>::findPeaks(const std::vector<U> & buf, const std::vector<U> & corr, T threshold, bool normalize,
+                             std::vector<long> & peaks) {
+    int dataLen = corr.size();
+    int numPeaks = 0;
+    long firstStart = numInputs - (size() - 1);
+
+    // Energy of buf[i] through buf[i + size() - 1], recomputed every call so that rounding
+    // doesn't build up over a long stream.
+    double energy = 0;
+    for (int k=0; k<size()-1; k++) {
+        energy += std::norm(buf[k]);
+    }
+    for (int i=0; i<dataLen; i++) {
+        energy += std::norm(buf[i + size() - 1]);
+        if (firstStart + i >= 0) {
+            T metric = std::norm(corr[i]);
+            if (normalize) {
+                T denominator = (T) (energy * referenceEnergy);
+                metric = (denominator > 0) ? metric / denominator : 0;
+            }
+            if (inPeak && firstStart + i >= peakIndex + size()) {
+                peaks.push_back(peakIndex);
+                numPeaks++;
+                inPeak = false;
+            }
+            if (metric >= threshold && (!inPeak || metric > peakValue)) {
+                peakValue = metric;
+                peakIndex = firstStart + i;
+                inPeak = true;
+            }
+        }
+        energy -= std::norm(buf[i]);
+    }
+    numInputs += dataLen;
+    return numPeaks;
+}
+
+template <class T>
+RealVector<T> & Correlator<T>::correlate(RealVector<T> & data) {
+    std::vector<T> *dataTmp;
+
+    if (data.scratchBuf == NULL) {
+        dataTmp = &workBuf;
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    correlateBlock(VECTOR_TO_ARRAY(data.vec), data.size(), (T *) savedData.data(), *dataTmp, outBuf);
+    numInputs += data.size();
+    data.vec.swap(outBuf);
+    return data;
+}
+
+/**
+ * \brief Correlates "data" in place with "correlator", continuing from the previous call.
+ *
+ * \param data Buffer to correlate.
+ * \param correlator The correlator.  Holds the reference and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline RealVector<T> & correlate(RealVector<T> & data, Correlator<T> & correlator) {
+    return correlator.correlate(data);
+}
+
+template <class T>
+ComplexVector<T> & Correlator<T>::correlateComplex(ComplexVector<T> & data) {
+    std::vector< std::complex<T> > *dataTmp;
+
+    if (data.scratchBuf == NULL) {
+        dataTmp = &complexWorkBuf;
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    correlateBlock(VECTOR_TO_ARRAY(data.vec), data.size(), (std::complex<T> *) savedData.data(), *dataTmp,
+                   complexOutBuf);
+    numInputs += data.size();
+    data.vec.swap(complexOutBuf);
+    return data;
+}
+
+/**
+ * \brief Correlates complex "data" in place with "correlator", continuing from the previous call.
+ *
+ * \param data Buffer to correlate.
+ * \param correlator The correlator.  Holds the reference and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline ComplexVector<T> & correlate(ComplexVector<T> & data, Correlator<T> & correlator) {
+    return correlator.correlateComplex(data);
+}
+
+template <class T>
+int Correlator<T>::detect(const RealVector<T> & data, std::vector<long> & peaks, T threshold, bool normalize) {
+    correlateBlock(VECTOR_TO_ARRAY(data.vec), data.size(), (T *) savedData.data(), workBuf, outBuf);
+    return findPeaks(workBuf, outBuf, threshold, normalize, peaks);
+}
+
+template <class T>
+int Correlator<T>::detect(const ComplexVector<T> & data, std::vector<long> & peaks, T threshold, bool normalize) {
+    correlateBlock(VECTOR_TO_ARRAY(data.vec), data.size(), (std::complex<T> *) savedData.data(), complexWorkBuf,
+                   complexOutBuf);
+    return findPeaks(complexWorkBuf, complexOutBuf, threshold, normalize, peaks);
+}
+
+template <class T>
+int Correlator<T>::flush(std::vector<long> & peaks) {
+    if (!inPeak) {
+        return 0;
+    }
+    peaks.push_back(peakIndex);
+    inPeak = false;
+    return 1;
+}
+
+};
+
+#endif
@@ -0,0 +1,380 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file FarrowResampler.h
+ *
+ * Definition of the template class FarrowResampler.
+ */
+
+#ifndef NimbleDSP_FarrowResampler_h
+#define NimbleDSP_FarrowResampler_h
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "RealFirFilter.h"
+#include "SimdKernels.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Streaming resampler for arbitrary and time varying ratios, using the Farrow structure.
+ *
+ * PolyphaseResampler needs a bank of taps for every output phase, which is impractical when the
+ * ratio isn't a ratio of small integers or changes as it runs (clock drift correction, Doppler
+ * tracking).  The Farrow structure instead approximates each tap of a fractional delay filter as a
+ * polynomial in the fractional delay "mu".  Each polynomial coefficient forms a branch filter, and
+ * an output is the branch filters' outputs combined with Horner's rule:
+ *
+ *      y = ((v[order] * mu + v[order - 1]) * mu + ...) * mu + v[0]
+ *
+ * where v[p] is the dot product of branch p with the input.  The branches are fixed, so changing
+ * the ratio is just a change to the step between outputs.
+ *
+ * Output m is the input interpolated at time m / ratio() minus a delay of numTaps() / 2 samples,
+ * with zero history before the first input.  The position of the next output carries across calls,
+ * so splitting the input into blocks doesn't change the results.
+ */
+template <class T>
+class FarrowResampler {
+ protected:
+    /**
+     * \brief The branch filters, one after another.  Branch p holds the mu^p coefficients of the
+     *      taps in reverse order.
+     */
+    std::vector<T> branches;
+
+    /**
+     * \brief Number of taps in each branch.
+     */
+    int tapsPerBranch;
+
+    int polyOrder;
+
+    double resampleRatio;
+
+    /**
+     * \brief Input samples between outputs, split into whole and fractional parts.
+     */
+    int stepInt;
+    double stepFrac;
+
+    /**
+     * \brief The last tapsPerBranch - 1 input samples.  Sized for complex data so that the same
+     *      buffer works for either kind of data.
+     */
+    std::vector<char> savedData;
+
+    /**
+     * \brief Index of the newest input sample that the next output uses, relative to the start of
+     *      the next block of input.
+     */
+    int inputIndex;
+
+    /**
+     * \brief Fractional delay of the next output, in [0, 1).
+     */
+    double mu;
+
+    /**
+     * \brief Working buffers for the history plus input and for the outputs.  The output buffer is
+     *      swapped with the caller's data, so once both have grown to the block size resampling
+     *      doesn't allocate.
+     */
+    std::vector<T> workBuf;
+    std::vector<T> outBuf;
+    std::vector< std::complex<T> > complexWorkBuf;
+    std::vector< std::complex<T> > complexOutBuf;
+
+    template <class U>
+    void resampleBlock(const U *dataIn, int dataLen, U *history, std::vector<U> & buf, std::vector<U> & out);
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Designs the branches with \ref design.
+     *
+     * \param numTaps Number of taps in each branch.  Must be even.
+     * \param order Order of the polynomials in mu.
+     * \param bandwidth Bandwidth of the interpolating filter, normalized so that 1.0 is the Nyquist
+     *      frequency of the input.
+     * \param ratio Output sample rate divided by the input sample rate.
+     */
+    FarrowResampler<T>(int numTaps = 8, int order = 4, double bandwidth = 0.8, double ratio = 1.0)
+            {design(numTaps, order, bandwidth); setRatio(ratio);}
+
+    /**
+     * \brief Branch constructor, for branches designed elsewhere.
+     *
+     * \param branchTaps The branch filters one after another, in normal (not reversed) tap order.
+     *      Branch p holds the coefficients of mu^p, where an output with fractional delay mu
+     *      interpolates between the inputs that line up with taps numTaps/2 - 1 and numTaps/2.
+     * \param numTaps Number of taps in each branch.  branchTaps.size() must be a multiple of it.
+     * \param ratio Output sample rate divided by the input sample rate.
+     */
+    template <typename U>
+    FarrowResampler<T>(const std::vector<U> & branchTaps, int numTaps, double ratio = 1.0)
+            {setBranches(branchTaps, numTaps); setRatio(ratio);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Designs the branches and clears the streaming state.
+     *
+     * A windowed sinc fractional delay filter (see RealFirFilter::fractionalDelayFilter) is
+     * designed for each of order + 1 Chebyshev spaced delays in [0, 1), normalized to unity DC
+     * gain, and each tap is interpolated by a polynomial through those delays.
+     *
+     * \param numTaps Number of taps in each branch.  Must be even.
+     * \param order Order of the polynomials in mu.
+     * \param bandwidth Bandwidth of the interpolating filter, normalized so that 1.0 is the Nyquist
+     *      frequency of the input.
+     */
+    void design(int numTaps, int order, double bandwidth);
+
+    /**
+     * \brief Replaces the branches and clears the streaming state.  See the branch constructor.
+     */
+    template <typename U>
+    void setBranches(const std::vector<U> & branchTaps, int numTaps);
+
+    /**
+     * \brief Changes the ratio that the following outputs are produced at.  Doesn't allocate or
+     *      disturb the streaming state, so it can be called between any two blocks.
+     *
+     * \param ratio Output sample rate divided by the input sample rate.
+     */
+    void setRatio(double ratio);
+
+    /**
+     * \brief Clears the streaming state, as if no data had been resampled yet.
+     */
+    void reset();
+
+    double ratio() const {return resampleRatio;}
+    int numTaps() const {return tapsPerBranch;}
+    int order() const {return polyOrder;}
+
+    /**
+     * \brief Resamples "data" in place, continuing from the previous call.
+     *
+     * \param data Buffer to resample.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    RealVector<T> & resample(RealVector<T> & data);
+
+    /**
+     * \brief Resamples complex "data" in place, continuing from the previous call.
+     *
+     * A resampler should be used for either real or complex data, not both, since they share
+     * the streaming state.
+     * \param data Buffer to resample.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    ComplexVector<T> & resampleComplex(ComplexVector<T> & data);
+};
+
+
+template <class T>
+void FarrowResampler<T>::design(int numTaps, int order, double bandwidth) {
+    assert(numTaps > 0 && numTaps % 2 == 0);
+    assert(order >= 0);
+    
+    int numNodes = order + 1;
+    std::vector<double> nodes(numNodes);
+    for (int j=0; j<numNodes; j++) {
+        nodes[j] = 0.5 - 0.5 * std::cos(M_PI * (2 * j + 1) / (2 * numNodes));
+    }
+    
+    // Expand each node's Lagrange basis polynomial into powers of mu, and add it in weighted by
+    // the taps designed for that node's delay.
+    std::vector<double> coefs(numNodes * numTaps, 0), basis(numNodes);
+    RealFirFilter<double> designer;
+    for (int j=0; j<numNodes; j++) {
+        // A delay of 0.5 - mu centers the sinc on tap numTaps/2 - mu.
+        designer.fractionalDelayFilter(numTaps, bandwidth, 0.5 - nodes[j]);
+        double dcGain = designer.sum();
+        
+        std::fill(basis.begin(), basis.end(), 0);
+        basis[0] = 1;
+        for (int i=0; i<numNodes; i++) {
+            if (i == j) {
+                continue;
+            }
+            double scale = 1 / (nodes[j] - nodes[i]);
+            for (int p=numNodes-1; p>=0; p--) {
+                basis[p] = ((p > 0 ? basis[p - 1] : 0) - nodes[i] * basis[p]) * scale;
+            }
+        }
+        for (int p=0; p<numNodes; p++) {
+            for (int k=0; k<numTaps; k++) {
+                coefs[p * numTaps + k] += basis[p] * designer[k] / dcGain;
+            }
+        }
+    }
+    setBranches(coefs, numTaps);
+}
+
+template <class T>
+template <typename U>
+void FarrowResampler<T>::setBranches(const std::vector<U> & branchTaps, int numTaps) {
+    assert(numTaps > 0 && branchTaps.size() > 0 && branchTaps.size() % numTaps == 0);
+    tapsPerBranch = numTaps;
+    polyOrder = branchTaps.size() / numTaps - 1;
+    branches.resize(branchTaps.size());
+    for (int p=0; p<=polyOrder; p++) {
+        for (int k=0; k<numTaps; k++) {
+            branches[p * numTaps + numTaps - 1 - k] = (T) branchTaps[p * numTaps + k];
+        }
+    }
+    savedData.resize((tapsPerBranch - 1) * sizeof(std::complex<T>));
+    reset();
+}
+
+template <class T>
+void FarrowResampler<T>::setRatio(double ratio) {
+    assert(ratio > 0);
+    resampleRatio = ratio;
+    double step = 1 / ratio;
+    stepInt = (int) std::floor(step);
+    stepFrac = step - stepInt;
+}
+
+template <class T>
+void FarrowResampler<T>::reset() {
+    std::fill(savedData.begin(), savedData.end(), 0);
+    inputIndex = 0;
+    mu = 0;
+}
+
+template <class T>
+template <class U>
+void FarrowResampler<T>::resampleBlock(const U *dataIn, int dataLen, U *history, std::vector<U> & buf,
+                                       std::vector<U> & out) {
+    int numHistory = tapsPerBranch - 1;
+    buf.resize(numHistory + dataLen);
+    for (int i=0; i<numHistory; i++) {
+        buf[i] = history[i];
+    }
+    for (int i=0; i<dataLen; i++) {
+        buf[i + numHistory] = dataIn[i];
+    }
+
+    // Output n needs input samples inputIndex - (tapsPerBranch - 1) through inputIndex, which
+    // start at buf[inputIndex].
+    out.resize((inputIndex < dataLen) ? (int) ((dataLen - inputIndex) * resampleRatio) + 2 : 0);
+    int numOut = 0;
+    const T *lastBranch = VECTOR_TO_ARRAY(branches) + polyOrder * tapsPerBranch;
+    while (inputIndex < dataLen) {
+        const U *x = VECTOR_TO_ARRAY(buf) + inputIndex;
+        T frac = (T) mu;
+        U sum = dotProduct(x, lastBranch, tapsPerBranch);
+        for (const T *branch = lastBranch - tapsPerBranch; branch >= VECTOR_TO_ARRAY(branches);
+                branch -= tapsPerBranch) {
+            sum = sum * frac + dotProduct(x, branch, tapsPerBranch);
+        }
+        out[numOut++] = sum;
+
+        inputIndex += stepInt;
+        mu += stepFrac;
+        if (mu >= 1) {
+            mu -= 1;
+            inputIndex++;
+        }
+    }
+    out.resize(numOut);
+    inputIndex -= dataLen;
+
+    for (int i=0; i<numHistory; i++) {
+        history[i] = buf[dataLen + i];
+    }
+}
+
+template <class T>
+RealVector<T> & FarrowResampler<T>::resample(RealVector<T> & data) {
+    std::vector<T> *dataTmp;
+
+    if (data.scratchBuf == NULL) {
+        dataTmp = &workBuf;
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    resampleBlock(VECTOR_TO_ARRAY(data.vec), data.size(), (T *) savedData.data(), *dataTmp, outBuf);
+    data.vec.swap(outBuf);
+    return data;
+}
+
+/**
+ * \brief Resamples "data" in place with "resampler", continuing from the previous call.
+ *
+ * \param data Buffer to resample.
+ * \param resampler The resampler.  Holds the branches, the ratio and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline RealVector<T> & resample(RealVector<T> & data, FarrowResampler<T> & resampler) {
+    return resampler.resample(data);
+}
+
+template <class T>
+ComplexVector<T> & FarrowResampler<T>::resampleComplex(ComplexVector<T> & data) {
+    std::vector< std::complex<T> > *dataTmp;
+
+    if (data.scratchBuf == NULL) {
+        dataTmp = &complexWorkBuf;
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    resampleBlock(VECTOR_TO_ARRAY(data.vec), data.size(), (std::complex<T> *) savedData.data(),
+                  *dataTmp, complexOutBuf);
+    data.vec.swap(complexOutBuf);
+    return data;
+}
+
+/**
+ * \brief Resamples complex "data" in place with "resampler", continuing from the previous call.
+ *
+ * \param data Buffer to resample.
+ * \param resampler The resampler.  Holds the branches, the ratio and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline ComplexVector<T> & resample(ComplexVector<T> & data, FarrowResampler<T> & resampler) {
+    return resampler.resampleComplex(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,349 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file FastConvolver.h
+ *
+ * Definition of the template class FastConvolver.
+ */
+
+#ifndef NimbleDSP_FastConvolver_h
+#define NimbleDSP_FastConvolver_h
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cassert>
+#include <cstdlib>
+#include <type_traits>
+#include "Vector.h"
+#include "FftPlan.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Filters with fewer taps than this are always convolved in direct form when the filter's
+ *      convolution algorithm is NimbleDSP::AUTO_CONVOLUTION.
+ */
+const unsigned FFT_CONVOLUTION_MIN_TAPS = 64;
+
+/**
+ * \brief Scalar type that the FFT convolution of a T-valued filter is computed in.
+ *
+ * Floating point types are used as-is.  Integer types are promoted to double so that the
+ * convolution code compiles for every filter type, although the filters only select the FFT
+ * path for floating point types.
+ */
+template <class T>
+struct FftScalar {
+    typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type type;
+};
+
+/**
+ * \brief Overlap-save FFT convolution engine.
+ *
+ * Holds the (scaled) spectrum of a set of filter taps along with the work buffers needed to
+ * convolve data with them.  The FFT size is picked from the number of taps when the taps are
+ * set, and everything is cached until the taps change, so the cost of convolving a block of N
+ * samples with an M tap filter drops from O(N*M) to roughly O(N*log(M)).  The FFT plans come
+ * from the calling thread's plan cache.
+ *
+ * The FIR filter classes own one of these and use it automatically for long filters, but it
+ * can also be used on its own.  T is the floating point scalar type, i.e. "float", not
+ * "std::complex<float>".
+ */
+template <class T>
+class FastConvolver {
+ protected:
+    /**
+     * \brief Copy of the taps that \ref spectrum was computed from.
+     */
+    std::vector< std::complex<T> > taps;
+
+    /**
+     * \brief FFT of the zero-padded taps, pre-scaled by 1/fftSize.  This and the work buffers are
+     *      cache line aligned because every block streams through all three.
+     */
+    std::vector< std::complex<T>, AlignedAllocator< std::complex<T> > > spectrum;
+
+    /**
+     * \brief Time domain work buffer, fftSize long.
+     */
+    std::vector< std::complex<T>, AlignedAllocator< std::complex<T> > > timeBuf;
+
+    /**
+     * \brief Frequency domain work buffer, fftSize long.
+     */
+    std::vector< std::complex<T>, AlignedAllocator< std::complex<T> > > freqBuf;
+
+    /**
+     * \brief FFT size.  Zero until taps have been set.
+     */
+    int fftSize;
+
+    /**
+     * \brief Indicates that all of the taps have zero imaginary parts.
+     */
+    bool realTaps;
+
+    /**
+     * \brief Picks the power of two FFT size that minimizes the work per output sample.
+     */
+    static int bestFftSize(int numTaps);
+
+    /**
+     * \brief Approximate number of flops for one block (2 FFTs and the spectral multiply).
+     */
+    double flopsPerBlock() const {return 10.0 * fftSize * std::log((double) fftSize) / std::log(2.0) + 6.0 * fftSize;}
+
+    template <class U>
+    void convBlocks(const U *input, int inputLen, int start, int count, U *output, std::false_type isComplex);
+
+    template <class U>
+    void convBlocks(const std::complex<U> *input, int inputLen, int start, int count, std::complex<U> *output,
+                    std::true_type isComplex);
+
+    void filterBlock(FftPlan<T> & forwardFft, FftPlan<T> & inverseFft);
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * The convolver can't be used until \ref setTaps has been called.
+     */
+    FastConvolver<T>() : fftSize(0), realTaps(true) {}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Sets the filter taps.
+     *
+     * If "newTaps" is the same as the taps that are already set this does nothing, so it is
+     * cheap to call before every convolution.
+     *
+     * \param newTaps The filter taps.  Can be real or std::complex.
+     * \return True if the spectrum was recomputed, false if the taps were unchanged.
+     */
+    template <class U>
+    bool setTaps(const std::vector<U> & newTaps);
+
+    /**
+     * \brief Returns the number of taps.
+     */
+    int numTaps() const {return (int) taps.size();}
+
+    /**
+     * \brief Returns the FFT size.
+     */
+    int getFftSize() const {return fftSize;}
+
+    /**
+     * \brief Returns the number of outputs produced by each FFT block.
+     */
+    int blockSize() const {return fftSize - numTaps() + 1;}
+
+    /**
+     * \brief Estimates whether FFT convolution will be faster than direct convolution.
+     *
+     * \param numOutputs Number of output samples that will be computed.
+     * \param realData True if the data is real.  Real data with real taps is processed two blocks
+     *      per FFT.
+     * \param flopsPerMac Flops per multiply-accumulate of the direct form filter: 2 for real data
+     *      and taps, 4 for complex data and real taps, 8 for complex data and taps.
+     */
+    bool isFasterThanDirect(int numOutputs, bool realData, int flopsPerMac) const;
+
+    /**
+     * \brief Computes part of the linear convolution of "input" with the taps.
+     *
+     * "input" is treated as if it were zero outside of 0 to inputLen-1.  The full convolution is
+     * inputLen + numTaps - 1 samples long, and this method computes "count" of them beginning
+     * with index "start".
+     *
+     * \param input The data to convolve.  Either T or std::complex<T>.
+     * \param inputLen Length of "input".
+     * \param start Index into the full convolution of the first output.
+     * \param count Number of outputs to compute.
+     * \param output Where the results go.  Must not overlap "input".
+     */
+    template <class U>
+    void conv(const U *input, int inputLen, int start, int count, U *output) {
+        assert(fftSize > 0);
+        convBlocks(input, inputLen, start, count, output, std::integral_constant<bool, !std::is_arithmetic<U>::value>());
+    }
+};
+
+
+template <class T>
+int FastConvolver<T>::bestFftSize(int numTaps) {
+    int size = 2;
+    while (size < 2 * numTaps) {
+        size <<= 1;
+    }
+
+    int bestSize = size;
+    double bestCost = 1e300;
+    for (int i=0; i<5; i++, size <<= 1) {
+        double log2Size = std::log((double) size) / std::log(2.0);
+        double cost = (10.0 * size * log2Size + 6.0 * size) / (size - numTaps + 1);
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestSize = size;
+        }
+    }
+    return bestSize;
+}
+
+template <class T>
+template <class U>
+bool FastConvolver<T>::setTaps(const std::vector<U> & newTaps) {
+    assert(newTaps.size() > 0);
+
+    if (newTaps.size() == taps.size()) {
+        bool same = true;
+        for (unsigned i=0; i<taps.size() && same; i++) {
+            same = (taps[i] == std::complex<T>(newTaps[i]));
+        }
+        if (same) {
+            return false;
+        }
+    }
+
+    taps.resize(newTaps.size());
+    realTaps = true;
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] = std::complex<T>(newTaps[i]);
+        if (taps[i].imag() != 0) {
+            realTaps = false;
+        }
+    }
+
+    int newFftSize = bestFftSize(numTaps());
+    if (newFftSize != fftSize) {
+        fftSize = newFftSize;
+        timeBuf.resize(fftSize);
+        freqBuf.resize(fftSize);
+        spectrum.resize(fftSize);
+    }
+
+    // Fold the inverse FFT's 1/N scaling into the spectrum.
+    T scale = ((T) 1) / fftSize;
+    for (int i=0; i<fftSize; i++) {
+        timeBuf[i] = (i < numTaps()) ? taps[i] * scale : std::complex<T>(0);
+    }
+    fftPlan<T>(fftSize, false).transform(VECTOR_TO_ARRAY(timeBuf), VECTOR_TO_ARRAY(spectrum));
+    return true;
+}
+
+template <class T>
+bool FastConvolver<T>::isFasterThanDirect(int numOutputs, bool realData, int flopsPerMac) const {
+    if (fftSize == 0 || numOutputs <= 0) {
+        return false;
+    }
+    double numBlocks = std::ceil(((double) numOutputs) / blockSize());
+    if (realData && realTaps) {
+        numBlocks = std::ceil(numBlocks / 2);
+    }
+    double fftFlops = numBlocks * flopsPerBlock();
+    double directFlops = ((double) numOutputs) * numTaps() * flopsPerMac;
+    return fftFlops < directFlops;
+}
+
+template <class T>
+void FastConvolver<T>::filterBlock(FftPlan<T> & forwardFft, FftPlan<T> & inverseFft) {
+    forwardFft.transform(VECTOR_TO_ARRAY(timeBuf), VECTOR_TO_ARRAY(freqBuf));
+    for (int i=0; i<fftSize; i++) {
+        freqBuf[i] *= spectrum[i];
+    }
+    inverseFft.transform(VECTOR_TO_ARRAY(freqBuf), VECTOR_TO_ARRAY(timeBuf));
+}
+
+template <class T>
+template <class U>
+void FastConvolver<T>::convBlocks(const U *input, int inputLen, int start, int count, U *output,
+                                  std::false_type) {
+    // Real data.  With real taps the real and imaginary parts of each FFT carry two independent
+    // blocks, which halves the number of FFTs.
+    assert(realTaps);
+    FftPlan<T> & forwardFft = fftPlan<T>(fftSize, false);
+    FftPlan<T> & inverseFft = fftPlan<T>(fftSize, true);
+    int overlap = numTaps() - 1;
+    int hop = blockSize();
+    int end = start + count;
+
+    for (int block0=start; block0<end; block0+=2*hop) {
+        int block1 = block0 + hop;
+        for (int i=0, index0=block0-overlap, index1=block1-overlap; i<fftSize; i++, index0++, index1++) {
+            T re = (index0 >= 0 && index0 < inputLen) ? (T) input[index0] : (T) 0;
+            T im = (block1 < end && index1 >= 0 && index1 < inputLen) ? (T) input[index1] : (T) 0;
+            timeBuf[i] = std::complex<T>(re, im);
+        }
+
+        filterBlock(forwardFft, inverseFft);
+
+        for (int i=0; i<hop && block0+i<end; i++) {
+            output[block0 - start + i] = (U) timeBuf[overlap + i].real();
+        }
+        for (int i=0; i<hop && block1+i<end; i++) {
+            output[block1 - start + i] = (U) timeBuf[overlap + i].imag();
+        }
+    }
+}
+
+template <class T>
+template <class U>
+void FastConvolver<T>::convBlocks(const std::complex<U> *input, int inputLen, int start, int count,
+                                  std::complex<U> *output, std::true_type) {
+    FftPlan<T> & forwardFft = fftPlan<T>(fftSize, false);
+    FftPlan<T> & inverseFft = fftPlan<T>(fftSize, true);
+    int overlap = numTaps() - 1;
+    int hop = blockSize();
+    int end = start + count;
+
+    for (int block=start; block<end; block+=hop) {
+        for (int i=0, index=block-overlap; i<fftSize; i++, index++) {
+            if (index >= 0 && index < inputLen) {
+                timeBuf[i] = std::complex<T>((T) input[index].real(), (T) input[index].imag());
+            }
+            else {
+                timeBuf[i] = 0;
+            }
+        }
+
+        filterBlock(forwardFft, inverseFft);
+
+        for (int i=0; i<hop && block+i<end; i++) {
+            output[block - start + i] = std::complex<U>((U) timeBuf[overlap + i].real(),
+                                                        (U) timeBuf[overlap + i].imag());
+        }
+    }
+}
+
+};
+
+#endif
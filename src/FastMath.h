@@ -0,0 +1,327 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+/**
+ * @file FastMath.h
+ *
+ * Polynomial approximations of the transcendental functions, for the NimbleDSP::FAST_MATH
+ * versions of the vector methods (RealVector::exp, ComplexVector::angle, etc).
+ *
+ * Each function reduces its argument to a short interval and evaluates a minimax polynomial on
+ * it, with no table lookups and no branches, so the array loops can be vectorized.  The angle
+ * kernel, which is what FM demodulation spends its time in, has hand written SSE2 versions.  The
+ * maximum errors below are for double and are those of the polynomials themselves; float results
+ * carry float rounding on top of that.
+ *
+ *      fastAtan2   5e-8 radians absolute
+ *      fastExp     1e-10 relative, for -708 < x < 709 (float: -87 < x < 88).  Saturates outside.
+ *      fastLog     1e-11 absolute on the mantissa, for normal positive x.  Undefined otherwise.
+ *      fastPolar   1e-11 absolute, for |angle| < 1e5.  Degrades with larger angles.
+ *
+ * Types other than float and double fall back to the std functions.
+ */
+
+#ifndef NimbleDSP_FastMath_h
+#define NimbleDSP_FastMath_h
+
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include "NimbleDspCommon.h"
+#include "SimdKernels.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief IEEE 754 layout of the floating point types, for building and taking apart exponents.
+ */
+template <class T>
+struct FastMathTraits;
+
+template <>
+struct FastMathTraits<float> {
+    typedef uint32_t Bits;
+    static const int mantissaBits = 23;
+    static const int exponentBias = 127;
+    static float minExpArgument() {return -87.0f;}
+    static float maxExpArgument() {return 88.0f;}
+};
+
+template <>
+struct FastMathTraits<double> {
+    typedef uint64_t Bits;
+    static const int mantissaBits = 52;
+    static const int exponentBias = 1023;
+    static double minExpArgument() {return -708.0;}
+    static double maxExpArgument() {return 709.0;}
+};
+
+/**
+ * \brief Rounds to the nearest integer with a cast, which is cheaper than std::floor and
+ *      vectorizes.
+ */
+template <class T>
+inline int fastRound(T x) {
+    return (int) (x + (x < 0 ? (T) -0.5 : (T) 0.5));
+}
+
+template <class T>
+inline T fastAtan2Polynomial(T y, T x) {
+    T absX = std::abs(x);
+    T absY = std::abs(y);
+    T big = std::max(absX, absY);
+    T small = std::min(absX, absY);
+    T z = (big == 0) ? 0 : small / big;
+    T u = z * z;
+    T result = (T) -0.0040570260489490775;
+    result = result * u + (T) 0.02187219179460582;
+    result = result * u + (T) -0.05592620103518556;
+    result = result * u + (T) 0.09643259302761488;
+    result = result * u + (T) -0.13909065065221263;
+    result = result * u + (T) 0.1994665739676689;
+    result = result * u + (T) -0.33329869315923755;
+    result = result * u + (T) 0.9999993378797607;
+    result *= z;
+    result = (absY > absX) ? (T) (M_PI / 2) - result : result;
+    result = (x < 0) ? (T) M_PI - result : result;
+    return std::signbit(y) ? -result : result;
+}
+
+template <class T>
+inline T fastExpPolynomial(T x) {
+    typedef typename FastMathTraits<T>::Bits Bits;
+    x = std::min(std::max(x, FastMathTraits<T>::minExpArgument()), FastMathTraits<T>::maxExpArgument());
+    int k = fastRound(x * (T) 1.4426950408889634);
+    // ln(2) split in two so that r is accurate even for large k.
+    T r = x - k * (T) 0.693145751953125 - k * (T) 1.428606820309417232e-6;
+    T result = (T) 0.00019775312742182104;
+    result = result * r + (T) 0.0013948182079794476;
+    result = result * r + (T) 0.008333560798878653;
+    result = result * r + (T) 0.04166622545019199;
+    result = result * r + (T) 0.16666665127856084;
+    result = result * r + (T) 0.5000000104523081;
+    result = result * r + (T) 1.000000000242831;
+    result = result * r + (T) 0.9999999999616948;
+    
+    Bits scaleBits = ((Bits) (k + FastMathTraits<T>::exponentBias)) << FastMathTraits<T>::mantissaBits;
+    T scale;
+    std::memcpy(&scale, &scaleBits, sizeof(scale));
+    return result * scale;
+}
+
+template <class T>
+inline T fastLogPolynomial(T x) {
+    typedef typename FastMathTraits<T>::Bits Bits;
+    const Bits mantissaMask = (((Bits) 1) << FastMathTraits<T>::mantissaBits) - 1;
+    Bits bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int) (bits >> FastMathTraits<T>::mantissaBits) - FastMathTraits<T>::exponentBias;
+    bits = (bits & mantissaMask) | (((Bits) FastMathTraits<T>::exponentBias) << FastMathTraits<T>::mantissaBits);
+    T mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    
+    // Center the mantissa on 1, [sqrt(1/2), sqrt(2)), to keep s small.
+    bool halve = mantissa > (T) 1.4142135623730951;
+    mantissa = halve ? mantissa * (T) 0.5 : mantissa;
+    exponent += halve ? 1 : 0;
+    
+    // log(m) = 2 * atanh(s), s = (m - 1) / (m + 1)
+    T s = (mantissa - 1) / (mantissa + 1);
+    T u = s * s;
+    T result = (T) 0.1197092311990758;
+    result = result * u + (T) 0.14256482054931552;
+    result = result * u + (T) 0.20000444704951445;
+    result = result * u + (T) 0.3333333044900278;
+    result = result * u + (T) 1.000000000056522;
+    return 2 * s * result + exponent * (T) 0.6931471805599453;
+}
+
+template <class T>
+inline std::complex<T> fastPolarPolynomial(T angle) {
+    int quadrant = fastRound(angle * (T) 0.6366197723675814);
+    // pi/2 split in two so that r is accurate for larger angles.
+    T r = angle - quadrant * (T) 1.5707963267341256 - quadrant * (T) 6.077100506506192e-11;
+    T u = r * r;
+    T sine = (T) 2.710482196767064e-06;
+    sine = sine * u + (T) -0.0001983824291453757;
+    sine = sine * u + (T) 0.008333324301882916;
+    sine = sine * u + (T) -0.1666666655375892;
+    sine = sine * u + (T) 0.9999999999589053;
+    sine *= r;
+    T cosine = (T) -2.744240619020539e-07;
+    cosine = cosine * u + (T) 2.4803033588490282e-05;
+    cosine = cosine * u + (T) -0.0013888902268178358;
+    cosine = cosine * u + (T) 0.04166666701839617;
+    cosine = cosine * u + (T) -0.5000000000294618;
+    cosine = cosine * u + (T) 1.000000000000385;
+    
+    switch (quadrant & 3) {
+        case 0: return std::complex<T>(cosine, sine);
+        case 1: return std::complex<T>(-sine, cosine);
+        case 2: return std::complex<T>(-cosine, -sine);
+        default: return std::complex<T>(sine, -cosine);
+    }
+}
+
+/**
+ * \brief Fast approximation of std::atan2(y, x).  See the file description for the accuracy.
+ */
+template <class T>
+inline T fastAtan2(T y, T x) {return (T) std::atan2(y, x);}
+inline float fastAtan2(float y, float x) {return fastAtan2Polynomial(y, x);}
+inline double fastAtan2(double y, double x) {return fastAtan2Polynomial(y, x);}
+
+/**
+ * \brief Fast approximation of std::exp(x).  See the file description for the accuracy.
+ */
+template <class T>
+inline T fastExp(T x) {return (T) std::exp(x);}
+inline float fastExp(float x) {return fastExpPolynomial(x);}
+inline double fastExp(double x) {return fastExpPolynomial(x);}
+
+/**
+ * \brief Fast approximation of std::log(x).  See the file description for the accuracy.
+ */
+template <class T>
+inline T fastLog(T x) {return (T) std::log(x);}
+inline float fastLog(float x) {return fastLogPolynomial(x);}
+inline double fastLog(double x) {return fastLogPolynomial(x);}
+
+/**
+ * \brief Fast approximation of std::polar((T) 1, angle), i.e. e^(j*angle).  See the file
+ *      description for the accuracy.
+ */
+template <class T>
+inline std::complex<T> fastPolar(T angle) {return std::polar((T) 1, angle);}
+inline std::complex<float> fastPolar(float angle) {return fastPolarPolynomial(angle);}
+inline std::complex<double> fastPolar(double angle) {return fastPolarPolynomial(angle);}
+
+/**
+ * \brief Replaces each of the "n" elements of "data" with (fastAtan2(imag, real), 0).
+ */
+template <class T>
+inline void fastAngle(std::complex<T> * data, int n) {
+    for (int i=0; i<n; i++) {
+        data[i] = std::complex<T>(fastAtan2(data[i].imag(), data[i].real()), 0);
+    }
+}
+
+
+#if defined(NIMBLEDSP_SSE2)
+
+inline __m128 selectBits(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+    return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+inline __m128d selectBits(__m128d mask, __m128d ifTrue, __m128d ifFalse) {
+    return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+}
+
+/**
+ * \brief SSE2 version of \ref fastAtan2Polynomial, four at a time.
+ */
+inline __m128 fastAtan2Sse(__m128 y, __m128 x) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 absX = _mm_andnot_ps(signMask, x);
+    __m128 absY = _mm_andnot_ps(signMask, y);
+    __m128 big = _mm_max_ps(absX, absY);
+    __m128 small = _mm_min_ps(absX, absY);
+    __m128 z = _mm_div_ps(small, _mm_max_ps(big, _mm_set1_ps(1.17549435e-38f)));
+    __m128 u = _mm_mul_ps(z, z);
+    __m128 result = _mm_set1_ps(-0.0040570260489490775f);
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(0.02187219179460582f));
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(-0.05592620103518556f));
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(0.09643259302761488f));
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(-0.13909065065221263f));
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(0.1994665739676689f));
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(-0.33329869315923755f));
+    result = _mm_add_ps(_mm_mul_ps(result, u), _mm_set1_ps(0.9999993378797607f));
+    result = _mm_mul_ps(result, z);
+    result = selectBits(_mm_cmpgt_ps(absY, absX), _mm_sub_ps(_mm_set1_ps((float) (M_PI / 2)), result), result);
+    result = selectBits(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps((float) M_PI), result), result);
+    return _mm_xor_ps(result, _mm_and_ps(signMask, y));
+}
+
+inline __m128d fastAtan2Sse(__m128d y, __m128d x) {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d absX = _mm_andnot_pd(signMask, x);
+    __m128d absY = _mm_andnot_pd(signMask, y);
+    __m128d big = _mm_max_pd(absX, absY);
+    __m128d small = _mm_min_pd(absX, absY);
+    __m128d z = _mm_div_pd(small, _mm_max_pd(big, _mm_set1_pd(2.2250738585072014e-308)));
+    __m128d u = _mm_mul_pd(z, z);
+    __m128d result = _mm_set1_pd(-0.0040570260489490775);
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(0.02187219179460582));
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(-0.05592620103518556));
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(0.09643259302761488));
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(-0.13909065065221263));
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(0.1994665739676689));
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(-0.33329869315923755));
+    result = _mm_add_pd(_mm_mul_pd(result, u), _mm_set1_pd(0.9999993378797607));
+    result = _mm_mul_pd(result, z);
+    result = selectBits(_mm_cmpgt_pd(absY, absX), _mm_sub_pd(_mm_set1_pd(M_PI / 2), result), result);
+    result = selectBits(_mm_cmplt_pd(x, _mm_setzero_pd()), _mm_sub_pd(_mm_set1_pd(M_PI), result), result);
+    return _mm_xor_pd(result, _mm_and_pd(signMask, y));
+}
+
+inline void fastAngle(std::complex<float> * data, int n) {
+    float *interleaved = (float *) data;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 first = _mm_loadu_ps(interleaved + 2*i);
+        __m128 second = _mm_loadu_ps(interleaved + 2*i + 4);
+        __m128 re = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 result = fastAtan2Sse(im, re);
+        _mm_storeu_ps(interleaved + 2*i, _mm_unpacklo_ps(result, _mm_setzero_ps()));
+        _mm_storeu_ps(interleaved + 2*i + 4, _mm_unpackhi_ps(result, _mm_setzero_ps()));
+    }
+    for (; i < n; i++) {
+        data[i] = std::complex<float>(fastAtan2(data[i].imag(), data[i].real()), 0);
+    }
+}
+
+inline void fastAngle(std::complex<double> * data, int n) {
+    double *interleaved = (double *) data;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d first = _mm_loadu_pd(interleaved + 2*i);
+        __m128d second = _mm_loadu_pd(interleaved + 2*i + 2);
+        __m128d result = fastAtan2Sse(_mm_unpackhi_pd(first, second), _mm_unpacklo_pd(first, second));
+        _mm_storeu_pd(interleaved + 2*i, _mm_unpacklo_pd(result, _mm_setzero_pd()));
+        _mm_storeu_pd(interleaved + 2*i + 2, _mm_unpackhi_pd(result, _mm_setzero_pd()));
+    }
+    for (; i < n; i++) {
+        data[i] = std::complex<double>(fastAtan2(data[i].imag(), data[i].real()), 0);
+    }
+}
+
+#endif
+
+};
+
+#endif
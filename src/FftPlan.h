@@ -0,0 +1,345 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file FftPlan.h
+ *
+ * Definition of the template classes FftPlan and RealFftPlan and the per-thread FFT plan caches.
+ */
+
+#ifndef NimbleDSP_FftPlan_h
+#define NimbleDSP_FftPlan_h
+
+#include <complex>
+#include <map>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "kissfft.hh"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief A reusable FFT of a fixed size and direction.
+ *
+ * Building an FFT engine computes its factorization and twiddle factors, which costs more than
+ * a small transform does.  A plan does that once, so code that transforms many buffers of the
+ * same size should create one plan and pass it to ComplexVector::fft or ComplexVector::ifft, or
+ * use \ref fftPlan to get one from the cache.
+ *
+ * The inverse transform is unscaled, like kissfft.  T is the scalar type, i.e. "float", not
+ * "std::complex<float>".
+ */
+template <class T>
+class FftPlan {
+ protected:
+    kissfft<T> engine;
+
+    /**
+     * \brief Number of points in the transform.
+     */
+    unsigned fftSize;
+
+    /**
+     * \brief Indicates that this is an inverse transform.
+     */
+    bool inverseFft;
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param size Number of points in the transform.
+     * \param inverse True for an inverse FFT, false for a forward FFT.
+     */
+    FftPlan<T>(unsigned size, bool inverse = false) : engine(size, inverse), fftSize(size),
+            inverseFft(inverse) {assert(size > 0);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of points in the transform.
+     */
+    unsigned size() const {return fftSize;}
+
+    /**
+     * \brief Returns true if this is an inverse transform.
+     */
+    bool isInverse() const {return inverseFft;}
+
+    /**
+     * \brief Transforms "input" and puts the results in "output".
+     *
+     * Both arrays must hold \ref size elements and must not overlap.
+     */
+    void transform(const std::complex<T> *input, std::complex<T> *output) {
+        engine.transform((const typename kissfft_utils::traits<T>::cpx_type *) input,
+                         (typename kissfft_utils::traits<T>::cpx_type *) output);
+    }
+};
+
+
+/**
+ * \brief A reusable FFT of real data.
+ *
+ * The forward transform takes "size" real samples and produces the size/2 + 1 non-negative
+ * frequency bins.  The rest of the spectrum is the conjugate mirror image of these bins, so it
+ * isn't computed.  The inverse transform takes those bins back to "size" real samples and, like
+ * FftPlan, is unscaled.
+ *
+ * For even sizes the samples are packed two to a complex value and transformed with a size/2
+ * point complex FFT, which is about half the work of a full complex FFT.  Odd sizes fall back to
+ * a full size complex FFT.
+ */
+template <class T>
+class RealFftPlan {
+ protected:
+    /**
+     * \brief Complex FFT of size/2 points for even sizes, or size points for odd sizes.
+     */
+    FftPlan<T> complexPlan;
+
+    /**
+     * \brief e^(-j*2*pi*k/size) for the forward transform, e^(j*2*pi*k/size) for the inverse.
+     */
+    std::vector< std::complex<T> > twiddles;
+
+    /**
+     * \brief Work buffers, complexPlan.size() long.
+     */
+    std::vector< std::complex<T> > packedBuf;
+    std::vector< std::complex<T> > transformBuf;
+
+    /**
+     * \brief Number of real samples.
+     */
+    unsigned fftSize;
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param size Number of real samples in the transform.
+     * \param inverse True for an inverse FFT, false for a forward FFT.
+     */
+    RealFftPlan<T>(unsigned size, bool inverse = false);
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of real samples in the transform.
+     */
+    unsigned size() const {return fftSize;}
+
+    /**
+     * \brief Returns the number of frequency bins, i.e. size()/2 + 1.
+     */
+    unsigned numBins() const {return fftSize / 2 + 1;}
+
+    /**
+     * \brief Returns true if this is an inverse transform.
+     */
+    bool isInverse() const {return complexPlan.isInverse();}
+
+    /**
+     * \brief Forward transform.  "input" holds \ref size samples and "output" gets \ref numBins
+     *      bins.
+     */
+    void transform(const T *input, std::complex<T> *output);
+
+    /**
+     * \brief Inverse transform.  "input" holds \ref numBins bins and "output" gets \ref size
+     *      samples.
+     */
+    void transform(const std::complex<T> *input, T *output);
+};
+
+
+template <class T>
+RealFftPlan<T>::RealFftPlan(unsigned size, bool inverse) :
+        complexPlan((size % 2 == 0) ? size / 2 : size, inverse), fftSize(size) {
+    packedBuf.resize(complexPlan.size());
+    transformBuf.resize(complexPlan.size());
+    if (size % 2 == 0) {
+        double sign = inverse ? 1.0 : -1.0;
+        twiddles.resize(size / 2);
+        for (unsigned k=0; k<twiddles.size(); k++) {
+            double phase = sign * 2 * M_PI * k / size;
+            twiddles[k] = std::complex<T>((T) std::cos(phase), (T) std::sin(phase));
+        }
+    }
+}
+
+template <class T>
+void RealFftPlan<T>::transform(const T *input, std::complex<T> *output) {
+    assert(!isInverse());
+    unsigned halfSize = complexPlan.size();
+
+    if (fftSize % 2 != 0) {
+        for (unsigned i=0; i<fftSize; i++) {
+            packedBuf[i] = std::complex<T>(input[i], 0);
+        }
+        complexPlan.transform(&packedBuf[0], &transformBuf[0]);
+        for (unsigned k=0; k<numBins(); k++) {
+            output[k] = transformBuf[k];
+        }
+        return;
+    }
+
+    // Even samples go in the real part and odd samples in the imaginary part.  The spectra of the
+    // two halves are separated using conjugate symmetry and combined with one radix-2 butterfly.
+    for (unsigned i=0; i<halfSize; i++) {
+        packedBuf[i] = std::complex<T>(input[2*i], input[2*i + 1]);
+    }
+    complexPlan.transform(&packedBuf[0], &transformBuf[0]);
+
+    output[0] = std::complex<T>(transformBuf[0].real() + transformBuf[0].imag(), 0);
+    output[halfSize] = std::complex<T>(transformBuf[0].real() - transformBuf[0].imag(), 0);
+    for (unsigned k=1; k<halfSize; k++) {
+        std::complex<T> z = transformBuf[k];
+        std::complex<T> zMirror = std::conj(transformBuf[halfSize - k]);
+        std::complex<T> evens = (z + zMirror) * (T) 0.5;
+        std::complex<T> odds = (z - zMirror) * std::complex<T>(0, (T) -0.5);
+        output[k] = evens + twiddles[k] * odds;
+    }
+}
+
+template <class T>
+void RealFftPlan<T>::transform(const std::complex<T> *input, T *output) {
+    assert(isInverse());
+    unsigned halfSize = complexPlan.size();
+
+    if (fftSize % 2 != 0) {
+        packedBuf[0] = std::complex<T>(input[0].real(), 0);
+        for (unsigned k=1; k<numBins(); k++) {
+            packedBuf[k] = input[k];
+            packedBuf[fftSize - k] = std::conj(input[k]);
+        }
+        complexPlan.transform(&packedBuf[0], &transformBuf[0]);
+        for (unsigned i=0; i<fftSize; i++) {
+            output[i] = transformBuf[i].real();
+        }
+        return;
+    }
+
+    // Undo the butterfly to rebuild the spectrum of the packed even/odd sequence.  The factor of 2
+    // that drops out here makes the result scale by fftSize, matching an unscaled complex IFFT.
+    for (unsigned k=0; k<halfSize; k++) {
+        std::complex<T> x = input[k];
+        std::complex<T> xMirror = std::conj(input[halfSize - k]);
+        std::complex<T> evens = x + xMirror;
+        std::complex<T> odds = (x - xMirror) * twiddles[k];
+        packedBuf[k] = evens + std::complex<T>(0, 1) * odds;
+    }
+    complexPlan.transform(&packedBuf[0], &transformBuf[0]);
+    for (unsigned i=0; i<halfSize; i++) {
+        output[2*i] = transformBuf[i].real();
+        output[2*i + 1] = transformBuf[i].imag();
+    }
+}
+
+
+/**
+ * \brief Returns this thread's plan cache for scalar type T.
+ *
+ * The cache is thread local so that looking up a plan never has to take a lock.
+ */
+template <class T>
+std::map<std::pair<unsigned, bool>, FftPlan<T> > & fftPlanCache() {
+    static thread_local std::map<std::pair<unsigned, bool>, FftPlan<T> > cache;
+    return cache;
+}
+
+/**
+ * \brief Returns a cached plan for an FFT of the given size and direction.
+ *
+ * The plan is created the first time it is asked for and reused after that.  Each thread has its
+ * own cache, so the returned plan should only be used by the calling thread.  The reference stays
+ * valid until \ref clearFftPlanCache is called.
+ *
+ * \param size Number of points in the transform.
+ * \param inverse True for an inverse FFT, false for a forward FFT.
+ */
+template <class T>
+FftPlan<T> & fftPlan(unsigned size, bool inverse = false) {
+    std::map<std::pair<unsigned, bool>, FftPlan<T> > & cache = fftPlanCache<T>();
+    std::pair<unsigned, bool> key(size, inverse);
+
+    typename std::map<std::pair<unsigned, bool>, FftPlan<T> >::iterator it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.insert(std::make_pair(key, FftPlan<T>(size, inverse))).first;
+    }
+    return it->second;
+}
+
+/**
+ * \brief Returns this thread's real FFT plan cache for scalar type T.
+ */
+template <class T>
+std::map<std::pair<unsigned, bool>, RealFftPlan<T> > & realFftPlanCache() {
+    static thread_local std::map<std::pair<unsigned, bool>, RealFftPlan<T> > cache;
+    return cache;
+}
+
+/**
+ * \brief Returns a cached plan for a real FFT of the given size and direction.
+ *
+ * Works the same way as \ref fftPlan.
+ *
+ * \param size Number of real samples in the transform.
+ * \param inverse True for an inverse FFT, false for a forward FFT.
+ */
+template <class T>
+RealFftPlan<T> & realFftPlan(unsigned size, bool inverse = false) {
+    std::map<std::pair<unsigned, bool>, RealFftPlan<T> > & cache = realFftPlanCache<T>();
+    std::pair<unsigned, bool> key(size, inverse);
+
+    typename std::map<std::pair<unsigned, bool>, RealFftPlan<T> >::iterator it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.insert(std::make_pair(key, RealFftPlan<T>(size, inverse))).first;
+    }
+    return it->second;
+}
+
+/**
+ * \brief Frees all of the calling thread's cached plans, complex and real, for scalar type T.
+ */
+template <class T>
+void clearFftPlanCache() {
+    fftPlanCache<T>().clear();
+    realFftPlanCache<T>().clear();
+}
+
+};
+
+#endif
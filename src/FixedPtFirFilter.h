@@ -0,0 +1,297 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+/**
+ * @file FixedPtFirFilter.h
+ *
+ * Definition of the template class FixedPtFirFilter.
+ */
+
+#ifndef NimbleDSP_FixedPtFirFilter_h
+#define NimbleDSP_FixedPtFirFilter_h
+
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <stdint.h>
+#include "RealFixedPtVector.h"
+#include "SimdKernels.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief FIR filter for fixed point data.
+ *
+ * RealFirFilter<short> multiplies and sums in short, which overflows almost immediately.  This
+ * filter keeps the samples (T) and the taps (C) in their own narrow types and does the
+ * multiply-accumulates in a wider accumulator type (A).  The taps are in Q format with
+ * \ref fractionalBits fractional bits, so each output is the accumulated sum shifted right by
+ * that many bits, rounded as \ref rounding says, and saturated to the range of T.
+ *
+ * For example, int16_t samples filtered by Q15 taps:
+ *
+ *      FixedPtFirFilter<int16_t> filt(q15Taps, 15);
+ *      conv(samples, filt);
+ *
+ * With int16_t samples and taps and an int32_t accumulator (the defaults) the multiply-accumulates
+ * use SSE2 pmaddwd or NEON vmlal, eight or more taps at a time.  The accumulator wraps if the sum
+ * overflows it, so the taps should be scaled so that sum(|taps|) * max(|sample|) fits in A.
+ *
+ * The taps are held in \ref vec.
+ */
+template <class T, class C = T, class A = int32_t>
+class FixedPtFirFilter : public RealFixedPtVector<C> {
+ protected:
+    /**
+     * \brief The last size() - 1 input samples.  Used for stream filtering.
+     */
+    std::vector<T> savedData;
+    
+    /**
+     * \brief Indicates how many samples are in \ref savedData.
+     */
+    int numSavedSamples;
+    
+    /**
+     * \brief The taps in reverse order, so that every output is a forward \ref dotProductAccumulate.
+     */
+    std::vector<C> reversedTaps;
+    
+    /**
+     * \brief Working buffers for the input with its history or padding, and for the outputs at
+     *      accumulator precision.  They keep their capacity from call to call.
+     */
+    std::vector<T> workBuf;
+    RealVector<A> resultBuf;
+    
+    void reverseTaps() {reversedTaps.assign(this->vec.rbegin(), this->vec.rend());}
+    
+    void initState() {numSavedSamples = this->size() > 0 ? this->size() - 1 : 0;
+                      savedData.assign(numSavedSamples, 0);}
+    
+    /**
+     * \brief Shifts an accumulated sum down by \ref fractionalBits with the chosen rounding.
+     */
+    A scaleOutput(A sum) const;
+    
+    /**
+     * \brief Computes "numResults" outputs from \ref workBuf, starting at "first" and "rate"
+     *      samples apart, and puts them in "data" scaled and saturated.
+     */
+    void filterWork(RealVector<T> & data, int first, int rate, int numResults);
+    
+ public:
+    /**
+     * \brief Determines how the filter should filter.  See RealFirFilter::filtOperation.
+     */
+    FilterOperationType filtOperation;
+    
+    /**
+     * \brief Number of fractional bits in the taps, i.e. how far the sums are shifted down.
+     */
+    int fractionalBits;
+    
+    /**
+     * \brief How the bits that are shifted off are rounded.
+     *
+     * NimbleDSP::ROUND_DOWN just shifts (rounds toward minus infinity).
+     * NimbleDSP::ROUND_HALF_UP rounds to the nearest value, with halves rounded up.  This is the
+     *      default.
+     * NimbleDSP::ROUND_HALF_EVEN rounds to the nearest value, with halves rounded to the even one,
+     *      which avoids a DC bias.
+     */
+    FixedPtRoundingType rounding;
+    
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param taps The filter taps, in Q format with "fracBits" fractional bits.
+     * \param fracBits Number of fractional bits in the taps.
+     * \param operation How the filter filters.  Defaults to NimbleDSP::STREAMING.
+     */
+    template <typename U>
+    FixedPtFirFilter<T, C, A>(const std::vector<U> & taps, int fracBits, FilterOperationType operation = STREAMING) :
+            RealFixedPtVector<C>(taps) {init(fracBits, operation);}
+    
+    /**
+     * \brief Array constructor.
+     *
+     * \param taps Array of filter taps, in Q format with "fracBits" fractional bits.
+     * \param numTaps Number of taps in "taps".
+     * \param fracBits Number of fractional bits in the taps.
+     * \param operation How the filter filters.  Defaults to NimbleDSP::STREAMING.
+     */
+    template <typename U>
+    FixedPtFirFilter<T, C, A>(const U *taps, unsigned numTaps, int fracBits, FilterOperationType operation = STREAMING) :
+            RealFixedPtVector<C>(taps, numTaps) {init(fracBits, operation);}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Sets up the state for a new set of taps.  Called by the constructors.
+     */
+    void init(int fracBits, FilterOperationType operation) {
+        assert(this->size() > 0);
+        assert(fracBits >= 0 && fracBits < (int) (8 * sizeof(A)) - 1);
+        fractionalBits = fracBits;
+        filtOperation = operation;
+        rounding = ROUND_HALF_UP;
+        initState();
+    }
+    
+    /**
+     * \brief Clears the streaming state, as if no data had been filtered.
+     */
+    void reset() {initState();}
+    
+    /**
+     * \brief Convolution method.
+     *
+     * \param data The buffer that will be filtered.
+     * \param trimTails This parameter is ignored.  The operation of the filter is determined by how
+     *      \ref filtOperation is set.
+     * \return Reference to "data", which holds the result of the convolution.
+     */
+    RealVector<T> & conv(RealVector<T> & data, bool trimTails = false) {return decimate(data, 1, trimTails);}
+    
+    /**
+     * \brief Decimate method.
+     *
+     * Equivalent to \ref conv followed by keeping every rate'th output, but only the outputs that
+     * are kept are computed.
+     *
+     * \param data The buffer that will be filtered.
+     * \param rate Indicates how much to downsample.
+     * \param trimTails This parameter is ignored.  The operation of the filter is determined by how
+     *      \ref filtOperation is set.
+     * \return Reference to "data", which holds the result of the decimation.
+     */
+    RealVector<T> & decimate(RealVector<T> & data, int rate, bool trimTails = false);
+};
+
+
+template <class T, class C, class A>
+inline A FixedPtFirFilter<T, C, A>::scaleOutput(A sum) const {
+    return roundedShift(sum, fractionalBits, rounding);
+}
+
+template <class T, class C, class A>
+void FixedPtFirFilter<T, C, A>::filterWork(RealVector<T> & data, int first, int rate, int numResults) {
+    resultBuf.vec.resize(numResults);
+    for (int i=0; i<numResults; i++) {
+        resultBuf[i] = scaleOutput(dotProductAccumulate<A>(VECTOR_TO_ARRAY(workBuf) + first + i*rate,
+                                                           VECTOR_TO_ARRAY(reversedTaps), this->size()));
+    }
+    resultBuf.saturate((A) std::numeric_limits<T>::max());
+    
+    data.vec.resize(numResults);
+    for (int i=0; i<numResults; i++) {
+        data[i] = (T) resultBuf[i];
+    }
+}
+
+template <class T, class C, class A>
+RealVector<T> & FixedPtFirFilter<T, C, A>::decimate(RealVector<T> & data, int rate, bool trimTails) {
+    assert(rate > 0);
+    int numTaps = this->size();
+    int dataLen = data.size();
+    reverseTaps();
+    
+    switch (filtOperation) {
+    
+    case STREAMING: {
+        int totalLen = numSavedSamples + dataLen;
+        workBuf.resize(totalLen);
+        std::copy(savedData.begin(), savedData.begin() + numSavedSamples, workBuf.begin());
+        std::copy(data.vec.begin(), data.vec.end(), workBuf.begin() + numSavedSamples);
+        
+        int numResults = 0;
+        if (totalLen >= numTaps) {
+            numResults = (totalLen - (numTaps - 1) + rate - 1) / rate;
+        }
+        filterWork(data, 0, rate, numResults);
+        
+        int nextResultDataPoint = numResults * rate;
+        numSavedSamples = totalLen - nextResultDataPoint;
+        savedData.resize(std::max((int) savedData.size(), numSavedSamples));
+        std::copy(workBuf.begin() + nextResultDataPoint, workBuf.end(), savedData.begin());
+        }
+        break;
+    
+    case ONE_SHOT_RETURN_ALL_RESULTS:
+    case ONE_SHOT_TRIM_TAILS: {
+        // Padding the data with zeros on both sides lets the tails use the same dot product as the
+        // middle.  Output n (counting from the start of the full convolution) starts at workBuf[n].
+        workBuf.assign(dataLen + 2 * (numTaps - 1), 0);
+        std::copy(data.vec.begin(), data.vec.end(), workBuf.begin() + (numTaps - 1));
+        if (filtOperation == ONE_SHOT_RETURN_ALL_RESULTS) {
+            filterWork(data, 0, rate, (dataLen + numTaps - 1 + rate - 1) / rate);
+        }
+        else {
+            filterWork(data, (numTaps - 1) / 2, rate, (dataLen + rate - 1) / rate);
+        }
+        }
+        break;
+    }
+    return data;
+}
+
+/**
+ * \brief Convolution function for fixed point filters.
+ *
+ * \param data Buffer to operate on.
+ * \param filter The filter to convolve with.
+ * \param trimTails This parameter is ignored.  The operation of the filter is determined by how
+ *      the filter's filtOperation is set.
+ * \return Reference to "data", which holds the result of the convolution.
+ */
+template <class T, class C, class A>
+inline RealVector<T> & conv(RealVector<T> & data, FixedPtFirFilter<T, C, A> & filter, bool trimTails = false) {
+    return filter.conv(data, trimTails);
+}
+
+/**
+ * \brief Decimate function for fixed point filters.
+ *
+ * \param data Buffer to operate on.
+ * \param rate Indicates how much to downsample.
+ * \param filter The filter that will convolve "data".
+ * \param trimTails This parameter is ignored.  The operation of the filter is determined by how
+ *      the filter's filtOperation is set.
+ * \return Reference to "data", which holds the result of the decimation.
+ */
+template <class T, class C, class A>
+inline RealVector<T> & decimate(RealVector<T> & data, int rate, FixedPtFirFilter<T, C, A> & filter,
+            bool trimTails = false) {
+    return filter.decimate(data, rate, trimTails);
+}
+
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file FixedRealVector.h
+ *
+ * Definition of the template class FixedRealVector.
+ */
+
+#ifndef NimbleDSP_FixedRealVector_h
+#define NimbleDSP_FixedRealVector_h
+
+#include <array>
+#include <cassert>
+#include "RealVector.h"
+#include "VectorView.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Real vector whose size, N, is fixed at compile time.
+ *
+ * The elements are held in a std::array, so the vector lives wherever it is declared (on the
+ * stack, inside another object) with no heap allocation, and every loop over it has a constant
+ * trip count that the compiler can unroll and vectorize.  It is meant for processing loops whose
+ * block size never changes.  For anything the fixed-size methods don't cover, \ref view gives a
+ * VectorView of the elements, and FixedFirFilter filters it directly.
+ */
+template <class T, unsigned N>
+class FixedRealVector {
+ public:
+    /**
+     * \brief The elements.
+     */
+    std::array<T, N> vec;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.  Sets every element to "value".
+     */
+    FixedRealVector<T, N>(T value = 0) {vec.fill(value);}
+
+    /**
+     * \brief Array constructor.  Copies N elements from "data".
+     */
+    template <typename U>
+    FixedRealVector<T, N>(const U *data) {for (unsigned i=0; i<N; i++) vec[i] = (T) data[i];}
+
+    /**
+     * \brief std::array constructor.
+     */
+    FixedRealVector<T, N>(const std::array<T, N> & data) : vec(data) {}
+
+    /**
+     * \brief Vector constructor.  "data" must have N elements.
+     */
+    FixedRealVector<T, N>(const Vector<T> & data) {assert(data.size() == N); std::copy(data.vec.begin(), data.vec.end(), vec.begin());}
+
+    /*****************************************************************************************
+                                            Operators
+    *****************************************************************************************/
+    T& operator[](unsigned index) {return vec[index];}
+    const T& operator[](unsigned index) const {return vec[index];}
+
+    FixedRealVector<T, N> & operator+=(const FixedRealVector<T, N> & rhs)
+            {for (unsigned i=0; i<N; i++) vec[i] += rhs.vec[i]; return *this;}
+    FixedRealVector<T, N> & operator-=(const FixedRealVector<T, N> & rhs)
+            {for (unsigned i=0; i<N; i++) vec[i] -= rhs.vec[i]; return *this;}
+    FixedRealVector<T, N> & operator*=(const FixedRealVector<T, N> & rhs)
+            {for (unsigned i=0; i<N; i++) vec[i] *= rhs.vec[i]; return *this;}
+    FixedRealVector<T, N> & operator/=(const FixedRealVector<T, N> & rhs)
+            {for (unsigned i=0; i<N; i++) vec[i] /= rhs.vec[i]; return *this;}
+
+    FixedRealVector<T, N> & operator+=(const T & rhs) {for (unsigned i=0; i<N; i++) vec[i] += rhs; return *this;}
+    FixedRealVector<T, N> & operator-=(const T & rhs) {for (unsigned i=0; i<N; i++) vec[i] -= rhs; return *this;}
+    FixedRealVector<T, N> & operator*=(const T & rhs) {for (unsigned i=0; i<N; i++) vec[i] *= rhs; return *this;}
+    FixedRealVector<T, N> & operator/=(const T & rhs) {for (unsigned i=0; i<N; i++) vec[i] /= rhs; return *this;}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of elements, N.
+     */
+    static constexpr unsigned size() {return N;}
+
+    /**
+     * \brief Returns a pointer to the first element.
+     */
+    T *data() {return vec.data();}
+    const T *data() const {return vec.data();}
+
+    /**
+     * \brief Returns a view of the elements.
+     */
+    VectorView<T> view() {return VectorView<T>(vec.data(), N);}
+
+    /**
+     * \brief Returns the sum of all the elements.
+     */
+    T sum() const;
+
+    /**
+     * \brief Returns the sum of the products of the elements of "this" and "other".
+     */
+    T dot(const FixedRealVector<T, N> & other) const {return dotProduct(vec.data(), other.vec.data(), N);}
+
+    /**
+     * \brief Copies the elements into a RealVector.
+     */
+    RealVector<T> toVector() const {return RealVector<T>(vec.data(), N);}
+};
+
+
+template <class T, unsigned N>
+T FixedRealVector<T, N>::sum() const {
+    T total = 0;
+    for (unsigned i=0; i<N; i++) {
+        total += vec[i];
+    }
+    return total;
+}
+
+/**
+ * \brief Returns the sum of all the elements of "buffer".
+ */
+template <class T, unsigned N>
+inline T sum(const FixedRealVector<T, N> & buffer) {
+    return buffer.sum();
+}
+
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file HalfBandFilter.h
+ *
+ * Definition of the template class HalfBandDecimator.
+ */
+
+#ifndef NimbleDSP_HalfBandFilter_h
+#define NimbleDSP_HalfBandFilter_h
+
+#include <vector>
+#include <cassert>
+#include "RealVector.h"
+#include "SimdKernels.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Decimate by 2 filter that skips the zero taps of a half-band filter.
+ *
+ * Every other tap of a half-band filter is zero, apart from the center tap.  Decimating by 2 with
+ * RealFirFilter multiplies by all of them, so this class splits the input into its even and odd
+ * samples ahead of time.  Every output is then a dot product of the even samples with the
+ * non-zero taps, which \ref firDotProduct folds since they're symmetric, plus one odd sample times
+ * the center tap.  That's about a quarter of the multiplies of the full filter.
+ *
+ * The taps can be designed with RealFirFilter::halfBandFilter.  The number of taps must be 3 more
+ * than a multiple of 4, and the taps that should be zero are ignored rather than checked.  The
+ * results are the same as RealFirFilter::decimate by 2 in NimbleDSP::STREAMING mode with the same
+ * taps.
+ */
+template <class T>
+class HalfBandDecimator {
+ protected:
+    /**
+     * \brief The non-zero taps other than the center one, in reverse order.
+     */
+    std::vector<T> evenBank;
+    
+    T centerTap;
+    
+    int filterLen;
+    
+    TapSymmetryType bankSymmetry;
+    
+    /**
+     * \brief The input samples that the next output needs.  Used for stream filtering.
+     */
+    std::vector<T> savedData;
+    
+    /**
+     * \brief Indicates how many samples are in \ref savedData.
+     */
+    int numSavedSamples;
+    
+    /**
+     * \brief Working buffers for the input with its history, and for its even samples.  They keep
+     *      their capacity from call to call.
+     */
+    std::vector<T> workBuf;
+    std::vector<T> evenBuf;
+    
+    template <typename U>
+    void setTaps(const U *taps, unsigned numTaps);
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param taps The half-band filter taps.
+     */
+    template <typename U>
+    HalfBandDecimator<T>(const std::vector<U> & taps) {setTaps(VECTOR_TO_ARRAY(taps), taps.size());}
+    
+    /**
+     * \brief Array constructor.
+     *
+     * \param taps Array of half-band filter taps.
+     * \param numTaps Number of taps in "taps".
+     */
+    template <typename U>
+    HalfBandDecimator<T>(const U *taps, unsigned numTaps) {setTaps(taps, numTaps);}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of taps, including the zeros.
+     */
+    int numTaps() const {return filterLen;}
+    
+    /**
+     * \brief Clears the streaming state, as if no data had been filtered.
+     */
+    void reset() {numSavedSamples = filterLen - 1; savedData.assign(numSavedSamples, 0);}
+    
+    /**
+     * \brief Decimates "data" by 2 in place, continuing from the previous call.
+     *
+     * \param data Buffer to decimate.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    RealVector<T> & decimate(RealVector<T> & data);
+};
+
+
+template <class T>
+template <typename U>
+void HalfBandDecimator<T>::setTaps(const U *taps, unsigned numTaps) {
+    assert(numTaps % 4 == 3);
+    filterLen = numTaps;
+    evenBank.resize((numTaps + 1) / 2);
+    for (unsigned q=0; q<evenBank.size(); q++) {
+        evenBank[q] = (T) taps[numTaps - 1 - 2 * q];
+    }
+    centerTap = (T) taps[numTaps / 2];
+    bankSymmetry = detectTapSymmetry(VECTOR_TO_ARRAY(evenBank), evenBank.size());
+    reset();
+}
+
+template <class T>
+RealVector<T> & HalfBandDecimator<T>::decimate(RealVector<T> & data) {
+    int dataLen = data.size();
+    int totalLen = numSavedSamples + dataLen;
+    workBuf.resize(totalLen);
+    std::copy(savedData.begin(), savedData.begin() + numSavedSamples, workBuf.begin());
+    std::copy(data.vec.begin(), data.vec.end(), workBuf.begin() + numSavedSamples);
+    
+    evenBuf.resize((totalLen + 1) / 2);
+    for (unsigned j=0; j<evenBuf.size(); j++) {
+        evenBuf[j] = workBuf[2 * j];
+    }
+    
+    // Output m is the dot product of the reversed taps with workBuf[2m] onwards.  The non-zero
+    // taps other than the center one line up with even samples.
+    int numResults = 0;
+    if (totalLen >= filterLen) {
+        numResults = (totalLen - (filterLen - 1) + 1) / 2;
+    }
+    int numEven = evenBank.size();
+    int center = filterLen / 2;
+    data.vec.resize(numResults);
+    for (int m=0; m<numResults; m++) {
+        data[m] = firDotProduct(VECTOR_TO_ARRAY(evenBuf) + m, VECTOR_TO_ARRAY(evenBank), numEven, bankSymmetry) +
+                  centerTap * workBuf[2 * m + center];
+    }
+    
+    int nextResultDataPoint = 2 * numResults;
+    numSavedSamples = totalLen - nextResultDataPoint;
+    savedData.resize(std::max((int) savedData.size(), numSavedSamples));
+    std::copy(workBuf.begin() + nextResultDataPoint, workBuf.end(), savedData.begin());
+    return data;
+}
+
+/**
+ * \brief Decimates "data" by 2 in place with "filter", continuing from the previous call.
+ *
+ * \param data Buffer to decimate.
+ * \param filter The half-band decimator.  Holds the taps and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline RealVector<T> & decimate(RealVector<T> & data, HalfBandDecimator<T> & filter) {
+    return filter.decimate(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,326 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file IirKernels.h
+ *
+ * Direct form II IIR kernels shared by RealIirFilter and ComplexIirFilter, including the block
+ * filter that splits a long one-shot vector into segments.
+ */
+
+#ifndef NimbleDSP_IirKernels_h
+#define NimbleDSP_IirKernels_h
+
+#include <vector>
+#include <algorithm>
+#include "ThreadPool.h"
+#include "Allocators.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Number of segments that \ref iirFilterLanes runs in lockstep.
+ */
+const int IIR_LANES = 8;
+
+/**
+ * \brief Number of samples per lane that \ref iirFilterLanes interleaves at a time.
+ */
+const int IIR_LANES_CHUNK_LEN = 64;
+
+/**
+ * \brief The shortest segment that \ref blockIirFilter splits data into.  Shorter segments spend
+ *      too much of their time fixing up states.
+ */
+const int IIR_MIN_SEGMENT_LEN = 512;
+
+/**
+ * \brief The shortest block that RealIirFilter and ComplexIirFilter filter with \ref blockIirFilter
+ *      when their filterAlgorithm is NimbleDSP::AUTO_IIR.
+ */
+const unsigned IIR_BLOCK_MIN_LEN = 4 * IIR_MIN_SEGMENT_LEN;
+
+/**
+ * \brief Runs the direct form II recursion on "Lanes" independent segments at once.
+ *
+ * Filtering one sample needs the previous sample's result, so a single recursion runs at one
+ * sample per chain of dependent multiply-adds.  Segments don't depend on each other, so running
+ * several side by side keeps the multiply-adds of one from waiting on another, and puts the same
+ * operation on every lane in turn, which the compiler can vectorize.
+ *
+ * The state of a lane is its last "order" intermediate values, most recent first (w[n], w[n-1],
+ * ..., w[n-order+1]), where w[n] = x[n] - den[1]*w[n-1] - ... and y[n] = num[0]*w[n] + ....
+ * den[0] is taken to be 1.
+ *
+ * \param data Lane j's samples start at data + j * stride.  Filtered in place.
+ * \param stride Distance between the starts of the lanes.
+ * \param steps Number of samples to filter in each lane.
+ * \param order max(numLen, denLen) - 1.
+ * \param states Lanes states of "order" values each, lane after lane.  Updated on return.
+ * \param feedbackOnly If true only the states are updated.  "data" is left alone.
+ */
+template <int Lanes, class C, class U>
+void iirFilterLanes(U *data, int stride, int steps, const C *num, int numLen, const C *den, int denLen, int order,
+                    U *states, bool feedbackOnly) {
+    // hist holds a window of intermediate values for every lane, twice over, so that w[n-k]
+    // is always at hist[(pos + k) * Lanes + lane] without wrapping.
+    const int histLen = order + 1;
+    ScratchBuffer<U> scratch;
+    std::vector<U> & hist = *scratch;
+    hist.assign(2 * histLen * Lanes, U(0));
+    for (int j=0; j<Lanes; j++) {
+        for (int k=0; k<order; k++) {
+            hist[k * Lanes + j] = hist[(k + histLen) * Lanes + j] = states[j * order + k];
+        }
+    }
+
+    // The lanes' samples are copied into "x" a chunk at a time, interleaved so that each step
+    // reads and writes one sample of every lane with contiguous loads and stores.
+    const int chunkLen = IIR_LANES_CHUNK_LEN;
+    U x[chunkLen * Lanes];
+    U *window = hist.data();
+    int pos = 0;
+    // w[n-1] and w[n] are carried in locals too, for the same reason as "out" below.
+    const C den1 = (denLen > 1) ? den[1] : C(0);
+    U prev[Lanes];
+    for (int j=0; j<Lanes; j++) {
+        prev[j] = window[j];
+    }
+    for (int start=0; start<steps; start+=chunkLen) {
+        int len = std::min(chunkLen, steps - start);
+        for (int j=0; j<Lanes; j++) {
+            const U *in = data + j * stride + start;
+            for (int n=0; n<len; n++) {
+                x[n * Lanes + j] = in[n];
+            }
+        }
+
+        for (int n=0; n<len; n++) {
+            pos = (pos == 0) ? histLen - 1 : pos - 1;
+            U *w = window + pos * Lanes;
+            U *xn = x + n * Lanes;
+            U acc[Lanes];
+            for (int j=0; j<Lanes; j++) {
+                acc[j] = xn[j] - den1 * prev[j];
+            }
+            for (int i=2; i<denLen; i++) {
+                for (int j=0; j<Lanes; j++) {
+                    acc[j] -= den[i] * w[i * Lanes + j];
+                }
+            }
+            for (int j=0; j<Lanes; j++) {
+                w[j] = w[histLen * Lanes + j] = prev[j] = acc[j];
+            }
+
+            if (!feedbackOnly) {
+                // w[n] comes from acc rather than being read straight back from hist, which
+                // would stall on the stores just made.
+                U out[Lanes];
+                for (int j=0; j<Lanes; j++) {
+                    out[j] = num[0] * acc[j];
+                }
+                for (int i=1; i<numLen; i++) {
+                    for (int j=0; j<Lanes; j++) {
+                        out[j] += num[i] * w[i * Lanes + j];
+                    }
+                }
+                for (int j=0; j<Lanes; j++) {
+                    xn[j] = out[j];
+                }
+            }
+        }
+
+        if (!feedbackOnly) {
+            for (int j=0; j<Lanes; j++) {
+                U *out = data + j * stride + start;
+                for (int n=0; n<len; n++) {
+                    out[n] = x[n * Lanes + j];
+                }
+            }
+        }
+    }
+
+    for (int j=0; j<Lanes; j++) {
+        for (int k=0; k<order; k++) {
+            states[j * order + k] = window[(pos + k) * Lanes + j];
+        }
+    }
+}
+
+/**
+ * \brief Runs \ref iirFilterLanes on "numSegments" consecutive segments of "segmentLen" samples,
+ *      IIR_LANES at a time and then one at a time for the leftovers.  "states" holds a state per
+ *      segment.
+ */
+template <class C, class U>
+void iirFilterSegments(U *data, int segmentLen, int numSegments, const C *num, int numLen, const C *den, int denLen,
+                       int order, U *states, bool feedbackOnly) {
+    int s = 0;
+    for (; s + IIR_LANES <= numSegments; s += IIR_LANES) {
+        iirFilterLanes<IIR_LANES>(data + s * segmentLen, segmentLen, segmentLen, num, numLen, den, denLen, order,
+                                  states + s * order, feedbackOnly);
+    }
+    for (; s < numSegments; s++) {
+        iirFilterLanes<1>(data + s * segmentLen, 0, segmentLen, num, numLen, den, denLen, order, states + s * order,
+                          feedbackOnly);
+    }
+}
+
+/**
+ * \brief Sets "power" to the order x order matrix that advances a direct form II state "steps"
+ *      samples with no input.  Row major.
+ */
+template <class C>
+void iirTransitionPower(const C *den, int denLen, int order, int steps, std::vector<C> & power) {
+    // One step: w[n+1] = -den[1]*w[n] - ..., and the rest of the state shifts down one.
+    ScratchBuffer<C> stepBuffer, productBuffer;
+    std::vector<C> & step = *stepBuffer;
+    std::vector<C> & product = *productBuffer;
+    step.assign(order * order, C(0));
+    for (int i=1; i<denLen; i++) {
+        step[i - 1] = -den[i];
+    }
+    for (int r=1; r<order; r++) {
+        step[r * order + r - 1] = 1;
+    }
+
+    power.assign(order * order, C(0));
+    for (int r=0; r<order; r++) {
+        power[r * order + r] = 1;
+    }
+    product.resize(order * order);
+    for (; steps > 0; steps >>= 1) {
+        if (steps & 1) {
+            for (int r=0; r<order; r++) {
+                for (int c=0; c<order; c++) {
+                    C sum = 0;
+                    for (int k=0; k<order; k++) {
+                        sum += power[r * order + k] * step[k * order + c];
+                    }
+                    product[r * order + c] = sum;
+                }
+            }
+            power.swap(product);
+        }
+        if (steps > 1) {
+            for (int r=0; r<order; r++) {
+                for (int c=0; c<order; c++) {
+                    C sum = 0;
+                    for (int k=0; k<order; k++) {
+                        sum += step[r * order + k] * step[k * order + c];
+                    }
+                    product[r * order + c] = sum;
+                }
+            }
+            step.swap(product);
+        }
+    }
+}
+
+/**
+ * \brief Filters "dataLen" samples in place, picking up from "state" and leaving the final state
+ *      in it.
+ *
+ * This is the block version of the direct form II recursion that RealIirFilter::filter and
+ * ComplexIirFilter::filter run.  The data is split into segments, IIR_LANES per thread of "pool"
+ * (or just IIR_LANES if "pool" is NULL), of at least IIR_MIN_SEGMENT_LEN samples, in three passes:
+ *
+ *      1. Each segment is filtered from a zero state, keeping only its final state.
+ *         The segments run side by side (see \ref iirFilterLanes), spread across the pool.
+ *      2. The state at the start of each segment is worked out from the one before:
+ *         x[s+1] = A^L * x[s] + z[s], where A^L advances a state by a segment of L samples and z[s]
+ *         is the final state from pass 1.  This is the only serial pass, and it costs order^2
+ *         operations per segment.
+ *      3. Each segment is filtered for real from its starting state, again side by side.
+ *
+ * Pass 1 doesn't compute outputs, so the work is about one and a half times that of filtering
+ * serially, but it runs IIR_LANES recursions at once on each thread, which is several times
+ * faster.  The results match the
+ * serial recursion to within rounding, for stable filters.
+ *
+ * \param state "order" values in the format described by \ref iirFilterLanes.
+ */
+template <class C, class U, class S>
+void blockIirFilter(ThreadPool *pool, U *data, int dataLen, const C *num, int numLen, const C *den, int denLen,
+                    S *state) {
+    const int order = std::max(numLen, denLen) - 1;
+    int numThreads = (pool == NULL) ? 1 : pool->size();
+    int numSegments = std::min(IIR_LANES * numThreads, dataLen / IIR_MIN_SEGMENT_LEN);
+
+    ScratchBuffer<U> startsBuffer;
+    std::vector<U> & starts = *startsBuffer;
+    starts.resize((std::max(numSegments, 1) + 1) * order);
+    for (int k=0; k<order; k++) {
+        starts[k] = (U) state[k];
+    }
+    if (numSegments <= 1 || order == 0) {
+        iirFilterLanes<1>(data, 0, dataLen, num, numLen, den, denLen, order, starts.data(), false);
+        for (int k=0; k<order; k++) {
+            state[k] = (S) starts[k];
+        }
+        return;
+    }
+    const int segmentLen = dataLen / numSegments;
+
+    // Pass 1: the zero state final state of each segment, into starts[s + 1].  The last segment's
+    // isn't needed, but leaving it out would break up the last group of lanes.
+    std::fill(starts.begin() + order, starts.end(), U(0));
+    parallelFor(pool, 0, numSegments, IIR_LANES, [&](int first, int last) {
+        iirFilterSegments(data + first * segmentLen, segmentLen, last - first, num, numLen, den, denLen, order,
+                          &starts[(first + 1) * order], true);
+    });
+
+    // Pass 2: add the response to each segment's starting state.
+    ScratchBuffer<C> transitionBuffer;
+    std::vector<C> & transition = *transitionBuffer;
+    iirTransitionPower(den, denLen, order, segmentLen, transition);
+    for (int s=1; s<numSegments; s++) {
+        const U *previous = &starts[(s - 1) * order];
+        U *current = &starts[s * order];
+        for (int r=0; r<order; r++) {
+            U sum = current[r];
+            for (int c=0; c<order; c++) {
+                sum += transition[r * order + c] * previous[c];
+            }
+            current[r] = sum;
+        }
+    }
+
+    // Pass 3: filter each segment from its starting state.  The last segment takes the leftover
+    // samples on its own afterwards.
+    parallelFor(pool, 0, numSegments, IIR_LANES, [&](int first, int last) {
+        iirFilterSegments(data + first * segmentLen, segmentLen, last - first, num, numLen, den, denLen, order,
+                          &starts[first * order], false);
+    });
+    U *lastState = &starts[(numSegments - 1) * order];
+    iirFilterLanes<1>(data + numSegments * segmentLen, 0, dataLen - numSegments * segmentLen, num, numLen, den, denLen,
+                      order, lastState, false);
+    for (int k=0; k<order; k++) {
+        state[k] = (S) lastState[k];
+    }
+}
+
+};
+
+#endif
@@ -0,0 +1,348 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file Instrumentation.h
+ *
+ * Call counters, timers and allocation tracking for the library's hot paths.
+ *
+ * Build with NIMBLEDSP_INSTRUMENTATION defined to compile the hooks in.  Each instrumented
+ * operation (RealFirFilter::conv, ComplexVector::fft, RealIirFilter::filter, ...) then records
+ * how many times it was called, how many input samples it was given, the time spent in it, and
+ * the heap allocations it made.  \ref instrumentationSnapshot returns the totals for each
+ * operation, and the filters also keep their own totals in their "instrumentation" member, so
+ * that one stage of a chain can be told from another.  Without NIMBLEDSP_INSTRUMENTATION the
+ * hooks and the members compile to nothing and the snapshot is empty.  Every translation unit
+ * in a program has to be built with the same setting.
+ *
+ * Times include anything the operation calls, so a resample that filters internally is counted
+ * once as a resample.  Work that an operation hands to a ThreadPool is timed as part of the
+ * caller's wall clock time.
+ *
+ * Allocations are counted by the replacement global operator new and delete in
+ * AllocationCounter.cpp, which has to be added to the program's sources.  Without it the
+ * allocation counts stay at zero.  Only the allocations made on the thread running the
+ * operation are counted.
+ */
+
+#ifndef NimbleDSP_Instrumentation_h
+#define NimbleDSP_Instrumentation_h
+
+#include <vector>
+#include <map>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+#include <stdint.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define NIMBLEDSP_HAVE_RDTSC
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define NIMBLEDSP_HAVE_RDTSC
+#endif
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Totals for one operation or one filter.
+ */
+struct InstrumentationCounts {
+    /** \brief Number of calls. */
+    uint64_t calls;
+    /** \brief Number of input samples passed in. */
+    uint64_t samples;
+    /** \brief Wall clock time spent in the calls. */
+    uint64_t nanoseconds;
+    /** \brief Time spent in the calls, in time stamp counter ticks.  Zero on processors without one. */
+    uint64_t cycles;
+    /** \brief Number of heap allocations made by the calls.  See the file description. */
+    uint64_t allocations;
+    /** \brief Total bytes requested by those allocations. */
+    uint64_t allocatedBytes;
+
+    InstrumentationCounts() : calls(0), samples(0), nanoseconds(0), cycles(0), allocations(0), allocatedBytes(0) {}
+
+    InstrumentationCounts & operator+=(const InstrumentationCounts & rhs) {
+        calls += rhs.calls;
+        samples += rhs.samples;
+        nanoseconds += rhs.nanoseconds;
+        cycles += rhs.cycles;
+        allocations += rhs.allocations;
+        allocatedBytes += rhs.allocatedBytes;
+        return *this;
+    }
+
+    /**
+     * \brief Returns the input samples processed per second of time spent in the calls.
+     */
+    double samplesPerSecond() const {return (nanoseconds == 0) ? 0 : samples * 1e9 / nanoseconds;}
+};
+
+/**
+ * \brief The per operation totals at one point in time.
+ */
+struct InstrumentationSnapshot {
+    /**
+     * \brief Wall clock time since the program started or \ref resetInstrumentation was last
+     *      called.  An operation whose nanoseconds are close to this kept a core busy the whole
+     *      time.
+     */
+    uint64_t elapsedNanoseconds;
+
+    /**
+     * \brief Totals keyed by operation name, e.g. "RealFirFilter::conv".  The instantiations for
+     *      different sample types are added together.
+     */
+    std::map<std::string, InstrumentationCounts> operations;
+
+    InstrumentationSnapshot() : elapsedNanoseconds(0) {}
+};
+
+/**
+ * \brief Heap allocations made on one thread.
+ */
+struct ThreadAllocationCounts {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+/**
+ * \brief Returns the number of heap allocations and bytes allocated on the calling thread so far,
+ *      as counted by the operator new in AllocationCounter.cpp.
+ */
+inline ThreadAllocationCounts & threadAllocationCounts() {
+    static thread_local ThreadAllocationCounts counts = {0, 0};
+    return counts;
+}
+
+/**
+ * \brief Reads the processor's time stamp counter, or returns 0 if it doesn't have one.
+ */
+inline uint64_t readCycleCounter() {
+#if defined(NIMBLEDSP_HAVE_RDTSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * \brief Returns the steady clock's current time in nanoseconds.
+ */
+inline uint64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class OperationCounter;
+
+/**
+ * \brief The list of every OperationCounter in the program.  Counters add themselves when they
+ *      are constructed and stay until the program exits.
+ */
+class InstrumentationRegistry {
+ protected:
+    std::mutex lock;
+    std::vector<OperationCounter *> counters;
+    std::atomic<uint64_t> startNanoseconds;
+
+    InstrumentationRegistry() : startNanoseconds(steadyNanoseconds()) {}
+
+ public:
+    static InstrumentationRegistry & instance() {
+        static InstrumentationRegistry registry;
+        return registry;
+    }
+
+    void add(OperationCounter *counter) {
+        std::lock_guard<std::mutex> guard(lock);
+        counters.push_back(counter);
+    }
+
+    InstrumentationSnapshot snapshot();
+    void reset();
+};
+
+/**
+ * \brief Process wide totals for one operation.  Safe to update from any number of threads.
+ */
+class OperationCounter {
+ protected:
+    const char *operationName;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> samples;
+    std::atomic<uint64_t> nanoseconds;
+    std::atomic<uint64_t> cycles;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> allocatedBytes;
+
+ public:
+    /**
+     * \brief Constructor.  "name" has to outlive the counter; it is normally a string literal.
+     */
+    OperationCounter(const char *name) : operationName(name), calls(0), samples(0), nanoseconds(0), cycles(0),
+            allocations(0), allocatedBytes(0) {InstrumentationRegistry::instance().add(this);}
+
+    const char *name() const {return operationName;}
+
+    void record(const InstrumentationCounts & counts) {
+        calls.fetch_add(counts.calls, std::memory_order_relaxed);
+        samples.fetch_add(counts.samples, std::memory_order_relaxed);
+        nanoseconds.fetch_add(counts.nanoseconds, std::memory_order_relaxed);
+        cycles.fetch_add(counts.cycles, std::memory_order_relaxed);
+        allocations.fetch_add(counts.allocations, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(counts.allocatedBytes, std::memory_order_relaxed);
+    }
+
+    InstrumentationCounts counts() const {
+        InstrumentationCounts current;
+        current.calls = calls.load(std::memory_order_relaxed);
+        current.samples = samples.load(std::memory_order_relaxed);
+        current.nanoseconds = nanoseconds.load(std::memory_order_relaxed);
+        current.cycles = cycles.load(std::memory_order_relaxed);
+        current.allocations = allocations.load(std::memory_order_relaxed);
+        current.allocatedBytes = allocatedBytes.load(std::memory_order_relaxed);
+        return current;
+    }
+
+    void reset() {
+        calls.store(0, std::memory_order_relaxed);
+        samples.store(0, std::memory_order_relaxed);
+        nanoseconds.store(0, std::memory_order_relaxed);
+        cycles.store(0, std::memory_order_relaxed);
+        allocations.store(0, std::memory_order_relaxed);
+        allocatedBytes.store(0, std::memory_order_relaxed);
+    }
+};
+
+inline InstrumentationSnapshot InstrumentationRegistry::snapshot() {
+    InstrumentationSnapshot result;
+    std::lock_guard<std::mutex> guard(lock);
+    result.elapsedNanoseconds = steadyNanoseconds() - startNanoseconds.load();
+    for (unsigned i=0; i<counters.size(); i++) {
+        InstrumentationCounts counts = counters[i]->counts();
+        if (counts.calls > 0) {
+            result.operations[counters[i]->name()] += counts;
+        }
+    }
+    return result;
+}
+
+inline void InstrumentationRegistry::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (unsigned i=0; i<counters.size(); i++) {
+        counters[i]->reset();
+    }
+    startNanoseconds.store(steadyNanoseconds());
+}
+
+/**
+ * \brief Returns the totals of every operation that has been called since the program started
+ *      or \ref resetInstrumentation was last called.
+ */
+inline InstrumentationSnapshot instrumentationSnapshot() {
+    return InstrumentationRegistry::instance().snapshot();
+}
+
+/**
+ * \brief Zeroes the per operation totals.  The filters' own totals are left alone; assign
+ *      InstrumentationCounts() to a filter's "instrumentation" member to clear it.
+ */
+inline void resetInstrumentation() {
+    InstrumentationRegistry::instance().reset();
+}
+
+/**
+ * \brief Times the scope it is declared in and adds one call to an OperationCounter, and
+ *      optionally to a filter's own totals, when it is destroyed.
+ */
+class InstrumentedScope {
+ protected:
+    OperationCounter & counter;
+    InstrumentationCounts *instanceCounts;
+    uint64_t numSamples;
+    uint64_t startNanoseconds;
+    uint64_t startCycles;
+    ThreadAllocationCounts startAllocations;
+
+    InstrumentedScope(const InstrumentedScope &);
+    InstrumentedScope & operator=(const InstrumentedScope &);
+
+ public:
+    /**
+     * \param operation The counter to add the call to.
+     * \param samples Number of input samples the call was given.
+     * \param instance A filter's own totals to add the call to as well, or NULL.
+     */
+    InstrumentedScope(OperationCounter & operation, uint64_t samples, InstrumentationCounts *instance = NULL) :
+            counter(operation), instanceCounts(instance), numSamples(samples),
+            startAllocations(threadAllocationCounts()) {
+        startNanoseconds = steadyNanoseconds();
+        startCycles = readCycleCounter();
+    }
+
+    ~InstrumentedScope() {
+        InstrumentationCounts call;
+        call.cycles = readCycleCounter() - startCycles;
+        call.nanoseconds = steadyNanoseconds() - startNanoseconds;
+        call.calls = 1;
+        call.samples = numSamples;
+        const ThreadAllocationCounts & allocated = threadAllocationCounts();
+        call.allocations = allocated.allocations - startAllocations.allocations;
+        call.allocatedBytes = allocated.bytes - startAllocations.bytes;
+        counter.record(call);
+        if (instanceCounts != NULL) {
+            *instanceCounts += call;
+        }
+    }
+};
+
+};
+
+/**
+ * \def NIMBLEDSP_INSTRUMENT(name, samples)
+ * \brief Counts and times the rest of the enclosing scope as operation "name", given "samples"
+ *      input samples.  Nothing when NIMBLEDSP_INSTRUMENTATION isn't defined.
+ *
+ * \def NIMBLEDSP_INSTRUMENT_MEMBER(name, samples)
+ * \brief Same as NIMBLEDSP_INSTRUMENT, and also adds the call to this->instrumentation.  For
+ *      methods of classes with an "instrumentation" member.
+ */
+#if defined(NIMBLEDSP_INSTRUMENTATION)
+#define NIMBLEDSP_INSTRUMENT(name, samples) \
+    static NimbleDSP::OperationCounter nimbleDspOperationCounter(name); \
+    NimbleDSP::InstrumentedScope nimbleDspInstrumentedScope(nimbleDspOperationCounter, samples)
+#define NIMBLEDSP_INSTRUMENT_MEMBER(name, samples) \
+    static NimbleDSP::OperationCounter nimbleDspOperationCounter(name); \
+    NimbleDSP::InstrumentedScope nimbleDspInstrumentedScope(nimbleDspOperationCounter, samples, &this->instrumentation)
+#else
+#define NIMBLEDSP_INSTRUMENT(name, samples)
+#define NIMBLEDSP_INSTRUMENT_MEMBER(name, samples)
+#endif
+
+#endif
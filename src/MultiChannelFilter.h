@@ -0,0 +1,489 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file MultiChannelFilter.h
+ *
+ * Definition of the template classes MultiChannelFirFilter and MultiChannelIirFilter, which run
+ * many channels of data through one set of coefficients.
+ */
+
+#ifndef NimbleDSP_MultiChannelFilter_h
+#define NimbleDSP_MultiChannelFilter_h
+
+#include <complex>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include "RealVector.h"
+#include "ComplexVector.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Interleaves equal length channels into one buffer.
+ *
+ * Sample n of channel c ends up at index n * channels.size() + c of "interleaved", which is the
+ * layout the multi-channel filters work on.
+ *
+ * \param channels The channels.  They must all be the same size.
+ * \param interleaved On return holds the interleaved samples.
+ * \return Reference to "interleaved".
+ */
+template <class V, class U>
+Vector<U> & interleaveChannels(const std::vector<V> & channels, Vector<U> & interleaved) {
+    unsigned numChannels = channels.size();
+    unsigned numFrames = (numChannels > 0) ? channels[0].size() : 0;
+
+    interleaved.vec.resize(numChannels * numFrames);
+    for (unsigned c=0; c<numChannels; c++) {
+        assert(channels[c].size() == numFrames);
+        for (unsigned n=0; n<numFrames; n++) {
+            interleaved.vec[n * numChannels + c] = channels[c].vec[n];
+        }
+    }
+    return interleaved;
+}
+
+/**
+ * \brief Splits an interleaved buffer back into its channels.
+ *
+ * \param interleaved The interleaved samples.  Its size must be a multiple of channels.size().
+ * \param channels On return channel c holds samples c, c + channels.size(), ... of "interleaved".
+ * \return Reference to "channels".
+ */
+template <class V, class U>
+std::vector<V> & deinterleaveChannels(const Vector<U> & interleaved, std::vector<V> & channels) {
+    unsigned numChannels = channels.size();
+    assert(numChannels > 0 && interleaved.size() % numChannels == 0);
+    unsigned numFrames = interleaved.size() / numChannels;
+
+    for (unsigned c=0; c<numChannels; c++) {
+        channels[c].vec.resize(numFrames);
+        for (unsigned n=0; n<numFrames; n++) {
+            channels[c].vec[n] = interleaved.vec[n * numChannels + c];
+        }
+    }
+    return channels;
+}
+
+
+/**
+ * \brief Streaming FIR filter that applies one set of taps to many channels at once.
+ *
+ * Keeping one RealFirFilter or ComplexFirFilter per channel means every channel reloads the same
+ * taps.  This class holds the taps once and works on interleaved data (sample n of channel c at
+ * index n * numChannels() + c), so each tap is applied to every channel before moving to the next
+ * tap.  The innermost loop runs across channels with unit stride, which the compiler vectorizes.
+ *
+ * T is the tap type: a real type for the equivalent of RealFirFilter (on real or complex data), or
+ * std::complex for the equivalent of ComplexFirFilter.  The results are the same as filtering each
+ * channel with its own filter in NimbleDSP::STREAMING mode.  A filter should be used for one data
+ * type only, since the streaming state is shared.
+ */
+template <class T>
+class MultiChannelFirFilter {
+ protected:
+    /**
+     * \brief The last numTaps - 1 frames of input, interleaved like the data.
+     */
+    std::vector<char> savedData;
+
+    unsigned channels;
+
+    template <class U>
+    U *history();
+
+ public:
+    /**
+     * \brief The filter taps, shared by all channels.
+     */
+    std::vector<T> taps;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param filterTaps The filter taps.
+     * \param numChannels Number of channels.
+     */
+    template <typename U>
+    MultiChannelFirFilter<T>(const std::vector<U> & filterTaps, unsigned numChannels)
+            {assert(filterTaps.size() > 0); setTaps(VECTOR_TO_ARRAY(filterTaps), filterTaps.size(), numChannels);}
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param filterTaps Array of filter taps.
+     * \param numTaps Number of taps in "filterTaps".
+     * \param numChannels Number of channels.
+     */
+    template <typename U>
+    MultiChannelFirFilter<T>(const U *filterTaps, unsigned numTaps, unsigned numChannels)
+            {setTaps(filterTaps, numTaps, numChannels);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Replaces the taps and the number of channels and clears the streaming state.
+     */
+    template <typename U>
+    void setTaps(const U *filterTaps, unsigned numTaps, unsigned numChannels);
+
+    /**
+     * \brief Clears the streaming state of every channel.
+     */
+    void reset() {std::fill(savedData.begin(), savedData.end(), 0);}
+
+    unsigned numChannels() const {return channels;}
+
+    /**
+     * \brief Filters interleaved data in place, continuing from the previous call.
+     *
+     * \param data Interleaved samples.  Its size must be a multiple of \ref numChannels.
+     * \return Reference to "data".
+     */
+    template <class U>
+    Vector<U> & filter(Vector<U> & data);
+
+    /**
+     * \brief Filters separate channel buffers in place, continuing from the previous call.
+     *
+     * The channels are interleaved, filtered, and split apart again.  Data that is already
+     * interleaved should use the other filter method, which avoids the copies.
+     * \param data One buffer per channel.  They must all be the same size.
+     * \return Reference to "data".
+     */
+    template <class U>
+    std::vector< RealVector<U> > & filter(std::vector< RealVector<U> > & data);
+
+    template <class U>
+    std::vector< ComplexVector<U> > & filter(std::vector< ComplexVector<U> > & data);
+};
+
+
+template <class T>
+template <typename U>
+void MultiChannelFirFilter<T>::setTaps(const U *filterTaps, unsigned numTaps, unsigned numChannels) {
+    assert(numTaps > 0 && numChannels > 0);
+    taps.resize(numTaps);
+    for (unsigned i=0; i<numTaps; i++) {
+        taps[i] = (T) filterTaps[i];
+    }
+    channels = numChannels;
+    savedData.clear();
+}
+
+template <class T>
+template <class U>
+U *MultiChannelFirFilter<T>::history() {
+    unsigned numBytes = (taps.size() - 1) * channels * sizeof(U);
+    if (savedData.size() != numBytes) {
+        savedData.assign(numBytes, 0);
+    }
+    return (U *) savedData.data();
+}
+
+template <class T>
+template <class U>
+Vector<U> & MultiChannelFirFilter<T>::filter(Vector<U> & data) {
+    assert(data.size() % channels == 0);
+    ScratchBuffer<U> scratch;
+    std::vector<U> *dataTmp;
+    unsigned numFrames = data.size() / channels;
+    unsigned numTaps = taps.size();
+    unsigned numHistory = (numTaps - 1) * channels;
+    U *saved = history<U>();
+
+    if (data.scratchBuf == NULL) {
+        dataTmp = scratch.get();
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    dataTmp->resize(numHistory + data.size());
+    U *buf = VECTOR_TO_ARRAY(*dataTmp);
+    std::copy(saved, saved + numHistory, buf);
+    std::copy(data.vec.begin(), data.vec.end(), buf + numHistory);
+
+    // Frame n of the output uses input frames n through n + numTaps - 1 of buf, oldest first.
+    for (unsigned n=0; n<numFrames; n++) {
+        U *out = VECTOR_TO_ARRAY(data.vec) + n * channels;
+        std::fill(out, out + channels, U(0));
+        for (unsigned k=0; k<numTaps; k++) {
+            T tap = taps[numTaps - 1 - k];
+            const U *in = buf + (n + k) * channels;
+            for (unsigned c=0; c<channels; c++) {
+                out[c] += tap * in[c];
+            }
+        }
+    }
+
+    std::copy(buf + data.size(), buf + data.size() + numHistory, saved);
+    return data;
+}
+
+template <class T>
+template <class U>
+std::vector< RealVector<U> > & MultiChannelFirFilter<T>::filter(std::vector< RealVector<U> > & data) {
+    assert(data.size() == channels);
+    RealVector<U> interleaved;
+    filter(interleaveChannels(data, interleaved));
+    return deinterleaveChannels(interleaved, data);
+}
+
+template <class T>
+template <class U>
+std::vector< ComplexVector<U> > & MultiChannelFirFilter<T>::filter(std::vector< ComplexVector<U> > & data) {
+    assert(data.size() == channels);
+    ComplexVector<U> interleaved;
+    filter(interleaveChannels(data, interleaved));
+    return deinterleaveChannels(interleaved, data);
+}
+
+/**
+ * \brief Filters interleaved "data" in place with "filt", continuing from the previous call.
+ *
+ * \param data Interleaved samples.  Its size must be a multiple of filt.numChannels().
+ * \param filt The filter.  Holds the taps and every channel's streaming state.
+ * \return Reference to "data".
+ */
+template <class T, class U>
+inline Vector<U> & filter(Vector<U> & data, MultiChannelFirFilter<T> & filt) {
+    return filt.filter(data);
+}
+
+
+/**
+ * \brief IIR filter that applies one numerator and denominator to many channels at once.
+ *
+ * The multi-channel counterpart of RealIirFilter and ComplexIirFilter.  It is a transposed direct
+ * form II filter whose state is stored structure-of-arrays style, one row of numChannels() values
+ * per delay, so each coefficient is applied across every channel in one unit-stride loop.  The
+ * data is interleaved the same way as for MultiChannelFirFilter, and the state persists between
+ * calls.
+ *
+ * The coefficients are normalized so that denominator[0] is 1, and the shorter of the numerator
+ * and denominator is zero padded to the length of the longer one.
+ */
+template <class T>
+class MultiChannelIirFilter {
+ protected:
+    /**
+     * \brief order() rows of filter state followed by one row of input, each numChannels() long.
+     */
+    std::vector<char> savedData;
+
+    unsigned channels;
+
+    template <class U>
+    U *state();
+
+ public:
+    std::vector<T> numerator;
+    std::vector<T> denominator;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param num The numerator coefficients.
+     * \param den The denominator coefficients.  den[0] must not be 0.
+     * \param numChannels Number of channels.
+     */
+    template <typename U>
+    MultiChannelIirFilter<T>(const std::vector<U> & num, const std::vector<U> & den, unsigned numChannels)
+            {assert(num.size() > 0 && den.size() > 0);
+            setCoefficients(VECTOR_TO_ARRAY(num), num.size(), VECTOR_TO_ARRAY(den), den.size(), numChannels);}
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param num Array of numerator coefficients.
+     * \param numLen Number of elements in "num".
+     * \param den Array of denominator coefficients.  den[0] must not be 0.
+     * \param denLen Number of elements in "den".
+     * \param numChannels Number of channels.
+     */
+    template <typename U>
+    MultiChannelIirFilter<T>(const U *num, unsigned numLen, const U *den, unsigned denLen, unsigned numChannels)
+            {setCoefficients(num, numLen, den, denLen, numChannels);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Replaces the coefficients and the number of channels and clears the filter state.
+     */
+    template <typename U>
+    void setCoefficients(const U *num, unsigned numLen, const U *den, unsigned denLen, unsigned numChannels);
+
+    /**
+     * \brief Clears the filter state of every channel.
+     */
+    void reset() {std::fill(savedData.begin(), savedData.end(), 0);}
+
+    unsigned numChannels() const {return channels;}
+
+    /**
+     * \brief Returns the filter order, i.e. the number of delays per channel.
+     */
+    unsigned order() const {return numerator.size() - 1;}
+
+    /**
+     * \brief Filters interleaved data in place, continuing from the previous call.
+     *
+     * \param data Interleaved samples.  Its size must be a multiple of \ref numChannels.
+     * \return Reference to "data".
+     */
+    template <class U>
+    Vector<U> & filter(Vector<U> & data);
+
+    /**
+     * \brief Filters separate channel buffers in place, continuing from the previous call.
+     *
+     * \param data One buffer per channel.  They must all be the same size.
+     * \return Reference to "data".
+     */
+    template <class U>
+    std::vector< RealVector<U> > & filter(std::vector< RealVector<U> > & data);
+
+    template <class U>
+    std::vector< ComplexVector<U> > & filter(std::vector< ComplexVector<U> > & data);
+};
+
+
+template <class T>
+template <typename U>
+void MultiChannelIirFilter<T>::setCoefficients(const U *num, unsigned numLen, const U *den, unsigned denLen,
+                                               unsigned numChannels) {
+    assert(numLen > 0 && denLen > 0 && numChannels > 0);
+    assert(den[0] != U(0));
+    unsigned len = std::max(numLen, denLen);
+    T a0 = (T) den[0];
+
+    numerator.assign(len, T(0));
+    denominator.assign(len, T(0));
+    for (unsigned i=0; i<numLen; i++) {
+        numerator[i] = (T) num[i] / a0;
+    }
+    for (unsigned i=0; i<denLen; i++) {
+        denominator[i] = (T) den[i] / a0;
+    }
+    channels = numChannels;
+    savedData.clear();
+}
+
+template <class T>
+template <class U>
+U *MultiChannelIirFilter<T>::state() {
+    unsigned numBytes = (order() + 1) * channels * sizeof(U);
+    if (savedData.size() != numBytes) {
+        savedData.assign(numBytes, 0);
+    }
+    return (U *) savedData.data();
+}
+
+template <class T>
+template <class U>
+Vector<U> & MultiChannelIirFilter<T>::filter(Vector<U> & data) {
+    assert(data.size() % channels == 0);
+    unsigned numFrames = data.size() / channels;
+    unsigned filtOrder = order();
+    U *z = state<U>();
+    U *in = z + filtOrder * channels;
+    T b0 = numerator[0];
+
+    for (unsigned n=0; n<numFrames; n++) {
+        U *out = VECTOR_TO_ARRAY(data.vec) + n * channels;
+
+        if (filtOrder == 0) {
+            for (unsigned c=0; c<channels; c++) {
+                out[c] = b0 * out[c];
+            }
+            continue;
+        }
+
+        for (unsigned c=0; c<channels; c++) {
+            in[c] = out[c];
+            out[c] = b0 * in[c] + z[c];
+        }
+        for (unsigned k=0; k<filtOrder-1; k++) {
+            T b = numerator[k + 1];
+            T a = denominator[k + 1];
+            U *zk = z + k * channels;
+            const U *zNext = zk + channels;
+            for (unsigned c=0; c<channels; c++) {
+                zk[c] = b * in[c] - a * out[c] + zNext[c];
+            }
+        }
+        T b = numerator[filtOrder];
+        T a = denominator[filtOrder];
+        U *zLast = z + (filtOrder - 1) * channels;
+        for (unsigned c=0; c<channels; c++) {
+            zLast[c] = b * in[c] - a * out[c];
+        }
+    }
+    return data;
+}
+
+template <class T>
+template <class U>
+std::vector< RealVector<U> > & MultiChannelIirFilter<T>::filter(std::vector< RealVector<U> > & data) {
+    assert(data.size() == channels);
+    RealVector<U> interleaved;
+    filter(interleaveChannels(data, interleaved));
+    return deinterleaveChannels(interleaved, data);
+}
+
+template <class T>
+template <class U>
+std::vector< ComplexVector<U> > & MultiChannelIirFilter<T>::filter(std::vector< ComplexVector<U> > & data) {
+    assert(data.size() == channels);
+    ComplexVector<U> interleaved;
+    filter(interleaveChannels(data, interleaved));
+    return deinterleaveChannels(interleaved, data);
+}
+
+/**
+ * \brief Filters interleaved "data" in place with "filt", continuing from the previous call.
+ *
+ * \param data Interleaved samples.  Its size must be a multiple of filt.numChannels().
+ * \param filt The filter.  Holds the coefficients and every channel's state.
+ * \return Reference to "data".
+ */
+template <class T, class U>
+inline Vector<U> & filter(Vector<U> & data, MultiChannelIirFilter<T> & filt) {
+    return filt.filter(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,457 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file MultiStageDecimator.h
+ *
+ * Definition of the template class MultiStageDecimator and the multi-stage decimation planner.
+ */
+
+#ifndef NimbleDSP_MultiStageDecimator_h
+#define NimbleDSP_MultiStageDecimator_h
+
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdint.h>
+#include "RealFirFilter.h"
+#include "CicFilter.h"
+#include "HalfBandFilter.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Most taps that the planner gives a half-band or FIR stage, since \ref RealFirFilter::firpm
+ *      stops converging reliably beyond that.
+ */
+const int MAX_DECIMATION_STAGE_TAPS = 255;
+
+/**
+ * \brief One stage of a DecimationPlan.
+ */
+struct DecimationStage {
+    DecimationStageType type;
+    
+    /**
+     * \brief How much the stage decimates by.  Always 2 for a half-band stage.
+     */
+    int rate;
+    
+    /**
+     * \brief Number of taps of a half-band or FIR stage.  0 for a CIC stage.
+     */
+    int numTaps;
+    
+    /**
+     * \brief Number of integrator and comb stages of a CIC stage.  0 for the others.
+     */
+    int numCicStages;
+    
+    /**
+     * \brief Edges of the passband and stopband, normalized so that 1.0 is the Nyquist frequency
+     *      of the stage's input.  A CIC stage has no stopband edge, so it is 0.
+     */
+    double passbandEdge;
+    double stopbandEdge;
+};
+
+/**
+ * \brief A chain of decimation stages, as produced by \ref planDecimation.
+ */
+struct DecimationPlan {
+    std::vector<DecimationStage> stages;
+    
+    /**
+     * \brief Estimated number of multiplies, plus additions for CIC stages, per input sample.
+     */
+    double cost;
+    
+    /**
+     * \brief Returns the total decimation rate.
+     */
+    int rate() const {int total = 1;
+                      for (unsigned s=0; s<stages.size(); s++) total *= stages[s].rate;
+                      return total;}
+};
+
+/**
+ * \brief Estimates the number of taps an equiripple lowpass filter needs.  Kaiser's formula.
+ *
+ * \param attenuation Stopband attenuation in dB.  The passband ripple is assumed to be the same.
+ * \param transitionWidth Width of the transition band in cycles per sample.
+ */
+inline int estimateFirTaps(double attenuation, double transitionWidth) {
+    return (int) std::ceil((attenuation - 7.95) / (14.36 * transitionWidth)) + 1;
+}
+
+/**
+ * \brief Returns the smallest attenuation, in dB, of the filter "taps" from "stopbandEdge" (where
+ *      1.0 is the Nyquist frequency) to the Nyquist frequency.
+ */
+inline double firStopbandAttenuation(const std::vector<double> & taps, double stopbandEdge) {
+    double peak = 0;
+    int gridLen = 8 * taps.size();
+    for (int g=0; g<=gridLen; g++) {
+        double omega = M_PI * (stopbandEdge + (1 - stopbandEdge) * g / gridLen);
+        std::complex<double> response = 0;
+        for (unsigned i=0; i<taps.size(); i++) {
+            response += taps[i] * std::polar(1.0, -omega * i);
+        }
+        peak = std::max(peak, std::abs(response));
+    }
+    return -20 * std::log10(peak);
+}
+
+/**
+ * \brief Adds a half-band or FIR stage, decimating by "rate", to "plan" if it is practical.
+ *
+ * \param inputRate The stage's input sample rate, as a fraction of the plan's input rate.
+ * \param band Edge of the band of interest, in cycles per sample of the plan's input.
+ * \return False if the stage can't meet the requirements.
+ */
+inline bool addDecimationStage(DecimationPlan & plan, DecimationStageType type, int rate, double inputRate,
+                               double band, double attenuation) {
+    // The stopband starts where the first alias of the band edge lands, so only what was in the
+    // transition band aliases, and it aliases into the transition band.
+    DecimationStage stage;
+    stage.type = type;
+    stage.rate = rate;
+    stage.numCicStages = 0;
+    stage.passbandEdge = 2 * band / inputRate;
+    stage.stopbandEdge = 2.0 / rate - stage.passbandEdge;
+    if (stage.stopbandEdge <= stage.passbandEdge) {
+        return false;
+    }
+    stage.numTaps = estimateFirTaps(attenuation, (stage.stopbandEdge - stage.passbandEdge) / 2);
+    
+    double multiplies;
+    if (type == HALF_BAND_STAGE) {
+        // Round up to 3 more than a multiple of 4, and widen the passband to use up the extra taps.
+        // The early stages' passbands are so narrow that firpm has trouble with them otherwise.
+        stage.numTaps = 4 * (std::max(stage.numTaps, 7) / 4) + 3;
+        stage.passbandEdge = std::max(stage.passbandEdge, 0.5 - (attenuation - 7.95) / (14.36 * (stage.numTaps - 1)));
+        stage.stopbandEdge = 1 - stage.passbandEdge;
+        int nonZero = (stage.numTaps + 1) / 2;
+        multiplies = (nonZero >= FOLD_MIN_TAPS ? (nonZero + 1) / 2 : nonZero) + 1;
+    }
+    else {
+        stage.numTaps |= 1;
+        multiplies = stage.numTaps >= FOLD_MIN_TAPS ? (stage.numTaps + 1) / 2 : stage.numTaps;
+    }
+    if (stage.numTaps > MAX_DECIMATION_STAGE_TAPS) {
+        return false;
+    }
+    plan.stages.push_back(stage);
+    plan.cost += multiplies * inputRate / rate;
+    return true;
+}
+
+/**
+ * \brief Picks the number of CIC stages for decimating by "rate" ahead of the rest of a plan.
+ *
+ * \return False if no number of stages attenuates the aliases enough without too much droop, or
+ *      without growing beyond the precision of a CicDecimator<T, int64_t>.
+ */
+inline bool planCicStage(DecimationStage & stage, int rate, double band, double attenuation, double maxDroop) {
+    // In CIC output Nyquist units, the band edge and its first alias.
+    double edge = 2 * band * rate;
+    for (int numStages=1; numStages<=6; numStages++) {
+        int growth = (int) std::ceil(numStages * std::log2((double) rate) - 1e-9);
+        double droop = -20 * std::log10(cicMagnitude(edge, numStages, rate, 1));
+        if (64 - 2 - growth < 24 || droop > maxDroop) {
+            return false;
+        }
+        if (-20 * std::log10(cicMagnitude(2 - edge, numStages, rate, 1)) >= attenuation) {
+            stage.type = CIC_STAGE;
+            stage.rate = rate;
+            stage.numTaps = 0;
+            stage.numCicStages = numStages;
+            stage.passbandEdge = edge;
+            stage.stopbandEdge = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief Plans a chain of decimation stages for a large decimation rate.
+ *
+ * Every factorization of "rate" into an optional CIC stage, some half-band stages and a final FIR
+ * stage that decimates by at least 2 is tried, and the one with the smallest \ref DecimationPlan::cost
+ * is kept.  The early stages only have to keep their aliases out of the band of interest, so
+ * their transition bands are wide and their filters short.  The final FIR stage does the sharp
+ * cut off at the output rate.
+ *
+ * The CIC stage isn't compensated, so it is only used when its droop at the passband edge is no
+ * more than "maxCicDroop".  For a flat response use allowCic = false, or design a compensated
+ * chain by hand with CicDecimator::compensationFilter.
+ *
+ * \param plan Set to the plan.
+ * \param rate Total decimation rate.  Must be at least 2.
+ * \param passbandEdge Edge of the passband, normalized so that 1.0 is the Nyquist frequency of
+ *      the output.  Frequencies between there and the output's Nyquist frequency may alias.
+ * \param attenuation Smallest attenuation, in dB, of anything that aliases into the passband.
+ * \param allowCic Whether the first stage may be a CIC filter.  Defaults to true.
+ * \param maxCicDroop Most droop, in dB, that a CIC stage may cause at the passband edge.
+ * \return False if there is no practical plan.
+ */
+inline bool planDecimation(DecimationPlan & plan, int rate, double passbandEdge, double attenuation,
+                           bool allowCic = true, double maxCicDroop = 0.1) {
+    assert(rate >= 2);
+    assert(passbandEdge > 0 && passbandEdge < 1 && attenuation > 0);
+    
+    // Edge of the band of interest in cycles per input sample.
+    double band = passbandEdge / (2.0 * rate);
+    bool found = false;
+    for (int cicRate=1; cicRate<=rate/2; cicRate++) {
+        if (rate % cicRate || (cicRate > 1 && !allowCic)) {
+            continue;
+        }
+        DecimationPlan front;
+        front.cost = 0;
+        if (cicRate > 1) {
+            DecimationStage cic;
+            if (!planCicStage(cic, cicRate, band, attenuation, maxCicDroop)) {
+                continue;
+            }
+            front.stages.push_back(cic);
+            front.cost = cic.numCicStages * (1 + 1.0 / cicRate);
+        }
+        
+        int remaining = rate / cicRate;
+        for (int numHalfBands=0; remaining % (1 << numHalfBands) == 0 && (remaining >> numHalfBands) >= 2;
+                numHalfBands++) {
+            DecimationPlan candidate = front;
+            double inputRate = 1.0 / cicRate;
+            bool practical = true;
+            for (int h=0; h<numHalfBands && practical; h++, inputRate/=2) {
+                practical = addDecimationStage(candidate, HALF_BAND_STAGE, 2, inputRate, band, attenuation);
+            }
+            practical = practical && addDecimationStage(candidate, FIR_STAGE, remaining >> numHalfBands,
+                                                        inputRate, band, attenuation);
+            if (practical && (!found || candidate.cost < plan.cost)) {
+                plan = candidate;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+
+/**
+ * \brief Number of lengths MultiStageDecimator::design tries for each half-band or FIR stage.
+ */
+const int MAX_STAGE_DESIGN_ATTEMPTS = 8;
+
+/**
+ * \brief Decimator that runs a DecimationPlan: CIC, half-band and FIR stages one after another.
+ *
+ * Decimating by hundreds with a single RealFirFilter takes a filter with thousands of taps.  The
+ * same response can be had for a small fraction of the work by decimating in stages, with a cheap
+ * filter at the high rates and the expensive one at the lowest rate.  \ref design plans the
+ * stages with \ref planDecimation and designs their filters.  Since the planner's tap counts are
+ * estimates, each filter is lengthened until it meets the attenuation.
+ *
+ * T must be a floating point type.  The CIC stage, if there is one, quantizes the samples as
+ * CicDecimator describes, using \ref fullScale.
+ */
+template <class T>
+class MultiStageDecimator {
+ protected:
+    DecimationPlan stagePlan;
+    std::vector< CicDecimator<T> > cicStages;
+    std::vector< HalfBandDecimator<T> > halfBandStages;
+    std::vector< RealFirFilter<T> > firStages;
+    
+ public:
+    /**
+     * \brief Largest magnitude of the samples.  Only used by a CIC stage.  Defaults to 1.
+     */
+    double fullScale;
+    
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.  Doesn't decimate until \ref design is called.
+     */
+    MultiStageDecimator<T>() : fullScale(1) {stagePlan.cost = 0;}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Plans the stages with \ref planDecimation and designs them.  See planDecimation for
+     *      the parameters.
+     *
+     * \return False if there is no practical plan, or a stage's filter design didn't converge or
+     *      fell short of "attenuation" however long it was made.
+     */
+    bool design(int rate, double passbandEdge, double attenuation, bool allowCic = true,
+                double maxCicDroop = 0.1);
+    
+    /**
+     * \brief Designs the stages of "plan".  The stages run in the order they are in.
+     *
+     * \param plan The stages.  Half-band and FIR stages are lengthened, up to
+     *      NimbleDSP::MAX_STAGE_DESIGN_ATTEMPTS - 1 times, if they fall short of "attenuation" in
+     *      their stopbands.
+     * \param attenuation Attenuation, in dB, the half-band and FIR stages should have.
+     * \return False if a stage's filter design didn't converge or still fell short of
+     *      "attenuation" at its longest.  The stages are designed and usable either way, and
+     *      \ref plan has the tap counts that were used.
+     */
+    bool design(const DecimationPlan & plan, double attenuation);
+    
+    /**
+     * \brief Returns the stages, with the number of taps that were actually designed.
+     */
+    const DecimationPlan & plan() const {return stagePlan;}
+    
+    /**
+     * \brief Returns the total decimation rate.
+     */
+    int rate() const {return stagePlan.rate();}
+    
+    /**
+     * \brief Clears the streaming state of all of the stages.
+     */
+    void reset();
+    
+    /**
+     * \brief Decimates "data" in place, continuing from the previous call.
+     *
+     * \param data Buffer to decimate.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    RealVector<T> & decimate(RealVector<T> & data);
+};
+
+
+template <class T>
+bool MultiStageDecimator<T>::design(int rate, double passbandEdge, double attenuation, bool allowCic,
+                                    double maxCicDroop) {
+    DecimationPlan newPlan;
+    if (!planDecimation(newPlan, rate, passbandEdge, attenuation, allowCic, maxCicDroop)) {
+        return false;
+    }
+    return design(newPlan, attenuation);
+}
+
+template <class T>
+bool MultiStageDecimator<T>::design(const DecimationPlan & plan, double attenuation) {
+    stagePlan = plan;
+    cicStages.clear();
+    halfBandStages.clear();
+    firStages.clear();
+    
+    bool converged = true;
+    for (unsigned s=0; s<stagePlan.stages.size(); s++) {
+        DecimationStage & stage = stagePlan.stages[s];
+        if (stage.type == CIC_STAGE) {
+            cicStages.push_back(CicDecimator<T>(stage.rate, stage.numCicStages));
+            continue;
+        }
+        
+        RealFirFilter<double> designer;
+        bool metSpec = false;
+        int lengthStep = (stage.type == HALF_BAND_STAGE) ? 4 : 2;
+        for (int attempt=0; ; attempt++) {
+            bool stageConverged;
+            if (stage.type == HALF_BAND_STAGE) {
+                stageConverged = designer.halfBandFilter(stage.numTaps, stage.passbandEdge);
+            }
+            else {
+                double freqPoints[] = {0, stage.passbandEdge, stage.stopbandEdge, 1};
+                double desired[] = {1, 0};
+                double weight[] = {1, 1};
+                stageConverged = designer.firpm(stage.numTaps - 1, 2, freqPoints, desired, weight);
+            }
+            metSpec = stageConverged && firStopbandAttenuation(designer.vec, stage.stopbandEdge) >= attenuation;
+            if (metSpec || attempt == MAX_STAGE_DESIGN_ATTEMPTS - 1) {
+                break;
+            }
+            stage.numTaps += lengthStep;
+        }
+        converged = converged && metSpec;
+        if (stage.type == HALF_BAND_STAGE) {
+            halfBandStages.push_back(HalfBandDecimator<T>(designer.vec));
+        }
+        else {
+            firStages.push_back(RealFirFilter<T>(designer.vec));
+        }
+    }
+    return converged;
+}
+
+template <class T>
+void MultiStageDecimator<T>::reset() {
+    for (unsigned i=0; i<cicStages.size(); i++) {
+        cicStages[i].reset();
+    }
+    for (unsigned i=0; i<halfBandStages.size(); i++) {
+        halfBandStages[i].reset();
+    }
+    for (unsigned i=0; i<firStages.size(); i++) {
+        firStages[i].reset();
+    }
+}
+
+template <class T>
+RealVector<T> & MultiStageDecimator<T>::decimate(RealVector<T> & data) {
+    unsigned cic = 0, halfBand = 0, fir = 0;
+    for (unsigned s=0; s<stagePlan.stages.size(); s++) {
+        switch (stagePlan.stages[s].type) {
+            case CIC_STAGE:
+                cicStages[cic].fullScale = fullScale;
+                cicStages[cic++].decimate(data);
+                break;
+            case HALF_BAND_STAGE:
+                halfBandStages[halfBand++].decimate(data);
+                break;
+            case FIR_STAGE:
+                firStages[fir++].decimate(data, stagePlan.stages[s].rate);
+                break;
+        }
+    }
+    return data;
+}
+
+/**
+ * \brief Decimates "data" in place with "decimator", continuing from the previous call.
+ *
+ * \param data Buffer to decimate.
+ * \param decimator The decimator.  Holds the stages and their streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline RealVector<T> & decimate(RealVector<T> & data, MultiStageDecimator<T> & decimator) {
+    return decimator.decimate(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,344 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+/**
+ * @file Nco.h
+ *
+ * Definition of the template class Nco.
+ */
+
+#ifndef NimbleDSP_Nco_h
+#define NimbleDSP_Nco_h
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdint.h>
+#include "ComplexVector.h"
+#include "VectorView.h"
+#include "SplitComplexVector.h"
+#include "RealFirFilter.h"
+
+
+namespace NimbleDSP {
+
+template <class T> class RealFirFilter;
+
+/**
+ * \brief log2 of the number of entries in the \ref Nco sine table.
+ */
+const int NCO_TABLE_BITS = 10;
+
+/**
+ * \brief Numerically controlled oscillator and mixer.
+ *
+ * ComplexVector::tone and ComplexVector::modulate call std::cos and std::sin for every sample and
+ * accumulate the phase in T, which is slow and, for float, drifts over long streams.  The NCO
+ * keeps its phase in a 64 bit fixed point accumulator instead: one full cycle is 2^64, so the
+ * phase wraps exactly and a frequency is resolved to sampleFreq / 2^64 no matter how long it runs.
+ *
+ * Each sample is looked up in a 2^NCO_TABLE_BITS entry table of e^(j*2*pi*k/N) at the nearest
+ * entry, and the left over angle b (at most pi/N) is applied by multiplying by a short Taylor
+ * series for e^(j*b).  That is accurate to about 1e-14 with no transcendental calls.  The table
+ * is shared by every Nco of a given T.
+ *
+ * The phase carries over from call to call, so a stream can be mixed a block at a time.
+ * \ref modulateDecimate also folds the mixing into a RealFirFilter's decimation, so the data is
+ * only read once.
+ */
+template <class T>
+class Nco {
+ protected:
+    /**
+     * \brief Phase of the next sample.  2^64 is a full cycle.
+     */
+    uint64_t phaseAccumulator;
+    
+    /**
+     * \brief Amount the phase advances each sample.
+     */
+    uint64_t phaseIncrement;
+    
+    /**
+     * \brief Points at \ref sineTable, so the per sample lookups skip the static initialization
+     *      check.
+     */
+    const std::complex<T> *table;
+    
+    /**
+     * \brief Returns the shared table of e^(j*2*pi*k/2^NCO_TABLE_BITS).
+     */
+    static const std::vector< std::complex<T> > & sineTable();
+    
+    /**
+     * \brief Returns e^(j*phase), with "phase" in accumulator units.
+     */
+    std::complex<T> lookup(uint64_t phase) const;
+    
+    /**
+     * \brief Builds the table returned by \ref sineTable.
+     */
+    static std::vector< std::complex<T> > buildSineTable();
+    
+    /**
+     * \brief Converts a phase or frequency in cycles (cycles per sample) to accumulator units.
+     */
+    static uint64_t toAccumulator(double cycles);
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param freq The oscillator frequency.  May be negative.
+     * \param sampleFreq The sample frequency.  Defaults to 1 Hz.
+     * \param phase The starting phase, in radians.  Defaults to 0.
+     */
+    Nco<T>(T freq = 0.0, T sampleFreq = 1.0, T phase = 0.0) : table(VECTOR_TO_ARRAY(sineTable()))
+            {setFrequency(freq, sampleFreq); setPhase(phase);}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Changes the frequency without disturbing the phase.
+     *
+     * \param freq The oscillator frequency.  May be negative.
+     * \param sampleFreq The sample frequency.  Defaults to 1 Hz.
+     */
+    void setFrequency(T freq, T sampleFreq = 1.0)
+            {assert(sampleFreq > 0.0); phaseIncrement = toAccumulator(((double) freq) / sampleFreq);}
+    
+    /**
+     * \brief Returns the frequency, in the range [0, sampleFreq).
+     */
+    T getFrequency(T sampleFreq = 1.0) const {return (T) (phaseIncrement * (sampleFreq / 18446744073709551616.0));}
+    
+    /**
+     * \brief Sets the phase of the next sample, in radians.
+     */
+    void setPhase(T phase) {phaseAccumulator = toAccumulator(phase / (2 * M_PI));}
+    
+    /**
+     * \brief Returns the phase of the next sample, in radians in the range [0, 2*pi).
+     */
+    T getPhase() const {return (T) (phaseAccumulator * (2 * M_PI / 18446744073709551616.0));}
+    
+    /**
+     * \brief Returns the next sample of the oscillator and advances the phase.
+     */
+    std::complex<T> next() {
+        std::complex<T> sample = lookup(phaseAccumulator);
+        phaseAccumulator += phaseIncrement;
+        return sample;
+    }
+    
+    /**
+     * \brief Fills "vec" with the oscillator's next samples.
+     *
+     * \param vec The vector to put the tone in.
+     * \param numSamples The number of samples to generate.  "0" indicates to generate
+     *      vec.size() samples.  Defaults to 0.
+     * \return Reference to "vec".
+     */
+    ComplexVector<T> & tone(ComplexVector<T> & vec, unsigned numSamples = 0);
+    
+    /**
+     * \brief Multiplies "data" by the oscillator's next samples.
+     *
+     * \return Reference to "data".
+     */
+    ComplexVector<T> & modulate(ComplexVector<T> & data);
+    
+    /**
+     * \brief Multiplies the viewed samples by the oscillator's next samples, in place.
+     *
+     * \return "data".
+     */
+    VectorView< std::complex<T> > modulate(VectorView< std::complex<T> > data);
+    
+    /**
+     * \brief Multiplies split complex "data" by the oscillator's next samples.
+     *
+     * \return Reference to "data".
+     */
+    SplitComplexVector<T> & modulate(SplitComplexVector<T> & data);
+    
+    /**
+     * \brief Mixes "data" with the oscillator and decimates it with "filter" in one pass.
+     *
+     * The result is the same as modulate(data) followed by filter.decimateComplex(data, rate), in
+     * any of the filter's operating modes, but the mixing is done as the samples are copied into
+     * the filter's working buffer rather than as a separate pass over the data.
+     *
+     * \param data The buffer to mix and decimate.
+     * \param rate The decimation rate.
+     * \param filter The decimation filter.
+     * \return Reference to "data", which holds the result of the decimation.
+     */
+    ComplexVector<T> & modulateDecimate(ComplexVector<T> & data, int rate, RealFirFilter<T> & filter);
+};
+
+
+template <class T>
+std::vector< std::complex<T> > Nco<T>::buildSineTable() {
+    const int tableLen = 1 << NCO_TABLE_BITS;
+    std::vector< std::complex<T> > table(tableLen);
+    for (int i=0; i<tableLen; i++) {
+        double angle = 2 * M_PI * i / tableLen;
+        table[i] = std::complex<T>((T) std::cos(angle), (T) std::sin(angle));
+    }
+    return table;
+}
+
+template <class T>
+const std::vector< std::complex<T> > & Nco<T>::sineTable() {
+    static const std::vector< std::complex<T> > table = buildSineTable();
+    return table;
+}
+
+template <class T>
+uint64_t Nco<T>::toAccumulator(double cycles) {
+    cycles -= std::floor(cycles);
+    // A tiny negative "cycles" rounds up to exactly 1 above, which is a whole cycle, i.e. 0.
+    if (cycles >= 1.0) {
+        cycles = 0.0;
+    }
+    // cycles is now in [0, 1), so the product is exactly representable below 2^64.
+    return (uint64_t) (cycles * 18446744073709551616.0);
+}
+
+template <class T>
+inline std::complex<T> Nco<T>::lookup(uint64_t phase) const {
+    const int fineBits = 64 - NCO_TABLE_BITS;
+    // Round to the nearest table entry so that the left over angle is as small as possible.
+    uint64_t index = (phase + ((uint64_t) 1 << (fineBits - 1))) >> fineBits;
+    int64_t fine = (int64_t) (phase - (index << fineBits));
+    T angle = (T) (fine * (2 * M_PI / 18446744073709551616.0));
+    T angleSquared = angle * angle;
+    std::complex<T> rotation((T) 1 - angleSquared * ((T) 0.5 - angleSquared * (T) (1.0 / 24)),
+                             angle * ((T) 1 - angleSquared * (T) (1.0 / 6)));
+    return table[index & ((1 << NCO_TABLE_BITS) - 1)] * rotation;
+}
+
+template <class T>
+ComplexVector<T> & Nco<T>::tone(ComplexVector<T> & vec, unsigned numSamples) {
+    if (numSamples && numSamples != vec.size()) {
+        vec.vec.resize(numSamples);
+    }
+    for (unsigned i=0; i<vec.size(); i++) {
+        vec[i] = next();
+    }
+    return vec;
+}
+
+template <class T>
+ComplexVector<T> & Nco<T>::modulate(ComplexVector<T> & data) {
+    for (unsigned i=0; i<data.size(); i++) {
+        data[i] *= next();
+    }
+    return data;
+}
+
+template <class T>
+VectorView< std::complex<T> > Nco<T>::modulate(VectorView< std::complex<T> > data) {
+    for (unsigned i=0; i<data.size(); i++) {
+        data[i] *= next();
+    }
+    return data;
+}
+
+template <class T>
+SplitComplexVector<T> & Nco<T>::modulate(SplitComplexVector<T> & data) {
+    T *r = VECTOR_TO_ARRAY(data.re), *i = VECTOR_TO_ARRAY(data.im);
+    for (unsigned n=0; n<data.size(); n++) {
+        std::complex<T> c = next();
+        T real = r[n] * c.real() - i[n] * c.imag();
+        i[n] = r[n] * c.imag() + i[n] * c.real();
+        r[n] = real;
+    }
+    return data;
+}
+
+template <class T>
+ComplexVector<T> & Nco<T>::modulateDecimate(ComplexVector<T> & data, int rate, RealFirFilter<T> & filter) {
+    struct MixLoad {
+        Nco<T> & nco;
+        MixLoad(Nco<T> & oscillator) : nco(oscillator) {}
+        std::complex<T> operator()(const std::complex<T> & sample) {return sample * nco.next();}
+    };
+    MixLoad load(*this);
+    return filter.decimateComplexLoaded(data, rate, load);
+}
+
+/**
+ * \brief Fills "vec" with the next samples from "nco".
+ *
+ * \param vec The vector to put the tone in.
+ * \param nco The oscillator.
+ * \param numSamples The number of samples to generate.  "0" indicates to generate
+ *      vec.size() samples.  Defaults to 0.
+ * \return Reference to "vec".
+ */
+template <class T>
+inline ComplexVector<T> & tone(ComplexVector<T> & vec, Nco<T> & nco, unsigned numSamples = 0) {
+    return nco.tone(vec, numSamples);
+}
+
+/**
+ * \brief Multiplies "data" by the next samples from "nco".
+ *
+ * \return Reference to "data".
+ */
+template <class T>
+inline ComplexVector<T> & modulate(ComplexVector<T> & data, Nco<T> & nco) {
+    return nco.modulate(data);
+}
+
+/**
+ * \brief Multiplies split complex "data" by the next samples from "nco".
+ *
+ * \return Reference to "data".
+ */
+template <class T>
+inline SplitComplexVector<T> & modulate(SplitComplexVector<T> & data, Nco<T> & nco) {
+    return nco.modulate(data);
+}
+
+/**
+ * \brief Mixes "data" with "nco" and decimates it with "filter" in one pass.  See
+ *      Nco::modulateDecimate.
+ */
+template <class T>
+inline ComplexVector<T> & modulateDecimate(ComplexVector<T> & data, int rate, Nco<T> & nco,
+            RealFirFilter<T> & filter) {
+    return nco.modulateDecimate(data, rate, filter);
+}
+
+};
+
+#endif
@@ -12,6 +12,15 @@
 namespace NimbleDSP {
 
 enum FilterOperationType {STREAMING, ONE_SHOT_RETURN_ALL_RESULTS, ONE_SHOT_TRIM_TAILS};
+enum ConvolutionAlgorithmType {DIRECT_CONVOLUTION, FFT_CONVOLUTION, AUTO_CONVOLUTION};
+enum FileAccessType {MEMORY_MAPPED_FILE, BUFFERED_FILE};
+enum MathAccuracyType {EXACT_MATH, FAST_MATH};
+enum FixedPtRoundingType {ROUND_DOWN, ROUND_HALF_UP, ROUND_HALF_EVEN};
+enum WindowType {RECTANGULAR_WINDOW, HANN_WINDOW, HAMMING_WINDOW, BLACKMAN_WINDOW};
+enum SpectralAveragingType {LINEAR_AVERAGING, EXPONENTIAL_AVERAGING, PEAK_HOLD};
+enum TapSymmetryType {DETECT_SYMMETRY, NO_SYMMETRY, SYMMETRIC_TAPS, ANTISYMMETRIC_TAPS};
+enum DecimationStageType {CIC_STAGE, HALF_BAND_STAGE, FIR_STAGE};
+enum IirAlgorithmType {SERIAL_IIR, BLOCK_IIR, AUTO_IIR};
 typedef enum ParksMcClellanFilterType {PASSBAND_FILTER = 1, DIFFERENTIATOR_FILTER, HILBERT_FILTER} ParksMcClellanFilterType;
 
 };
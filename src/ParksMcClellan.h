@@ -44,18 +44,29 @@ which is part of Embarcadero's C++ Builder vcl.
 #include <math.h>
 #define M_2PI  6.28318530717958647692
 
-static int NFCNS, NGRID;
-static double DEV;
-static double *FX, *WTX;
-static bool converged;
+/*
+The Fortran common block (the globals in the original port) is now the state of a
+ParksMcClellanDesign object, so each design has its own copy and firpm can run on any number of
+threads at once.
+*/
+class ParksMcClellanDesign
+{
+ public:
+  bool Design(double *FirCoeff, int NFILT, int JTYPE, int NBANDS, double *EDGE, double *fx, double *wtx, int LGRID);
+
+ private:
+  int NFCNS, NGRID;
+  double DEV;
+  double *FX, *WTX;
+  bool converged;
 
+  double EFF(double FREQ, int LBAND, int JTYPE);
+  double WATE(double FREQ, int LBAND, int JTYPE);
+  void Remez(std::vector<int> &IEXT, std::vector<double> &AD, std::vector<double> &ALPHA, std::vector<double> &X, std::vector<double> &Y, std::vector<double> &H, std::vector<double> &DES, std::vector<double> &GRID, std::vector<double> &WT, std::vector<double> &A, std::vector<double> &P, std::vector<double> &Q);
+};
 
-static bool ParksMcClellan2(double *FirCoeff, int NFILT, int JTYPE, int NBANDS, double *EDGE, double *FX, double *WTX, int LGRID = 16);
-static double  EFF(double FREQ, int LBAND, int JTYPE);
-static double WATE(double FREQ, int LBAND, int JTYPE);
-static double D(std::vector<double> &X, int K, int N, int M);
-static double GEE(std::vector<double> &X, std::vector<double> &GRID, std::vector<double> &AD, std::vector<double> &Y, int K, int N);
-static void Remez(std::vector<int> &IEXT, std::vector<double> &AD, std::vector<double> &ALPHA, std::vector<double> &X, std::vector<double> &Y, std::vector<double> &H, std::vector<double> &DES, std::vector<double> &GRID, std::vector<double> &WT, std::vector<double> &A, std::vector<double> &P, std::vector<double> &Q);
+inline double D(std::vector<double> &X, int K, int N, int M);
+inline double GEE(std::vector<double> &X, std::vector<double> &GRID, std::vector<double> &AD, std::vector<double> &Y, int K, int N);
 
 
 /* Input Values
@@ -69,7 +80,13 @@ static void Remez(std::vector<int> &IEXT, std::vector<double> &AD, std::vector<d
 */
 //---------------------------------------------------------------------------
 
-bool ParksMcClellan2(double *FirCoeff, int NFILT, int JTYPE, int NBANDS, double *EDGE, double *fx, double *wtx, int LGRID)
+inline bool ParksMcClellan2(double *FirCoeff, int NFILT, int JTYPE, int NBANDS, double *EDGE, double *fx, double *wtx, int LGRID = 16)
+{
+ ParksMcClellanDesign design;
+ return design.Design(FirCoeff, NFILT, JTYPE, NBANDS, EDGE, fx, wtx, LGRID);
+}
+
+inline bool ParksMcClellanDesign::Design(double *FirCoeff, int NFILT, int JTYPE, int NBANDS, double *EDGE, double *fx, double *wtx, int LGRID)
 {
  int J=0, L=0, NEG=0, NODD=0, LBAND=0;
  int NM1=0, NZ=0;
@@ -242,7 +259,7 @@ VALUE OF NORMALIZED FREQUENCY NEEDED FOR EVALUATION.
 */
 
 
-double EFF(double FREQ, int LBAND, int JTYPE)
+inline double ParksMcClellanDesign::EFF(double FREQ, int LBAND, int JTYPE)
 {
  if(JTYPE == 2)  return( FX[LBAND] * FREQ );
  else return( FX[LBAND] );
@@ -252,7 +269,7 @@ double EFF(double FREQ, int LBAND, int JTYPE)
 //FUNCTION TO CALCULATE THE WEIGHT FUNCTION AS A FUNCTION OF FREQUENCY.  SIMILAR TO THE FUNCTION
 //EFF, THIS FUNCTION CAN BE REPLACED BY A USER-WRITTEN ROUTINE TO CALCULATE ANY DESIRED WEIGHTING FUNCTION.
 
-double WATE(double FREQ, int LBAND, int JTYPE)
+inline double ParksMcClellanDesign::WATE(double FREQ, int LBAND, int JTYPE)
 {
  if(JTYPE == 1 || JTYPE == 3) return(WTX[LBAND]); // JTYPE=1 Bandpass JTYPE=3 for Hilberts
  if(FX[LBAND] < 0.0001) return(WTX[LBAND]);       // JTYPE=2 for Differentiators
@@ -270,7 +287,7 @@ THE EXTREMAL FREQUENCIES (POINTS OF MAXIMUM ERROR) AND THEN CALCULATES THE COEFF
 THE BEST APPROXIMATION.
 */
 
-void Remez(std::vector<int> &IEXT, std::vector<double> &AD, std::vector<double> &ALPHA, std::vector<double> &X, std::vector<double> &Y, std::vector<double> &H, std::vector<double> &DES, std::vector<double> &GRID, std::vector<double> &WT, std::vector<double> &A, std::vector<double> &P, std::vector<double> &Q)
+inline void ParksMcClellanDesign::Remez(std::vector<int> &IEXT, std::vector<double> &AD, std::vector<double> &ALPHA, std::vector<double> &X, std::vector<double> &Y, std::vector<double> &H, std::vector<double> &DES, std::vector<double> &GRID, std::vector<double> &WT, std::vector<double> &A, std::vector<double> &P, std::vector<double> &Q)
 {
  int J=0, ITRMAX=0, NZ=0, NZZ=0, JET=0, K=0, L=0, NU=0, JCHNGE=0, K1=0, KNZ=0, KLOW=0, NUT=0, KUP=0;
  int NUT1=0, LUCK=0, KN=0, NM1=0, KKK=0, JM1=0, JP1=0, NITER=0;
@@ -566,7 +583,7 @@ L545: if(NFCNS <= 3)
 
 //-----------------------------------------------------------------------
 // FUNCTION TO CALCULATE THE LAGRANGE INTERPOLATION COEFFICIENTS FOR USE IN THE FUNCTION GEE.
-double D(std::vector<double> &X, int K, int N, int M)
+inline double D(std::vector<double> &X, int K, int N, int M)
 {
  int J, L;
  double Dee, Q;
@@ -583,7 +600,7 @@ double D(std::vector<double> &X, int K, int N, int M)
 //-----------------------------------------------------------------------
 // FUNCTION TO EVALUATE THE FREQUENCY RESPONSE USING THE LAGRANGE INTERPOLATION FORMULA
 // IN THE BARYCENTRIC FORM
-double GEE(std::vector<double> &X, std::vector<double> &GRID, std::vector<double> &AD, std::vector<double> &Y, int K, int N)
+inline double GEE(std::vector<double> &X, std::vector<double> &GRID, std::vector<double> &AD, std::vector<double> &Y, int K, int N)
 {
  int j;
  double P,C,D,XF;
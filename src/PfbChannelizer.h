@@ -0,0 +1,295 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file PfbChannelizer.h
+ *
+ * Definition of the template class PfbChannelizer.
+ */
+
+#ifndef NimbleDSP_PfbChannelizer_h
+#define NimbleDSP_PfbChannelizer_h
+
+#include <complex>
+#include <vector>
+#include <cassert>
+#include "ComplexVector.h"
+#include "FftPlan.h"
+#include "MultiChannelFilter.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Streaming polyphase filter bank channelizer.
+ *
+ * Splits a complex signal into numChannels() equally spaced channels.  Channel k is centered at
+ * k / numChannels() of the input sample rate (so the upper channels are the negative
+ * frequencies), and its output is the input mixed down by that frequency, filtered with the
+ * prototype low pass filter, and decimated by decimateRate().  Doing that channel by channel
+ * costs a full filter per channel.  Splitting the prototype into numChannels() branches of every
+ * numChannels()'th tap turns the whole bank into one branch filter per channel followed by a
+ * single inverse FFT, so each output frame costs numTaps() multiplies plus one
+ * numChannels()-point FFT.
+ *
+ * With an oversampling factor of 1 the channels are critically sampled (decimated by
+ * numChannels()), which is the cheapest but aliases the edges of neighbouring channels into each
+ * other.  An oversampling factor of 2 decimates by numChannels() / 2, so a prototype whose
+ * transition band extends past the channel edge doesn't alias into the channel.  The branch
+ * outputs are rotated before the FFT to undo the phase that the reduced decimation adds.
+ *
+ * The outputs are the same as ComplexVector::modulate followed by RealFirFilter::decimateComplex
+ * in NimbleDSP::STREAMING mode for each channel, with the mixing phase carried across calls.
+ */
+template <class T>
+class PfbChannelizer {
+ protected:
+    /**
+     * \brief The branch taps.  Row p holds prototype taps p*numChannels() through
+     *      (p + 1)*numChannels() - 1 in reverse order, zero padded past the end of the prototype.
+     */
+    std::vector<T> branchTaps;
+
+    /**
+     * \brief Number of rows in \ref branchTaps, i.e. the number of taps in each branch.
+     */
+    int tapsPerBranch;
+
+    int channels;
+    int decimationRate;
+    int prototypeLen;
+
+    /**
+     * \brief Inverse FFT that combines the branch outputs into the channels.
+     */
+    FftPlan<T> plan;
+
+    /**
+     * \brief The last numChannels()*tapsPerBranch - 1 input samples.
+     */
+    std::vector< std::complex<T> > savedData;
+
+    /**
+     * \brief Index of the newest input sample that the next frame uses, relative to the start of
+     *      the next block of input.
+     */
+    int inputIndex;
+
+    /**
+     * \brief Rotation of the next frame's branch outputs, i.e. (frame * decimateRate()) mod
+     *      numChannels().  Always 0 when critically sampled.
+     */
+    int rotation;
+
+    /**
+     * \brief Working buffers.  The output buffer is swapped with the caller's data, so once the
+     *      buffers have grown to the block size channelizing doesn't allocate.
+     */
+    std::vector< std::complex<T> > workBuf;
+    std::vector< std::complex<T> > outBuf;
+    std::vector< std::complex<T> > branchBuf;
+    std::vector< std::complex<T> > fftBuf;
+
+    template <typename U>
+    void initBranches(const U *taps, unsigned numTaps, int numChannels, int oversampling);
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param taps The prototype low pass filter taps, e.g. the "vec" of a RealFirFilter.  Its
+     *      passband should be about one channel wide, i.e. a cutoff near 1/numChannels of the
+     *      Nyquist rate.
+     * \param numChannels Number of channels.
+     * \param oversampling The output rate of each channel relative to critical sampling.  Must
+     *      divide numChannels.  1 and 2 are the usual choices.
+     */
+    template <typename U>
+    PfbChannelizer<T>(const std::vector<U> & taps, int numChannels, int oversampling = 1)
+            : plan(numChannels, true)
+            {assert(taps.size() > 0); initBranches(VECTOR_TO_ARRAY(taps), taps.size(), numChannels, oversampling);}
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param taps Array of prototype low pass filter taps.
+     * \param numTaps Number of taps in "taps".
+     * \param numChannels Number of channels.
+     * \param oversampling The output rate of each channel relative to critical sampling.  Must
+     *      divide numChannels.
+     */
+    template <typename U>
+    PfbChannelizer<T>(const U *taps, unsigned numTaps, int numChannels, int oversampling = 1)
+            : plan(numChannels, true) {initBranches(taps, numTaps, numChannels, oversampling);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Clears the streaming state, as if no data had been channelized yet.
+     */
+    void reset();
+
+    int numChannels() const {return channels;}
+    int decimateRate() const {return decimationRate;}
+    int numTaps() const {return prototypeLen;}
+
+    /**
+     * \brief Channelizes "data" in place, continuing from the previous call.
+     *
+     * \param data Buffer of input samples.  On return holds the output frames one after another,
+     *      i.e. output n of channel k is at index n * numChannels() + k.  One frame is produced for
+     *      every decimateRate() input samples.
+     * \return Reference to "data".
+     */
+    ComplexVector<T> & channelize(ComplexVector<T> & data);
+
+    /**
+     * \brief Channelizes "data", continuing from the previous call, and splits the results into
+     *      one vector per channel.
+     *
+     * \param data Buffer of input samples.  On return holds the interleaved output frames.
+     * \param channelOut Resized to numChannels() and on return channel k holds that channel's
+     *      outputs.
+     * \return Reference to "channelOut".
+     */
+    std::vector< ComplexVector<T> > & channelize(ComplexVector<T> & data,
+                                                 std::vector< ComplexVector<T> > & channelOut);
+};
+
+
+template <class T>
+template <typename U>
+void PfbChannelizer<T>::initBranches(const U *taps, unsigned numTaps, int numChannels, int oversampling) {
+    assert(numTaps > 0 && numChannels > 0 && oversampling > 0 && numChannels % oversampling == 0);
+    channels = numChannels;
+    decimationRate = numChannels / oversampling;
+    prototypeLen = numTaps;
+    tapsPerBranch = (numTaps + numChannels - 1) / numChannels;
+
+    branchTaps.assign(tapsPerBranch * numChannels, 0);
+    for (int p=0; p<tapsPerBranch; p++) {
+        for (int j=0; j<numChannels; j++) {
+            unsigned tapIndex = p * numChannels + numChannels - 1 - j;
+            if (tapIndex < numTaps) {
+                branchTaps[p * numChannels + j] = (T) taps[tapIndex];
+            }
+        }
+    }
+    savedData.resize(tapsPerBranch * numChannels - 1);
+    branchBuf.resize(numChannels);
+    fftBuf.resize(numChannels);
+    reset();
+}
+
+template <class T>
+void PfbChannelizer<T>::reset() {
+    std::fill(savedData.begin(), savedData.end(), std::complex<T>(0));
+    inputIndex = 0;
+    rotation = 0;
+}
+
+template <class T>
+ComplexVector<T> & PfbChannelizer<T>::channelize(ComplexVector<T> & data) {
+    std::vector< std::complex<T> > *dataTmp;
+
+    if (data.scratchBuf == NULL) {
+        dataTmp = &workBuf;
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    int dataLen = data.size();
+    int numHistory = savedData.size();
+    std::vector< std::complex<T> > & buf = *dataTmp;
+    buf.resize(numHistory + dataLen);
+    std::copy(savedData.begin(), savedData.end(), buf.begin());
+    std::copy(data.vec.begin(), data.vec.end(), buf.begin() + numHistory);
+
+    int numFrames = (inputIndex < dataLen) ? (dataLen - inputIndex + decimationRate - 1) / decimationRate : 0;
+    outBuf.resize(numFrames * channels);
+    std::complex<T> *branches = VECTOR_TO_ARRAY(branchBuf);
+    for (int frame=0; frame<numFrames; frame++) {
+        // Tap i of the prototype lines up with buf[newest - i], so row p of the branch taps lines
+        // up with the numChannels() samples ending at buf[newest - p*numChannels()].  Accumulating
+        // the rows leaves branch r's output in branches[numChannels() - 1 - r].
+        const std::complex<T> *newest = VECTOR_TO_ARRAY(buf) + numHistory + inputIndex;
+        std::fill(branches, branches + channels, std::complex<T>(0));
+        for (int p=0; p<tapsPerBranch; p++) {
+            const std::complex<T> *x = newest - (p + 1) * channels + 1;
+            const T *row = VECTOR_TO_ARRAY(branchTaps) + p * channels;
+            for (int j=0; j<channels; j++) {
+                branches[j] += row[j] * x[j];
+            }
+        }
+
+        // Mixing channel k down puts a phase of -2*pi*k*newest/numChannels() on the frame, which
+        // is the same as rotating the branches by newest mod numChannels() before the FFT.
+        for (int r=0; r<channels; r++) {
+            int branch = r + rotation;
+            if (branch >= channels) {
+                branch -= channels;
+            }
+            fftBuf[r] = branches[channels - 1 - branch];
+        }
+        plan.transform(VECTOR_TO_ARRAY(fftBuf), VECTOR_TO_ARRAY(outBuf) + frame * channels);
+
+        inputIndex += decimationRate;
+        rotation += decimationRate;
+        if (rotation >= channels) {
+            rotation -= channels;
+        }
+    }
+    inputIndex -= dataLen;
+
+    std::copy(buf.begin() + dataLen, buf.end(), savedData.begin());
+    data.vec.swap(outBuf);
+    return data;
+}
+
+template <class T>
+std::vector< ComplexVector<T> > & PfbChannelizer<T>::channelize(ComplexVector<T> & data,
+                                                                std::vector< ComplexVector<T> > & channelOut) {
+    channelOut.resize(channels);
+    return deinterleaveChannels(channelize(data), channelOut);
+}
+
+/**
+ * \brief Channelizes "data" in place with "channelizer", continuing from the previous call.
+ *
+ * \param data Buffer of input samples.  On return holds the interleaved output frames.
+ * \param channelizer The channelizer.  Holds the filter bank and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline ComplexVector<T> & channelize(ComplexVector<T> & data, PfbChannelizer<T> & channelizer) {
+    return channelizer.channelize(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,572 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file Pipeline.h
+ *
+ * Streaming processing pipelines whose stages run on their own threads.
+ *
+ * A pipeline is a chain of stages connected by links.  A \ref PipelineSource produces blocks of
+ * data, each \ref PipelineStage turns an input block into an output block, and a
+ * \ref PipelineSink consumes blocks.  Each stage keeps its own state (filter history, the last
+ * phase of a modulator, ...) from block to block, so a chain that would otherwise be one loop
+ * full of "last" variables becomes a set of small stages:
+ *
+ *      Pipeline pipeline;
+ *      FileSourceStage<float, RealVector<float> > audio("audio.raw", 1024);
+ *      InterpStage<RealVector<float>, RealFirFilter<float> > upsample(filt, 4);
+ *      FmModulatorStage modulate;       // A PipelineStage<RealVector<float>, ComplexVector<float> >
+ *      FileSinkStage<std::complex<float>, ComplexVector<float> > fm("fm.bin");
+ *      pipeline.connect(audio, upsample);
+ *      pipeline.connect(upsample, modulate);
+ *      pipeline.connect(modulate, fm);
+ *      pipeline.run();
+ *
+ * Each link holds a fixed pool of blocks and two lock-free single producer/single consumer rings:
+ * one carries filled blocks downstream and the other returns used blocks upstream to be refilled.
+ * Blocks are never freed or copied while the pipeline runs, so once the blocks' buffers have grown
+ * to the working size the pipeline doesn't allocate.  The number of blocks per link bounds how far
+ * a stage can run ahead of the next one.
+ *
+ * The stages are owned by the caller and must outlive the pipeline run.  Each stage may be
+ * connected to one upstream and one downstream stage.
+ */
+
+#ifndef NimbleDSP_Pipeline_h
+#define NimbleDSP_Pipeline_h
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+#include "SampleFile.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Default number of blocks in each link of a Pipeline.
+ */
+const unsigned DEFAULT_PIPELINE_DEPTH = 4;
+
+/**
+ * \brief Lock-free ring buffer for one producer thread and one consumer thread.
+ *
+ * push and pop never block; they return false when the ring is full or empty.  T should be cheap
+ * to copy, like a pointer.
+ */
+template <class T>
+class SpscRing {
+ protected:
+    std::vector<T> buf;
+    unsigned mask;
+    
+    /**
+     * \brief Free running read and write counts.  Only the consumer writes \ref head and only
+     *      the producer writes \ref tail.
+     */
+    std::atomic<unsigned> head;
+    std::atomic<unsigned> tail;
+
+ public:
+    /**
+     * \brief Basic constructor.
+     *
+     * \param minCapacity Minimum number of elements the ring must hold.  It is rounded up to a
+     *      power of two.
+     */
+    SpscRing<T>(unsigned minCapacity) : head(0), tail(0) {
+        unsigned capacity = 1;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        buf.resize(capacity);
+        mask = capacity - 1;
+    }
+    
+    /**
+     * \brief Returns the number of elements the ring can hold.
+     */
+    unsigned capacity() const {return mask + 1;}
+    
+    /**
+     * \brief Adds "value" to the ring.  Producer thread only.
+     *
+     * \return False if the ring is full.
+     */
+    bool push(const T & value) {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        buf[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * \brief Takes the oldest element out of the ring.  Consumer thread only.
+     *
+     * \return False if the ring is empty.
+     */
+    bool pop(T & value) {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buf[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+
+/**
+ * \brief Connection between two pipeline stages that carries blocks of type V.
+ */
+template <class V>
+class PipelineLink {
+ protected:
+    std::vector<V> blocks;
+    
+    /**
+     * \brief Filled blocks on their way downstream.
+     */
+    SpscRing<V *> filled;
+    
+    /**
+     * \brief Used blocks on their way back upstream.
+     */
+    SpscRing<V *> recycled;
+    
+    /**
+     * \brief Set by the producer once it has sent its last block.
+     */
+    std::atomic<bool> finished;
+
+ public:
+    PipelineLink<V>(unsigned numBlocks) : blocks(numBlocks), filled(numBlocks), recycled(numBlocks), finished(false)
+            {reset();}
+    
+    /**
+     * \brief Puts every block back in the recycled ring.  Only call it while no stage is running.
+     */
+    void reset() {
+        V *block;
+        while (filled.pop(block)) {}
+        while (recycled.pop(block)) {}
+        for (unsigned i=0; i<blocks.size(); i++) {
+            recycled.push(&blocks[i]);
+        }
+        finished.store(false);
+    }
+    
+    /**
+     * \brief Producer: waits for a block to fill.
+     */
+    V *acquire() {
+        V *block;
+        while (!recycled.pop(block)) {
+            std::this_thread::yield();
+        }
+        return block;
+    }
+    
+    /**
+     * \brief Producer: sends a filled block downstream.  Never has to wait, since there are only
+     *      as many blocks as the ring holds.
+     */
+    void send(V *block) {filled.push(block);}
+    
+    /**
+     * \brief Producer: returns a block that it acquired but didn't fill.
+     */
+    void discard(V *block) {recycled.push(block);}
+    
+    /**
+     * \brief Producer: marks the end of the stream.
+     */
+    void finish() {finished.store(true, std::memory_order_release);}
+    
+    /**
+     * \brief Consumer: waits for the next filled block.
+     *
+     * \return NULL at the end of the stream.
+     */
+    V *receive() {
+        V *block;
+        while (!filled.pop(block)) {
+            if (finished.load(std::memory_order_acquire)) {
+                // The last block may have gone in just before the flag was set.
+                return filled.pop(block) ? block : NULL;
+            }
+            std::this_thread::yield();
+        }
+        return block;
+    }
+    
+    /**
+     * \brief Consumer: sends a used block back upstream.
+     */
+    void release(V *block) {recycled.push(block);}
+};
+
+
+/**
+ * \brief Base class of everything a Pipeline runs.
+ */
+class PipelineNode {
+ public:
+    virtual ~PipelineNode() {}
+    
+    /**
+     * \brief Processes blocks until the stream ends.  Runs on the node's own thread.
+     */
+    virtual void run() = 0;
+    
+    /**
+     * \brief Called on the node's thread after its last block.  The file sinks flush here, for
+     *      example.
+     */
+    virtual void finish() {}
+};
+
+/**
+ * \brief The input side of a stage that consumes blocks of type V.
+ */
+template <class V>
+class PipelineInput : public virtual PipelineNode {
+ public:
+    PipelineLink<V> *input;
+    PipelineInput<V>() : input(NULL) {}
+};
+
+/**
+ * \brief The output side of a stage that produces blocks of type V.
+ */
+template <class V>
+class PipelineOutput : public virtual PipelineNode {
+ public:
+    PipelineLink<V> *output;
+    PipelineOutput<V>() : output(NULL) {}
+};
+
+
+/**
+ * \brief A stage that produces blocks.  Derived classes implement \ref generate.
+ */
+template <class Out>
+class PipelineSource : public PipelineOutput<Out> {
+ public:
+    /**
+     * \brief Fills "out" with the next block.
+     *
+     * \return False at the end of the stream, in which case "out" is not sent.
+     */
+    virtual bool generate(Out & out) = 0;
+    
+    virtual void run() {
+        assert(this->output != NULL);
+        while (true) {
+            Out *out = this->output->acquire();
+            if (!generate(*out)) {
+                this->output->discard(out);
+                break;
+            }
+            this->output->send(out);
+        }
+        this->finish();
+        this->output->finish();
+    }
+};
+
+/**
+ * \brief A stage that turns input blocks into output blocks.  Derived classes implement
+ *      \ref process.
+ */
+template <class In, class Out>
+class PipelineStage : public PipelineInput<In>, public PipelineOutput<Out> {
+ public:
+    /**
+     * \brief Processes the block "in" into "out".
+     *
+     * "out" holds whatever was in it the last time it went through the pipeline, and should be
+     * treated as a buffer to reuse.  "in" is recycled afterwards, so when In and Out are the same
+     * type a stage that works in place can just process "in" and swap it into "out".
+     */
+    virtual void process(In & in, Out & out) = 0;
+    
+    virtual void run() {
+        assert(this->input != NULL && this->output != NULL);
+        In *in;
+        while ((in = this->input->receive()) != NULL) {
+            Out *out = this->output->acquire();
+            process(*in, *out);
+            this->input->release(in);
+            this->output->send(out);
+        }
+        this->finish();
+        this->output->finish();
+    }
+};
+
+/**
+ * \brief A stage that consumes blocks.  Derived classes implement \ref consume.
+ */
+template <class In>
+class PipelineSink : public PipelineInput<In> {
+ public:
+    /**
+     * \brief Does whatever the sink does with the block "in".
+     */
+    virtual void consume(In & in) = 0;
+    
+    virtual void run() {
+        assert(this->input != NULL);
+        In *in;
+        while ((in = this->input->receive()) != NULL) {
+            consume(*in);
+            this->input->release(in);
+        }
+        this->finish();
+    }
+};
+
+
+/**
+ * \brief Runs a set of connected stages, one thread per stage.
+ */
+class Pipeline {
+ protected:
+    /**
+     * \brief Type-erased handle on a link so the pipeline can reset and delete it.
+     */
+    class LinkHolder {
+     public:
+        virtual ~LinkHolder() {}
+        virtual void reset() = 0;
+    };
+    
+    template <class V>
+    class TypedLinkHolder : public LinkHolder {
+     public:
+        PipelineLink<V> link;
+        TypedLinkHolder(unsigned numBlocks) : link(numBlocks) {}
+        virtual void reset() {link.reset();}
+    };
+    
+    std::vector<PipelineNode *> nodes;
+    std::vector<LinkHolder *> links;
+    std::vector<std::thread> threads;
+    unsigned depth;
+    
+    void addNode(PipelineNode *node) {
+        if (std::find(nodes.begin(), nodes.end(), node) == nodes.end()) {
+            nodes.push_back(node);
+        }
+    }
+    
+    Pipeline(const Pipeline &);
+    Pipeline & operator=(const Pipeline &);
+
+ public:
+    /**
+     * \brief Basic constructor.
+     *
+     * \param blocksPerLink Number of blocks in each link.  At least 2 so that neighboring stages
+     *      can work at the same time.
+     */
+    Pipeline(unsigned blocksPerLink = DEFAULT_PIPELINE_DEPTH) : depth(blocksPerLink) {assert(blocksPerLink >= 2);}
+    
+    ~Pipeline() {
+        wait();
+        for (unsigned i=0; i<links.size(); i++) {
+            delete links[i];
+        }
+    }
+    
+    /**
+     * \brief Connects the output of "from" to the input of "to".
+     */
+    template <class V>
+    void connect(PipelineOutput<V> & from, PipelineInput<V> & to) {
+        assert(from.output == NULL && to.input == NULL);
+        TypedLinkHolder<V> *holder = new TypedLinkHolder<V>(depth);
+        links.push_back(holder);
+        from.output = &holder->link;
+        to.input = &holder->link;
+        addNode(&from);
+        addNode(&to);
+    }
+    
+    /**
+     * \brief Starts every stage on its own thread and returns.
+     */
+    void start() {
+        assert(threads.empty());
+        for (unsigned i=0; i<links.size(); i++) {
+            links[i]->reset();
+        }
+        for (unsigned i=0; i<nodes.size(); i++) {
+            threads.push_back(std::thread(&PipelineNode::run, nodes[i]));
+        }
+    }
+    
+    /**
+     * \brief Waits for every stage to finish.  The stream ends when the source's
+     *      PipelineSource::generate returns false.
+     */
+    void wait() {
+        for (unsigned i=0; i<threads.size(); i++) {
+            threads[i].join();
+        }
+        threads.clear();
+    }
+    
+    /**
+     * \brief Runs the pipeline until the stream ends.
+     */
+    void run() {start(); wait();}
+};
+
+
+/*****************************************************************************************
+                                        Stages
+*****************************************************************************************/
+/**
+ * \brief Source that reads blocks from a file with a FileSource.
+ *
+ * F is the file's sample format and V is the block type, e.g. ComplexVector<float>.
+ */
+template <class F, class V>
+class FileSourceStage : public PipelineSource<V> {
+ public:
+    FileSource<F> file;
+    unsigned blockLen;
+    
+    /**
+     * \brief Opens "filename".  The other parameters are the same as FileSource's.
+     *
+     * \param samplesPerBlock Number of samples per block.  Only the last block may be shorter.
+     */
+    FileSourceStage<F, V>(const char *filename, unsigned samplesPerBlock, FileAccessType access = MEMORY_MAPPED_FILE,
+                          bool readAhead = false) : file(filename, access, readAhead), blockLen(samplesPerBlock) {}
+    
+    virtual bool generate(V & out) {return file.read(out, blockLen) > 0;}
+};
+
+/**
+ * \brief Sink that writes blocks to a file with a FileSink.
+ */
+template <class F, class V>
+class FileSinkStage : public PipelineSink<V> {
+ public:
+    FileSink<F> file;
+    
+    /**
+     * \brief Opens "filename".  The other parameters are the same as FileSink's.
+     */
+    FileSinkStage<F, V>(const char *filename, bool writeBehind = false) : file(filename, writeBehind) {}
+    
+    virtual void consume(V & in) {file.write(in);}
+    virtual void finish() {file.flush();}
+};
+
+/**
+ * \brief Stage that filters blocks with an FIR filter's conv method.  The filter should be in
+ *      STREAMING mode.
+ */
+template <class V, class Filter>
+class ConvStage : public PipelineStage<V, V> {
+ public:
+    Filter & filt;
+    
+    ConvStage<V, Filter>(Filter & filter) : filt(filter) {}
+    
+    virtual void process(V & in, V & out) {conv(in, filt); std::swap(in, out);}
+};
+
+/**
+ * \brief Stage that decimates blocks with an FIR filter.  The filter should be in STREAMING mode.
+ */
+template <class V, class Filter>
+class DecimateStage : public PipelineStage<V, V> {
+ public:
+    Filter & filt;
+    int rate;
+    
+    DecimateStage<V, Filter>(Filter & filter, int decimateRate) : filt(filter), rate(decimateRate) {}
+    
+    virtual void process(V & in, V & out) {decimate(in, rate, filt); std::swap(in, out);}
+};
+
+/**
+ * \brief Stage that interpolates blocks with an FIR filter.  The filter should be in STREAMING mode.
+ */
+template <class V, class Filter>
+class InterpStage : public PipelineStage<V, V> {
+ public:
+    Filter & filt;
+    int rate;
+    
+    InterpStage<V, Filter>(Filter & filter, int interpRate) : filt(filter), rate(interpRate) {}
+    
+    virtual void process(V & in, V & out) {interp(in, rate, filt); std::swap(in, out);}
+};
+
+/**
+ * \brief Stage that filters blocks with an IIR or second-order-section filter's filter method.
+ */
+template <class V, class Filter>
+class IirStage : public PipelineStage<V, V> {
+ public:
+    Filter & filt;
+    
+    IirStage<V, Filter>(Filter & filter) : filt(filter) {}
+    
+    virtual void process(V & in, V & out) {filt.filter(in); std::swap(in, out);}
+};
+
+/**
+ * \brief Stage that applies a function to each block in place, e.g. one of the Vector transforms.
+ *
+ * Any callable works, including a lambda that captures state of its own:
+ *
+ *      TransformStage< ComplexVector<float> > magnitude([](ComplexVector<float> & buf) {abs(buf);});
+ */
+template <class V>
+class TransformStage : public PipelineStage<V, V> {
+ public:
+    std::function<void (V &)> transform;
+    
+    TransformStage<V>(std::function<void (V &)> function) : transform(function) {}
+    
+    virtual void process(V & in, V & out) {transform(in); std::swap(in, out);}
+};
+
+};
+
+#endif
@@ -0,0 +1,241 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file PolyphaseResampler.h
+ *
+ * Definition of the template class PolyphaseResampler.
+ */
+
+#ifndef NimbleDSP_PolyphaseResampler_h
+#define NimbleDSP_PolyphaseResampler_h
+
+#include <complex>
+#include <vector>
+#include <cassert>
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "SimdKernels.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Streaming rational resampler built on a polyphase decomposition of a real FIR filter.
+ *
+ * Resampling by interpRate/decimateRate conceptually inserts interpRate - 1 zeros between input
+ * samples, filters, and keeps every decimateRate'th result.  Only one in interpRate taps ever
+ * lines up with a non-zero sample, and which ones depends on the output's phase.  At construction
+ * the taps are split into interpRate phase banks, each holding the taps for one phase contiguously
+ * and in reverse order, so every output is a single forward dot product over the input.
+ *
+ * RealFirFilter::resample in NimbleDSP::STREAMING mode uses the same kernel,
+ * \ref streamingPolyphaseResample, so the results are the same as with a filter with the same taps
+ * and rates.  Interpolation and decimation are the special cases decimateRate = 1 and
+ * interpRate = 1.
+ */
+template <class T>
+class PolyphaseResampler {
+ protected:
+    /**
+     * \brief The phase banks, one after another.  Bank p holds taps p, p + interpRate,
+     *      p + 2*interpRate, ... in reverse order, zero padded at the front to \ref tapsPerPhase.
+     */
+    std::vector<T> phaseBanks;
+
+    /**
+     * \brief Number of taps in each phase bank.
+     */
+    int tapsPerPhase;
+
+    int interpolationRate;
+    int decimationRate;
+
+    /**
+     * \brief The last tapsPerPhase - 1 input samples, followed by room for the first
+     *      tapsPerPhase - 1 samples of a new block.  Sized for complex data so that the same buffer
+     *      works for either kind of data.
+     */
+    std::vector<char> savedData;
+
+    /**
+     * \brief Where the next output falls on the upsampled time line, relative to the start of the
+     *      next block of input.  See \ref streamingPolyphaseResample.
+     */
+    int phase;
+
+    /**
+     * \brief Buffers for the outputs.  They are swapped with the caller's data, so once they have
+     *      grown to the block size resampling doesn't allocate.
+     */
+    std::vector<T> outBuf;
+    std::vector< std::complex<T> > complexOutBuf;
+
+    template <class U>
+    void initBanks(const U *taps, int numTaps);
+
+    template <class U>
+    void resampleBlock(std::vector<U> & data, U *history, std::vector<U> & out);
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Vector constructor.
+     *
+     * \param taps The prototype filter taps.  The filter runs at interpRate times the input rate.
+     * \param interpRate The interpolation rate.
+     * \param decimateRate The decimation rate.
+     */
+    template <typename U>
+    PolyphaseResampler<T>(const std::vector<U> & taps, int interpRate, int decimateRate)
+            {assert(taps.size() > 0); setFilter(VECTOR_TO_ARRAY(taps), taps.size(), interpRate, decimateRate);}
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param taps Array of prototype filter taps.
+     * \param numTaps Number of taps in "taps".
+     * \param interpRate The interpolation rate.
+     * \param decimateRate The decimation rate.
+     */
+    template <typename U>
+    PolyphaseResampler<T>(const U *taps, unsigned numTaps, int interpRate, int decimateRate)
+            {setFilter(taps, numTaps, interpRate, decimateRate);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Replaces the filter and rates and clears the streaming state.
+     */
+    template <typename U>
+    void setFilter(const U *taps, unsigned numTaps, int interpRate, int decimateRate);
+
+    /**
+     * \brief Clears the streaming state, as if no data had been resampled yet.
+     */
+    void reset();
+
+    int interpRate() const {return interpolationRate;}
+    int decimateRate() const {return decimationRate;}
+
+    /**
+     * \brief Returns the number of taps in each phase bank.
+     */
+    int numTapsPerPhase() const {return tapsPerPhase;}
+
+    /**
+     * \brief Resamples "data" in place, continuing from the previous call.
+     *
+     * \param data Buffer to resample.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    RealVector<T> & resample(RealVector<T> & data);
+
+    /**
+     * \brief Resamples complex "data" in place, continuing from the previous call.
+     *
+     * A resampler should be used for either real or complex data, not both, since they share
+     * the streaming state.
+     * \param data Buffer to resample.  Its size changes to the number of outputs produced.
+     * \return Reference to "data".
+     */
+    ComplexVector<T> & resampleComplex(ComplexVector<T> & data);
+};
+
+
+template <class T>
+template <typename U>
+void PolyphaseResampler<T>::setFilter(const U *taps, unsigned numTaps, int interpRate, int decimateRate) {
+    assert(numTaps > 0 && interpRate > 0 && decimateRate > 0);
+    interpolationRate = interpRate;
+    decimationRate = decimateRate;
+    initBanks(taps, numTaps);
+    savedData.resize(2 * (tapsPerPhase - 1) * sizeof(std::complex<T>));
+    reset();
+}
+
+template <class T>
+template <class U>
+void PolyphaseResampler<T>::initBanks(const U *taps, int numTaps) {
+    tapsPerPhase = (numTaps + interpolationRate - 1) / interpolationRate;
+    buildPhaseBanks(taps, numTaps, interpolationRate, phaseBanks);
+}
+
+template <class T>
+void PolyphaseResampler<T>::reset() {
+    std::fill(savedData.begin(), savedData.end(), 0);
+    phase = 0;
+}
+
+template <class T>
+template <class U>
+void PolyphaseResampler<T>::resampleBlock(std::vector<U> & data, U *history, std::vector<U> & out) {
+    out.resize(((long) data.size() * interpolationRate + decimationRate - 1) / decimationRate + 1);
+    out.resize(streamingPolyphaseResample(data.data(), data.size(), interpolationRate, decimationRate,
+                                          VECTOR_TO_ARRAY(phaseBanks), tapsPerPhase, history, phase,
+                                          VECTOR_TO_ARRAY(out)));
+    data.swap(out);
+}
+
+template <class T>
+RealVector<T> & PolyphaseResampler<T>::resample(RealVector<T> & data) {
+    resampleBlock(data.vec, (T *) savedData.data(), outBuf);
+    return data;
+}
+
+/**
+ * \brief Resamples "data" in place with "resampler", continuing from the previous call.
+ *
+ * \param data Buffer to resample.
+ * \param resampler The resampler.  Holds the filter, the rates and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline RealVector<T> & resample(RealVector<T> & data, PolyphaseResampler<T> & resampler) {
+    return resampler.resample(data);
+}
+
+template <class T>
+ComplexVector<T> & PolyphaseResampler<T>::resampleComplex(ComplexVector<T> & data) {
+    resampleBlock(data.vec, (std::complex<T> *) savedData.data(), complexOutBuf);
+    return data;
+}
+
+/**
+ * \brief Resamples complex "data" in place with "resampler", continuing from the previous call.
+ *
+ * \param data Buffer to resample.
+ * \param resampler The resampler.  Holds the filter, the rates and the streaming state.
+ * \return Reference to "data".
+ */
+template <class T>
+inline ComplexVector<T> & resample(ComplexVector<T> & data, PolyphaseResampler<T> & resampler) {
+    return resampler.resampleComplex(data);
+}
+
+};
+
+#endif
@@ -33,11 +33,17 @@ THE SOFTWARE.
 #include <complex>
 #include <math.h>
 #include "RealVector.h"
+#include "SplitComplexVector.h"
+#include "FastConvolver.h"
+#include "SimdKernels.h"
+#include "VectorView.h"
 #include "ParksMcClellan.h"
 
 
 namespace NimbleDSP {
 
+template <class T> class Nco;
+
 /**
  * \brief Class for real FIR filters.
  */
@@ -45,10 +51,21 @@ template <class T>
 class RealFirFilter : public RealVector<T> {
  protected:
     /**
-     * \brief Saved data that is used for stream filtering.
+     * \brief Saved data that is used for stream filtering.  It is double length, 2 * (size() - 1)
+     *      samples, so that \ref streamingFirInPlace can use the back half to stitch the start of
+     *      a block onto the end of the previous one.  Sized for complex data so that the same
+     *      buffer works for either kind of data.
      */
     std::vector<char> savedData;
     
+    /**
+     * \brief Working buffers used when the data has no scratch buffer of its own.  They keep their
+     *      capacity from call to call, so streaming doesn't allocate once they've grown to the
+     *      block size.
+     */
+    std::vector<T> workBuf;
+    std::vector< std::complex<T> > complexWorkBuf;
+    
     /**
      * \brief Indicates how many samples are in \ref savedData.  Used for stream filtering.
      */
@@ -59,11 +76,100 @@ class RealFirFilter : public RealVector<T> {
      */
     int phase;
     
+    /**
+     * \brief The taps in reverse order, so the direct form inner loops can run forward through
+     *      contiguous memory with \ref dotProduct.  Refreshed by \ref reverseTaps.
+     */
+    std::vector< T > reversedTaps;
+    
+    /**
+     * \brief Symmetry of the current taps, as found by the last \ref reverseTaps or \ref foldInterp.
+     */
+    TapSymmetryType foldSymmetry;
+    
+    /**
+     * \brief Table from \ref foldInterpTaps for streaming interpolation.  Refreshed by \ref foldInterp.
+     */
+    std::vector< T > foldedInterpTaps;
+    
+    /**
+     * \brief The taps split into polyphase branches by \ref buildPhaseBanks.  Refreshed by
+     *      \ref polyphaseBanks.
+     */
+    std::vector< T > phaseBanks;
+    
+    /**
+     * \brief Copies the current taps into \ref reversedTaps and works out their symmetry.
+     */
+    void reverseTaps() {reversedTaps.resize(this->size());
+                        std::reverse_copy(this->vec.begin(), this->vec.end(), reversedTaps.begin());
+                        foldSymmetry = tapSymmetry();}
+    
+    /**
+     * \brief Works out the symmetry of the taps and folds them for interpolating by "rate".
+     *
+     * \return The folded table for \ref streamingFirInterp, or NULL if the taps can't be folded.
+     */
+    const T *foldInterp(int rate) {foldSymmetry = tapSymmetry();
+            return foldInterpTaps(VECTOR_TO_ARRAY(this->vec), this->size(), rate, foldSymmetry, foldedInterpTaps) ?
+                   VECTOR_TO_ARRAY(foldedInterpTaps) : NULL;}
+    
+    /**
+     * \brief Splits the taps into "rate" polyphase branches for interpolation and resampling.
+     */
+    const T *polyphaseBanks(int rate)
+            {buildPhaseBanks(VECTOR_TO_ARRAY(this->vec), this->size(), rate, phaseBanks); return VECTOR_TO_ARRAY(phaseBanks);}
+    
+    /**
+     * \brief FFT convolution engine.  Caches the spectrum of the taps between calls.
+     */
+    FastConvolver<typename FftScalar<T>::type> fastConvolver;
+    
     /**
      * \brief Applies a Hamming window on the current contents of "this".
      */
     void hamming(void);
     
+    /**
+     * \brief Decides whether a convolution should be done with \ref fastConvolver.
+     *
+     * \param numOutputs Number of outputs the convolution will produce.
+     * \param realData True for real data, false for complex data.
+     */
+    bool useFftConvolution(int numOutputs, bool realData);
+    
+    /**
+     * \brief Streaming convolution of "dataLen" samples at "data", in place.  Shared by the vector
+     *      and view versions of conv and convComplex.  The taps must already be reversed.
+     *
+     * \param work Buffer for the FFT path to stitch the saved samples onto the new ones.
+     * \param realData True for real data, false for complex data.
+     * \param history The stream's 2 * (size() - 1) saved samples.
+     */
+    template <class U>
+    void streamingConv(U *data, int dataLen, std::vector<U> & work, bool realData, U *history);
+    
+    /**
+     * \brief The body of \ref conv, \ref convComplex and \ref convSplit.  Convolves "vec" in place
+     *      as \ref filtOperation says.  The taps must already be reversed.
+     *
+     * \param work Buffer to copy the input to, or to stitch the saved samples onto it.
+     * \param realData True for real data, false for complex data.
+     * \param history The stream's 2 * (size() - 1) saved samples.
+     */
+    template <class U>
+    void convVector(std::vector<U> & vec, std::vector<U> & work, bool realData, U *history);
+    
+    /**
+     * \brief The body of \ref decimateComplex.  Each input sample is passed through "load" as it is
+     *      copied into the working buffer, which is how \ref Nco::modulateDecimate mixes and
+     *      decimates in one pass.
+     */
+    template <class Load>
+    ComplexVector<T> & decimateComplexLoaded(ComplexVector<T> & data, int rate, Load & load);
+    
+    template <class U> friend class Nco;
+    
  public:
     /**
      * \brief Determines how the filter should filter.
@@ -74,6 +180,43 @@ class RealFirFilter : public RealVector<T> {
      *      filtered one continuous set of data.
      */
     FilterOperationType filtOperation;
+    
+    /**
+     * \brief Determines how the \ref conv and \ref convComplex methods compute the convolution.
+     *
+     * NimbleDSP::DIRECT_CONVOLUTION always uses the direct form.
+     * NimbleDSP::FFT_CONVOLUTION always uses overlap-save FFT convolution (floating point types only).
+     * NimbleDSP::AUTO_CONVOLUTION uses FFT convolution when the filter has at least
+     *      NimbleDSP::FFT_CONVOLUTION_MIN_TAPS taps and it is estimated to be faster.  This is the default.
+     * The results are the same either way, to within floating point rounding.
+     */
+    ConvolutionAlgorithmType convAlgorithm;
+    
+    /**
+     * \brief Says whether the taps are symmetric (h[i] == h[N-1-i]) or antisymmetric
+     *      (h[i] == -h[N-1-i]), as linear phase filters are.
+     *
+     * The direct form convolution, decimation and streaming interpolation fold symmetric and
+     * antisymmetric taps, adding each pair of samples that share a tap before multiplying, which
+     * halves the multiplies.  Convolution and decimation fold filters with at least
+     * NimbleDSP::FOLD_MIN_TAPS taps, and interpolation folds when the number of taps is a multiple
+     * of the rate.
+     * NimbleDSP::DETECT_SYMMETRY checks the taps each time they are used.  This is the default.
+     * NimbleDSP::SYMMETRIC_TAPS and NimbleDSP::ANTISYMMETRIC_TAPS declare the symmetry and skip the
+     *      check.  The filter then acts as if one half of the taps were the mirror image of the
+     *      other, so the declaration has to be true.
+     * NimbleDSP::NO_SYMMETRY never folds.
+     * Assigning new taps with operator= sets it back to NimbleDSP::DETECT_SYMMETRY.
+     */
+    TapSymmetryType symmetry;
+#if defined(NIMBLEDSP_INSTRUMENTATION)
+    /**
+     * \brief This filter's own call counts, samples, time and allocations, across all of its
+     *      filtering methods.  Only there when NIMBLEDSP_INSTRUMENTATION is defined (see
+     *      Instrumentation.h).
+     */
+    InstrumentationCounts instrumentation;
+#endif
 
     /*****************************************************************************************
                                         Constructors
@@ -87,12 +230,14 @@ class RealFirFilter : public RealVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then the vector methods that require one borrow one from the calling thread's
+     *      workspace (see ScratchBuffer), and the filtering methods use a work buffer that the
+     *      filter keeps between calls.
      */
     RealFirFilter<T>(unsigned size = DEFAULT_BUF_LEN, FilterOperationType operation = STREAMING, std::vector<T> *scratch = NULL) : RealVector<T>(size, scratch)
-            {if (size > 0) {savedData.resize((size - 1) * sizeof(std::complex<T>)); numSavedSamples = size - 1;}
-             else {savedData.resize(0); numSavedSamples = 0;} phase = 0; filtOperation = operation;}
+            {if (size > 0) {savedData.resize(2 * (size - 1) * sizeof(std::complex<T>)); numSavedSamples = size - 1;}
+             else {savedData.resize(0); numSavedSamples = 0;} phase = 0; filtOperation = operation;
+             convAlgorithm = AUTO_CONVOLUTION; symmetry = DETECT_SYMMETRY;}
     
     /**
      * \brief Vector constructor.
@@ -104,12 +249,14 @@ class RealFirFilter : public RealVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then the vector methods that require one borrow one from the calling thread's
+     *      workspace (see ScratchBuffer), and the filtering methods use a work buffer that the
+     *      filter keeps between calls.
      */
     template <typename U>
     RealFirFilter<T>(std::vector<U> data, FilterOperationType operation = STREAMING, std::vector<T> *scratch = NULL) : RealVector<T>(data, scratch)
-            {savedData.resize((data.size() - 1) * sizeof(std::complex<T>)); numSavedSamples = data.size() - 1; phase = 0; filtOperation = operation;}
+            {savedData.resize(2 * (data.size() - 1) * sizeof(std::complex<T>)); numSavedSamples = data.size() - 1; phase = 0; filtOperation = operation;
+             convAlgorithm = AUTO_CONVOLUTION; symmetry = DETECT_SYMMETRY;}
     
     /**
      * \brief Array constructor.
@@ -122,18 +269,29 @@ class RealFirFilter : public RealVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then the vector methods that require one borrow one from the calling thread's
+     *      workspace (see ScratchBuffer), and the filtering methods use a work buffer that the
+     *      filter keeps between calls.
      */
     template <typename U>
     RealFirFilter<T>(U *data, unsigned dataLen, FilterOperationType operation = STREAMING, std::vector<T> *scratch = NULL) : RealVector<T>(data, dataLen, scratch)
-            {savedData.resize((dataLen - 1) * sizeof(std::complex<T>)); numSavedSamples = dataLen - 1; phase = 0; filtOperation = operation;}
+            {savedData.resize(2 * (dataLen - 1) * sizeof(std::complex<T>)); numSavedSamples = dataLen - 1; phase = 0; filtOperation = operation;
+             convAlgorithm = AUTO_CONVOLUTION; symmetry = DETECT_SYMMETRY;}
     
     /**
      * \brief Copy constructor.
      */
-    RealFirFilter<T>(const RealFirFilter<T>& other) {this->vec = other.vec; savedData = other.savedData;
-            numSavedSamples = other.numSavedSamples; phase = other.phase; filtOperation = other.filtOperation;}
+    RealFirFilter<T>(const RealFirFilter<T>& other) : RealVector<T>(other) {savedData = other.savedData;
+            numSavedSamples = other.numSavedSamples; phase = other.phase; filtOperation = other.filtOperation;
+            convAlgorithm = other.convAlgorithm; symmetry = other.symmetry; fastConvolver = other.fastConvolver;}
+    
+    /**
+     * \brief Move constructor.  Takes over the taps and the filter state of "other" without
+     *      copying them.
+     */
+    RealFirFilter<T>(RealFirFilter<T>&& other) : RealVector<T>(std::move(other)) {savedData = std::move(other.savedData);
+            numSavedSamples = other.numSavedSamples; phase = other.phase; filtOperation = other.filtOperation;
+            convAlgorithm = other.convAlgorithm; symmetry = other.symmetry; fastConvolver = std::move(other.fastConvolver);}
     
     /*****************************************************************************************
                                             Operators
@@ -141,11 +299,42 @@ class RealFirFilter : public RealVector<T> {
     /**
      * \brief Assignment operator.
      */
-    RealFirFilter<T>& operator=(const Vector<T>& rhs) {this->vec = rhs.vec; savedData.resize(this->size() - 1); phase = 0; filtOperation = STREAMING; return *this;}
+    RealFirFilter<T>& operator=(const Vector<T>& rhs) {this->vec = rhs.vec;
+            savedData.assign(2 * (this->size() > 0 ? this->size() - 1 : 0) * sizeof(std::complex<T>), 0);
+            numSavedSamples = this->size() > 0 ? this->size() - 1 : 0; phase = 0; filtOperation = STREAMING;
+            symmetry = DETECT_SYMMETRY; return *this;}
+    
+    /**
+     * \brief Copy assignment operator.  Copies the taps and the filter state.
+     */
+    RealFirFilter<T>& operator=(const RealFirFilter<T>& rhs) {RealVector<T>::operator=(rhs); savedData = rhs.savedData;
+            numSavedSamples = rhs.numSavedSamples; phase = rhs.phase; filtOperation = rhs.filtOperation;
+            convAlgorithm = rhs.convAlgorithm; symmetry = rhs.symmetry; fastConvolver = rhs.fastConvolver; return *this;}
+    
+    /**
+     * \brief Move assignment operator.
+     */
+    RealFirFilter<T>& operator=(RealFirFilter<T>&& rhs) {RealVector<T>::operator=(std::move(rhs)); savedData = std::move(rhs.savedData);
+            numSavedSamples = rhs.numSavedSamples; phase = rhs.phase; filtOperation = rhs.filtOperation;
+            convAlgorithm = rhs.convAlgorithm; symmetry = rhs.symmetry; fastConvolver = std::move(rhs.fastConvolver); return *this;}
     
     /*****************************************************************************************
                                             Methods
     *****************************************************************************************/
+    /**
+     * \brief Clears the streaming state, so that the next call starts a new stream as if the
+     *      filter had just been constructed.  The taps and settings are kept.
+     */
+    void reset() {savedData.assign(savedData.size(), 0); numSavedSamples = this->size() > 0 ? this->size() - 1 : 0;
+            phase = 0;}
+    
+    /**
+     * \brief Returns the symmetry the filter will use: \ref symmetry if it has been declared,
+     *      otherwise what \ref detectTapSymmetry finds in the current taps.
+     */
+    TapSymmetryType tapSymmetry() const {return (symmetry == DETECT_SYMMETRY) ?
+            detectTapSymmetry(VECTOR_TO_ARRAY(this->vec), this->size()) : symmetry;}
+    
     /**
      * \brief Convolution method.
      *
@@ -166,6 +355,18 @@ class RealFirFilter : public RealVector<T> {
      */
     virtual ComplexVector<T> & convComplex(ComplexVector<T> & data, bool trimTails = false);
     
+    /**
+     * \brief Convolution method for split complex data.
+     *
+     * Gives the same results as \ref convComplex, but the real and imaginary parts are filtered
+     * separately with the real data kernels, which need no shuffles.  A filter should be used for
+     * only one of real, complex and split complex data, since they share the streaming state.
+     *
+     * \param data The buffer that will be filtered.
+     * \return Reference to "data", which holds the result of the convolution.
+     */
+    SplitComplexVector<T> & convSplit(SplitComplexVector<T> & data);
+    
     /**
      * \brief Decimate method.
      *
@@ -224,7 +425,12 @@ class RealFirFilter : public RealVector<T> {
      * \brief Resample method.
      *
      * This method is equivalent to upsampling by "interpRate", filtering, and downsampling
-     *      by "decimateRate", but is much more efficient.
+     *      by "decimateRate", but is much more efficient.  NimbleDSP::STREAMING operation uses the
+     *      same polyphase kernel as PolyphaseResampler, and each call returns every output whose
+     *      newest input sample has arrived.  The stream of outputs doesn't depend on how the input
+     *      is split into blocks.  Before the kernel was shared an output was held back until the
+     *      first sample of its window arrived, so when the number of taps isn't a multiple of
+     *      "interpRate" some outputs now come one call earlier than they used to.
      *
      * \param data The buffer that will be filtered.
      * \param interpRate Indicates how much to upsample.
@@ -239,7 +445,12 @@ class RealFirFilter : public RealVector<T> {
      * \brief Resample method for complex data.
      *
      * This method is equivalent to upsampling by "interpRate", filtering, and downsampling
-     *      by "decimateRate", but is much more efficient.
+     *      by "decimateRate", but is much more efficient.  NimbleDSP::STREAMING operation uses the
+     *      same polyphase kernel as PolyphaseResampler, and each call returns every output whose
+     *      newest input sample has arrived.  The stream of outputs doesn't depend on how the input
+     *      is split into blocks.  Before the kernel was shared an output was held back until the
+     *      first sample of its window arrived, so when the number of taps isn't a multiple of
+     *      "interpRate" some outputs now come one call earlier than they used to.
      *
      * \param data The buffer that will be filtered.
      * \param interpRate Indicates how much to upsample.
@@ -250,6 +461,54 @@ class RealFirFilter : public RealVector<T> {
      */
     virtual ComplexVector<T> & resampleComplex(ComplexVector<T> & data, int interpRate, int decimateRate, bool trimTails = false);
     
+    /**
+     * \brief Convolution method for data that the filter doesn't own.
+     *
+     * The view versions of conv, decimate, and interp only support NimbleDSP::STREAMING operation,
+     * since the one-shot modes produce more results than there are inputs.  They share the filter
+     * state with the vector versions, so the two can be mixed in one stream.
+     *
+     * \param data The samples to filter.  They are overwritten with the results.
+     * \return "data".
+     */
+    VectorView<T> conv(VectorView<T> data);
+    
+    /**
+     * \brief Convolution method for complex data that the filter doesn't own.  See the real version.
+     */
+    VectorView< std::complex<T> > conv(VectorView< std::complex<T> > data);
+    
+    /**
+     * \brief Decimate method for data that the filter doesn't own.  Streaming only.
+     *
+     * \param data The samples to filter.  The results are written over the start of it.
+     * \param rate Indicates how much to downsample.
+     * \return View of the results at the start of "data".
+     */
+    VectorView<T> decimate(VectorView<T> data, int rate);
+    
+    /**
+     * \brief Decimate method for complex data that the filter doesn't own.  Streaming only.
+     */
+    VectorView< std::complex<T> > decimate(VectorView< std::complex<T> > data, int rate);
+    
+    /**
+     * \brief Interpolation method for data that the filter doesn't own.  Streaming only.
+     *
+     * \param data The samples to filter.
+     * \param rate Indicates how much to upsample.
+     * \param results Where the results go.  It must hold at least data.size() * rate samples, and
+     *      may be the same memory as "data".
+     * \return View of the results at the start of "results".
+     */
+    VectorView<T> interp(VectorView<T> data, int rate, VectorView<T> results);
+    
+    /**
+     * \brief Interpolation method for complex data that the filter doesn't own.  Streaming only.
+     */
+    VectorView< std::complex<T> > interp(VectorView< std::complex<T> > data, int rate,
+                                         VectorView< std::complex<T> > results);
+    
     /**
      * \brief Parks-McClellan algorithm for generating equiripple FIR filter coefficients.
      *
@@ -293,322 +552,197 @@ class RealFirFilter : public RealVector<T> {
      *          by one tenth of a sample.  "delay" can be positive or negative.
      */
     void fractionalDelayFilter(int numTaps, double bandwidth, double delay);
+    
+    /**
+     * \brief Designs an equiripple half-band lowpass filter with \ref firpm.
+     *
+     * A half-band filter's bands are symmetric about half the Nyquist frequency, which makes every
+     * other tap zero apart from the center tap, which is 0.5.  The design forces those taps to be
+     * exactly zero so that HalfBandDecimator can skip them.
+     *
+     * \param numTaps Number of taps.  Must be 3 more than a multiple of 4, so that the taps at the
+     *          ends aren't zero.
+     * \param passbandEdge Edge of the passband, normalized so that 1.0 is the Nyquist frequency.
+     *          Must be less than 0.5.  The stopband starts at 1 - passbandEdge.
+     * \return Boolean that indicates whether the filter converged or not.
+     */
+    bool halfBandFilter(int numTaps, double passbandEdge);
 };
 
 
 template <class T>
-RealVector<T> & RealFirFilter<T>::conv(RealVector<T> & data, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector<T> scratch;
-    std::vector<T> *dataTmp;
-    T *savedDataArray = (T *) VECTOR_TO_ARRAY(savedData);
+bool RealFirFilter<T>::useFftConvolution(int numOutputs, bool realData) {
+    if (!std::is_floating_point<T>::value || convAlgorithm == DIRECT_CONVOLUTION || numOutputs <= 0) {
+        return false;
+    }
+    if (convAlgorithm == AUTO_CONVOLUTION && this->size() < FFT_CONVOLUTION_MIN_TAPS) {
+        return false;
+    }
     
-    if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+    fastConvolver.setTaps(this->vec);
+    if (convAlgorithm == FFT_CONVOLUTION) {
+        return true;
+    }
+    return fastConvolver.isFasterThanDirect(numOutputs, realData, realData ? 2 : 4);
+}
+
+template <class T>
+template <class U>
+void RealFirFilter<T>::streamingConv(U *data, int dataLen, std::vector<U> & work, bool realData, U *history) {
+    if (useFftConvolution(dataLen, realData)) {
+        int numHistory = (int) this->size() - 1;
+        work.resize(numHistory + dataLen);
+        for (int i=0; i<numHistory; i++) {
+            work[i] = history[i];
+        }
+        for (int i=0; i<dataLen; i++) {
+            work[i + numHistory] = data[i];
+        }
+        fastConvolver.conv(VECTOR_TO_ARRAY(work), work.size(), numHistory, dataLen, data);
+        for (int i=0; i<numHistory; i++) {
+            history[i] = work[i + dataLen];
+        }
     }
     else {
-        dataTmp = data.scratchBuf;
+        streamingFirInPlace(data, dataLen, VECTOR_TO_ARRAY(reversedTaps), this->size(), history, foldSymmetry);
     }
+}
 
+template <class T>
+template <class U>
+void RealFirFilter<T>::convVector(std::vector<U> & vec, std::vector<U> & work, bool realData, U *history) {
     switch (filtOperation) {
 
     case STREAMING:
-        dataTmp->resize((this->size() - 1) + data.size());
-        for (int i=0; i<this->size()-1; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + this->size() - 1] = data[i];
-        }
-        
-        for (resultIndex=0; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex, filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        for (int i=0; i<this->size()-1; i++) {
-            savedDataArray[i] = (*dataTmp)[i + data.size()];
-        }
+        streamingConv(VECTOR_TO_ARRAY(vec), vec.size(), work, realData, history);
         break;
 
     case ONE_SHOT_RETURN_ALL_RESULTS:
-        *dataTmp = data.vec;
-        data.resize(data.size() + this->size() - 1);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
+        work = vec;
+        vec.resize(vec.size() + this->size() - 1);
+        if (useFftConvolution(vec.size(), realData)) {
+            fastConvolver.conv(VECTOR_TO_ARRAY(work), work.size(), 0, vec.size(), VECTOR_TO_ARRAY(vec));
+            break;
         }
         
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(work), work.size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), 1, 0, vec.size(),
+                   VECTOR_TO_ARRAY(vec), foldSymmetry);
         break;
 
     case ONE_SHOT_TRIM_TAILS:
-        *dataTmp = data.vec;
+        work = vec;
 
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<((int)this->size()-1) - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size() - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        if (useFftConvolution(vec.size(), realData)) {
+            fastConvolver.conv(VECTOR_TO_ARRAY(work), work.size(), initialTrim, vec.size(),
+                               VECTOR_TO_ARRAY(vec));
+            break;
+        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(work), work.size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), 1, initialTrim, vec.size(),
+                   VECTOR_TO_ARRAY(vec), foldSymmetry);
         break;
     }
+}
+
+template <class T>
+RealVector<T> & RealFirFilter<T>::conv(RealVector<T> & data, bool trimTails) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::conv", data.size());
+    std::vector<T> *dataTmp;
+    
+    if (data.scratchBuf == NULL) {
+        dataTmp = &workBuf;
+    }
+    else {
+        dataTmp = data.scratchBuf;
+    }
+
+    reverseTaps();
+    convVector(data.vec, *dataTmp, true, (T *) VECTOR_TO_ARRAY(savedData));
     return data;
 }
 
 template <class T>
 ComplexVector<T> & RealFirFilter<T>::convComplex(ComplexVector<T> & data, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::convComplex", data.size());
     std::vector< std::complex<T> > *dataTmp;
-    std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &complexWorkBuf;
     }
     else {
         dataTmp = data.scratchBuf;
     }
 
-    switch (filtOperation) {
-
-    case STREAMING:
-        dataTmp->resize((this->size() - 1) + data.size());
-        for (int i=0; i<this->size()-1; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + this->size() - 1] = data[i];
-        }
-        
-        for (resultIndex=0; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex, filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        for (int i=0; i<this->size()-1; i++) {
-            savedDataArray[i] = (*dataTmp)[i + data.size()];
-        }
-        break;
-
-    case ONE_SHOT_RETURN_ALL_RESULTS:
-        *dataTmp = data.vec;
-        data.resize(data.size() + this->size() - 1);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        break;
-
-    case ONE_SHOT_TRIM_TAILS:
-        *dataTmp = data.vec;
-
-        // Initial partial overlap
-        int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<((int)this->size()-1) - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size() - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+    reverseTaps();
+    convVector(data.vec, *dataTmp, false, (std::complex<T> *) VECTOR_TO_ARRAY(savedData));
+    return data;
+}
 
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        break;
-    }
+template <class T>
+SplitComplexVector<T> & RealFirFilter<T>::convSplit(SplitComplexVector<T> & data) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::convSplit", data.size());
+    // The real and imaginary parts are filtered as two real streams.  Their histories take the
+    // two halves of savedData, which is sized for 2 * (size() - 1) complex samples.
+    T *history = (T *) VECTOR_TO_ARRAY(savedData);
+    reverseTaps();
+    convVector(data.re, workBuf, true, history);
+    convVector(data.im, workBuf, true, history + 2 * (this->size() - 1));
     return data;
 }
 
+/**
+ * \brief Convolution of split complex data with real taps.  See RealFirFilter::convSplit.
+ *
+ * \param data The buffer that will be filtered.
+ * \param filter The filter.
+ * \return Reference to "data", which holds the result of the convolution.
+ */
+template <class T>
+inline SplitComplexVector<T> & conv(SplitComplexVector<T> & data, RealFirFilter<T> & filter) {
+    return filter.convSplit(data);
+}
+
 template <class T>
 RealVector<T> & RealFirFilter<T>::decimate(RealVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector<T> scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::decimate", data.size());
     std::vector<T> *dataTmp;
     T *savedDataArray = (T *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
     }
 
+    reverseTaps();
     switch (filtOperation) {
 
-    case STREAMING: {
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        data.resize((data.size() + numSavedSamples - (this->size() - 1) + rate - 1)/rate);
-        for (resultIndex=0; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate, filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        int nextResultDataPoint = resultIndex * rate;
-        numSavedSamples = dataTmp->size() - nextResultDataPoint;
-
-        for (int i=0; i<numSavedSamples; i++) {
-            savedDataArray[i] = (*dataTmp)[i + nextResultDataPoint];
-        }
-        }
+    case STREAMING:
+        data.resize(streamingFirDecimate(VECTOR_TO_ARRAY(data.vec), data.size(), rate, VECTOR_TO_ARRAY(reversedTaps),
+                                         this->size(), savedDataArray, numSavedSamples, *dataTmp,
+                                         VECTOR_TO_ARRAY(data.vec), foldSymmetry));
         break;
 
     case ONE_SHOT_RETURN_ALL_RESULTS:
         *dataTmp = data.vec;
         data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
         
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<((int)this->size()-1+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), rate, 0, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
 
     case ONE_SHOT_TRIM_TAILS:
         *dataTmp = data.vec;
         data.resize((data.size() + rate - 1) / rate);
         
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<(((int)this->size()-1) - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size() - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), rate, initialTrim, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
     }
     return data;
@@ -616,109 +750,56 @@ RealVector<T> & RealFirFilter<T>::decimate(RealVector<T> & data, int rate, bool
 
 template <class T>
 ComplexVector<T> & RealFirFilter<T>::decimateComplex(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+    IdentityLoad load;
+    return decimateComplexLoaded(data, rate, load);
+}
+
+template <class T>
+template <class Load>
+ComplexVector<T> & RealFirFilter<T>::decimateComplexLoaded(ComplexVector<T> & data, int rate, Load & load) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::decimateComplex", data.size());
     std::vector< std::complex<T> > *dataTmp;
     std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &complexWorkBuf;
     }
     else {
         dataTmp = data.scratchBuf;
     }
 
+    reverseTaps();
     switch (filtOperation) {
 
-    case STREAMING: {
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        data.resize((data.size() + numSavedSamples - (this->size() - 1) + rate - 1)/rate);
-        for (resultIndex=0; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate, filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        int nextResultDataPoint = resultIndex * rate;
-        numSavedSamples = dataTmp->size() - nextResultDataPoint;
-
-        for (int i=0; i<numSavedSamples; i++) {
-            savedDataArray[i] = (*dataTmp)[i + nextResultDataPoint];
-        }
-        }
+    case STREAMING:
+        data.resize(streamingFirDecimate(VECTOR_TO_ARRAY(data.vec), data.size(), rate, VECTOR_TO_ARRAY(reversedTaps),
+                                         this->size(), savedDataArray, numSavedSamples, *dataTmp,
+                                         VECTOR_TO_ARRAY(data.vec), load, foldSymmetry));
         break;
 
     case ONE_SHOT_RETURN_ALL_RESULTS:
-        *dataTmp = data.vec;
-        data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<((int)this->size()-1+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
+        dataTmp->resize(data.size());
+        for (unsigned i=0; i<data.size(); i++) {
+            (*dataTmp)[i] = load(data[i]);
         }
+        data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
         
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), rate, 0, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
 
     case ONE_SHOT_TRIM_TAILS:
-        *dataTmp = data.vec;
+        dataTmp->resize(data.size());
+        for (unsigned i=0; i<data.size(); i++) {
+            (*dataTmp)[i] = load(data[i]);
+        }
         data.resize((data.size() + rate - 1) / rate);
         
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<(((int)this->size()-1) - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size() - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(reversedTaps), this->size(), rate, initialTrim, data.size(),
+                   VECTOR_TO_ARRAY(data.vec), foldSymmetry);
         break;
     }
     return data;
@@ -726,16 +807,12 @@ ComplexVector<T> & RealFirFilter<T>::decimateComplex(ComplexVector<T> & data, in
 
 template <class T>
 RealVector<T> & RealFirFilter<T>::interp(RealVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector<T> scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::interp", data.size());
     std::vector<T> *dataTmp;
     T *savedDataArray = (T *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
@@ -744,48 +821,12 @@ RealVector<T> & RealFirFilter<T>::interp(RealVector<T> & data, int rate, bool tr
     switch (filtOperation) {
 
     case STREAMING: {
-        int numTaps = (this->size() + rate - 1) / rate;
-        if (numSavedSamples >= numTaps) {
-            // First call to interp, have too many "saved" (really just the initial zeros) samples
-            numSavedSamples = numTaps - 1;
-            phase = (numTaps - 1) * rate;
-        }
-        
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        data.resize(dataTmp->size() * rate);
-        bool keepGoing = true;
-        for (resultIndex=0, dataStart=0, filterStart=phase; keepGoing; ++resultIndex) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-                if (dataTmp->size() - dataStart == numSavedSamples) {
-                    keepGoing = false;
-                    phase = filterStart;
-                }
-            }
-        }
-        data.resize(resultIndex);
-
-        int i;
-        for (i=0; dataStart<dataTmp->size(); i++, dataStart++) {
-            savedDataArray[i] = (*dataTmp)[dataStart];
-        }
-        numSavedSamples = i;
+        int dataLen = data.size();
+        data.resize(dataLen * rate);
+        const T *folded = foldInterp(rate);
+        data.resize(streamingFirInterp(VECTOR_TO_ARRAY(data.vec), dataLen, rate, polyphaseBanks(rate),
+                                       this->size(), savedDataArray, numSavedSamples, phase, *dataTmp,
+                                       VECTOR_TO_ARRAY(data.vec), folded, foldSymmetry));
         }
         break;
 
@@ -793,91 +834,16 @@ RealVector<T> & RealFirFilter<T>::interp(RealVector<T> & data, int rate, bool tr
         *dataTmp = data.vec;
         data.resize(data.size() * rate + this->size() - 1 - (rate - 1));
         
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (dataStart=0, filterStart=resultIndex; resultIndex<(int)dataTmp->size()*rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int) this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
 
     case ONE_SHOT_TRIM_TAILS:
         *dataTmp = data.vec;
         data.resize(data.size() * rate);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1 - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-       
-        // Middle full overlap
-        for (dataStart=0, filterStart=(int)this->size()-1; resultIndex<(int)dataTmp->size()*rate - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
     }
     return data;
@@ -885,16 +851,12 @@ RealVector<T> & RealFirFilter<T>::interp(RealVector<T> & data, int rate, bool tr
 
 template <class T>
 ComplexVector<T> & RealFirFilter<T>::interpComplex(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector< std::complex<T> > scratch;
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::interpComplex", data.size());
     std::vector< std::complex<T> > *dataTmp;
     std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &complexWorkBuf;
     }
     else {
         dataTmp = data.scratchBuf;
@@ -903,48 +865,12 @@ ComplexVector<T> & RealFirFilter<T>::interpComplex(ComplexVector<T> & data, int
     switch (filtOperation) {
 
     case STREAMING: {
-        int numTaps = (this->size() + rate - 1) / rate;
-        if (numSavedSamples >= numTaps) {
-            // First call to interp, have too many "saved" (really just the initial zeros) samples
-            numSavedSamples = numTaps - 1;
-            phase = (numTaps - 1) * rate;
-        }
-        
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        data.resize(dataTmp->size() * rate);
-        bool keepGoing = true;
-        for (resultIndex=0, dataStart=0, filterStart=phase; keepGoing; ++resultIndex) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-                if (dataTmp->size() - dataStart == numSavedSamples) {
-                    keepGoing = false;
-                    phase = filterStart;
-                }
-            }
-        }
-        data.resize(resultIndex);
-
-        int i;
-        for (i=0; dataStart<dataTmp->size(); i++, dataStart++) {
-            savedDataArray[i] = (*dataTmp)[dataStart];
-        }
-        numSavedSamples = i;
+        int dataLen = data.size();
+        data.resize(dataLen * rate);
+        const T *folded = foldInterp(rate);
+        data.resize(streamingFirInterp(VECTOR_TO_ARRAY(data.vec), dataLen, rate, polyphaseBanks(rate),
+                                       this->size(), savedDataArray, numSavedSamples, phase, *dataTmp,
+                                       VECTOR_TO_ARRAY(data.vec), folded, foldSymmetry));
         }
         break;
 
@@ -952,91 +878,16 @@ ComplexVector<T> & RealFirFilter<T>::interpComplex(ComplexVector<T> & data, int
         *dataTmp = data.vec;
         data.resize(data.size() * rate + this->size() - 1 - (rate - 1));
         
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (dataStart=0, filterStart=resultIndex; resultIndex<(int)dataTmp->size()*rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int) this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
 
     case ONE_SHOT_TRIM_TAILS:
         *dataTmp = data.vec;
         data.resize(data.size() * rate);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1 - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-       
-        // Middle full overlap
-        for (dataStart=0, filterStart=(int)this->size()-1; resultIndex<(int)dataTmp->size()*rate - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
     }
     return data;
@@ -1044,17 +895,13 @@ ComplexVector<T> & RealFirFilter<T>::interpComplex(ComplexVector<T> & data, int
 
 template <class T>
 RealVector<T> & RealFirFilter<T>::resample(RealVector<T> & data, int interpRate, int decimateRate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::resample", data.size());
     int interpLen, resampLen;
-    std::vector<T> scratch;
     std::vector<T> *dataTmp;
     T *savedDataArray = (T *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &workBuf;
     }
     else {
         dataTmp = data.scratchBuf;
@@ -1065,48 +912,16 @@ RealVector<T> & RealFirFilter<T>::resample(RealVector<T> & data, int interpRate,
     case STREAMING: {
         int numTaps = (this->size() + interpRate - 1) / interpRate;
         if (numSavedSamples >= numTaps) {
-            // First call to interp, have too many "saved" (really just the initial zeros) samples
+            // First call to resample, have too many "saved" (really just the initial zeros) samples
             numSavedSamples = numTaps - 1;
-            phase = (numTaps - 1) * interpRate;
-        }
-        
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
-        }
-        
-        interpLen = dataTmp->size() * interpRate;
-        resampLen = (interpLen + decimateRate - 1) / decimateRate;
-        data.resize(resampLen);
-        bool keepGoing = true;
-        for (resultIndex=0, dataStart=0, filterStart=phase; keepGoing; ++resultIndex) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-            if (dataTmp->size() - dataStart == numSavedSamples) {
-                keepGoing = false;
-                phase = filterStart;
-            }
+            phase = 0;
         }
-        data.resize(resultIndex);
         
-        int i;
-        for (i=0; dataStart<dataTmp->size(); i++, dataStart++) {
-            savedDataArray[i] = (*dataTmp)[dataStart];
-        }
-        numSavedSamples = i;
+        dataTmp->resize(((long) data.size() * interpRate + decimateRate - 1) / decimateRate + 1);
+        dataTmp->resize(streamingPolyphaseResample(data.vec.data(), data.size(), interpRate, decimateRate,
+                                                   polyphaseBanks(interpRate), numTaps, savedDataArray, phase,
+                                                   VECTOR_TO_ARRAY(*dataTmp)));
+        data.vec.swap(*dataTmp);
         }
         break;
 
@@ -1116,52 +931,8 @@ RealVector<T> & RealFirFilter<T>::resample(RealVector<T> & data, int interpRate,
         resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
         
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0, filterStart=0; resultIndex<((int)this->size()-1+decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
 
     case ONE_SHOT_TRIM_TAILS:
@@ -1169,55 +940,9 @@ RealVector<T> & RealFirFilter<T>::resample(RealVector<T> & data, int interpRate,
         interpLen = data.size() * interpRate;
         resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0, filterStart=initialTrim;
-             resultIndex<((int)this->size()-1 - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
     }
     return data;
@@ -1225,17 +950,13 @@ RealVector<T> & RealFirFilter<T>::resample(RealVector<T> & data, int interpRate,
 
 template <class T>
 ComplexVector<T> & RealFirFilter<T>::resampleComplex(ComplexVector<T> & data, int interpRate, int decimateRate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::resampleComplex", data.size());
     int interpLen, resampLen;
-    std::vector< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     std::complex<T> *savedDataArray = (std::complex<T> *) VECTOR_TO_ARRAY(savedData);
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = &complexWorkBuf;
     }
     else {
         dataTmp = data.scratchBuf;
@@ -1246,48 +967,16 @@ ComplexVector<T> & RealFirFilter<T>::resampleComplex(ComplexVector<T> & data, in
     case STREAMING: {
         int numTaps = (this->size() + interpRate - 1) / interpRate;
         if (numSavedSamples >= numTaps) {
-            // First call to interp, have too many "saved" (really just the initial zeros) samples
+            // First call to resample, have too many "saved" (really just the initial zeros) samples
             numSavedSamples = numTaps - 1;
-            phase = (numTaps - 1) * interpRate;
-        }
-        
-        dataTmp->resize(numSavedSamples + data.size());
-        for (int i=0; i<numSavedSamples; i++) {
-            (*dataTmp)[i] = savedDataArray[i];
-        }
-        for (int i=0; i<data.size(); i++) {
-            (*dataTmp)[i + numSavedSamples] = data[i];
+            phase = 0;
         }
         
-        interpLen = dataTmp->size() * interpRate;
-        resampLen = (interpLen + decimateRate - 1) / decimateRate;
-        data.resize(resampLen);
-        bool keepGoing = true;
-        for (resultIndex=0, dataStart=0, filterStart=phase; keepGoing; ++resultIndex) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-            if (dataTmp->size() - dataStart == numSavedSamples) {
-                keepGoing = false;
-                phase = filterStart;
-            }
-        }
-        data.resize(resultIndex);
-        
-        int i;
-        for (i=0; dataStart<dataTmp->size(); i++, dataStart++) {
-            savedDataArray[i] = (*dataTmp)[dataStart];
-        }
-        numSavedSamples = i;
+        dataTmp->resize(((long) data.size() * interpRate + decimateRate - 1) / decimateRate + 1);
+        dataTmp->resize(streamingPolyphaseResample(data.vec.data(), data.size(), interpRate, decimateRate,
+                                                   polyphaseBanks(interpRate), numTaps, savedDataArray, phase,
+                                                   VECTOR_TO_ARRAY(*dataTmp)));
+        data.vec.swap(*dataTmp);
         }
         break;
 
@@ -1297,52 +986,8 @@ ComplexVector<T> & RealFirFilter<T>::resampleComplex(ComplexVector<T> & data, in
         resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
         
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0, filterStart=0; resultIndex<((int)this->size()-1+decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
 
     case ONE_SHOT_TRIM_TAILS:
@@ -1350,55 +995,9 @@ ComplexVector<T> & RealFirFilter<T>::resampleComplex(ComplexVector<T> & data, in
         interpLen = data.size() * interpRate;
         resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0, filterStart=initialTrim;
-             resultIndex<((int)this->size()-1 - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
         break;
     }
     return data;
@@ -1430,6 +1029,28 @@ bool RealFirFilter<T>::firpm(int filterOrder, int numBands, double *freqPoints,
 }
 
 
+template <class T>
+bool RealFirFilter<T>::halfBandFilter(int numTaps, double passbandEdge) {
+    assert(numTaps % 4 == 3);
+    assert(passbandEdge > 0 && passbandEdge < 0.5);
+    
+    double freqPoints[] = {0, passbandEdge, 1 - passbandEdge, 1};
+    double desired[] = {1, 0};
+    double weight[] = {1, 1};
+    bool converged = firpm(numTaps - 1, 2, freqPoints, desired, weight);
+    
+    // Equal weights make the error symmetric about half the Nyquist frequency, so these taps only
+    // differ from their ideal values by the design's numerical error.
+    int center = numTaps / 2;
+    for (int i=0; i<numTaps; i++) {
+        if ((i - center) % 2 == 0) {
+            (*this)[i] = 0;
+        }
+    }
+    (*this)[center] = (T) 0.5;
+    return converged;
+}
+
 template <class T>
 void RealFirFilter<T>::fractionalDelayFilter(int numTaps, double bandwidth, double delay) {
     assert(bandwidth > 0 && bandwidth < 1.0);
@@ -1462,6 +1083,107 @@ void RealFirFilter<T>::fractionalDelayFilter(int numTaps, double bandwidth, doub
     hamming();
 }
 
+template <class T>
+VectorView<T> RealFirFilter<T>::conv(VectorView<T> data) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::conv", data.size());
+    assert(filtOperation == STREAMING);
+    reverseTaps();
+    streamingConv(data.data(), data.size(), workBuf, true, (T *) VECTOR_TO_ARRAY(savedData));
+    return data;
+}
+
+template <class T>
+VectorView< std::complex<T> > RealFirFilter<T>::conv(VectorView< std::complex<T> > data) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::convComplex", data.size());
+    assert(filtOperation == STREAMING);
+    reverseTaps();
+    streamingConv(data.data(), data.size(), complexWorkBuf, false, (std::complex<T> *) VECTOR_TO_ARRAY(savedData));
+    return data;
+}
+
+template <class T>
+VectorView<T> RealFirFilter<T>::decimate(VectorView<T> data, int rate) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::decimate", data.size());
+    assert(filtOperation == STREAMING);
+    reverseTaps();
+    return data.subview(0, streamingFirDecimate(data.data(), data.size(), rate, VECTOR_TO_ARRAY(reversedTaps),
+                        this->size(), (T *) VECTOR_TO_ARRAY(savedData), numSavedSamples, workBuf,
+                        data.data(), foldSymmetry));
+}
+
+template <class T>
+VectorView< std::complex<T> > RealFirFilter<T>::decimate(VectorView< std::complex<T> > data, int rate) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::decimateComplex", data.size());
+    assert(filtOperation == STREAMING);
+    reverseTaps();
+    return data.subview(0, streamingFirDecimate(data.data(), data.size(), rate, VECTOR_TO_ARRAY(reversedTaps),
+                        this->size(), (std::complex<T> *) VECTOR_TO_ARRAY(savedData), numSavedSamples,
+                        complexWorkBuf, data.data(), foldSymmetry));
+}
+
+template <class T>
+VectorView<T> RealFirFilter<T>::interp(VectorView<T> data, int rate, VectorView<T> results) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::interp", data.size());
+    assert(filtOperation == STREAMING);
+    assert(results.size() >= data.size() * rate);
+    const T *folded = foldInterp(rate);
+    return results.subview(0, streamingFirInterp(data.data(), data.size(), rate, polyphaseBanks(rate),
+                           this->size(), (T *) VECTOR_TO_ARRAY(savedData), numSavedSamples, phase, workBuf,
+                           results.data(), folded, foldSymmetry));
+}
+
+template <class T>
+VectorView< std::complex<T> > RealFirFilter<T>::interp(VectorView< std::complex<T> > data, int rate,
+                                                      VectorView< std::complex<T> > results) {
+    NIMBLEDSP_INSTRUMENT_MEMBER("RealFirFilter::interpComplex", data.size());
+    assert(filtOperation == STREAMING);
+    assert(results.size() >= data.size() * rate);
+    const T *folded = foldInterp(rate);
+    return results.subview(0, streamingFirInterp(data.data(), data.size(), rate, polyphaseBanks(rate),
+                           this->size(), (std::complex<T> *) VECTOR_TO_ARRAY(savedData), numSavedSamples, phase,
+                           complexWorkBuf, results.data(), folded, foldSymmetry));
+}
+
+/**
+ * \brief Streaming convolution of a view.  See RealFirFilter::conv.
+ */
+template <class T>
+inline VectorView<T> conv(VectorView<T> data, RealFirFilter<T> & filter) {
+    return filter.conv(data);
+}
+
+template <class T>
+inline VectorView< std::complex<T> > conv(VectorView< std::complex<T> > data, RealFirFilter<T> & filter) {
+    return filter.conv(data);
+}
+
+/**
+ * \brief Streaming decimation of a view.  See RealFirFilter::decimate.
+ */
+template <class T>
+inline VectorView<T> decimate(VectorView<T> data, int rate, RealFirFilter<T> & filter) {
+    return filter.decimate(data, rate);
+}
+
+template <class T>
+inline VectorView< std::complex<T> > decimate(VectorView< std::complex<T> > data, int rate, RealFirFilter<T> & filter) {
+    return filter.decimate(data, rate);
+}
+
+/**
+ * \brief Streaming interpolation of a view.  See RealFirFilter::interp.
+ */
+template <class T>
+inline VectorView<T> interp(VectorView<T> data, int rate, VectorView<T> results, RealFirFilter<T> & filter) {
+    return filter.interp(data, rate, results);
+}
+
+template <class T>
+inline VectorView< std::complex<T> > interp(VectorView< std::complex<T> > data, int rate,
+                                            VectorView< std::complex<T> > results, RealFirFilter<T> & filter) {
+    return filter.interp(data, rate, results);
+}
+
 template <class T>
 void RealFirFilter<T>::hamming() {
     T phase = -M_PI;
@@ -37,6 +37,30 @@ THE SOFTWARE.
 namespace NimbleDSP {
 
 
+/**
+ * \brief Shifts "value" right by "bits" bits, rounding the bits that are shifted off.
+ *
+ * NimbleDSP::ROUND_DOWN just shifts (rounds toward minus infinity).  NimbleDSP::ROUND_HALF_UP
+ * rounds to the nearest value with halves rounded up, and NimbleDSP::ROUND_HALF_EVEN rounds halves
+ * to the even value, which avoids a DC bias.
+ */
+template <class A>
+inline A roundedShift(A value, int bits, FixedPtRoundingType rounding) {
+    if (bits == 0) {
+        return value;
+    }
+    A half = ((A) 1) << (bits - 1);
+    switch (rounding) {
+        case ROUND_DOWN:
+            return value >> bits;
+        case ROUND_HALF_UP:
+            return (value + half) >> bits;
+        default:
+            // Halves round up only when that makes the result even.
+            return (value + half - 1 + ((value >> bits) & 1)) >> bits;
+    }
+}
+
 /**
  * \brief Vector class for real, fixed point (i.e. short's, int's, etc.) numbers.
  */
@@ -55,8 +79,8 @@ class RealFixedPtVector : public RealVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     RealFixedPtVector<T>(unsigned size = DEFAULT_BUF_LEN, std::vector<T> *scratch = NULL) :
             RealVector<T>(size, scratch) {}
@@ -71,8 +95,8 @@ class RealFixedPtVector : public RealVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     template <typename U>
     RealFixedPtVector<T>(std::vector<U> data, std::vector<T> *scratch = NULL) : RealVector<T>(data, scratch) {}
@@ -88,8 +112,8 @@ class RealFixedPtVector : public RealVector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     template <typename U>
     RealFixedPtVector<T>(U *data, unsigned dataLen, std::vector<T> *scratch = NULL) :
@@ -98,7 +122,12 @@ class RealFixedPtVector : public RealVector<T> {
     /**
      * \brief Copy constructor.
      */
-    RealFixedPtVector<T>(const RealFixedPtVector<T>& other) {this->vec = other.vec;}
+    RealFixedPtVector<T>(const RealFixedPtVector<T>& other) : RealVector<T>(other) {}
+    
+    /**
+     * \brief Move constructor.  Takes over the contents of "other" without copying them.
+     */
+    RealFixedPtVector<T>(RealFixedPtVector<T>&& other) : RealVector<T>(std::move(other)) {}
     
     /*****************************************************************************************
                                             Operators
@@ -108,6 +137,17 @@ class RealFixedPtVector : public RealVector<T> {
      */
     RealFixedPtVector<T>& operator=(const Vector<T>& rhs);
     
+    /**
+     * \brief Copy assignment operator.
+     */
+    RealFixedPtVector<T>& operator=(const RealFixedPtVector<T>& rhs) {RealVector<T>::operator=(rhs); return *this;}
+    
+    /**
+     * \brief Move assignment operator.
+     */
+    RealFixedPtVector<T>& operator=(RealFixedPtVector<T>&& rhs)
+            {RealVector<T>::operator=(std::move(rhs)); return *this;}
+    
     /**
      * \brief Pre-increment operator.
      */
@@ -208,7 +248,7 @@ class RealFixedPtVector : public RealVector<T> {
      * \param exponent Exponent to use.
      * \return Reference to "this".
      */
-    RealVector<T> & pow(const SLICKDSP_FLOAT_TYPE exponent);
+    RealVector<T> & pow(const typename FloatTypeTraits<T>::type exponent);
     
     /**
      * \brief Returns the mode of the data in \ref buf.
@@ -508,7 +548,7 @@ inline RealFixedPtVector<T> operator<<(RealFixedPtVector<T> lhs, const T& rhs)
 }
 
 template <class T>
-RealVector<T> & RealFixedPtVector<T>::pow(const SLICKDSP_FLOAT_TYPE exponent) {
+RealVector<T> & RealFixedPtVector<T>::pow(const typename FloatTypeTraits<T>::type exponent) {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = (T) std::round(std::pow(this->vec[i], exponent));
     }
@@ -518,11 +558,11 @@ RealVector<T> & RealFixedPtVector<T>::pow(const SLICKDSP_FLOAT_TYPE exponent) {
 template <class T>
 const T RealFixedPtVector<T>::mode() {
     assert(this->size() > 0);
-    std::vector<T> tempScratch;
+    ScratchBuffer<T> tempScratch;
     std::vector<T> *scratch;
 
     if (this->scratchBuf == NULL) {
-        scratch = &tempScratch;
+        scratch = tempScratch.get();
     }
     else {
         scratch = this->scratchBuf;
@@ -32,15 +32,22 @@ THE SOFTWARE.
 
 #include "Vector.h"
 #include "ComplexVector.h"
+#include "VectorExpression.h"
+#include "SimdKernels.h"
+#include "FastMath.h"
 
 
 namespace NimbleDSP {
 
 /**
  * \brief Vector class for real numbers.
+ *
+ * \tparam Allocator Allocator for the samples (see Vector).  Arithmetic, statistics and the conv family
+ *      work with any allocator.  The methods that take a ComplexVector, like convComplex and fft, and the
+ *      filter classes use vectors with the default allocator.
  */
-template <class T>
-class RealVector : public Vector<T> {
+template <class T, class Allocator = std::allocator<T> >
+class RealVector : public Vector<T, Allocator> {
  public:
     /*****************************************************************************************
                                         Constructors
@@ -54,10 +61,11 @@ class RealVector : public Vector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
-    RealVector<T>(unsigned size = DEFAULT_BUF_LEN, std::vector<T> *scratch = NULL) : Vector<T>(size, scratch) {}
+    RealVector<T, Allocator>(unsigned size = DEFAULT_BUF_LEN, std::vector<T> *scratch = NULL) :
+            Vector<T, Allocator>(size, scratch) {}
     
     /**
      * \brief Vector constructor.
@@ -69,11 +77,12 @@ class RealVector : public Vector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     template <typename U>
-    RealVector<T>(std::vector<U> data, std::vector<T> *scratch = NULL) : Vector<T>(data, scratch) {}
+    RealVector<T, Allocator>(std::vector<U> data, std::vector<T> *scratch = NULL) :
+            Vector<T, Allocator>(data, scratch) {}
     
     /**
      * \brief Array constructor.
@@ -86,16 +95,33 @@ class RealVector : public Vector<T> {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     template <typename U>
-    RealVector<T>(U *data, unsigned dataLen, std::vector<T> *scratch = NULL) : Vector<T>(data, dataLen, scratch) {}
+    RealVector<T, Allocator>(U *data, unsigned dataLen, std::vector<T> *scratch = NULL) :
+            Vector<T, Allocator>(data, dataLen, scratch) {}
     
     /**
      * \brief Copy constructor.
      */
-    RealVector<T>(const RealVector<T>& other) {this->vec = other.vec;}
+    RealVector<T, Allocator>(const RealVector<T, Allocator>& other) : Vector<T, Allocator>(other) {}
+    
+    /**
+     * \brief Move constructor.  Takes over the contents of "other" without copying them.
+     */
+    RealVector<T, Allocator>(RealVector<T, Allocator>&& other) : Vector<T, Allocator>(std::move(other)) {}
+    
+    /**
+     * \brief Expression constructor.  Evaluates "expr" (see \ref lazy) in a single pass.
+     *
+     * \param expr The expression.
+     * \param scratch Pointer to a scratch buffer.
+     */
+    template <class E>
+    RealVector<T, Allocator>(const VectorExpression<E> & expr, std::vector<T> *scratch = NULL) :
+            Vector<T, Allocator>(0, scratch)
+            {evaluate(expr, this->vec);}
     
     /*****************************************************************************************
                                             Operators
@@ -103,56 +129,99 @@ class RealVector : public Vector<T> {
     /**
      * \brief Assignment operator.
      */
-    RealVector<T>& operator=(const Vector<T>& rhs) {this->vec = rhs.vec; return *this;}
+    RealVector<T, Allocator>& operator=(const Vector<T, Allocator>& rhs) {this->vec = rhs.vec; return *this;}
+    
+    /**
+     * \brief Copy assignment operator.
+     */
+    RealVector<T, Allocator>& operator=(const RealVector<T, Allocator>& rhs)
+            {Vector<T, Allocator>::operator=(rhs); return *this;}
+    
+    /**
+     * \brief Move assignment operator.
+     */
+    RealVector<T, Allocator>& operator=(RealVector<T, Allocator>&& rhs)
+            {Vector<T, Allocator>::operator=(std::move(rhs)); return *this;}
+    
+    /**
+     * \brief Expression assignment operator.  Evaluates "expr" (see \ref lazy) in a single pass.
+     *      "this" may appear in the expression.
+     */
+    template <class E>
+    RealVector<T, Allocator>& operator=(const VectorExpression<E> & expr) {evaluate(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Adds an expression to "this" in a single pass.
+     */
+    template <class E>
+    RealVector<T, Allocator>& operator+=(const VectorExpression<E> & expr) {evaluateWith<AddOperation>(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Subtracts an expression from "this" in a single pass.
+     */
+    template <class E>
+    RealVector<T, Allocator>& operator-=(const VectorExpression<E> & expr) {evaluateWith<SubtractOperation>(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Multiplies "this" by an expression in a single pass.
+     */
+    template <class E>
+    RealVector<T, Allocator>& operator*=(const VectorExpression<E> & expr) {evaluateWith<MultiplyOperation>(expr, this->vec); return *this;}
+    
+    /**
+     * \brief Divides "this" by an expression in a single pass.
+     */
+    template <class E>
+    RealVector<T, Allocator>& operator/=(const VectorExpression<E> & expr) {evaluateWith<DivideOperation>(expr, this->vec); return *this;}
     
     /**
      * \brief Unary minus (negation) operator.
      */
-    RealVector<T> & operator-();
+    RealVector<T, Allocator> & operator-();
     
     /**
      * \brief Add Buffer/Assignment operator.
      */
-    template <class U>
-    RealVector<T> & operator+=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    RealVector<T, Allocator> & operator+=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Add Scalar/Assignment operator.
      */
-    RealVector<T> & operator+=(const T &rhs);
+    RealVector<T, Allocator> & operator+=(const T &rhs);
     
     /**
      * \brief Subtract Buffer/Assignment operator.
      */
-    template <class U>
-    RealVector<T> & operator-=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    RealVector<T, Allocator> & operator-=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Subtract Scalar/Assignment operator.
      */
-    RealVector<T> & operator-=(const T &rhs);
+    RealVector<T, Allocator> & operator-=(const T &rhs);
     
     /**
      * \brief Multiply Buffer/Assignment operator.
      */
-    template <class U>
-    RealVector<T> & operator*=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    RealVector<T, Allocator> & operator*=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Multiply Scalar/Assignment operator.
      */
-    RealVector<T> & operator*=(const T &rhs);
+    RealVector<T, Allocator> & operator*=(const T &rhs);
 
     /**
      * \brief Divide Buffer/Assignment operator.
      */
-    template <class U>
-    RealVector<T> & operator/=(const Vector<U> &rhs);
+    template <class U, class UAllocator>
+    RealVector<T, Allocator> & operator/=(const Vector<U, UAllocator> &rhs);
     
     /**
      * \brief Divide Scalar/Assignment operator.
      */
-    RealVector<T> & operator/=(const T &rhs);
+    RealVector<T, Allocator> & operator/=(const T &rhs);
     
     /*****************************************************************************************
                                              Methods
@@ -163,25 +232,37 @@ class RealVector : public Vector<T> {
      * \param exponent Exponent to use.
      * \return Reference to "this".
      */
-    RealVector<T> & pow(const SLICKDSP_FLOAT_TYPE exponent);
+    RealVector<T, Allocator> & pow(const typename FloatTypeTraits<T>::type exponent);
     
     /**
      * \brief Returns the mean (average) of the data in \ref buf.
+     *
+     * \tparam A The type that the sum is accumulated in and returned in.  See FloatTypeTraits.
      */
-    const SLICKDSP_FLOAT_TYPE mean() const;
+    template <class A = typename FloatTypeTraits<T>::type>
+    const A mean() const;
     
     /**
      * \brief Returns the variance of the data in \ref buf.
+     *
+     * \tparam A The type that the sums are accumulated in and returned in.  See FloatTypeTraits.
      */
-    const SLICKDSP_FLOAT_TYPE var() const;
+    template <class A = typename FloatTypeTraits<T>::type>
+    const A var() const;
     
     /**
      * \brief Returns the standard deviation of the data in \ref buf.
+     *
+     * \tparam A The type that the sums are accumulated in and returned in.  See FloatTypeTraits.
      */
-    const SLICKDSP_FLOAT_TYPE stdDev() const {return std::sqrt(this->var());}
+    template <class A = typename FloatTypeTraits<T>::type>
+    const A stdDev() const {return std::sqrt(this->template var<A>());}
     
     /**
      * \brief Returns the median element of \ref buf.
+     *
+     * Uses a selection algorithm (std::nth_element), so it takes linear time.  The selection is done
+     * in a copy of the data, which goes in \ref scratchBuf if there is one.
      */
     const T median();
     
@@ -213,7 +294,7 @@ class RealVector : public Vector<T> {
      *      any that are less than -val are made equal to -val.
      * \return Reference to "this".
      */
-    RealVector<T> & saturate(T val);
+    RealVector<T, Allocator> & saturate(T val);
     
     /**
      * \brief Convolution method for complex data.
@@ -272,33 +353,77 @@ class RealVector : public Vector<T> {
      */
     virtual ComplexVector<T> & resampleComplex(ComplexVector<T> & data, int interpRate, int decimateRate, bool trimTails = false);
     
+    /**
+     * \brief Computes the FFT of the data in \ref vec.
+     *
+     * Since the data is real only the size()/2 + 1 non-negative frequency bins are computed; the
+     * rest are their complex conjugates.  Uses the calling thread's cached plan for this size
+     * (see NimbleDSP::realFftPlan).  \ref vec is not modified.
+     * \param spectrum Resized to size()/2 + 1 and set equal to the half spectrum.  Its domain is
+     *      set to NimbleDSP::FREQUENCY_DOMAIN.
+     * \return Reference to "spectrum".
+     */
+    ComplexVector<T> & fft(ComplexVector<T> & spectrum) {return fft(spectrum, realFftPlan<T>(this->size(), false));}
+    
+    /**
+     * \brief Computes the FFT of the data in \ref vec using "plan".
+     *
+     * \param spectrum Resized to size()/2 + 1 and set equal to the half spectrum.
+     * \param plan Forward real FFT plan with the same size as \ref vec.
+     * \return Reference to "spectrum".
+     */
+    ComplexVector<T> & fft(ComplexVector<T> & spectrum, RealFftPlan<T> & plan);
+    
+    /**
+     * \brief Sets \ref vec equal to the inverse FFT of a half spectrum.
+     *
+     * The inverse of \ref fft.  Like ComplexVector::ifft the result is not scaled by 1/N.
+     * \param spectrum The size()/2 + 1 non-negative frequency bins.
+     * \param numSamples Number of samples to produce.  Must be 2*(spectrum.size() - 1) or one more
+     *      than that.  "0" means 2*(spectrum.size() - 1).
+     * \return Reference to "this".
+     */
+    RealVector<T, Allocator> & ifft(const ComplexVector<T> & spectrum, unsigned numSamples = 0);
+    
+    /**
+     * \brief Sets \ref vec equal to the inverse FFT of a half spectrum using "plan".
+     *
+     * \param spectrum The plan.size()/2 + 1 non-negative frequency bins.
+     * \param plan Inverse real FFT plan.  \ref vec is resized to plan.size().
+     * \return Reference to "this".
+     */
+    RealVector<T, Allocator> & ifft(const ComplexVector<T> & spectrum, RealFftPlan<T> & plan);
+    
     /**
      * \brief Changes the elements of \ref vec to their absolute value.
      *
      * \return Reference to "this".
      */
-    RealVector<T> & abs();
+    RealVector<T, Allocator> & abs();
     
     /**
      * \brief Sets each element of \ref vec to e^(element).
      *
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastExp.  Defaults to NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    RealVector<T> & exp();
+    RealVector<T, Allocator> & exp(MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Sets each element of \ref vec to the natural log of the element.
      *
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastLog.  Defaults to NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    RealVector<T> & log();
+    RealVector<T, Allocator> & log(MathAccuracyType accuracy = EXACT_MATH);
     
     /**
      * \brief Sets each element of \ref vec to the base 10 log of the element.
      *
+     * \param accuracy NimbleDSP::FAST_MATH uses \ref fastLog.  Defaults to NimbleDSP::EXACT_MATH.
      * \return Reference to "this".
      */
-    RealVector<T> & log10();
+    RealVector<T, Allocator> & log10(MathAccuracyType accuracy = EXACT_MATH);
 
     /**
      * \brief Circular rotation.
@@ -309,14 +434,14 @@ class RealVector : public Vector<T> {
      *      the left, and negative values shift it to the right.
      * \return Reference to "this".
      */
-    RealVector<T> & rotate(int numToShift);
+    RealVector<T, Allocator> & rotate(int numToShift);
     
     /**
      * \brief Reverses the order of the elements in \ref vec.
      *
      * \return Reference to "this".
      */
-    RealVector<T> & reverse();
+    RealVector<T, Allocator> & reverse();
 
     /**
      * \brief Sets the length of \ref vec to "len".
@@ -327,7 +452,7 @@ class RealVector : public Vector<T> {
      * \param val The value to set any new elements to.  Defaults to 0.
      * \return Reference to "this".
      */
-    RealVector<T> & resize(unsigned len, T val = (T) 0) {this->vec.resize(len, val); return *this;}
+    RealVector<T, Allocator> & resize(unsigned len, T val = (T) 0) {this->vec.resize(len, val); return *this;}
     
     /**
      * \brief Lengthens \ref vec by "len" elements.
@@ -336,7 +461,7 @@ class RealVector : public Vector<T> {
      * \param val The value to set the new elements to.  Defaults to 0.
      * \return Reference to "this".
      */
-    RealVector<T> & pad(unsigned len, T val = (T) 0) {this->vec.resize(this->size()+len, val); return *this;}
+    RealVector<T, Allocator> & pad(unsigned len, T val = (T) 0) {this->vec.resize(this->size()+len, val); return *this;}
     
     /**
      * \brief Inserts rate-1 zeros between samples.
@@ -346,7 +471,7 @@ class RealVector : public Vector<T> {
      *      after).  Valid values are 0 to "rate"-1.  Defaults to 0.
      * \return Reference to "this".
      */
-    RealVector<T> & upsample(int rate, int phase = 0);
+    RealVector<T, Allocator> & upsample(int rate, int phase = 0);
     
     /**
      * \brief Removes rate-1 samples out of every rate samples.
@@ -356,7 +481,7 @@ class RealVector : public Vector<T> {
      *      are 0 to "rate"-1.  Defaults to 0.
      * \return Reference to "this".
      */
-    RealVector<T> & downsample(int rate, int phase = 0);
+    RealVector<T, Allocator> & downsample(int rate, int phase = 0);
     
     /**
      * \brief Replaces \ref vec with the cumulative sum of the samples in \ref vec.
@@ -364,7 +489,19 @@ class RealVector : public Vector<T> {
      * \param initialVal Initializing value for the cumulative sum.  Defaults to zero.
      * \return Reference to "this".
      */
-	RealVector<T> & cumsum(T initialVal = 0);
+	RealVector<T, Allocator> & cumsum(T initialVal = 0);
+    
+    /**
+     * \brief Replaces \ref vec with the cumulative sum of an expression, evaluating the
+     *      expression and the sum in a single pass.
+     *
+     * For example "buf.cumsum(lazy(buf) * k)" does the work of "buf *= k; buf.cumsum();".
+     * \param expr The expression (see \ref lazy).  It may refer to "this".
+     * \param initialVal Initializing value for the cumulative sum.  Defaults to zero.
+     * \return Reference to "this".
+     */
+    template <class E>
+	RealVector<T, Allocator> & cumsum(const VectorExpression<E> & expr, T initialVal = 0);
     
     /**
      * \brief Replaces \ref vec with the difference between successive samples in vec.
@@ -372,7 +509,7 @@ class RealVector : public Vector<T> {
      * The resulting \ref vec is one element shorter than it was previously.
      * \return Reference to "this".
      */
-	RealVector<T> & diff();
+	RealVector<T, Allocator> & diff();
     
     /**
      * \brief Replaces \ref vec with the difference between successive samples in vec.
@@ -382,7 +519,7 @@ class RealVector : public Vector<T> {
      *      previous vec.
      * \return Reference to "this".
      */
-    RealVector<T> & diff(T & previousVal);
+    RealVector<T, Allocator> & diff(T & previousVal);
     
     /**
      * \brief Convolution method.
@@ -394,7 +531,7 @@ class RealVector : public Vector<T> {
      *      the convolution.
      * \return Reference to "data", which holds the result of the convolution.
      */
-    virtual RealVector<T> & conv(RealVector<T> & data, bool trimTails = false);
+    virtual RealVector<T, Allocator> & conv(RealVector<T, Allocator> & data, bool trimTails = false);
     
     /**
      * \brief Decimate method.
@@ -409,7 +546,7 @@ class RealVector : public Vector<T> {
      *      ends of the convolution.
      * \return Reference to "data", which holds the result of the decimation.
      */
-    virtual RealVector<T> & decimate(RealVector<T> & data, int rate, bool trimTails = false);
+    virtual RealVector<T, Allocator> & decimate(RealVector<T, Allocator> & data, int rate, bool trimTails = false);
     
     /**
      * \brief Interpolation method.
@@ -423,7 +560,7 @@ class RealVector : public Vector<T> {
      *      ends of the convolution.
      * \return Reference to "data", which holds the result of the interpolation.
      */
-    virtual RealVector<T> & interp(RealVector<T> & data, int rate, bool trimTails = false);
+    virtual RealVector<T, Allocator> & interp(RealVector<T, Allocator> & data, int rate, bool trimTails = false);
     
     /**
      * \brief Resample method.
@@ -439,7 +576,8 @@ class RealVector : public Vector<T> {
      *      ends of the convolution.
      * \return Reference to "data", which holds the result of the resampling.
      */
-    virtual RealVector<T> & resample(RealVector<T> & data, int interpRate, int decimateRate, bool trimTails = false);
+    virtual RealVector<T, Allocator> & resample(RealVector<T, Allocator> & data, int interpRate, int decimateRate,
+                bool trimTails = false);
     
     /**
      * \brief Generates a complex tone.
@@ -464,8 +602,8 @@ class RealVector : public Vector<T> {
     T modulate(T freq, T sampleFreq = 1.0, T phase = 0.0);
 };
 
-template <class T>
-RealVector<T> & RealVector<T>::pow(const SLICKDSP_FLOAT_TYPE exponent) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::pow(const typename FloatTypeTraits<T>::type exponent) {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = (T) std::pow(this->vec[i], exponent);
     }
@@ -479,48 +617,50 @@ RealVector<T> & RealVector<T>::pow(const SLICKDSP_FLOAT_TYPE exponent) {
  * \param exponent Exponent to use.
  * \return Reference to "buffer".
  */
-template <class T>
-RealVector<T> & pow(RealVector<T> & buffer, const SLICKDSP_FLOAT_TYPE exponent) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & pow(RealVector<T, Allocator> & buffer, const typename FloatTypeTraits<T>::type exponent) {
     return buffer.pow(exponent);
 }
 
-template <class T>
-const SLICKDSP_FLOAT_TYPE RealVector<T>::mean() const {
+template <class T, class Allocator>
+template <class A>
+const A RealVector<T, Allocator>::mean() const {
     assert(this->size() > 0);
-    SLICKDSP_FLOAT_TYPE sum = 0;
+    A sum = 0;
     for (unsigned i=0; i<this->size(); i++) {
-        sum += this->vec[i];
+        sum += (A) this->vec[i];
     }
-    return sum / this->size();
+    return sum / (A) this->size();
 }
 
 /**
  * \brief Returns the mean (average) of the data in "buffer".
  * \param buffer The buffer to operate on.
  */
-template <class T>
-const SLICKDSP_FLOAT_TYPE mean(RealVector<T> & buffer) {
+template <class T, class Allocator>
+const typename FloatTypeTraits<T>::type mean(RealVector<T, Allocator> & buffer) {
     return buffer.mean();
 }
 
-template <class T>
-const SLICKDSP_FLOAT_TYPE RealVector<T>::var() const {
+template <class T, class Allocator>
+template <class A>
+const A RealVector<T, Allocator>::var() const {
     assert(this->size() > 1);
-    SLICKDSP_FLOAT_TYPE meanVal = mean();
-    SLICKDSP_FLOAT_TYPE sum = 0;
+    A meanVal = this->template mean<A>();
+    A sum = 0;
     for (unsigned i=0; i<this->size(); i++) {
-        SLICKDSP_FLOAT_TYPE varDiff = ((SLICKDSP_FLOAT_TYPE) this->vec[i]) - meanVal;
+        A varDiff = ((A) this->vec[i]) - meanVal;
         sum += varDiff * varDiff;
     }
-    return sum / (this->size() - 1);
+    return sum / (A) (this->size() - 1);
 }
 
 /**
  * \brief Returns the variance of the data in "buffer".
  * \param buffer The buffer to operate on.
  */
-template <class T>
-const SLICKDSP_FLOAT_TYPE var(RealVector<T> & buffer) {
+template <class T, class Allocator>
+const typename FloatTypeTraits<T>::type var(RealVector<T, Allocator> & buffer) {
     return buffer.var();
 }
 
@@ -528,24 +668,29 @@ const SLICKDSP_FLOAT_TYPE var(RealVector<T> & buffer) {
  * \brief Returns the standard deviation of the data in "buffer".
  * \param buffer The buffer to operate on.
  */
-template <class T>
-const SLICKDSP_FLOAT_TYPE stdDev(RealVector<T> & buffer) {
+template <class T, class Allocator>
+const typename FloatTypeTraits<T>::type stdDev(RealVector<T, Allocator> & buffer) {
     return buffer.stdDev();
 }
 
-template <class T>
-const T RealVector<T>::median() {
+template <class T, class Allocator>
+const T RealVector<T, Allocator>::median() {
     assert(this->size() > 0);
-    std::vector<T> scratchBuf = this->vec;
-    std::sort(scratchBuf.begin(), scratchBuf.end());
+    ScratchBuffer<T> scratch;
+    std::vector<T> *scratchBuf = (this->scratchBuf == NULL) ? scratch.get() : this->scratchBuf;
+    scratchBuf->assign(this->vec.begin(), this->vec.end());
+    
+    unsigned topHalfIndex = this->size()/2;
+    typename std::vector<T>::iterator middle = scratchBuf->begin() + topHalfIndex;
+    std::nth_element(scratchBuf->begin(), middle, scratchBuf->end());
     if (this->size() & 1) {
         // Odd number of samples
-        return scratchBuf[this->size()/2];
+        return *middle;
     }
     else {
-        // Even number of samples.  Average the two in the middle.
-        unsigned topHalfIndex = this->size()/2;
-        return (scratchBuf[topHalfIndex] + scratchBuf[topHalfIndex-1]) / ((T) 2);
+        // Even number of samples.  Average the two in the middle.  nth_element leaves the smaller
+        // half in front of "middle", so the other one is the largest of those.
+        return (*middle + *std::max_element(scratchBuf->begin(), middle)) / ((T) 2);
     }
 }
 
@@ -553,13 +698,13 @@ const T RealVector<T>::median() {
  * \brief Returns the median element of "buffer".
  * \param buffer The buffer to operate on.
  */
-template <class T>
-const T median(RealVector<T> & buffer) {
+template <class T, class Allocator>
+const T median(RealVector<T, Allocator> & buffer) {
     return buffer.median();
 }
 
-template <class T>
-const T RealVector<T>::max(unsigned *maxLoc) const {
+template <class T, class Allocator>
+const T RealVector<T, Allocator>::max(unsigned *maxLoc) const {
     assert(this->size() > 0);
     T maxVal = this->vec[0];
     unsigned maxIndex = 0;
@@ -586,13 +731,13 @@ const T RealVector<T>::max(unsigned *maxLoc) const {
  *      to the maximum value the index of the first will be returned.
  *      Defaults to NULL.
  */
-template <class T>
-const T max(RealVector<T> & buffer, unsigned *maxLoc = NULL) {
+template <class T, class Allocator>
+const T max(RealVector<T, Allocator> & buffer, unsigned *maxLoc = NULL) {
     return buffer.max(maxLoc);
 }
 
-template <class T>
-const T RealVector<T>::min(unsigned *minLoc) const {
+template <class T, class Allocator>
+const T RealVector<T, Allocator>::min(unsigned *minLoc) const {
     assert(this->size() > 0);
     T minVal = this->vec[0];
     unsigned minIndex = 0;
@@ -618,13 +763,13 @@ const T RealVector<T>::min(unsigned *minLoc) const {
  *      to the minimum value the index of the first will be returned.
  *      Defaults to NULL.
  */
-template <class T>
-const T min(RealVector<T> & buffer, unsigned *minLoc = NULL) {
+template <class T, class Allocator>
+const T min(RealVector<T, Allocator> & buffer, unsigned *minLoc = NULL) {
     return buffer.min(minLoc);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::saturate(T val) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::saturate(T val) {
     for (unsigned i=0; i<this->size(); i++) {
         if (this->vec[i] > val)
             this->vec[i] = val;
@@ -643,83 +788,36 @@ RealVector<T> & RealVector<T>::saturate(T val) {
  *      any that are less than -val are made equal to -val.
  * \return Reference to "buffer".
  */
-template <class T>
-RealVector<T> & saturate(RealVector<T> & buffer, T val) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & saturate(RealVector<T, Allocator> & buffer, T val) {
     return buffer.saturate(val);
 }
 
-template <class T>
-ComplexVector<T> & RealVector<T>::convComplex(ComplexVector<T> & data, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T> & RealVector<T, Allocator>::convComplex(ComplexVector<T> & data, bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
+    ScratchBuffer<T> reversedTaps;
+    reversedTaps->assign(this->vec.rbegin(), this->vec.rend());
     if (trimTails) {
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<((int)this->size()-1) - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size() - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), 1, initialTrim,
+                   data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(data.size() + this->size() - 1);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -735,85 +833,37 @@ ComplexVector<T> & RealVector<T>::convComplex(ComplexVector<T> & data, bool trim
  *      the convolution.
  * \return Reference to "data", which holds the result of the convolution.
  */
-template <class T>
-inline ComplexVector<T> & conv(ComplexVector<T> & data, RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T> & conv(ComplexVector<T> & data, RealVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.convComplex(data, trimTails);
 }
 
-template <class T>
-ComplexVector<T> & RealVector<T>::decimateComplex(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T> & RealVector<T, Allocator>::decimateComplex(ComplexVector<T> & data, int rate, bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
+    ScratchBuffer<T> reversedTaps;
+    reversedTaps->assign(this->vec.rbegin(), this->vec.rend());
     if (trimTails) {
         data.resize((data.size() + rate - 1) / rate);
-        
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<(((int)this->size()-1) - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size() - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), rate, initialTrim,
+                   data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<((int)this->size()-1+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), rate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -832,114 +882,35 @@ ComplexVector<T> & RealVector<T>::decimateComplex(ComplexVector<T> & data, int r
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the decimation.
  */
-template <class T>
-inline ComplexVector<T> & decimate(ComplexVector<T> & data, int rate, RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T> & decimate(ComplexVector<T> & data, int rate, RealVector<T, Allocator> & filter,
+            bool trimTails = false) {
     return filter.decimateComplex(data, rate, trimTails);
 }
 
-template <class T>
-ComplexVector<T> & RealVector<T>::interpComplex(ComplexVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T> & RealVector<T, Allocator>::interpComplex(ComplexVector<T> & data, int rate, bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
     if (trimTails) {
         data.resize(data.size() * rate);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1 - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-       
-        // Middle full overlap
-        for (dataStart=0, filterStart=(int)this->size()-1; resultIndex<(int)dataTmp->size()*rate - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(data.size() * rate + this->size() - 1 - (rate - 1));
-        
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (dataStart=0, filterStart=resultIndex; resultIndex<(int)dataTmp->size()*rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int) this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -957,133 +928,39 @@ ComplexVector<T> & RealVector<T>::interpComplex(ComplexVector<T> & data, int rat
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the interpolation.
  */
-template <class T>
-inline ComplexVector<T> & interp(ComplexVector<T> & data, int rate, RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline ComplexVector<T> & interp(ComplexVector<T> & data, int rate, RealVector<T, Allocator> & filter,
+            bool trimTails = false) {
     return filter.interpComplex(data, rate, trimTails);
 }
 
-template <class T>
-ComplexVector<T> & RealVector<T>::resampleComplex(ComplexVector<T> & data, int interpRate, int decimateRate,  bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector< std::complex<T> > scratch;
+template <class T, class Allocator>
+ComplexVector<T> & RealVector<T, Allocator>::resampleComplex(ComplexVector<T> & data, int interpRate, int decimateRate,  bool trimTails) {
+    ScratchBuffer< std::complex<T> > scratch;
     std::vector< std::complex<T> > *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
     if (trimTails) {
         int interpLen = data.size() * interpRate;
         int resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0, filterStart=initialTrim;
-             resultIndex<((int)this->size()-1 - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         int interpLen = data.size() * interpRate + this->size() - 1 - (interpRate - 1);
         int resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-        
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0, filterStart=0; resultIndex<((int)this->size()-1+decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1103,14 +980,14 @@ ComplexVector<T> & RealVector<T>::resampleComplex(ComplexVector<T> & data, int i
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the resampling.
  */
-template <class T>
+template <class T, class Allocator>
 inline ComplexVector<T> & resample(ComplexVector<T> & data, int interpRate, int decimateRate,
-            RealVector<T> & filter, bool trimTails = false) {
+            RealVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.resampleComplex(data, interpRate, decimateRate, trimTails);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::abs() {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::abs() {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = (T) std::abs(this->vec[i]);
     }
@@ -1123,13 +1000,19 @@ RealVector<T> & RealVector<T>::abs() {
  * \param vector Buffer to operate on.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & abs(RealVector<T> & vector) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & abs(RealVector<T, Allocator> & vector) {
     return vector.abs();
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::exp() {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::exp(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        for (unsigned i=0; i<this->size(); i++) {
+            this->vec[i] = fastExp(this->vec[i]);
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = (T) std::exp(this->vec[i]);
     }
@@ -1140,15 +1023,22 @@ RealVector<T> & RealVector<T>::exp() {
  * \brief Sets each element of \ref vec to e^(element).
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See RealVector::exp.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & exp(RealVector<T> & vector) {
-    return vector.exp();
+template <class T, class Allocator>
+RealVector<T, Allocator> & exp(RealVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.exp(accuracy);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::log() {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::log(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        for (unsigned i=0; i<this->size(); i++) {
+            this->vec[i] = fastLog(this->vec[i]);
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
 		this->vec[i] = (T) std::log(this->vec[i]);
     }
@@ -1159,15 +1049,22 @@ RealVector<T> & RealVector<T>::log() {
  * \brief Sets each element of \ref vec to the natural log of the element.
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See RealVector::log.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & log(RealVector<T> & vector) {
-    return vector.log();
+template <class T, class Allocator>
+RealVector<T, Allocator> & log(RealVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.log(accuracy);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::log10() {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::log10(MathAccuracyType accuracy) {
+    if (accuracy == FAST_MATH) {
+        for (unsigned i=0; i<this->size(); i++) {
+            this->vec[i] = (T) (fastLog(this->vec[i]) * 0.4342944819032518);
+        }
+        return *this;
+    }
     for (unsigned i=0; i<this->size(); i++) {
 		this->vec[i] = (T) std::log10(this->vec[i]);
     }
@@ -1178,15 +1075,16 @@ RealVector<T> & RealVector<T>::log10() {
  * \brief Sets each element of \ref vec to the base 10 log of the element.
  *
  * \param vector Buffer to operate on.
+ * \param accuracy See RealVector::log10.  Defaults to NimbleDSP::EXACT_MATH.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & log10(RealVector<T> & vector) {
-    return vector.log10();
+template <class T, class Allocator>
+RealVector<T, Allocator> & log10(RealVector<T, Allocator> & vector, MathAccuracyType accuracy = EXACT_MATH) {
+    return vector.log10(accuracy);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::rotate(int numToShift) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::rotate(int numToShift) {
     while (numToShift < 0)
         numToShift += this->size();
     
@@ -1210,13 +1108,13 @@ RealVector<T> & RealVector<T>::rotate(int numToShift) {
  *      the left, and negative values shift it to the right.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & rotate(RealVector<T> & vector, int numToShift) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & rotate(RealVector<T, Allocator> & vector, int numToShift) {
     return vector.rotate(numToShift);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::reverse() {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::reverse() {
     std::reverse(this->vec.begin(), this->vec.end());
     return *this;
 }
@@ -1227,8 +1125,8 @@ RealVector<T> & RealVector<T>::reverse() {
  * \param vector Buffer to operate on.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & reverse(RealVector<T> & vector) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & reverse(RealVector<T, Allocator> & vector) {
     return vector.reverse();
 }
 
@@ -1242,8 +1140,8 @@ RealVector<T> & reverse(RealVector<T> & vector) {
  * \param val The value to set any new elements to.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & resize(RealVector<T> & vector, int len, T val = 0) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & resize(RealVector<T, Allocator> & vector, int len, T val = 0) {
     return vector.resize(len, val);
 }
 
@@ -1255,13 +1153,13 @@ RealVector<T> & resize(RealVector<T> & vector, int len, T val = 0) {
  * \param val The value to set the new elements to.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & pad(RealVector<T> & vector, int len, T val = 0) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & pad(RealVector<T, Allocator> & vector, int len, T val = 0) {
     return vector.pad(len, val);
 }
     
-template <class T>
-RealVector<T> & RealVector<T>::upsample(int rate, int phase) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::upsample(int rate, int phase) {
 	assert(rate > 0);
 	assert(phase >= 0 && phase < rate);
 	if (rate == 1)
@@ -1286,13 +1184,13 @@ RealVector<T> & RealVector<T>::upsample(int rate, int phase) {
  *      after).  Valid values are 0 to "rate"-1.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & upsample(RealVector<T> & vector, int rate, int phase = 0) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & upsample(RealVector<T, Allocator> & vector, int rate, int phase = 0) {
     return vector.upsample(rate, phase);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::downsample(int rate, int phase) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::downsample(int rate, int phase) {
 	assert(rate > 0);
 	assert(phase >= 0 && phase < rate);
 	if (rate == 1)
@@ -1316,13 +1214,13 @@ RealVector<T> & RealVector<T>::downsample(int rate, int phase) {
  *      are 0 to "rate"-1.  Defaults to 0.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & downsample(RealVector<T> & vector, int rate, int phase = 0) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & downsample(RealVector<T, Allocator> & vector, int rate, int phase = 0) {
     return vector.downsample(rate, phase);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::cumsum(T initialVal) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::cumsum(T initialVal) {
     T sum = initialVal;
     for (unsigned i=0; i<this->size(); i++) {
         sum += this->vec[i];
@@ -1338,13 +1236,40 @@ RealVector<T> & RealVector<T>::cumsum(T initialVal) {
  * \param initialVal Initializing value for the cumulative sum.  Defaults to zero.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & cumsum(RealVector<T> & vector, T initialVal = 0) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & cumsum(RealVector<T, Allocator> & vector, T initialVal = 0) {
     return vector.cumsum(initialVal);
 }
+
+template <class T, class Allocator>
+template <class E>
+RealVector<T, Allocator> & RealVector<T, Allocator>::cumsum(const VectorExpression<E> & expr, T initialVal) {
+    const E & e = expr.self();
+    T sum = initialVal;
+    this->vec.resize(e.size());
+    for (unsigned i=0; i<this->size(); i++) {
+        sum += e[i];
+        this->vec[i] = sum;
+    }
+    return *this;
+}
+
+/**
+ * \brief Replaces "vector" with the cumulative sum of an expression in a single pass.
+ *
+ * \param vector Buffer that receives the result.
+ * \param expr The expression (see \ref lazy).  It may refer to "vector".
+ * \param initialVal Initializing value for the cumulative sum.  Defaults to zero.
+ * \return Reference to "vector".
+ */
+template <class T, class Allocator, class E>
+RealVector<T, Allocator> & cumsum(RealVector<T, Allocator> & vector, const VectorExpression<E> & expr,
+            T initialVal = 0) {
+    return vector.cumsum(expr, initialVal);
+}
     
-template <class T>
-RealVector<T> & RealVector<T>::diff() {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::diff() {
 	assert(this->size() > 1);
 	for (unsigned i=0; i<(this->size()-1); i++) {
 		this->vec[i] = this->vec[i + 1] - this->vec[i];
@@ -1360,13 +1285,13 @@ RealVector<T> & RealVector<T>::diff() {
  * \param vector Buffer to operate on.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & diff(RealVector<T> & vector) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & diff(RealVector<T, Allocator> & vector) {
     return vector.diff();
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::diff(T & previousVal) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::diff(T & previousVal) {
 	assert(this->size() > 0);
     T nextPreviousVal = this->vec[this->size()-1];
 	for (unsigned i=this->size()-1; i>0; i--) {
@@ -1386,83 +1311,36 @@ RealVector<T> & RealVector<T>::diff(T & previousVal) {
  *      previous vec.
  * \return Reference to "vector".
  */
-template <class T>
-RealVector<T> & diff(RealVector<T> & vector, T & previousVal) {
+template <class T, class Allocator>
+RealVector<T, Allocator> & diff(RealVector<T, Allocator> & vector, T & previousVal) {
     return vector.diff(previousVal);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::conv(RealVector<T> & data, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector<T> scratch;
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::conv(RealVector<T, Allocator> & data, bool trimTails) {
+    ScratchBuffer<T> scratch;
     std::vector<T> *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
+    ScratchBuffer<T> reversedTaps;
+    reversedTaps->assign(this->vec.rbegin(), this->vec.rend());
     if (trimTails) {
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<((int)this->size()-1) - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size() - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), 1, initialTrim,
+                   data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(data.size() + this->size() - 1);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<(int)dataTmp->size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1478,85 +1356,39 @@ RealVector<T> & RealVector<T>::conv(RealVector<T> & data, bool trimTails) {
  *      the convolution.
  * \return Reference to "data", which holds the result of the convolution.
  */
-template <class T>
-inline RealVector<T> & conv(RealVector<T> & data, RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline RealVector<T, Allocator> & conv(RealVector<T, Allocator> & data, RealVector<T, Allocator> & filter,
+            bool trimTails = false) {
     return filter.conv(data, trimTails);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::decimate(RealVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    std::vector<T> scratch;
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::decimate(RealVector<T, Allocator> & data, int rate,
+            bool trimTails) {
+    ScratchBuffer<T> scratch;
     std::vector<T> *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
+    ScratchBuffer<T> reversedTaps;
+    reversedTaps->assign(this->vec.rbegin(), this->vec.rend());
     if (trimTails) {
         data.resize((data.size() + rate - 1) / rate);
-        
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0; resultIndex<(((int)this->size()-1) - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size() - initialTrim + rate - 1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - ((this->size()-1) - initialTrim), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), rate, initialTrim,
+                   data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(((data.size() + this->size() - 1) + (rate - 1)) / rate);
-        
-        // Initial partial overlap
-        for (resultIndex=0; resultIndex<((int)this->size()-1+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex*rate; filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()+rate-1)/rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 filterIndex>=0; dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=resultIndex*rate - (this->size()-1), filterIndex=this->size()-1;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex--) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
+        firOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                   VECTOR_TO_ARRAY(*reversedTaps), this->size(), rate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1575,114 +1407,35 @@ RealVector<T> & RealVector<T>::decimate(RealVector<T> & data, int rate, bool tri
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the decimation.
  */
-template <class T>
-inline RealVector<T> & decimate(RealVector<T> & data, int rate, RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline RealVector<T, Allocator> & decimate(RealVector<T, Allocator> & data, int rate,
+            RealVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.decimate(data, rate, trimTails);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::interp(RealVector<T> & data, int rate, bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector<T> scratch;
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::interp(RealVector<T, Allocator> & data, int rate, bool trimTails) {
+    ScratchBuffer<T> scratch;
     std::vector<T> *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
     if (trimTails) {
         data.resize(data.size() * rate);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1 - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=initialTrim + resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-       
-        // Middle full overlap
-        for (dataStart=0, filterStart=(int)this->size()-1; resultIndex<(int)dataTmp->size()*rate - initialTrim; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         data.resize(data.size() * rate + this->size() - 1 - (rate - 1));
-        
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0; resultIndex<(int)this->size()-1; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=resultIndex; filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-        }
-        
-        // Middle full overlap
-        for (dataStart=0, filterStart=resultIndex; resultIndex<(int)dataTmp->size()*rate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
-
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=rate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            ++filterStart;
-            if (filterStart >= (int) this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= rate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), rate, 1, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1700,133 +1453,40 @@ RealVector<T> & RealVector<T>::interp(RealVector<T> & data, int rate, bool trimT
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the interpolation.
  */
-template <class T>
-inline RealVector<T> & interp(RealVector<T> & data, int rate, RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline RealVector<T, Allocator> & interp(RealVector<T, Allocator> & data, int rate,
+            RealVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.interp(data, rate, trimTails);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::resample(RealVector<T> & data, int interpRate, int decimateRate,  bool trimTails) {
-    int resultIndex;
-    int filterIndex;
-    int dataIndex;
-    int dataStart, filterStart;
-    std::vector<T> scratch;
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::resample(RealVector<T, Allocator> & data, int interpRate,
+            int decimateRate,  bool trimTails) {
+    ScratchBuffer<T> scratch;
     std::vector<T> *dataTmp;
     
     if (data.scratchBuf == NULL) {
-        dataTmp = &scratch;
+        dataTmp = scratch.get();
     }
     else {
         dataTmp = data.scratchBuf;
     }
-    *dataTmp = data.vec;
+    dataTmp->assign(data.vec.begin(), data.vec.end());
     
     if (trimTails) {
         int interpLen = data.size() * interpRate;
         int resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-
-        // Initial partial overlap
         int initialTrim = (this->size() - 1) / 2;
-        for (resultIndex=0, dataStart=0, filterStart=initialTrim;
-             resultIndex<((int)this->size()-1 - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate - initialTrim + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, initialTrim, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     else {
         int interpLen = data.size() * interpRate + this->size() - 1 - (interpRate - 1);
         int resampLen = (interpLen + decimateRate - 1) / decimateRate;
         data.resize(resampLen);
-        
-        // Initial partial overlap
-        for (resultIndex=0, dataStart=0, filterStart=0; resultIndex<((int)this->size()-1+decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=0, filterIndex=filterStart; filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Middle full overlap
-        for (; resultIndex<((int)dataTmp->size()*interpRate + decimateRate-1)/decimateRate; resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 filterIndex>=0; dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
-        
-        // Final partial overlap
-        for (; resultIndex<(int)data.size(); resultIndex++) {
-            data[resultIndex] = 0;
-            for (dataIndex=dataStart, filterIndex=filterStart;
-                 dataIndex<(int)dataTmp->size(); dataIndex++, filterIndex-=interpRate) {
-                data[resultIndex] += (*dataTmp)[dataIndex] * this->vec[filterIndex];
-            }
-            filterStart += decimateRate;
-            while (filterStart >= (int)this->size()) {
-                // Filter no longer overlaps with this data sample, so the first overlap sample is the next one.  We thus
-                // increment the data index and decrement the filter index.
-                filterStart -= interpRate;
-                ++dataStart;
-            }
-        }
+        resampleOutputs(this->threadPool, VECTOR_TO_ARRAY(*dataTmp), dataTmp->size(), VECTOR_TO_ARRAY(this->vec),
+                        this->size(), interpRate, decimateRate, 0, data.size(), VECTOR_TO_ARRAY(data.vec));
     }
     return data;
 }
@@ -1846,14 +1506,14 @@ RealVector<T> & RealVector<T>::resample(RealVector<T> & data, int interpRate, in
  *      ends of the convolution.
  * \return Reference to "data", which holds the result of the resampling.
  */
-template <class T>
-inline RealVector<T> & resample(RealVector<T> & data, int interpRate, int decimateRate,
-            RealVector<T> & filter, bool trimTails = false) {
+template <class T, class Allocator>
+inline RealVector<T, Allocator> & resample(RealVector<T, Allocator> & data, int interpRate, int decimateRate,
+            RealVector<T, Allocator> & filter, bool trimTails = false) {
     return filter.resample(data, interpRate, decimateRate, trimTails);
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::operator-()
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator-()
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] = -this->vec[i];
@@ -1861,9 +1521,9 @@ RealVector<T> & RealVector<T>::operator-()
     return *this;
 }
 
-template <class T>
-template <class U>
-RealVector<T> & RealVector<T>::operator+=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator+=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -1872,8 +1532,8 @@ RealVector<T> & RealVector<T>::operator+=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::operator+=(const T &rhs)
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator+=(const T &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] += rhs;
@@ -1881,23 +1541,23 @@ RealVector<T> & RealVector<T>::operator+=(const T &rhs)
     return *this;
 }
 
-template <class T, class U>
-inline RealVector<T> operator+(RealVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline RealVector<T, Allocator> operator+(RealVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs += rhs;
     return lhs;
 }
 
-template <class T>
-inline RealVector<T> operator+(RealVector<T> lhs, const T& rhs)
+template <class T, class Allocator>
+inline RealVector<T, Allocator> operator+(RealVector<T, Allocator> lhs, const T& rhs)
 {
     lhs += rhs;
     return lhs;
 }
 
-template <class T>
-template <class U>
-RealVector<T> & RealVector<T>::operator-=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator-=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -1906,8 +1566,8 @@ RealVector<T> & RealVector<T>::operator-=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::operator-=(const T &rhs)
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator-=(const T &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] -= rhs;
@@ -1915,23 +1575,23 @@ RealVector<T> & RealVector<T>::operator-=(const T &rhs)
     return *this;
 }
 
-template <class T, class U>
-inline RealVector<T> operator-(RealVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline RealVector<T, Allocator> operator-(RealVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs -= rhs;
     return lhs;
 }
 
-template <class T>
-inline RealVector<T> operator-(RealVector<T> lhs, const T& rhs)
+template <class T, class Allocator>
+inline RealVector<T, Allocator> operator-(RealVector<T, Allocator> lhs, const T& rhs)
 {
     lhs -= rhs;
     return lhs;
 }
 
-template <class T>
-template <class U>
-RealVector<T> & RealVector<T>::operator*=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator*=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -1940,8 +1600,8 @@ RealVector<T> & RealVector<T>::operator*=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::operator*=(const T &rhs)
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator*=(const T &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] *= rhs;
@@ -1949,23 +1609,23 @@ RealVector<T> & RealVector<T>::operator*=(const T &rhs)
     return *this;
 }
 
-template <class T, class U>
-inline RealVector<T> operator*(RealVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline RealVector<T, Allocator> operator*(RealVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs *= rhs;
     return lhs;
 }
 
-template <class T>
-inline RealVector<T> operator*(RealVector<T> lhs, const T& rhs)
+template <class T, class Allocator>
+inline RealVector<T, Allocator> operator*(RealVector<T, Allocator> lhs, const T& rhs)
 {
     lhs *= rhs;
     return lhs;
 }
 
-template <class T>
-template <class U>
-RealVector<T> & RealVector<T>::operator/=(const Vector<U> &rhs)
+template <class T, class Allocator>
+template <class U, class UAllocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator/=(const Vector<U, UAllocator> &rhs)
 {
     assert(this->size() == rhs.size());
     for (unsigned i=0; i<this->size(); i++) {
@@ -1974,8 +1634,8 @@ RealVector<T> & RealVector<T>::operator/=(const Vector<U> &rhs)
     return *this;
 }
 
-template <class T>
-RealVector<T> & RealVector<T>::operator/=(const T &rhs)
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::operator/=(const T &rhs)
 {
     for (unsigned i=0; i<this->size(); i++) {
         this->vec[i] /= rhs;
@@ -1983,22 +1643,22 @@ RealVector<T> & RealVector<T>::operator/=(const T &rhs)
     return *this;
 }
 
-template <class T, class U>
-inline RealVector<T> operator/(RealVector<T> lhs, const Vector<U>& rhs)
+template <class T, class Allocator, class U, class UAllocator>
+inline RealVector<T, Allocator> operator/(RealVector<T, Allocator> lhs, const Vector<U, UAllocator>& rhs)
 {
     lhs /= rhs;
     return lhs;
 }
 
-template <class T>
-inline RealVector<T> operator/(RealVector<T> lhs, const T& rhs)
+template <class T, class Allocator>
+inline RealVector<T, Allocator> operator/(RealVector<T, Allocator> lhs, const T& rhs)
 {
     lhs /= rhs;
     return lhs;
 }
 
-template <class T>
-T RealVector<T>::tone(T freq, T sampleFreq, T phase, unsigned numSamples) {
+template <class T, class Allocator>
+T RealVector<T, Allocator>::tone(T freq, T sampleFreq, T phase, unsigned numSamples) {
     assert(sampleFreq > 0.0);
     
     if (numSamples && numSamples != this->size()) {
@@ -2024,13 +1684,13 @@ T RealVector<T>::tone(T freq, T sampleFreq, T phase, unsigned numSamples) {
  *      this->size() samples.  Defaults to 0.
  * \return Reference to "this".
  */
-template <class T>
-T tone(RealVector<T> & vec, T freq, T sampleFreq = 1.0, T phase = 0.0, unsigned numSamples = 0) {
+template <class T, class Allocator>
+T tone(RealVector<T, Allocator> & vec, T freq, T sampleFreq = 1.0, T phase = 0.0, unsigned numSamples = 0) {
     return vec.tone(freq, sampleFreq, phase, numSamples);
 }
 
-template <class T>
-T RealVector<T>::modulate(T freq, T sampleFreq, T phase) {
+template <class T, class Allocator>
+T RealVector<T, Allocator>::modulate(T freq, T sampleFreq, T phase) {
     assert(sampleFreq > 0.0);
     
     T phaseInc = (freq / sampleFreq) * 2 * M_PI;
@@ -2049,11 +1709,69 @@ T RealVector<T>::modulate(T freq, T sampleFreq, T phase) {
  * \param phase The modulating tone's starting phase, in radians.  Defaults to 0.
  * \return The next phase if the tone were to continue.
  */
- template <class T>
-T modulate(RealVector<T> &data, T freq, T sampleFreq, T phase) {
+ template <class T, class Allocator>
+T modulate(RealVector<T, Allocator> &data, T freq, T sampleFreq, T phase) {
     return data.modulate(freq, sampleFreq, phase);
 }
 
+template <class T, class Allocator>
+ComplexVector<T> & RealVector<T, Allocator>::fft(ComplexVector<T> & spectrum, RealFftPlan<T> & plan) {
+    NIMBLEDSP_INSTRUMENT("RealVector::fft", this->size());
+    assert(plan.size() == this->size() && !plan.isInverse());
+    
+    spectrum.resize(plan.numBins());
+    plan.transform(VECTOR_TO_ARRAY(this->vec), VECTOR_TO_ARRAY(spectrum.vec));
+    spectrum.domain = FREQUENCY_DOMAIN;
+    return spectrum;
+}
+
+/**
+ * \brief Computes the FFT of "data" and puts the size()/2 + 1 bin half spectrum in "spectrum".
+ *
+ * \param data The real data to transform.  It is not modified.
+ * \param spectrum Holds the half spectrum on return.
+ * \return Reference to "spectrum".
+ */
+template <class T, class Allocator>
+inline ComplexVector<T> & fft(RealVector<T, Allocator> & data, ComplexVector<T> & spectrum) {
+    return data.fft(spectrum);
+}
+
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::ifft(const ComplexVector<T> & spectrum, unsigned numSamples) {
+    assert(spectrum.size() > 0);
+    if (numSamples == 0) {
+        numSamples = 2 * (spectrum.size() - 1);
+    }
+    return ifft(spectrum, realFftPlan<T>(numSamples, true));
+}
+
+template <class T, class Allocator>
+RealVector<T, Allocator> & RealVector<T, Allocator>::ifft(const ComplexVector<T> & spectrum, RealFftPlan<T> & plan) {
+    NIMBLEDSP_INSTRUMENT("RealVector::ifft", spectrum.size());
+    assert(spectrum.domain == FREQUENCY_DOMAIN);
+    assert(plan.numBins() == spectrum.size() && plan.isInverse());
+    
+    this->vec.resize(plan.size());
+    plan.transform(VECTOR_TO_ARRAY(spectrum.vec), VECTOR_TO_ARRAY(this->vec));
+    return *this;
+}
+
+/**
+ * \brief Sets "data" equal to the inverse FFT of the half spectrum "spectrum".
+ *
+ * The result is not scaled by 1/N.
+ * \param data Holds the result on return.
+ * \param spectrum The non-negative frequency bins.
+ * \param numSamples Number of samples to produce.  "0" means 2*(spectrum.size() - 1).
+ * \return Reference to "data".
+ */
+template <class T, class Allocator>
+inline RealVector<T, Allocator> & ifft(RealVector<T, Allocator> & data, const ComplexVector<T> & spectrum,
+            unsigned numSamples = 0) {
+    return data.ifft(spectrum, numSamples);
+}
+
 
 };
 
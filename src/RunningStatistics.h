@@ -0,0 +1,519 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+/**
+ * @file RunningStatistics.h
+ *
+ * Sliding window statistics filters: running median, minimum, maximum, mean and variance.
+ *
+ * Each filter replaces every sample with a statistic of the last "windowLen" input samples, the
+ * current one included.  They stream like the FIR filters: the window carries over from one call
+ * to the next, so a signal can be filtered a block at a time.  Until "windowLen" samples have been
+ * seen the statistic is of the samples seen so far, rather than of a window padded with zeros.
+ * None of them allocate once constructed.
+ */
+
+#ifndef NimbleDSP_RunningStatistics_h
+#define NimbleDSP_RunningStatistics_h
+
+#include <vector>
+#include <functional>
+#include <cassert>
+#include "RealVector.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Sliding window median filter, for removing impulse noise.
+ *
+ * The window is split between a max-heap holding the smaller half of it and a min-heap holding
+ * the larger half, so the median is always at the top of one or both heaps.  Each new sample
+ * replaces the oldest one where it sits in the heaps and is sifted into place, which takes
+ * O(log windowLen) time per sample.  For even window lengths the median is the average of the
+ * two middle samples, as in RealVector::median.
+ */
+template <class T>
+class RunningMedian {
+ protected:
+    /**
+     * \brief The samples in the window, in arrival order.  A ring buffer indexed by "slots".
+     */
+    std::vector<T> window;
+    
+    /**
+     * \brief Heaps of slot numbers.  "lower" is a max-heap of the smaller half of the window and
+     *      "upper" is a min-heap of the larger half.  lower has the same number of samples as
+     *      upper or one more.
+     */
+    std::vector<int> heap[2];
+    unsigned heapSize[2];
+    
+    /**
+     * \brief For each slot in \ref window, which heap it is in and where.
+     */
+    std::vector<int> slotHeap;
+    std::vector<int> slotIndex;
+    
+    /**
+     * \brief Number of samples in the window, and the slot that the next sample goes in.
+     */
+    unsigned count;
+    unsigned nextSlot;
+    
+    enum {LOWER = 0, UPPER = 1};
+    
+    /**
+     * \brief True if element "a" of heap "h" belongs above element "b".
+     */
+    bool above(int h, int a, int b) const {
+        return (h == LOWER) ? (window[heap[h][a]] > window[heap[h][b]]) : (window[heap[h][a]] < window[heap[h][b]]);
+    }
+    
+    void place(int h, int index, int slot) {heap[h][index] = slot; slotHeap[slot] = h; slotIndex[slot] = index;}
+    
+    void swapElements(int h, int a, int b) {
+        int slotA = heap[h][a];
+        place(h, a, heap[h][b]);
+        place(h, b, slotA);
+    }
+    
+    int siftUp(int h, int index) {
+        while (index > 0 && above(h, index, (index - 1) / 2)) {
+            swapElements(h, index, (index - 1) / 2);
+            index = (index - 1) / 2;
+        }
+        return index;
+    }
+    
+    void siftDown(int h, int index) {
+        int size = (int) heapSize[h];
+        while (true) {
+            int child = 2 * index + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size && above(h, child + 1, child)) {
+                child++;
+            }
+            if (!above(h, child, index)) {
+                break;
+            }
+            swapElements(h, index, child);
+            index = child;
+        }
+    }
+    
+    /**
+     * \brief Restores "everything in lower <= everything in upper" after one sample changed.
+     *      Swapping the two tops is always enough.
+     */
+    void balanceTops() {
+        if (heapSize[UPPER] > 0 && window[heap[LOWER][0]] > window[heap[UPPER][0]]) {
+            int lowerTop = heap[LOWER][0];
+            place(LOWER, 0, heap[UPPER][0]);
+            place(UPPER, 0, lowerTop);
+            siftDown(LOWER, 0);
+            siftDown(UPPER, 0);
+        }
+    }
+    
+    /**
+     * \brief Adds "sample" to the window and returns the median.
+     */
+    T next(T sample);
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param windowLen Number of samples in the window.
+     */
+    RunningMedian<T>(unsigned windowLen) : window(windowLen), slotHeap(windowLen), slotIndex(windowLen) {
+        assert(windowLen > 0);
+        heap[LOWER].resize(windowLen / 2 + 1);
+        heap[UPPER].resize(windowLen / 2 + 1);
+        reset();
+    }
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of samples in the window.
+     */
+    unsigned windowLength() const {return window.size();}
+    
+    /**
+     * \brief Empties the window, as if no data had been filtered.
+     */
+    void reset() {count = 0; nextSlot = 0; heapSize[LOWER] = heapSize[UPPER] = 0;}
+    
+    /**
+     * \brief Replaces each sample in "data" with the median of the window ending at it.
+     *
+     * \return Reference to "data".
+     */
+    RealVector<T> & filter(RealVector<T> & data) {
+        for (unsigned i=0; i<data.size(); i++) {
+            data[i] = next(data[i]);
+        }
+        return data;
+    }
+};
+
+template <class T>
+T RunningMedian<T>::next(T sample) {
+    int slot = nextSlot;
+    window[slot] = sample;
+    if (++nextSlot == window.size()) {
+        nextSlot = 0;
+    }
+    
+    if (count < window.size()) {
+        // Still filling.  Alternate heaps so that lower stays the same size as upper or one bigger.
+        int h = (count & 1) ? UPPER : LOWER;
+        place(h, heapSize[h], slot);
+        heapSize[h]++;
+        siftUp(h, heapSize[h] - 1);
+        count++;
+    }
+    else {
+        // The new sample overwrote the oldest one, so it starts where that one was in the heaps.
+        int h = slotHeap[slot];
+        int index = siftUp(h, slotIndex[slot]);
+        siftDown(h, index);
+    }
+    balanceTops();
+    
+    if (count & 1) {
+        return window[heap[LOWER][0]];
+    }
+    else {
+        return (window[heap[LOWER][0]] + window[heap[UPPER][0]]) / ((T) 2);
+    }
+}
+
+/**
+ * \brief Running median function.
+ *
+ * \param data Buffer to operate on.
+ * \param runningMedian The running median filter.
+ * \return Reference to "data", which holds the filtered samples.
+ */
+template <class T>
+inline RealVector<T> & filter(RealVector<T> & data, RunningMedian<T> & runningMedian) {
+    return runningMedian.filter(data);
+}
+
+
+/**
+ * \brief Sliding window maximum (Compare = std::greater) or minimum (Compare = std::less) filter.
+ *      Use RunningMax and RunningMin.
+ *
+ * Keeps a monotonic queue: the samples in the window that could still become the extremum, i.e.
+ * those with nothing more extreme after them.  The front of the queue is the extremum.  Each
+ * sample is added and removed once, so it takes O(1) time per sample on average.
+ */
+template <class T, class Compare>
+class RunningExtremum {
+ protected:
+    /**
+     * \brief The queue, as a ring buffer of sample values and sample numbers.  It never holds
+     *      more than a window's worth.
+     */
+    std::vector<T> queueValues;
+    std::vector<unsigned long long> queuePositions;
+    unsigned head;
+    unsigned queueSize;
+    
+    /**
+     * \brief Number of samples filtered since the last reset.
+     */
+    unsigned long long position;
+    
+    Compare compare;
+    
+    unsigned queueIndex(unsigned i) const {unsigned index = head + i; return (index >= queueValues.size()) ? index - queueValues.size() : index;}
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param windowLen Number of samples in the window.
+     */
+    RunningExtremum<T, Compare>(unsigned windowLen) : queueValues(windowLen), queuePositions(windowLen) {
+        assert(windowLen > 0);
+        reset();
+    }
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of samples in the window.
+     */
+    unsigned windowLength() const {return queueValues.size();}
+    
+    /**
+     * \brief Empties the window, as if no data had been filtered.
+     */
+    void reset() {head = 0; queueSize = 0; position = 0;}
+    
+    /**
+     * \brief Replaces each sample in "data" with the extremum of the window ending at it.
+     *
+     * \return Reference to "data".
+     */
+    RealVector<T> & filter(RealVector<T> & data);
+};
+
+template <class T, class Compare>
+RealVector<T> & RunningExtremum<T, Compare>::filter(RealVector<T> & data) {
+    unsigned windowLen = queueValues.size();
+    for (unsigned i=0; i<data.size(); i++) {
+        T sample = data[i];
+        // Samples that the new one is at least as extreme as can never be the answer again.
+        while (queueSize > 0 && !compare(queueValues[queueIndex(queueSize - 1)], sample)) {
+            queueSize--;
+        }
+        if (queueSize > 0 && queuePositions[head] + windowLen <= position) {
+            head = queueIndex(1);
+            queueSize--;
+        }
+        unsigned tail = queueIndex(queueSize);
+        queueValues[tail] = sample;
+        queuePositions[tail] = position;
+        queueSize++;
+        position++;
+        data[i] = queueValues[head];
+    }
+    return data;
+}
+
+/**
+ * \brief Sliding window maximum filter.  See RunningExtremum.
+ */
+template <class T>
+class RunningMax : public RunningExtremum<T, std::greater<T> > {
+ public:
+    RunningMax<T>(unsigned windowLen) : RunningExtremum<T, std::greater<T> >(windowLen) {}
+};
+
+/**
+ * \brief Sliding window minimum filter.  See RunningExtremum.
+ */
+template <class T>
+class RunningMin : public RunningExtremum<T, std::less<T> > {
+ public:
+    RunningMin<T>(unsigned windowLen) : RunningExtremum<T, std::less<T> >(windowLen) {}
+};
+
+/**
+ * \brief Running maximum or minimum function.
+ *
+ * \param data Buffer to operate on.
+ * \param runningExtremum The RunningMax or RunningMin filter.
+ * \return Reference to "data", which holds the filtered samples.
+ */
+template <class T, class Compare>
+inline RealVector<T> & filter(RealVector<T> & data, RunningExtremum<T, Compare> & runningExtremum) {
+    return runningExtremum.filter(data);
+}
+
+
+/**
+ * \brief Sliding window mean and variance.  Use RunningMean and RunningVar.
+ *
+ * The mean and the sum of squared differences from it are updated as each sample enters and the
+ * oldest one leaves (Welford's method), in the accumulator type A.  Each time the window has
+ * been replaced they are recomputed from the window, so rounding errors don't build up over a
+ * long stream.  The variance is normalized by N - 1, as in RealVector::var.
+ */
+template <class T, class A = typename FloatTypeTraits<T>::type>
+class RunningMoments {
+ protected:
+    std::vector<T> window;
+    unsigned count;
+    unsigned nextSlot;
+    A meanVal;
+    A sumSquares;
+    
+    /**
+     * \brief Adds "sample" to the window, dropping the oldest one if the window is full.
+     */
+    void next(T sample);
+    
+    void recompute();
+    
+    A currentVar() const {return (count > 1) ? sumSquares / (A) (count - 1) : 0;}
+    
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param windowLen Number of samples in the window.
+     */
+    RunningMoments<T, A>(unsigned windowLen) : window(windowLen) {assert(windowLen > 0); reset();}
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of samples in the window.
+     */
+    unsigned windowLength() const {return window.size();}
+    
+    /**
+     * \brief Empties the window, as if no data had been filtered.
+     */
+    void reset() {count = 0; nextSlot = 0; meanVal = 0; sumSquares = 0;}
+    
+    /**
+     * \brief Returns the mean of the window that ends at the last sample filtered.
+     */
+    A mean() const {return meanVal;}
+    
+    /**
+     * \brief Returns the variance of the window that ends at the last sample filtered.
+     */
+    A var() const {return currentVar();}
+};
+
+template <class T, class A>
+void RunningMoments<T, A>::next(T sample) {
+    A x = (A) sample;
+    if (count < window.size()) {
+        count++;
+        A delta = x - meanVal;
+        meanVal += delta / (A) count;
+        sumSquares += delta * (x - meanVal);
+    }
+    else {
+        A oldest = (A) window[nextSlot];
+        A oldMean = meanVal;
+        meanVal += (x - oldest) / (A) count;
+        sumSquares += (x - oldest) * (x - meanVal + oldest - oldMean);
+    }
+    window[nextSlot] = sample;
+    if (++nextSlot == window.size()) {
+        nextSlot = 0;
+        recompute();
+    }
+}
+
+template <class T, class A>
+void RunningMoments<T, A>::recompute() {
+    A sum = 0;
+    for (unsigned i=0; i<count; i++) {
+        sum += (A) window[i];
+    }
+    meanVal = sum / (A) count;
+    sumSquares = 0;
+    for (unsigned i=0; i<count; i++) {
+        A diff = (A) window[i] - meanVal;
+        sumSquares += diff * diff;
+    }
+}
+
+/**
+ * \brief Sliding window mean filter.  See RunningMoments.
+ */
+template <class T, class A = typename FloatTypeTraits<T>::type>
+class RunningMean : public RunningMoments<T, A> {
+ public:
+    RunningMean<T, A>(unsigned windowLen) : RunningMoments<T, A>(windowLen) {}
+    
+    /**
+     * \brief Replaces each sample in "data" with the mean of the window ending at it.
+     *
+     * \return Reference to "data".
+     */
+    RealVector<T> & filter(RealVector<T> & data) {
+        for (unsigned i=0; i<data.size(); i++) {
+            this->next(data[i]);
+            data[i] = (T) this->meanVal;
+        }
+        return data;
+    }
+};
+
+/**
+ * \brief Sliding window variance filter.  See RunningMoments.
+ */
+template <class T, class A = typename FloatTypeTraits<T>::type>
+class RunningVar : public RunningMoments<T, A> {
+ public:
+    RunningVar<T, A>(unsigned windowLen) : RunningMoments<T, A>(windowLen) {}
+    
+    /**
+     * \brief Replaces each sample in "data" with the variance of the window ending at it.
+     *
+     * \return Reference to "data".
+     */
+    RealVector<T> & filter(RealVector<T> & data) {
+        for (unsigned i=0; i<data.size(); i++) {
+            this->next(data[i]);
+            data[i] = (T) this->currentVar();
+        }
+        return data;
+    }
+};
+
+/**
+ * \brief Running mean function.
+ *
+ * \param data Buffer to operate on.
+ * \param runningMean The running mean filter.
+ * \return Reference to "data", which holds the filtered samples.
+ */
+template <class T, class A>
+inline RealVector<T> & filter(RealVector<T> & data, RunningMean<T, A> & runningMean) {
+    return runningMean.filter(data);
+}
+
+/**
+ * \brief Running variance function.
+ *
+ * \param data Buffer to operate on.
+ * \param runningVar The running variance filter.
+ * \return Reference to "data", which holds the filtered samples.
+ */
+template <class T, class A>
+inline RealVector<T> & filter(RealVector<T> & data, RunningVar<T, A> & runningVar) {
+    return runningVar.filter(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,792 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file SampleFile.h
+ *
+ * Definition of the template classes FileSource and FileSink, which stream samples between files
+ * and vectors.
+ *
+ * Both convert between the file's sample format and the vector's type while they copy, so an
+ * int16 IQ capture can be read straight into a ComplexVector<float>:
+ *
+ *      FileSource< std::complex<int16_t> > capture("capture.iq");
+ *      capture.scale = 1.0 / 32768;
+ *      ComplexVector<float> buf;
+ *      while (capture.read(buf, 65536) > 0) {
+ *          ...
+ *      }
+ *
+ * Reads come straight out of a memory mapping of the file where the platform supports it, so
+ * there is no copy through a stdio buffer.  Otherwise, or if BUFFERED_FILE access is asked for,
+ * the file is read in large chunks with stdio buffering turned off.  Chunks are whole multiples of
+ * DEFAULT_ALIGNMENT bytes and their buffers are aligned to it.  Either way "asyncIo" overlaps the
+ * I/O with the processing: the source reads the next chunk ahead (or asks the kernel to page it
+ * in) while the caller works on the current one, and the sink writes a full chunk behind the
+ * caller while it fills the next one.  Each source or sink does its background I/O on one thread
+ * that lives as long as it does.
+ *
+ * Define NIMBLEDSP_DISABLE_MMAP to always use buffered reads.
+ */
+
+#ifndef NimbleDSP_SampleFile_h
+#define NimbleDSP_SampleFile_h
+
+#include <complex>
+#include <vector>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <type_traits>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include "Vector.h"
+#include "VectorView.h"
+#include "Allocators.h"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(NIMBLEDSP_DISABLE_MMAP)
+#define NIMBLEDSP_HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NIMBLEDSP_FSEEK fseeko
+#define NIMBLEDSP_FTELL ftello
+#else
+#define NIMBLEDSP_FSEEK fseek
+#define NIMBLEDSP_FTELL ftell
+#endif
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Default number of samples that FileSource and FileSink move per chunk.
+ */
+const unsigned DEFAULT_FILE_CHUNK_LEN = 1 << 16;
+
+/**
+ * \brief Returns "numSamples" rounded up so that a chunk of that many samples of type F is a whole
+ *      number of DEFAULT_ALIGNMENT byte blocks.
+ */
+template <class F>
+inline unsigned alignedChunkLen(unsigned numSamples) {
+    unsigned step = 1;
+    while ((step * sizeof(F)) % DEFAULT_ALIGNMENT != 0) {
+        step++;
+    }
+    return (numSamples + step - 1) / step * step;
+}
+
+/**
+ * \brief One background thread that runs one job at a time for FileSource and FileSink.
+ *
+ * The thread is started by the first \ref start and stopped by the destructor, so a source or sink
+ * reuses it for every chunk instead of starting a thread each time.
+ */
+class BackgroundIo {
+ protected:
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    std::function<void ()> job;
+    bool busy;
+    bool stopping;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            if (busy) {
+                guard.unlock();
+                job();
+                guard.lock();
+                busy = false;
+                jobDone.notify_all();
+            }
+            else if (stopping) {
+                return;
+            }
+            else {
+                jobReady.wait(guard);
+            }
+        }
+    }
+
+    BackgroundIo(const BackgroundIo &);
+    BackgroundIo & operator=(const BackgroundIo &);
+
+ public:
+    BackgroundIo() : busy(false), stopping(false) {}
+
+    ~BackgroundIo() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            jobReady.notify_all();
+            worker.join();
+        }
+    }
+
+    /**
+     * \brief Waits for the previous job to finish, then hands "task" to the background thread.
+     */
+    void start(const std::function<void ()> & task) {
+        wait();
+        if (!worker.joinable()) {
+            worker = std::thread(&BackgroundIo::workerLoop, this);
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = task;
+            busy = true;
+        }
+        jobReady.notify_all();
+    }
+
+    /**
+     * \brief Returns once the background thread has finished its job.  Everything the job wrote is
+     *      visible to the caller afterwards.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (busy) {
+            jobDone.wait(guard);
+        }
+    }
+};
+
+/**
+ * \brief Converts one scalar value to type S.  Conversions to integer types round and saturate.
+ */
+template <class S, bool isIntegral = std::is_integral<S>::value>
+struct SampleCast {
+    template <class V>
+    static S apply(V value) {return (S) value;}
+};
+
+template <class S>
+struct SampleCast<S, true> {
+    template <class V>
+    static S apply(V value) {
+        double rounded = std::floor((double) value + 0.5);
+        if (rounded > (double) std::numeric_limits<S>::max()) {
+            return std::numeric_limits<S>::max();
+        }
+        if (rounded < (double) std::numeric_limits<S>::min()) {
+            return std::numeric_limits<S>::min();
+        }
+        return (S) rounded;
+    }
+};
+
+/**
+ * \brief The type that samples are scaled in when converting from scalar type F to scalar type U:
+ *      the floating point one of the two, or double if neither is.
+ */
+template <class F, class U>
+struct SampleScaleType {
+    typedef typename std::conditional<std::is_floating_point<U>::value, U,
+            typename std::conditional<std::is_floating_point<F>::value, F, double>::type>::type type;
+};
+
+/**
+ * \brief Converts "numSamples" samples from "in" to "out" in one pass, multiplying each by "scale".
+ *      Complex samples are converted a component at a time.
+ */
+template <class F, class U>
+void convertSamples(const F *in, U *out, size_t numSamples, double scale) {
+    if (std::is_same<F, U>::value && scale == 1) {
+        memcpy((void *) out, (const void *) in, numSamples * sizeof(U));
+        return;
+    }
+    typedef typename SampleScaleType<F, U>::type S;
+    S s = (S) scale;
+    for (size_t i=0; i<numSamples; i++) {
+        out[i] = SampleCast<U>::apply(in[i] * s);
+    }
+}
+
+template <class F, class U>
+void convertSamples(const std::complex<F> *in, std::complex<U> *out, size_t numSamples, double scale) {
+    if (std::is_same<F, U>::value && scale == 1) {
+        memcpy((void *) out, (const void *) in, numSamples * sizeof(std::complex<U>));
+        return;
+    }
+    typedef typename SampleScaleType<F, U>::type S;
+    S s = (S) scale;
+    for (size_t i=0; i<numSamples; i++) {
+        out[i] = std::complex<U>(SampleCast<U>::apply(in[i].real() * s), SampleCast<U>::apply(in[i].imag() * s));
+    }
+}
+
+
+/**
+ * \brief Reads samples of type F from a file into vectors or views.
+ *
+ * F is the sample format of the file, e.g. "std::complex<int16_t>" for interleaved 16 bit I/Q or
+ * "float" for raw 32 bit floating point audio.  The file is read in the host's byte order.  The
+ * source is not copyable.
+ */
+template <class F>
+class FileSource {
+ protected:
+    /**
+     * \brief The file for buffered access.  NULL if the file is memory mapped or not open.
+     */
+    FILE *file;
+
+    /**
+     * \brief The memory mapping of the whole file.  NULL if the file isn't memory mapped.
+     */
+    const F *mappedSamples;
+    size_t mappedBytes;
+
+    /**
+     * \brief Number of samples in the file.
+     */
+    size_t numFileSamples;
+
+    /**
+     * \brief Index of the next sample to read.
+     */
+    size_t readPosition;
+
+    unsigned chunkLen;
+    bool asyncIo;
+
+    typedef std::vector<F, AlignedAllocator<F> > ChunkBuffer;
+
+    /**
+     * \brief Buffered access: the chunk being read from.  Samples [chunkStart, chunk.size()) have
+     *      not been handed out yet.
+     */
+    ChunkBuffer chunk;
+    size_t chunkStart;
+
+    /**
+     * \brief Buffered access with asyncIo: the chunk \ref readAheadIo is reading.
+     */
+    ChunkBuffer nextChunk;
+    BackgroundIo readAheadIo;
+    bool readAheadPending;
+
+    /**
+     * \brief Buffered access: index of the next sample that the file will read.
+     */
+    size_t filePosition;
+
+    /**
+     * \brief Buffered access: reads up to the next chunk boundary in the file into "buf", so that
+     *      the reads after a seek are back on aligned file offsets.
+     */
+    void readChunk(ChunkBuffer & buf) {
+        size_t len = chunkLen - filePosition % chunkLen;
+        buf.resize(len);
+        buf.resize(fread(VECTOR_TO_ARRAY(buf), sizeof(F), len, file));
+        filePosition += buf.size();
+    }
+
+    /**
+     * \brief Buffered access: makes sure \ref chunk has samples in it, unless the file is used up.
+     */
+    void fillChunk();
+
+    void startReadAhead() {readAheadIo.start([this]() {readChunk(nextChunk);}); readAheadPending = true;}
+    void finishReadAhead() {if (readAheadPending) readAheadIo.wait(); readAheadPending = false;}
+
+    /**
+     * \brief Returns a pointer to up to "maxSamples" contiguous unread samples and puts how many
+     *      are there in "numAvailable".  Doesn't advance the read position.
+     */
+    const F *peek(size_t maxSamples, size_t & numAvailable);
+
+    /**
+     * \brief Marks "numSamples" samples as read.
+     */
+    void advance(size_t numSamples);
+
+    void open(const char *filename, FileAccessType access);
+
+    FileSource<F>(const FileSource<F> &);
+    FileSource<F> & operator=(const FileSource<F> &);
+
+ public:
+    /**
+     * \brief Multiplies every sample as it is read.  E.g. 1.0 / 32768 maps int16 samples to [-1, 1).
+     *      Defaults to 1.
+     */
+    double scale;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Opens "filename" for reading.  Check \ref isOpen to see if it worked.
+     *
+     * \param filename The file to read.
+     * \param access MEMORY_MAPPED_FILE maps the file if the platform supports it, and falls back to
+     *      BUFFERED_FILE if it doesn't or if the mapping fails.
+     * \param readAhead Read (or page in) the next chunk in the background while the caller
+     *      processes the current one.
+     * \param chunkSamples Number of samples per chunk.  It is rounded up to a whole number of
+     *      DEFAULT_ALIGNMENT byte blocks.
+     */
+    FileSource<F>(const char *filename, FileAccessType access = MEMORY_MAPPED_FILE, bool readAhead = false,
+                  unsigned chunkSamples = DEFAULT_FILE_CHUNK_LEN);
+
+    ~FileSource<F>() {close();}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns true if the file was opened successfully and hasn't been closed.
+     */
+    bool isOpen() const {return file != NULL || mappedSamples != NULL;}
+
+    /**
+     * \brief Returns true if the file is memory mapped.
+     */
+    bool isMemoryMapped() const {return mappedSamples != NULL;}
+
+    /**
+     * \brief Returns the number of samples in the file.
+     */
+    size_t size() const {return numFileSamples;}
+
+    /**
+     * \brief Returns the index of the next sample that will be read.
+     */
+    size_t position() const {return readPosition;}
+
+    /**
+     * \brief Returns true once every sample has been read.
+     */
+    bool eof() const {return readPosition >= numFileSamples;}
+
+    /**
+     * \brief Moves the read position to sample number "sampleIndex".
+     */
+    void seek(size_t sampleIndex);
+
+    /**
+     * \brief Closes the file.
+     */
+    void close();
+
+    /**
+     * \brief Reads up to "numSamples" samples into "data", converted to "data"'s type.
+     *
+     * \return The number of samples read, which is also the new size of "data".  It is only less
+     *      than "numSamples" at the end of the file.
+     */
+    template <class U>
+    unsigned read(Vector<U> & data, unsigned numSamples);
+
+    /**
+     * \brief Reads up to data.size() samples into "data", converted to "data"'s type.
+     *
+     * \return The number of samples read.
+     */
+    template <class U>
+    unsigned read(VectorView<U> data) {return read(data.data(), data.size());}
+
+    /**
+     * \brief Reads up to "numSamples" samples into the array "data", converted to its type.
+     *
+     * \return The number of samples read.
+     */
+    template <class U>
+    unsigned read(U *data, unsigned numSamples);
+};
+
+
+template <class F>
+FileSource<F>::FileSource(const char *filename, FileAccessType access, bool readAhead, unsigned chunkSamples) {
+    assert(chunkSamples > 0);
+    file = NULL;
+    mappedSamples = NULL;
+    mappedBytes = 0;
+    numFileSamples = 0;
+    readPosition = 0;
+    chunkLen = alignedChunkLen<F>(chunkSamples);
+    asyncIo = readAhead;
+    chunkStart = 0;
+    readAheadPending = false;
+    filePosition = 0;
+    scale = 1;
+    open(filename, access);
+}
+
+template <class F>
+void FileSource<F>::open(const char *filename, FileAccessType access) {
+#ifdef NIMBLEDSP_HAVE_MMAP
+    if (access == MEMORY_MAPPED_FILE) {
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat fileStats;
+        if (fstat(fd, &fileStats) == 0 && fileStats.st_size > 0) {
+            void *mapping = mmap(NULL, fileStats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, fileStats.st_size, MADV_SEQUENTIAL);
+                mappedSamples = (const F *) mapping;
+                mappedBytes = fileStats.st_size;
+                numFileSamples = mappedBytes / sizeof(F);
+            }
+        }
+        ::close(fd);
+        if (mappedSamples != NULL) {
+            return;
+        }
+    }
+#endif
+    file = fopen(filename, "rb");
+    if (file == NULL) {
+        return;
+    }
+    // The chunks are big enough that stdio buffering would only add a copy.
+    setvbuf(file, NULL, _IONBF, 0);
+    NIMBLEDSP_FSEEK(file, 0, SEEK_END);
+    numFileSamples = NIMBLEDSP_FTELL(file) / sizeof(F);
+    NIMBLEDSP_FSEEK(file, 0, SEEK_SET);
+}
+
+template <class F>
+void FileSource<F>::close() {
+    finishReadAhead();
+#ifdef NIMBLEDSP_HAVE_MMAP
+    if (mappedSamples != NULL) {
+        munmap((void *) mappedSamples, mappedBytes);
+    }
+#endif
+    mappedSamples = NULL;
+    mappedBytes = 0;
+    if (file != NULL) {
+        fclose(file);
+        file = NULL;
+    }
+    chunk.clear();
+    nextChunk.clear();
+    chunkStart = 0;
+}
+
+template <class F>
+void FileSource<F>::seek(size_t sampleIndex) {
+    assert(sampleIndex <= numFileSamples);
+    readPosition = sampleIndex;
+    if (file != NULL) {
+        finishReadAhead();
+        chunk.clear();
+        nextChunk.clear();
+        chunkStart = 0;
+        filePosition = sampleIndex;
+        NIMBLEDSP_FSEEK(file, sampleIndex * sizeof(F), SEEK_SET);
+    }
+}
+
+template <class F>
+void FileSource<F>::fillChunk() {
+    if (chunkStart < chunk.size()) {
+        return;
+    }
+    if (readAheadPending) {
+        finishReadAhead();
+        chunk.swap(nextChunk);
+    }
+    else {
+        readChunk(chunk);
+    }
+    chunkStart = 0;
+    if (asyncIo && !chunk.empty()) {
+        startReadAhead();
+    }
+}
+
+template <class F>
+const F *FileSource<F>::peek(size_t maxSamples, size_t & numAvailable) {
+    if (mappedSamples != NULL) {
+        numAvailable = std::min(maxSamples, numFileSamples - readPosition);
+        return mappedSamples + readPosition;
+    }
+    fillChunk();
+    numAvailable = std::min(maxSamples, chunk.size() - chunkStart);
+    return numAvailable > 0 ? VECTOR_TO_ARRAY(chunk) + chunkStart : NULL;
+}
+
+template <class F>
+void FileSource<F>::advance(size_t numSamples) {
+    readPosition += numSamples;
+    if (mappedSamples != NULL) {
+#ifdef NIMBLEDSP_HAVE_MMAP
+        if (asyncIo && readPosition < numFileSamples) {
+            // Ask the kernel to start paging in the next chunk.  madvise wants a page aligned start.
+            size_t pageSize = sysconf(_SC_PAGESIZE);
+            size_t start = (readPosition * sizeof(F)) / pageSize * pageSize;
+            size_t len = std::min((size_t) chunkLen * sizeof(F), mappedBytes - start);
+            madvise((char *) mappedSamples + start, len, MADV_WILLNEED);
+        }
+#endif
+    }
+    else {
+        chunkStart += numSamples;
+    }
+}
+
+template <class F>
+template <class U>
+unsigned FileSource<F>::read(U *data, unsigned numSamples) {
+    unsigned numRead = 0;
+    while (numRead < numSamples && !eof()) {
+        size_t numAvailable;
+        const F *samples = peek(numSamples - numRead, numAvailable);
+        if (numAvailable == 0) {
+            // The file got shorter since it was opened.
+            break;
+        }
+        convertSamples(samples, data + numRead, numAvailable, scale);
+        advance(numAvailable);
+        numRead += numAvailable;
+    }
+    return numRead;
+}
+
+template <class F>
+template <class U>
+unsigned FileSource<F>::read(Vector<U> & data, unsigned numSamples) {
+    data.vec.resize(numSamples);
+    data.vec.resize(numSamples > 0 ? read(VECTOR_TO_ARRAY(data.vec), numSamples) : 0);
+    return data.size();
+}
+
+
+/**
+ * \brief Writes samples from vectors or views to a file as type F.
+ *
+ * F is the sample format of the file, as for FileSource.  Samples are converted and gathered into
+ * chunks, which are written when they fill up, by \ref flush, and when the sink is closed or
+ * destroyed.  The sink is not copyable.
+ */
+template <class F>
+class FileSink {
+ protected:
+    FILE *file;
+    unsigned chunkLen;
+    bool asyncIo;
+
+    typedef std::vector<F, AlignedAllocator<F> > ChunkBuffer;
+
+    /**
+     * \brief The chunk being filled.
+     */
+    ChunkBuffer chunk;
+
+    /**
+     * \brief With asyncIo, the chunk \ref writeBehindIo is writing.
+     */
+    ChunkBuffer writingChunk;
+    BackgroundIo writeBehindIo;
+
+    /**
+     * \brief Number of samples handed to \ref write so far.
+     */
+    size_t numSamplesWritten;
+
+    /**
+     * \brief Set if a write to the file comes up short.  Atomic because the write behind sets it
+     *      while \ref good may be reading it.
+     */
+    std::atomic<bool> writeFailed;
+
+    void writeChunk(ChunkBuffer & buf) {
+        if (!buf.empty() && fwrite(VECTOR_TO_ARRAY(buf), sizeof(F), buf.size(), file) != buf.size()) {
+            writeFailed = true;
+        }
+        buf.clear();
+    }
+
+    void finishWriteBehind() {writeBehindIo.wait();}
+
+    /**
+     * \brief Writes out \ref chunk, in the background if asyncIo is set.
+     */
+    void writeOutChunk();
+
+    FileSink<F>(const FileSink<F> &);
+    FileSink<F> & operator=(const FileSink<F> &);
+
+ public:
+    /**
+     * \brief Multiplies every sample before it is converted to F.  E.g. 32767 maps [-1, 1] to the
+     *      int16 range.  Conversion to integer formats rounds and saturates.  Defaults to 1.
+     */
+    double scale;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Opens "filename" for writing.  Check \ref isOpen to see if it worked.
+     *
+     * \param filename The file to write.
+     * \param writeBehind Write full chunks in the background while the caller fills the next one.
+     * \param chunkSamples Number of samples per chunk.  It is rounded up to a whole number of
+     *      DEFAULT_ALIGNMENT byte blocks.
+     * \param append Add to the end of an existing file instead of replacing it.
+     */
+    FileSink<F>(const char *filename, bool writeBehind = false, unsigned chunkSamples = DEFAULT_FILE_CHUNK_LEN,
+                bool append = false);
+
+    ~FileSink<F>() {close();}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns true if the file was opened successfully and hasn't been closed.
+     */
+    bool isOpen() const {return file != NULL;}
+
+    /**
+     * \brief Returns false if any write to the file has failed.
+     */
+    bool good() const {return isOpen() && !writeFailed;}
+
+    /**
+     * \brief Returns the number of samples written so far, including ones that are still buffered.
+     */
+    size_t size() const {return numSamplesWritten;}
+
+    /**
+     * \brief Writes the contents of "data", converted to F.
+     */
+    template <class U>
+    void write(const Vector<U> & data) {if (data.size() > 0) write(data.vec.data(), data.size());}
+
+    /**
+     * \brief Writes the contents of "data", converted to F.
+     */
+    template <class U>
+    void write(VectorView<U> data) {write(data.data(), data.size());}
+
+    /**
+     * \brief Writes "numSamples" samples from the array "data", converted to F.
+     */
+    template <class U>
+    void write(const U *data, unsigned numSamples);
+
+    /**
+     * \brief Writes out everything that has been buffered and waits for it to finish.
+     */
+    void flush();
+
+    /**
+     * \brief Flushes and closes the file.
+     */
+    void close();
+};
+
+
+template <class F>
+FileSink<F>::FileSink(const char *filename, bool writeBehind, unsigned chunkSamples, bool append) {
+    assert(chunkSamples > 0);
+    chunkLen = alignedChunkLen<F>(chunkSamples);
+    asyncIo = writeBehind;
+    numSamplesWritten = 0;
+    writeFailed = false;
+    scale = 1;
+    file = fopen(filename, append ? "ab" : "wb");
+    if (file != NULL) {
+        setvbuf(file, NULL, _IONBF, 0);
+        chunk.reserve(chunkLen);
+        if (asyncIo) {
+            writingChunk.reserve(chunkLen);
+        }
+    }
+}
+
+template <class F>
+void FileSink<F>::writeOutChunk() {
+    finishWriteBehind();
+    if (asyncIo) {
+        chunk.swap(writingChunk);
+        writeBehindIo.start([this]() {writeChunk(writingChunk);});
+    }
+    else {
+        writeChunk(chunk);
+    }
+}
+
+template <class F>
+template <class U>
+void FileSink<F>::write(const U *data, unsigned numSamples) {
+    assert(isOpen());
+    unsigned numDone = 0;
+    while (numDone < numSamples) {
+        size_t fill = chunk.size();
+        size_t num = std::min((size_t) (numSamples - numDone), (size_t) chunkLen - fill);
+        chunk.resize(fill + num);
+        convertSamples(data + numDone, VECTOR_TO_ARRAY(chunk) + fill, num, scale);
+        numDone += num;
+        if (chunk.size() == chunkLen) {
+            writeOutChunk();
+        }
+    }
+    numSamplesWritten += numSamples;
+}
+
+template <class F>
+void FileSink<F>::flush() {
+    if (file == NULL) {
+        return;
+    }
+    finishWriteBehind();
+    writeChunk(chunk);
+    fflush(file);
+}
+
+template <class F>
+void FileSink<F>::close() {
+    if (file == NULL) {
+        return;
+    }
+    flush();
+    fclose(file);
+    file = NULL;
+}
+
+};
+
+#endif
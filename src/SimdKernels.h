@@ -0,0 +1,1363 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file SimdKernels.h
+ *
+ * Dot product kernels used by the inner loops of the FIR filters, and the streaming and one-shot
+ * FIR loops built on them.
+ *
+ * The instruction set is picked at compile time from the compiler's target flags: AVX (with FMA
+ * if available), then SSE2, then NEON.  Build with e.g. "-mavx2 -mfma" or "-march=native" to get
+ * the wider kernels.  Define NIMBLEDSP_DISABLE_SIMD to force the portable versions.
+ *
+ * Because the SIMD kernels sum in a different order than a simple loop, floating point results
+ * can differ from the portable versions in the last few bits.
+ */
+
+#ifndef NimbleDSP_SimdKernels_h
+#define NimbleDSP_SimdKernels_h
+
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <stdint.h>
+#include "ThreadPool.h"
+#include "NimbleDspCommon.h"
+#include "Allocators.h"
+
+#if !defined(NIMBLEDSP_DISABLE_SIMD)
+    #if defined(__AVX__)
+        #define NIMBLEDSP_AVX
+        #define NIMBLEDSP_SSE2
+        #include <immintrin.h>
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define NIMBLEDSP_SSE2
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define NIMBLEDSP_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Returns the sum of x[i] * h[i] for i = 0 to n-1.
+ *
+ * This is the portable version.  It keeps four partial sums so that the compiler can pipeline
+ * the multiplies.  T can be any arithmetic type or std::complex.
+ */
+template <class T>
+inline T dotProduct(const T *x, const T *h, int n) {
+    T sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sum0 += x[i] * h[i];
+        sum1 += x[i + 1] * h[i + 1];
+        sum2 += x[i + 2] * h[i + 2];
+        sum3 += x[i + 3] * h[i + 3];
+    }
+    for (; i < n; i++) {
+        sum0 += x[i] * h[i];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * \brief Returns the sum of x[i] * h[i] for i = 0 to n-1, with complex data and real taps.
+ */
+template <class T>
+inline std::complex<T> dotProduct(const std::complex<T> *x, const T *h, int n) {
+    T re0 = 0, im0 = 0, re1 = 0, im1 = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        re0 += x[i].real() * h[i];
+        im0 += x[i].imag() * h[i];
+        re1 += x[i + 1].real() * h[i + 1];
+        im1 += x[i + 1].imag() * h[i + 1];
+    }
+    for (; i < n; i++) {
+        re0 += x[i].real() * h[i];
+        im0 += x[i].imag() * h[i];
+    }
+    return std::complex<T>(re0 + re1, im0 + im1);
+}
+
+
+#if defined(NIMBLEDSP_SSE2)
+
+inline float horizontalSum(__m128 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+inline double horizontalSum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+#if defined(NIMBLEDSP_AVX)
+inline __m256 multiplyAdd(__m256 a, __m256 b, __m256 c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+inline __m256d multiplyAdd(__m256d a, __m256d b, __m256d c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+#endif
+
+template <>
+inline float dotProduct<float>(const float *x, const float *h, int n) {
+    int i = 0;
+    __m128 acc = _mm_setzero_ps();
+#if defined(NIMBLEDSP_AVX)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = multiplyAdd(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i), acc0);
+        acc1 = multiplyAdd(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(h + i + 8), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    acc = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+#endif
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(h + i)));
+    }
+    float sum = horizontalSum(acc);
+    for (; i < n; i++) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+template <>
+inline double dotProduct<double>(const double *x, const double *h, int n) {
+    int i = 0;
+    __m128d acc = _mm_setzero_pd();
+#if defined(NIMBLEDSP_AVX)
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = multiplyAdd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(h + i), acc0);
+        acc1 = multiplyAdd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(h + i + 4), acc1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    acc = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+#endif
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(h + i)));
+    }
+    double sum = horizontalSum(acc);
+    for (; i < n; i++) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+template <>
+inline std::complex<float> dotProduct<float>(const std::complex<float> *x, const float *h, int n) {
+    // The accumulators hold interleaved (real, imag) pairs, so each tap is duplicated to line up
+    // with both halves of its sample.
+    const float *xf = reinterpret_cast<const float *>(x);
+    int i = 0;
+    __m128 acc = _mm_setzero_ps();
+#if defined(NIMBLEDSP_AVX)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256 taps = _mm256_loadu_ps(h + i);
+        __m256 lo = _mm256_unpacklo_ps(taps, taps);
+        __m256 hi = _mm256_unpackhi_ps(taps, taps);
+        acc0 = multiplyAdd(_mm256_loadu_ps(xf + 2*i), _mm256_permute2f128_ps(lo, hi, 0x20), acc0);
+        acc1 = multiplyAdd(_mm256_loadu_ps(xf + 2*i + 8), _mm256_permute2f128_ps(lo, hi, 0x31), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    acc = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+#endif
+    for (; i + 4 <= n; i += 4) {
+        __m128 taps = _mm_loadu_ps(h + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(xf + 2*i), _mm_unpacklo_ps(taps, taps)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(xf + 2*i + 4), _mm_unpackhi_ps(taps, taps)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    float re = _mm_cvtss_f32(acc);
+    float im = _mm_cvtss_f32(_mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+    for (; i < n; i++) {
+        re += x[i].real() * h[i];
+        im += x[i].imag() * h[i];
+    }
+    return std::complex<float>(re, im);
+}
+
+template <>
+inline std::complex<double> dotProduct<double>(const std::complex<double> *x, const double *h, int n) {
+    const double *xd = reinterpret_cast<const double *>(x);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(xd + 2*i), _mm_set1_pd(h[i])));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(xd + 2*i + 2), _mm_set1_pd(h[i + 1])));
+    }
+    for (; i < n; i++) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(xd + 2*i), _mm_set1_pd(h[i])));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    return std::complex<double>(_mm_cvtsd_f64(acc0), _mm_cvtsd_f64(_mm_unpackhi_pd(acc0, acc0)));
+}
+
+template <>
+inline std::complex<float> dotProduct< std::complex<float> >(const std::complex<float> *x,
+                                                             const std::complex<float> *h, int n) {
+    // straight holds (xr*hr, xi*hi) pairs and swapped holds (xr*hi, xi*hr) pairs, so the real part
+    // is the difference of straight's lanes and the imaginary part is the sum of swapped's.
+    const float *xf = reinterpret_cast<const float *>(x);
+    const float *hf = reinterpret_cast<const float *>(h);
+    int i = 0;
+    __m128 straight = _mm_setzero_ps();
+    __m128 swapped = _mm_setzero_ps();
+#if defined(NIMBLEDSP_AVX)
+    __m256 straight8 = _mm256_setzero_ps();
+    __m256 swapped8 = _mm256_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m256 data = _mm256_loadu_ps(xf + 2*i);
+        __m256 taps = _mm256_loadu_ps(hf + 2*i);
+        straight8 = multiplyAdd(data, taps, straight8);
+        swapped8 = multiplyAdd(data, _mm256_permute_ps(taps, _MM_SHUFFLE(2, 3, 0, 1)), swapped8);
+    }
+    straight = _mm_add_ps(_mm256_castps256_ps128(straight8), _mm256_extractf128_ps(straight8, 1));
+    swapped = _mm_add_ps(_mm256_castps256_ps128(swapped8), _mm256_extractf128_ps(swapped8, 1));
+#endif
+    for (; i + 2 <= n; i += 2) {
+        __m128 data = _mm_loadu_ps(xf + 2*i);
+        __m128 taps = _mm_loadu_ps(hf + 2*i);
+        straight = _mm_add_ps(straight, _mm_mul_ps(data, taps));
+        swapped = _mm_add_ps(swapped, _mm_mul_ps(data, _mm_shuffle_ps(taps, taps, _MM_SHUFFLE(2, 3, 0, 1))));
+    }
+    const __m128 negateOdd = _mm_set_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+    std::complex<float> sum(horizontalSum(_mm_mul_ps(straight, negateOdd)), horizontalSum(swapped));
+    for (; i < n; i++) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+template <>
+inline std::complex<double> dotProduct< std::complex<double> >(const std::complex<double> *x,
+                                                               const std::complex<double> *h, int n) {
+    const double *xd = reinterpret_cast<const double *>(x);
+    const double *hd = reinterpret_cast<const double *>(h);
+    __m128d straight = _mm_setzero_pd();
+    __m128d swapped = _mm_setzero_pd();
+    for (int i=0; i<n; i++) {
+        __m128d data = _mm_loadu_pd(xd + 2*i);
+        __m128d taps = _mm_loadu_pd(hd + 2*i);
+        straight = _mm_add_pd(straight, _mm_mul_pd(data, taps));
+        swapped = _mm_add_pd(swapped, _mm_mul_pd(data, _mm_shuffle_pd(taps, taps, 1)));
+    }
+    return std::complex<double>(_mm_cvtsd_f64(_mm_sub_sd(straight, _mm_unpackhi_pd(straight, straight))),
+                                horizontalSum(swapped));
+}
+
+#elif defined(NIMBLEDSP_NEON)
+
+template <>
+inline float dotProduct<float>(const float *x, const float *h, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(x + i), vld1q_f32(h + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(x + i + 4), vld1q_f32(h + i + 4));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(x + i), vld1q_f32(h + i));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+    float32x2_t pair = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    float sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+    for (; i < n; i++) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+template <>
+inline std::complex<float> dotProduct<float>(const std::complex<float> *x, const float *h, int n) {
+    const float *xf = reinterpret_cast<const float *>(x);
+    float32x4_t re = vdupq_n_f32(0);
+    float32x4_t im = vdupq_n_f32(0);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // vld2q splits the interleaved samples into real and imaginary vectors.
+        float32x4x2_t data = vld2q_f32(xf + 2*i);
+        float32x4_t taps = vld1q_f32(h + i);
+        re = vmlaq_f32(re, data.val[0], taps);
+        im = vmlaq_f32(im, data.val[1], taps);
+    }
+    float32x2_t rePair = vadd_f32(vget_low_f32(re), vget_high_f32(re));
+    float32x2_t imPair = vadd_f32(vget_low_f32(im), vget_high_f32(im));
+    std::complex<float> sum(vget_lane_f32(vpadd_f32(rePair, rePair), 0),
+                            vget_lane_f32(vpadd_f32(imPair, imPair), 0));
+    for (; i < n; i++) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+template <>
+inline std::complex<float> dotProduct< std::complex<float> >(const std::complex<float> *x,
+                                                             const std::complex<float> *h, int n) {
+    const float *xf = reinterpret_cast<const float *>(x);
+    const float *hf = reinterpret_cast<const float *>(h);
+    float32x4_t re = vdupq_n_f32(0);
+    float32x4_t im = vdupq_n_f32(0);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t data = vld2q_f32(xf + 2*i);
+        float32x4x2_t taps = vld2q_f32(hf + 2*i);
+        re = vmlaq_f32(re, data.val[0], taps.val[0]);
+        re = vmlsq_f32(re, data.val[1], taps.val[1]);
+        im = vmlaq_f32(im, data.val[0], taps.val[1]);
+        im = vmlaq_f32(im, data.val[1], taps.val[0]);
+    }
+    float32x2_t rePair = vadd_f32(vget_low_f32(re), vget_high_f32(re));
+    float32x2_t imPair = vadd_f32(vget_low_f32(im), vget_high_f32(im));
+    std::complex<float> sum(vget_lane_f32(vpadd_f32(rePair, rePair), 0),
+                            vget_lane_f32(vpadd_f32(imPair, imPair), 0));
+    for (; i < n; i++) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+#endif
+
+/**
+ * \brief Returns the same sum as \ref dotProduct for taps that are symmetric (h[i] == h[n-1-i]),
+ *      or antisymmetric (h[i] == -h[n-1-i]) if "antisymmetric" is true.
+ *
+ * The two samples that share a tap are added (or subtracted) before the multiply, so only the
+ * first (n + 1) / 2 taps are read and it takes half the multiplies.  This is the portable version.
+ * U is the sample type and V the tap type, as with \ref dotProduct.
+ */
+template <class U, class V>
+inline U foldedDotProduct(const U *x, const V *h, int n, bool antisymmetric) {
+    U sum0 = 0, sum1 = 0;
+    int half = n / 2;
+    int i = 0;
+    if (antisymmetric) {
+        for (; i + 2 <= half; i += 2) {
+            sum0 += (x[i] - x[n - 1 - i]) * h[i];
+            sum1 += (x[i + 1] - x[n - 2 - i]) * h[i + 1];
+        }
+        for (; i < half; i++) {
+            sum0 += (x[i] - x[n - 1 - i]) * h[i];
+        }
+    }
+    else {
+        for (; i + 2 <= half; i += 2) {
+            sum0 += (x[i] + x[n - 1 - i]) * h[i];
+            sum1 += (x[i + 1] + x[n - 2 - i]) * h[i + 1];
+        }
+        for (; i < half; i++) {
+            sum0 += (x[i] + x[n - 1 - i]) * h[i];
+        }
+    }
+    if (n % 2) {
+        sum0 += x[half] * h[half];
+    }
+    return sum0 + sum1;
+}
+
+
+#if defined(NIMBLEDSP_SSE2)
+
+// The SIMD versions load the mirrored samples from the far end, reverse them in the register, and
+// flip their sign bits with "flip" (all zeros for symmetric taps) so that one add folds either kind.
+// Like the dotProduct versions they keep two accumulators going so the adds can overlap.
+
+inline __m128 reverseFloats(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+inline __m128 reverseComplexFloats(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+#if defined(NIMBLEDSP_AVX)
+/**
+ * \brief Loads x[0] through x[7] in reverse order.  Loading the halves the other way round saves
+ *      a lane crossing shuffle.
+ */
+inline __m256 loadReversed(const float *x) {
+    __m256 swapped = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(x + 4)), _mm_loadu_ps(x), 1);
+    return _mm256_permute_ps(swapped, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+inline __m256d reverseDoubles(__m256d v) {
+    return _mm256_permute_pd(_mm256_permute2f128_pd(v, v, 1), 0x5);
+}
+
+inline __m256 reverseComplexFloats(__m256 v) {
+    return _mm256_permute_ps(_mm256_permute2f128_ps(v, v, 1), _MM_SHUFFLE(1, 0, 3, 2));
+}
+#endif
+
+template <>
+inline float foldedDotProduct<float, float>(const float *x, const float *h, int n, bool antisymmetric) {
+    int half = n / 2;
+    int i = 0;
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+#if defined(NIMBLEDSP_AVX)
+    __m256 flip8 = _mm256_set1_ps(antisymmetric ? -0.0f : 0.0f);
+    __m256 acc8a = _mm256_setzero_ps();
+    __m256 acc8b = _mm256_setzero_ps();
+    for (; i + 16 <= half; i += 16) {
+        __m256 back0 = _mm256_xor_ps(loadReversed(x + n - 8 - i), flip8);
+        __m256 back1 = _mm256_xor_ps(loadReversed(x + n - 16 - i), flip8);
+        acc8a = multiplyAdd(_mm256_add_ps(_mm256_loadu_ps(x + i), back0), _mm256_loadu_ps(h + i), acc8a);
+        acc8b = multiplyAdd(_mm256_add_ps(_mm256_loadu_ps(x + i + 8), back1), _mm256_loadu_ps(h + i + 8), acc8b);
+    }
+    acc8a = _mm256_add_ps(acc8a, acc8b);
+    acc0 = _mm_add_ps(_mm256_castps256_ps128(acc8a), _mm256_extractf128_ps(acc8a, 1));
+#endif
+    __m128 flip = _mm_set1_ps(antisymmetric ? -0.0f : 0.0f);
+    for (; i + 8 <= half; i += 8) {
+        __m128 back0 = _mm_xor_ps(reverseFloats(_mm_loadu_ps(x + n - 4 - i)), flip);
+        __m128 back1 = _mm_xor_ps(reverseFloats(_mm_loadu_ps(x + n - 8 - i)), flip);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(x + i), back0), _mm_loadu_ps(h + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(x + i + 4), back1), _mm_loadu_ps(h + i + 4)));
+    }
+    for (; i + 4 <= half; i += 4) {
+        __m128 back = _mm_xor_ps(reverseFloats(_mm_loadu_ps(x + n - 4 - i)), flip);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(x + i), back), _mm_loadu_ps(h + i)));
+    }
+    float sum = horizontalSum(_mm_add_ps(acc0, acc1));
+    for (; i < half; i++) {
+        sum += (antisymmetric ? x[i] - x[n - 1 - i] : x[i] + x[n - 1 - i]) * h[i];
+    }
+    if (n % 2) {
+        sum += x[half] * h[half];
+    }
+    return sum;
+}
+
+template <>
+inline double foldedDotProduct<double, double>(const double *x, const double *h, int n, bool antisymmetric) {
+    int half = n / 2;
+    int i = 0;
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+#if defined(NIMBLEDSP_AVX)
+    __m256d flip4 = _mm256_set1_pd(antisymmetric ? -0.0 : 0.0);
+    __m256d acc4a = _mm256_setzero_pd();
+    __m256d acc4b = _mm256_setzero_pd();
+    for (; i + 8 <= half; i += 8) {
+        __m256d back0 = _mm256_xor_pd(reverseDoubles(_mm256_loadu_pd(x + n - 4 - i)), flip4);
+        __m256d back1 = _mm256_xor_pd(reverseDoubles(_mm256_loadu_pd(x + n - 8 - i)), flip4);
+        acc4a = multiplyAdd(_mm256_add_pd(_mm256_loadu_pd(x + i), back0), _mm256_loadu_pd(h + i), acc4a);
+        acc4b = multiplyAdd(_mm256_add_pd(_mm256_loadu_pd(x + i + 4), back1), _mm256_loadu_pd(h + i + 4), acc4b);
+    }
+    acc4a = _mm256_add_pd(acc4a, acc4b);
+    acc0 = _mm_add_pd(_mm256_castpd256_pd128(acc4a), _mm256_extractf128_pd(acc4a, 1));
+#endif
+    __m128d flip = _mm_set1_pd(antisymmetric ? -0.0 : 0.0);
+    for (; i + 4 <= half; i += 4) {
+        __m128d back0 = _mm_loadu_pd(x + n - 2 - i);
+        __m128d back1 = _mm_loadu_pd(x + n - 4 - i);
+        back0 = _mm_xor_pd(_mm_shuffle_pd(back0, back0, 1), flip);
+        back1 = _mm_xor_pd(_mm_shuffle_pd(back1, back1, 1), flip);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(x + i), back0), _mm_loadu_pd(h + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(x + i + 2), back1), _mm_loadu_pd(h + i + 2)));
+    }
+    double sum = horizontalSum(_mm_add_pd(acc0, acc1));
+    for (; i < half; i++) {
+        sum += (antisymmetric ? x[i] - x[n - 1 - i] : x[i] + x[n - 1 - i]) * h[i];
+    }
+    if (n % 2) {
+        sum += x[half] * h[half];
+    }
+    return sum;
+}
+
+template <>
+inline std::complex<float> foldedDotProduct<std::complex<float>, float>(const std::complex<float> *x,
+                                                                         const float *h, int n, bool antisymmetric) {
+    // Two samples per register, so reversing the mirrored samples swaps the two (real, imag) pairs.
+    const float *xf = reinterpret_cast<const float *>(x);
+    int half = n / 2;
+    int i = 0;
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+#if defined(NIMBLEDSP_AVX)
+    __m256 flip8 = _mm256_set1_ps(antisymmetric ? -0.0f : 0.0f);
+    __m256 acc8a = _mm256_setzero_ps();
+    __m256 acc8b = _mm256_setzero_ps();
+    for (; i + 8 <= half; i += 8) {
+        __m256 taps = _mm256_loadu_ps(h + i);
+        __m256 lo = _mm256_unpacklo_ps(taps, taps);
+        __m256 hi = _mm256_unpackhi_ps(taps, taps);
+        __m256 back0 = _mm256_xor_ps(reverseComplexFloats(_mm256_loadu_ps(xf + 2*(n - 4 - i))), flip8);
+        __m256 back1 = _mm256_xor_ps(reverseComplexFloats(_mm256_loadu_ps(xf + 2*(n - 8 - i))), flip8);
+        acc8a = multiplyAdd(_mm256_add_ps(_mm256_loadu_ps(xf + 2*i), back0), _mm256_permute2f128_ps(lo, hi, 0x20),
+                            acc8a);
+        acc8b = multiplyAdd(_mm256_add_ps(_mm256_loadu_ps(xf + 2*i + 8), back1),
+                            _mm256_permute2f128_ps(lo, hi, 0x31), acc8b);
+    }
+    acc8a = _mm256_add_ps(acc8a, acc8b);
+    acc0 = _mm_add_ps(_mm256_castps256_ps128(acc8a), _mm256_extractf128_ps(acc8a, 1));
+#endif
+    __m128 flip = _mm_set1_ps(antisymmetric ? -0.0f : 0.0f);
+    for (; i + 4 <= half; i += 4) {
+        __m128 taps = _mm_loadu_ps(h + i);
+        __m128 back0 = _mm_xor_ps(reverseComplexFloats(_mm_loadu_ps(xf + 2*(n - 2 - i))), flip);
+        __m128 back1 = _mm_xor_ps(reverseComplexFloats(_mm_loadu_ps(xf + 2*(n - 4 - i))), flip);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(xf + 2*i), back0), _mm_unpacklo_ps(taps, taps)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(xf + 2*i + 4), back1),
+                                           _mm_unpackhi_ps(taps, taps)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    float re = _mm_cvtss_f32(acc0);
+    float im = _mm_cvtss_f32(_mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(1, 1, 1, 1)));
+    for (; i < half; i++) {
+        std::complex<float> pair = antisymmetric ? x[i] - x[n - 1 - i] : x[i] + x[n - 1 - i];
+        re += pair.real() * h[i];
+        im += pair.imag() * h[i];
+    }
+    if (n % 2) {
+        re += x[half].real() * h[half];
+        im += x[half].imag() * h[half];
+    }
+    return std::complex<float>(re, im);
+}
+
+template <>
+inline std::complex<double> foldedDotProduct<std::complex<double>, double>(const std::complex<double> *x,
+                                                                            const double *h, int n,
+                                                                            bool antisymmetric) {
+    const double *xd = reinterpret_cast<const double *>(x);
+    int half = n / 2;
+    __m128d flip = _mm_set1_pd(antisymmetric ? -0.0 : 0.0);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 2 <= half; i += 2) {
+        __m128d pair0 = _mm_add_pd(_mm_loadu_pd(xd + 2*i), _mm_xor_pd(_mm_loadu_pd(xd + 2*(n - 1 - i)), flip));
+        __m128d pair1 = _mm_add_pd(_mm_loadu_pd(xd + 2*i + 2), _mm_xor_pd(_mm_loadu_pd(xd + 2*(n - 2 - i)), flip));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(pair0, _mm_set1_pd(h[i])));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(pair1, _mm_set1_pd(h[i + 1])));
+    }
+    for (; i < half; i++) {
+        __m128d pair = _mm_add_pd(_mm_loadu_pd(xd + 2*i), _mm_xor_pd(_mm_loadu_pd(xd + 2*(n - 1 - i)), flip));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(pair, _mm_set1_pd(h[i])));
+    }
+    if (n % 2) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(xd + 2*half), _mm_set1_pd(h[half])));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    return std::complex<double>(_mm_cvtsd_f64(acc0), _mm_cvtsd_f64(_mm_unpackhi_pd(acc0, acc0)));
+}
+
+template <>
+inline std::complex<float> foldedDotProduct< std::complex<float>, std::complex<float> >(
+            const std::complex<float> *x, const std::complex<float> *h, int n, bool antisymmetric) {
+    // The straight and swapped sums of the complex dotProduct, on the folded samples.
+    const float *xf = reinterpret_cast<const float *>(x);
+    const float *hf = reinterpret_cast<const float *>(h);
+    int half = n / 2;
+    int i = 0;
+    __m128 straight = _mm_setzero_ps();
+    __m128 swapped = _mm_setzero_ps();
+#if defined(NIMBLEDSP_AVX)
+    __m256 flip8 = _mm256_set1_ps(antisymmetric ? -0.0f : 0.0f);
+    __m256 straight8 = _mm256_setzero_ps();
+    __m256 swapped8 = _mm256_setzero_ps();
+    for (; i + 4 <= half; i += 4) {
+        __m256 back = _mm256_xor_ps(reverseComplexFloats(_mm256_loadu_ps(xf + 2*(n - 4 - i))), flip8);
+        __m256 data = _mm256_add_ps(_mm256_loadu_ps(xf + 2*i), back);
+        __m256 taps = _mm256_loadu_ps(hf + 2*i);
+        straight8 = multiplyAdd(data, taps, straight8);
+        swapped8 = multiplyAdd(data, _mm256_permute_ps(taps, _MM_SHUFFLE(2, 3, 0, 1)), swapped8);
+    }
+    straight = _mm_add_ps(_mm256_castps256_ps128(straight8), _mm256_extractf128_ps(straight8, 1));
+    swapped = _mm_add_ps(_mm256_castps256_ps128(swapped8), _mm256_extractf128_ps(swapped8, 1));
+#endif
+    __m128 flip = _mm_set1_ps(antisymmetric ? -0.0f : 0.0f);
+    for (; i + 2 <= half; i += 2) {
+        __m128 back = _mm_xor_ps(reverseComplexFloats(_mm_loadu_ps(xf + 2*(n - 2 - i))), flip);
+        __m128 data = _mm_add_ps(_mm_loadu_ps(xf + 2*i), back);
+        __m128 taps = _mm_loadu_ps(hf + 2*i);
+        straight = _mm_add_ps(straight, _mm_mul_ps(data, taps));
+        swapped = _mm_add_ps(swapped, _mm_mul_ps(data, _mm_shuffle_ps(taps, taps, _MM_SHUFFLE(2, 3, 0, 1))));
+    }
+    const __m128 negateOdd = _mm_set_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+    std::complex<float> sum(horizontalSum(_mm_mul_ps(straight, negateOdd)), horizontalSum(swapped));
+    for (; i < half; i++) {
+        sum += (antisymmetric ? x[i] - x[n - 1 - i] : x[i] + x[n - 1 - i]) * h[i];
+    }
+    if (n % 2) {
+        sum += x[half] * h[half];
+    }
+    return sum;
+}
+
+template <>
+inline std::complex<double> foldedDotProduct< std::complex<double>, std::complex<double> >(
+            const std::complex<double> *x, const std::complex<double> *h, int n, bool antisymmetric) {
+    const double *xd = reinterpret_cast<const double *>(x);
+    const double *hd = reinterpret_cast<const double *>(h);
+    int half = n / 2;
+    __m128d flip = _mm_set1_pd(antisymmetric ? -0.0 : 0.0);
+    __m128d straight = _mm_setzero_pd();
+    __m128d swapped = _mm_setzero_pd();
+    for (int i=0; i<half; i++) {
+        __m128d data = _mm_add_pd(_mm_loadu_pd(xd + 2*i), _mm_xor_pd(_mm_loadu_pd(xd + 2*(n - 1 - i)), flip));
+        __m128d taps = _mm_loadu_pd(hd + 2*i);
+        straight = _mm_add_pd(straight, _mm_mul_pd(data, taps));
+        swapped = _mm_add_pd(swapped, _mm_mul_pd(data, _mm_shuffle_pd(taps, taps, 1)));
+    }
+    if (n % 2) {
+        __m128d data = _mm_loadu_pd(xd + 2*half);
+        __m128d taps = _mm_loadu_pd(hd + 2*half);
+        straight = _mm_add_pd(straight, _mm_mul_pd(data, taps));
+        swapped = _mm_add_pd(swapped, _mm_mul_pd(data, _mm_shuffle_pd(taps, taps, 1)));
+    }
+    return std::complex<double>(_mm_cvtsd_f64(_mm_sub_sd(straight, _mm_unpackhi_pd(straight, straight))),
+                                horizontalSum(swapped));
+}
+
+#elif defined(NIMBLEDSP_NEON)
+
+template <>
+inline float foldedDotProduct<float, float>(const float *x, const float *h, int n, bool antisymmetric) {
+    int half = n / 2;
+    int i = 0;
+    float32x4_t acc = vdupq_n_f32(0);
+    for (; i + 4 <= half; i += 4) {
+        // vrev64q reverses each half, and swapping the halves finishes the job.
+        float32x4_t back = vrev64q_f32(vld1q_f32(x + n - 4 - i));
+        back = vcombine_f32(vget_high_f32(back), vget_low_f32(back));
+        float32x4_t front = vld1q_f32(x + i);
+        acc = vmlaq_f32(acc, antisymmetric ? vsubq_f32(front, back) : vaddq_f32(front, back), vld1q_f32(h + i));
+    }
+    float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    float sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+    for (; i < half; i++) {
+        sum += (antisymmetric ? x[i] - x[n - 1 - i] : x[i] + x[n - 1 - i]) * h[i];
+    }
+    if (n % 2) {
+        sum += x[half] * h[half];
+    }
+    return sum;
+}
+
+#endif
+
+/**
+ * \brief Works out whether "n" taps are symmetric or antisymmetric.
+ *
+ * The comparison is exact, since folding taps that are only nearly symmetric would quietly
+ * change the results.  Taps that are all zero count as symmetric.
+ *
+ * \return NimbleDSP::SYMMETRIC_TAPS, NimbleDSP::ANTISYMMETRIC_TAPS or NimbleDSP::NO_SYMMETRY.
+ */
+template <class V>
+TapSymmetryType detectTapSymmetry(const V *taps, int n) {
+    bool symmetric = true;
+    bool antisymmetric = true;
+    for (int i=0; i<(n + 1)/2 && (symmetric || antisymmetric); i++) {
+        symmetric = symmetric && (taps[i] == taps[n - 1 - i]);
+        antisymmetric = antisymmetric && (taps[i] == -taps[n - 1 - i]);
+    }
+    if (n > 0 && symmetric) {
+        return SYMMETRIC_TAPS;
+    }
+    if (n > 0 && antisymmetric) {
+        return ANTISYMMETRIC_TAPS;
+    }
+    return NO_SYMMETRY;
+}
+
+/**
+ * \brief Number of taps below which \ref firDotProduct doesn't fold.  Short filters spend much of
+ *      their time in the scalar tails, and the SIMD dotProduct is faster for them.
+ */
+const int FOLD_MIN_TAPS = 64;
+
+/**
+ * \brief \ref dotProduct with reversed taps, or \ref foldedDotProduct when "symmetry" is
+ *      NimbleDSP::SYMMETRIC_TAPS or NimbleDSP::ANTISYMMETRIC_TAPS and there are at least
+ *      \ref FOLD_MIN_TAPS taps.  Reversing taps doesn't change their symmetry, so the folded version
+ *      works on them as they are.
+ */
+template <class U, class V>
+inline U firDotProduct(const U *x, const V *reversedTaps, int n, TapSymmetryType symmetry) {
+    if (n >= FOLD_MIN_TAPS && (symmetry == SYMMETRIC_TAPS || symmetry == ANTISYMMETRIC_TAPS)) {
+        return foldedDotProduct(x, reversedTaps, n, symmetry == ANTISYMMETRIC_TAPS);
+    }
+    return dotProduct(x, reversedTaps, n);
+}
+
+/**
+ * \brief Builds the table that lets \ref streamingFirInterp fold a symmetric or antisymmetric
+ *      interpolation filter.
+ *
+ * A polyphase branch of a linear phase filter isn't symmetric by itself, but when filterLen is a
+ * multiple of "rate", branch p is branch rate - 1 - p backwards, and the two branches produce a
+ * pair of outputs from the same input samples.  Splitting reversed branch p into the parts that
+ * are symmetric and antisymmetric about its centre, the pair is the sum and difference of two
+ * folded dot products, which together take as many multiplies as one output does directly.  Row p
+ * (for p < rate / 2) of the table holds the symmetric part and row rate - 1 - p the antisymmetric
+ * part.  For odd rates the middle branch is its own mirror image, and its row is just the branch
+ * reversed.  Each row has filterLen / rate taps.
+ *
+ * \return False, with "folded" left empty, if the filter can't be folded this way.  Integer taps
+ *      aren't folded, since splitting them would round.
+ */
+template <class V>
+bool foldInterpTaps(const V *taps, int filterLen, int rate, TapSymmetryType symmetry, std::vector<V> & folded) {
+    folded.clear();
+    if ((symmetry != SYMMETRIC_TAPS && symmetry != ANTISYMMETRIC_TAPS) || rate < 2 || filterLen % rate != 0 ||
+            !std::is_floating_point<decltype(std::abs(V()))>::value) {
+        return false;
+    }
+    int branchLen = filterLen / rate;
+    folded.resize(filterLen);
+    for (int p=0; p<=(rate - 1)/2; p++) {
+        int q = rate - 1 - p;
+        for (int i=0; i<branchLen; i++) {
+            V reversed = taps[p + (branchLen - 1 - i) * rate];
+            V forward = taps[p + i * rate];
+            if (p == q) {
+                folded[p * branchLen + i] = reversed;
+            }
+            else {
+                folded[p * branchLen + i] = (reversed + forward) / V(2);
+                folded[q * branchLen + i] = (reversed - forward) / V(2);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Computes the "rate" interpolation outputs that use the input samples x[0] through
+ *      x[branchLen - 1], from a table built by \ref foldInterpTaps.
+ */
+template <class U, class V>
+inline void foldedInterpOutputs(const U *x, const V *folded, int branchLen, int rate, bool antisymmetric,
+                                U *results) {
+    for (int p=0, q=rate-1; p<q; p++, q--) {
+        U even = foldedDotProduct(x, folded + p * branchLen, branchLen, false);
+        U odd = foldedDotProduct(x, folded + q * branchLen, branchLen, true);
+        results[p] = even + odd;
+        results[q] = antisymmetric ? odd - even : even - odd;
+    }
+    if (rate % 2) {
+        results[rate / 2] = foldedDotProduct(x, folded + (rate / 2) * branchLen, branchLen, antisymmetric);
+    }
+}
+
+/**
+ * \brief Splits "taps" into "rate" polyphase branches, so that resampling can use \ref dotProduct.
+ *
+ * Branch p holds taps p, p + rate, p + 2*rate, ... in reverse order, zero padded at the front to
+ * (filterLen + rate - 1) / rate taps, and the branches are stored one after another in "banks".
+ * The taps that line up with consecutive input samples are then contiguous and in the same order
+ * as the samples.  See \ref phaseBankDotProduct.
+ */
+template <class U, class V>
+void buildPhaseBanks(const U *taps, int filterLen, int rate, std::vector<V> & banks) {
+    int tapsPerPhase = (filterLen + rate - 1) / rate;
+    banks.assign(rate * tapsPerPhase, V(0));
+    for (int p=0; p<rate; p++) {
+        V *bank = &banks[0] + p * tapsPerPhase;
+        for (int j=0, tapIndex=p; tapIndex<filterLen; j++, tapIndex+=rate) {
+            bank[tapsPerPhase - 1 - j] = (V) taps[tapIndex];
+        }
+    }
+}
+
+/**
+ * \brief Returns the sum of x[j] * taps[filterIndex - j * rate] for j = 0 to count - 1, using the
+ *      tables from \ref buildPhaseBanks.  "count" must be at most filterIndex / rate + 1.
+ */
+template <class U, class V>
+inline U phaseBankDotProduct(const U *x, const V *banks, int tapsPerPhase, int rate, int filterIndex, int count) {
+    return dotProduct(x, banks + (filterIndex % rate) * tapsPerPhase + tapsPerPhase - 1 - filterIndex / rate, count);
+}
+
+/**
+ * \brief Returns the sum of x[i] * h[i] for i = 0 to n-1, computed in the accumulator type A.
+ *
+ * For fixed point data, where the products and the sum don't fit in the sample type.  Each
+ * sample and tap is widened to A before it is multiplied.  This is the portable version; int16_t
+ * data and taps with an int32_t accumulator have SIMD versions (SSE2 pmaddwd, NEON vmlal).
+ */
+template <class A, class T, class C>
+inline A dotProductAccumulate(const T *x, const C *h, int n) {
+    A sum0 = 0, sum1 = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        sum0 += (A) x[i] * (A) h[i];
+        sum1 += (A) x[i + 1] * (A) h[i + 1];
+    }
+    for (; i < n; i++) {
+        sum0 += (A) x[i] * (A) h[i];
+    }
+    return sum0 + sum1;
+}
+
+#if defined(NIMBLEDSP_SSE2)
+
+template <>
+inline int32_t dotProductAccumulate<int32_t, int16_t, int16_t>(const int16_t *x, const int16_t *h, int n) {
+    // pmaddwd multiplies eight pairs of 16 bit values and adds adjacent products into four 32 bit
+    // sums.
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x + i)),
+                                                  _mm_loadu_si128((const __m128i *) (h + i))));
+        acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x + i + 8)),
+                                                  _mm_loadu_si128((const __m128i *) (h + i + 8))));
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x + i)),
+                                                  _mm_loadu_si128((const __m128i *) (h + i))));
+    }
+    acc0 = _mm_add_epi32(acc0, acc1);
+    acc0 = _mm_add_epi32(acc0, _mm_shuffle_epi32(acc0, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc0 = _mm_add_epi32(acc0, _mm_shuffle_epi32(acc0, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t sum = _mm_cvtsi128_si32(acc0);
+    for (; i < n; i++) {
+        sum += (int32_t) x[i] * (int32_t) h[i];
+    }
+    return sum;
+}
+
+#elif defined(NIMBLEDSP_NEON)
+
+template <>
+inline int32_t dotProductAccumulate<int32_t, int16_t, int16_t>(const int16_t *x, const int16_t *h, int n) {
+    // vmlal widens four 16 bit products to 32 bits and accumulates them.
+    int32x4_t acc0 = vdupq_n_s32(0);
+    int32x4_t acc1 = vdupq_n_s32(0);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t data = vld1q_s16(x + i);
+        int16x8_t taps = vld1q_s16(h + i);
+        acc0 = vmlal_s16(acc0, vget_low_s16(data), vget_low_s16(taps));
+        acc1 = vmlal_s16(acc1, vget_high_s16(data), vget_high_s16(taps));
+    }
+    acc0 = vaddq_s32(acc0, acc1);
+    int32x2_t pair = vadd_s32(vget_low_s32(acc0), vget_high_s32(acc0));
+    int32_t sum = vget_lane_s32(vpadd_s32(pair, pair), 0);
+    for (; i < n; i++) {
+        sum += (int32_t) x[i] * (int32_t) h[i];
+    }
+    return sum;
+}
+
+#endif
+
+/**
+ * \brief Streaming direct form FIR filter that works in place, without a full copy of the block.
+ *
+ * "history" is a double length buffer of 2 * (numTaps - 1) samples.  On entry its first
+ * numTaps - 1 samples are the last inputs of the previous block, and on return they are the last
+ * inputs of this one.  The first numTaps - 1 outputs need some of those old samples, so they are
+ * computed in the history buffer with the start of the block appended.  The rest only need
+ * samples from "data" and are computed in place from the end of the block backwards, which never
+ * overwrites an input that a later (i.e. earlier in time) output still needs.
+ *
+ * \param data The block to filter.  Holds the filtered samples on return.
+ * \param dataLen Number of samples in "data".
+ * \param reversedTaps The filter taps in reverse order.
+ * \param numTaps Number of taps.
+ * \param history The double length history buffer.
+ * \param symmetry Symmetry of the taps, for \ref firDotProduct.
+ */
+template <class U, class V>
+void streamingFirInPlace(U *data, int dataLen, const V *reversedTaps, int numTaps, U *history,
+                         TapSymmetryType symmetry = NO_SYMMETRY) {
+    int numHistory = numTaps - 1;
+    int headLen = (dataLen < numHistory) ? dataLen : numHistory;
+
+    for (int i=0; i<headLen; i++) {
+        history[numHistory + i] = data[i];
+    }
+    // Output i only needs history[i] through history[i + numHistory], so it can replace history[i].
+    for (int i=0; i<headLen; i++) {
+        history[i] = firDotProduct(history + i, reversedTaps, numTaps, symmetry);
+    }
+
+    if (dataLen > numHistory) {
+        for (int i=0; i<numHistory; i++) {
+            history[numHistory + i] = data[dataLen - numHistory + i];
+        }
+        for (int i=dataLen-1; i>=numHistory; i--) {
+            data[i] = firDotProduct(data + i - numHistory, reversedTaps, numTaps, symmetry);
+        }
+        for (int i=0; i<numHistory; i++) {
+            data[i] = history[i];
+            history[i] = history[numHistory + i];
+        }
+    }
+    else {
+        for (int i=0; i<dataLen; i++) {
+            data[i] = history[i];
+        }
+        for (int i=0; i<numHistory; i++) {
+            history[i] = history[dataLen + i];
+        }
+    }
+}
+
+/**
+ * \brief Loader for \ref streamingFirDecimate that passes the samples through unchanged.
+ */
+struct IdentityLoad {
+    template <class U>
+    const U & operator()(const U & sample) const {return sample;}
+};
+
+/**
+ * \brief Streaming direct form decimating FIR filter with a loader.
+ *
+ * The history and the new block are stitched together in "work" as the loader runs over the
+ * block, so "results" may point at "data".  There are never more results than input samples.
+ *
+ * \param data The block to filter.
+ * \param dataLen Number of samples in "data".
+ * \param rate The decimation rate.
+ * \param reversedTaps The filter taps in reverse order.
+ * \param numTaps Number of taps.
+ * \param history Input samples left over from the previous block.
+ * \param numSavedSamples Number of samples in "history".  Updated on return.
+ * \param work Working buffer.  Keeps its capacity between calls.
+ * \param results Receives the filtered samples.
+ * \param load Called on each new sample, in order, as it is copied into "work", and returns the
+ *      sample to filter.  Lets a mixer or other per-sample operation ride along with the copy
+ *      instead of making its own pass over the data.
+ * \param symmetry Symmetry of the taps, for \ref firDotProduct.
+ * \return Number of results.
+ */
+template <class U, class V, class Load>
+int streamingFirDecimate(const U *data, int dataLen, int rate, const V *reversedTaps, int numTaps, U *history,
+                         int & numSavedSamples, std::vector<U> & work, U *results, Load & load,
+                         TapSymmetryType symmetry = NO_SYMMETRY) {
+    // A negative number of saved samples means that the next output starts that many samples
+    // into the new block.
+    int numSkipped = std::max(0, -numSavedSamples);
+    int numSaved = std::max(0, numSavedSamples);
+    int totalLen = numSaved + dataLen - numSkipped;
+    if (totalLen < 0) {
+        for (int i=0; i<dataLen; i++) {
+            load(data[i]);
+        }
+        numSavedSamples += dataLen;
+        return 0;
+    }
+    work.resize(totalLen);
+    for (int i=0; i<numSaved; i++) {
+        work[i] = history[i];
+    }
+    for (int i=0; i<numSkipped; i++) {
+        load(data[i]);
+    }
+    for (int i=numSkipped; i<dataLen; i++) {
+        work[i - numSkipped + numSaved] = load(data[i]);
+    }
+    
+    int numResults = 0;
+    if (totalLen >= numTaps) {
+        numResults = (totalLen - (numTaps - 1) + rate - 1) / rate;
+    }
+    for (int i=0; i<numResults; i++) {
+        results[i] = firDotProduct(&work[0] + i*rate, reversedTaps, numTaps, symmetry);
+    }
+    
+    int nextResultDataPoint = numResults * rate;
+    numSavedSamples = totalLen - nextResultDataPoint;
+    for (int i=0; i<numSavedSamples; i++) {
+        history[i] = work[i + nextResultDataPoint];
+    }
+    return numResults;
+}
+
+/**
+ * \brief Streaming direct form decimating FIR filter that reads the block in place.
+ *
+ * "history" is a double length buffer of 2 * (numTaps - 1) samples, as for
+ * \ref streamingFirInPlace.  The outputs that need samples from the previous block are computed
+ * with the start of the block stitched onto the end of the history, and the rest read straight
+ * from "data", so the block isn't copied.  "results" may point at "data": the first few outputs,
+ * whose places still hold samples that later outputs need, are held in "work" until the end.
+ * There are never more results than input samples.
+ *
+ * \param data The block to filter.
+ * \param dataLen Number of samples in "data".
+ * \param rate The decimation rate.
+ * \param reversedTaps The filter taps in reverse order.
+ * \param numTaps Number of taps.
+ * \param history The double length history buffer.  Its first numSavedSamples samples are the
+ *      input left over from the previous block.
+ * \param numSavedSamples Number of samples in "history".  Updated on return.  It is negative when
+ *      the next output starts partway into the next block, which happens when "rate" is more than
+ *      "numTaps".
+ * \param work Working buffer for at most numTaps outputs.  Keeps its capacity between calls.
+ * \param results Receives the filtered samples.
+ * \param symmetry Symmetry of the taps, for \ref firDotProduct.
+ * \return Number of results.
+ */
+template <class U, class V>
+int streamingFirDecimate(const U *data, int dataLen, int rate, const V *reversedTaps, int numTaps, U *history,
+                         int & numSavedSamples, std::vector<U> & work, U *results, IdentityLoad &,
+                         TapSymmetryType symmetry = NO_SYMMETRY) {
+    int numSaved = numSavedSamples;
+    int numHistory = numTaps - 1;
+    if (rate == 1 && numSaved == numHistory && results == data) {
+        streamingFirInPlace(results, dataLen, reversedTaps, numTaps, history, symmetry);
+        return dataLen;
+    }
+    
+    // Output i starts i * rate samples in, counting from the start of the history, which is
+    // data[i * rate - numSaved].
+    int totalLen = numSaved + dataLen;
+    int numResults = 0;
+    if (totalLen >= numTaps) {
+        numResults = (totalLen - (numTaps - 1) + rate - 1) / rate;
+    }
+    int numHead = (numSaved > 0) ? std::min(numResults, (numSaved + rate - 1) / rate) : 0;
+    int numHeld = numHead;
+    if (results == data) {
+        // Writing output j in place is only safe once output j + 1 starts past it.
+        int numUnsafe = (rate == 1) ? numResults : ((numSaved >= rate) ? (numSaved - rate) / (rate - 1) + 1 : 0);
+        numHeld = std::max(numHeld, std::min(numResults, numUnsafe));
+    }
+    
+    if (numHead > 0) {
+        int headLen = std::min(dataLen, numHistory);
+        for (int i=0; i<headLen; i++) {
+            history[numSaved + i] = data[i];
+        }
+    }
+    work.resize(numHeld);
+    for (int i=0; i<numHeld; i++) {
+        const U *x = (i < numHead) ? history + i * rate : data + (i * rate - numSaved);
+        work[i] = firDotProduct(x, reversedTaps, numTaps, symmetry);
+    }
+    
+    // Save the samples that the next block needs before the results can overwrite them.
+    int nextStart = numResults * rate;
+    numSavedSamples = totalLen - nextStart;
+    for (int i=0; i<numSavedSamples; i++) {
+        int n = nextStart + i;
+        history[i] = (n < numSaved) ? history[n] : data[n - numSaved];
+    }
+    
+    for (int i=numHeld; i<numResults; i++) {
+        results[i] = firDotProduct(data + (i * rate - numSaved), reversedTaps, numTaps, symmetry);
+    }
+    for (int i=0; i<numHeld; i++) {
+        results[i] = work[i];
+    }
+    return numResults;
+}
+
+/**
+ * \brief Streaming decimating FIR filter without a loader.  See the version above.
+ */
+template <class U, class V>
+inline int streamingFirDecimate(const U *data, int dataLen, int rate, const V *reversedTaps, int numTaps, U *history,
+                                int & numSavedSamples, std::vector<U> & work, U *results,
+                                TapSymmetryType symmetry = NO_SYMMETRY) {
+    IdentityLoad load;
+    return streamingFirDecimate(data, dataLen, rate, reversedTaps, numTaps, history, numSavedSamples, work, results,
+                                load, symmetry);
+}
+
+/**
+ * \brief Streaming interpolating FIR filter.
+ *
+ * Produces at most dataLen * rate results.  "results" may point at "data" as long as it has room
+ * for all of the results.  The outputs are computed from the last one back, which never
+ * overwrites an input sample that an earlier output still needs, and read the block in place.
+ * Only the ones that need samples from the previous block use a copy of the history with the
+ * start of the block stitched on, in "work".
+ *
+ * \param data The block to filter.
+ * \param dataLen Number of samples in "data".
+ * \param rate The interpolation rate.
+ * \param phaseBanks The filter taps split up by \ref buildPhaseBanks for "rate".
+ * \param filterLen Number of taps.
+ * \param history Input samples left over from the previous block.
+ * \param numSavedSamples Number of samples in "history".  Updated on return.
+ * \param phase The filter phase.  Updated on return.
+ * \param work Working buffer for the stitched history.  Keeps its capacity between calls.
+ * \param results Receives the filtered samples.
+ * \param folded Table from \ref foldInterpTaps, or NULL.  When it is given, and the filter is at
+ *      the start of a group of "rate" outputs (which it always is when filterLen is a multiple of
+ *      "rate"), the outputs are computed a group at a time with \ref foldedInterpOutputs.
+ * \param symmetry Symmetry of the taps.  Only used with "folded".
+ * \return Number of results.
+ */
+template <class U, class V>
+int streamingFirInterp(const U *data, int dataLen, int rate, const V *phaseBanks, int filterLen, U *history,
+                       int & numSavedSamples, int & phase, std::vector<U> & work, U *results,
+                       const V *folded = NULL, TapSymmetryType symmetry = NO_SYMMETRY) {
+    int numTaps = (filterLen + rate - 1) / rate;
+    // Output r starts at sample dataStart, counting from the start of the history, and its
+    // oldest sample meets tap filterStart.  Between blocks filterStart is at least lastGroup.
+    int lastGroup = filterLen - rate;
+    if (numSavedSamples >= numTaps || phase < lastGroup) {
+        // First call to interp, have too many "saved" (really just the initial zeros) samples
+        numSavedSamples = numTaps - 1;
+        phase = (numTaps - 1) * rate;
+    }
+    if (dataLen == 0) {
+        return 0;
+    }
+    
+    int numSaved = numSavedSamples;
+    int headLen = std::min(dataLen, numTaps);
+    work.resize(numSaved + headLen);
+    for (int i=0; i<numSaved; i++) {
+        work[i] = history[i];
+    }
+    for (int i=0; i<headLen; i++) {
+        work[numSaved + i] = data[i];
+    }
+    for (int i=0; i<numSaved; i++) {
+        history[i] = (dataLen >= numSaved) ? data[dataLen - numSaved + i] : work[dataLen + i];
+    }
+    
+    // The results run until dataStart reaches dataLen, which leaves filterStart at lastGroup.
+    int numResults = lastGroup + dataLen * rate - phase;
+    int stitchedLen = numSaved + headLen;
+    if (folded != NULL && phase == lastGroup && numSaved == numTaps - 1) {
+        // Every input sample past the history starts a group of "rate" outputs.
+        for (int dataStart=dataLen-1; dataStart>=0; dataStart--) {
+            const U *x = (dataStart + numTaps <= stitchedLen) ? &work[0] + dataStart : data + (dataStart - numSaved);
+            foldedInterpOutputs(x, folded, numTaps, rate, symmetry == ANTISYMMETRIC_TAPS, results + dataStart * rate);
+        }
+    }
+    else {
+        int last = phase + numResults - 1;
+        int dataStart = (last < filterLen) ? 0 : (last - lastGroup) / rate;
+        int filterStart = last - dataStart * rate;
+        for (int resultIndex=numResults-1; resultIndex>=0; resultIndex--) {
+            if (filterStart < 0) {
+                results[resultIndex] = U(0);
+            }
+            else {
+                int count = filterStart / rate + 1;
+                const U *x = (dataStart + count <= stitchedLen) ? &work[0] + dataStart : data + (dataStart - numSaved);
+                results[resultIndex] = phaseBankDotProduct(x, phaseBanks, numTaps, rate, filterStart, count);
+            }
+            if (dataStart > 0 && filterStart == lastGroup) {
+                filterStart = filterLen - 1;
+                --dataStart;
+            }
+            else {
+                --filterStart;
+            }
+        }
+    }
+    phase = lastGroup;
+    return numResults;
+}
+
+/**
+ * \brief Streaming polyphase rational resampler.
+ *
+ * Resamples by interpRate / decimateRate with the banks from \ref buildPhaseBanks, so every
+ * output is a single \ref dotProduct over tapsPerPhase input samples.  Each call produces every
+ * output whose newest input sample is in "data".  As in \ref streamingFirInPlace, "history" is a
+ * double length buffer: the outputs that need samples from the previous block are computed with
+ * the start of the block stitched onto its end, and the rest read straight from "data".
+ *
+ * \param data The block to resample.
+ * \param dataLen Number of samples in "data".
+ * \param interpRate The interpolation rate.
+ * \param decimateRate The decimation rate.
+ * \param phaseBanks The filter taps split up by \ref buildPhaseBanks for "interpRate".
+ * \param tapsPerPhase Number of taps in each bank.
+ * \param history 2 * (tapsPerPhase - 1) samples, the first tapsPerPhase - 1 of which are the last
+ *      inputs of the previous block.  Updated on return.
+ * \param phase Where the next output falls on the upsampled time line, relative to data[0]: its
+ *      newest input sample is data[phase / interpRate], which meets bank phase % interpRate.
+ *      Updated on return.
+ * \param results Receives the outputs.  Must not overlap "data", and needs room for
+ *      (dataLen * interpRate + decimateRate - 1) / decimateRate + 1 of them.
+ * \return Number of results.
+ */
+template <class U, class V>
+int streamingPolyphaseResample(const U *data, int dataLen, int interpRate, int decimateRate, const V *phaseBanks,
+                               int tapsPerPhase, U *history, int & phase, U *results) {
+    int numHistory = tapsPerPhase - 1;
+    int headLen = (dataLen < numHistory) ? dataLen : numHistory;
+    for (int i=0; i<headLen; i++) {
+        history[numHistory + i] = data[i];
+    }
+
+    // The output with newest sample data[inputIndex] uses data[inputIndex - numHistory] onwards,
+    // which start at history[inputIndex] while inputIndex < numHistory.
+    int inputIndex = phase / interpRate;
+    int bank = phase % interpRate;
+    int numResults = 0;
+    while (inputIndex < dataLen) {
+        const U *x = (inputIndex < numHistory) ? history + inputIndex : data + (inputIndex - numHistory);
+        results[numResults++] = dotProduct(x, phaseBanks + bank * tapsPerPhase, tapsPerPhase);
+        bank += decimateRate;
+        inputIndex += bank / interpRate;
+        bank %= interpRate;
+    }
+    phase = (inputIndex - dataLen) * interpRate + bank;
+
+    if (dataLen >= numHistory) {
+        for (int i=0; i<numHistory; i++) {
+            history[i] = data[dataLen - numHistory + i];
+        }
+    }
+    else {
+        for (int i=0; i<numHistory; i++) {
+            history[i] = history[dataLen + i];
+        }
+    }
+    return numResults;
+}
+
+
+/**
+ * \brief Computes outputs "first" through "last" - 1 of a one-shot convolution, optionally
+ *      decimated.
+ *
+ * Output r is sample r * rate + offset of the full convolution of "data" with "taps", which has
+ * dataLen + numTaps - 1 samples.  Outputs where the filter overlaps the data completely use
+ * \ref dotProduct.  The others, at either end, sum just the overlapping part.  Each output only
+ * depends on "data", so any set of output ranges can be computed independently.
+ *
+ * \param data The input samples.  Must not overlap "results".
+ * \param taps The filter taps, in order.
+ * \param reversedTaps The filter taps in reverse order.
+ * \param symmetry Symmetry of the taps, for \ref firDotProduct.
+ */
+template <class U, class V>
+void firOutputRange(const U *data, int dataLen, const V *taps, const V *reversedTaps, int numTaps, int rate,
+                    int offset, int first, int last, U *results, TapSymmetryType symmetry = NO_SYMMETRY) {
+    for (int resultIndex=first; resultIndex<last; resultIndex++) {
+        int n = resultIndex * rate + offset;
+        if (n >= numTaps - 1 && n < dataLen) {
+            results[resultIndex] = firDotProduct(data + (n - (numTaps - 1)), reversedTaps, numTaps, symmetry);
+        }
+        else {
+            U result = 0;
+            for (int filterIndex=std::min(n, numTaps - 1), dataIndex=n-filterIndex;
+                 filterIndex>=0 && dataIndex<dataLen; dataIndex++, filterIndex--) {
+                result += data[dataIndex] * taps[filterIndex];
+            }
+            results[resultIndex] = result;
+        }
+    }
+}
+
+/**
+ * \brief Computes outputs "first" through "last" - 1 of a one-shot resampling.
+ *
+ * Output r is sample r * decimateRate + offset of the convolution of "taps" with "data" upsampled
+ * by "interpRate" (with interpRate - 1 zeros after each sample).  Only the taps that line up with
+ * real samples are used, read from "phaseBanks" (see \ref buildPhaseBanks) with \ref dotProduct.
+ */
+template <class U, class V>
+void resampleOutputRange(const U *data, int dataLen, const V *phaseBanks, int numTaps, int interpRate,
+                         int decimateRate, int offset, int first, int last, U *results) {
+    int tapsPerPhase = (numTaps + interpRate - 1) / interpRate;
+    for (int resultIndex=first; resultIndex<last; resultIndex++) {
+        int n = resultIndex * decimateRate + offset;
+        int filterIndex = std::min(n, numTaps - 1);
+        // Back up to the last tap that lines up with a real sample.
+        filterIndex -= (interpRate - (n - filterIndex) % interpRate) % interpRate;
+        int dataIndex = (n - filterIndex) / interpRate;
+        int count = (filterIndex < 0) ? 0 : std::min(filterIndex / interpRate + 1, dataLen - dataIndex);
+        results[resultIndex] = (count <= 0) ? U(0) : phaseBankDotProduct(data + dataIndex, phaseBanks, tapsPerPhase,
+                                                                        interpRate, filterIndex, count);
+    }
+}
+
+/**
+ * \brief Number of multiply-accumulates below which a piece of a one-shot convolution isn't worth
+ *      handing to another thread.
+ */
+const int MIN_PARALLEL_MACS = 1 << 15;
+
+/**
+ * \brief Computes "numResults" outputs of a one-shot convolution with \ref firOutputRange,
+ *      split across "pool" if it isn't NULL.
+ */
+template <class U, class V>
+void firOutputs(ThreadPool *pool, const U *data, int dataLen, const V *taps, const V *reversedTaps, int numTaps,
+                int rate, int offset, int numResults, U *results, TapSymmetryType symmetry = NO_SYMMETRY) {
+    parallelFor(pool, 0, numResults, MIN_PARALLEL_MACS / numTaps, [=](int first, int last) {
+        firOutputRange(data, dataLen, taps, reversedTaps, numTaps, rate, offset, first, last, results, symmetry);
+    });
+}
+
+/**
+ * \brief Computes "numResults" outputs of a one-shot resampling with \ref resampleOutputRange,
+ *      split across "pool" if it isn't NULL.  The phase banks are built in a buffer borrowed from
+ *      the calling thread's workspace.
+ */
+template <class U, class V>
+void resampleOutputs(ThreadPool *pool, const U *data, int dataLen, const V *taps, int numTaps, int interpRate,
+                     int decimateRate, int offset, int numResults, U *results) {
+    ScratchBuffer<V> banks;
+    buildPhaseBanks(taps, numTaps, interpRate, *banks);
+    const V *phaseBanks = &(*banks)[0];
+    parallelFor(pool, 0, numResults, MIN_PARALLEL_MACS * interpRate / numTaps, [=](int first, int last) {
+        resampleOutputRange(data, dataLen, phaseBanks, numTaps, interpRate, decimateRate, offset, first, last,
+                            results);
+    });
+}
+
+};
+
+#endif
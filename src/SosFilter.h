@@ -0,0 +1,540 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file SosFilter.h
+ *
+ * Definition of the template class SosFilter and the polynomial to second-order section conversion.
+ */
+
+
+#ifndef NimbleDSP_SosFilter_h
+#define NimbleDSP_SosFilter_h
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include "Vector.h"
+#include "RealIirFilter.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Number of coefficients stored per section: b0, b1, b2, a1, a2 (a0 is normalized to 1).
+ */
+const unsigned SOS_COEFS_PER_SECTION = 5;
+
+/**
+ * \brief Number of sections that \ref SosFilter::filter runs through a block together.
+ */
+const unsigned SOS_PIPELINE_SECTIONS = 4;
+
+/**
+ * \brief Class for real IIR filters implemented as a cascade of second-order sections (biquads).
+ *
+ * Each section is a transposed direct form II biquad
+ *
+ *      H(z) = (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2)
+ *
+ * High order filters are much better behaved as a cascade of sections than as one high order
+ * polynomial (RealIirFilter), because the coefficients of each section only have to represent one
+ * pair of poles and zeros.  The filter state persists between calls, so data can be filtered in
+ * blocks as if it were one continuous stream.
+ *
+ * Each section's recursion is a serial chain of multiplies and adds from one sample to the next,
+ * so one section on its own can't keep the FPU busy.  The block path pipelines the cascade across
+ * samples instead: while sample n goes through section k, sample n + 1 goes through section k - 1,
+ * so the chains of up to SOS_PIPELINE_SECTIONS sections overlap.
+ */
+template <class T>
+class SosFilter {
+ protected:
+    /**
+     * \brief Filter state, two values per section.  Sized for complex data so that the same buffer
+     *      works for either kind of data.
+     */
+    std::vector<char> state;
+
+    template <class U>
+    void filterSection(unsigned section, U *data, unsigned dataLen);
+
+    template <unsigned NumStages, class U>
+    void filterPipelined(unsigned firstSection, U *data, unsigned dataLen);
+
+    /**
+     * \brief Runs one sample through one transposed direct form II section.
+     */
+    template <class U>
+    static U biquad(U x, const T *c, U & z1, U & z2) {
+        U y = c[0] * x + z1;
+        z1 = c[1] * x - c[3] * y + z2;
+        z2 = c[2] * x - c[4] * y;
+        return y;
+    }
+
+ public:
+    /**
+     * \brief The section coefficients, stored b0, b1, b2, a1, a2 for each section in turn.
+     */
+    std::vector<T> coefs;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * Creates "numSections" sections that pass their input through unchanged.
+     * \param numSections Number of second-order sections.
+     */
+    SosFilter<T>(unsigned numSections = 1) {
+        coefs.assign(numSections * SOS_COEFS_PER_SECTION, 0);
+        for (unsigned i=0; i<numSections; i++) {
+            coefs[i * SOS_COEFS_PER_SECTION] = 1;
+        }
+        reset();
+    }
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param sos Section coefficients in the Matlab "sos" layout: b0, b1, b2, a0, a1, a2 for each
+     *      section in turn.  Each section is normalized by its a0.
+     * \param numSections Number of sections in "sos".
+     */
+    template <typename U>
+    SosFilter<T>(const U *sos, unsigned numSections) {setSections(sos, numSections);}
+
+    /**
+     * \brief Polynomial constructor.
+     *
+     * Converts the transfer function num(z)/den(z), with coefficients in increasing powers of
+     * z^-1, to second-order sections.  See \ref setTransferFunction.
+     */
+    template <typename U>
+    SosFilter<T>(const std::vector<U> & num, const std::vector<U> & den) {setTransferFunction(num, den);}
+
+    /**
+     * \brief Converts a RealIirFilter to second-order sections.
+     */
+    template <typename U>
+    SosFilter<T>(const RealIirFilter<U> & filt) {setTransferFunction(filt.numerator, filt.denominator);}
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of second-order sections.
+     */
+    unsigned numSections() const {return coefs.size() / SOS_COEFS_PER_SECTION;}
+
+    /**
+     * \brief Sets the sections from coefficients in the Matlab "sos" layout and clears the state.
+     *
+     * \param sos b0, b1, b2, a0, a1, a2 for each section in turn.
+     * \param numSections Number of sections in "sos".
+     */
+    template <typename U>
+    void setSections(const U *sos, unsigned numSections);
+
+    /**
+     * \brief Sets the sections from a transfer function and clears the state.
+     *
+     * The roots of the numerator and denominator are found numerically, then complex conjugate
+     * poles and zeros are grouped into sections.  Following Matlab's zp2sos, the poles closest to
+     * the unit circle are matched with the zeros closest to them, and those sections are placed
+     * last in the cascade.
+     *
+     * \param num Numerator coefficients, in increasing powers of z^-1.
+     * \param den Denominator coefficients, in increasing powers of z^-1.  den[0] must not be 0.
+     */
+    template <typename U>
+    void setTransferFunction(const std::vector<U> & num, const std::vector<U> & den);
+
+    /**
+     * \brief Zeros the filter state.
+     */
+    void reset() {state.assign(2 * numSections() * sizeof(std::complex<T>), 0);}
+
+    /**
+     * \brief Filters "data" in place, continuing from the state left by the previous call.
+     *
+     * The sections are taken SOS_PIPELINE_SECTIONS at a time, and each group is pipelined across
+     * the samples of the block (sample n in section k alongside sample n + 1 in section k - 1) with
+     * the group's coefficients and state in registers.  The results are exactly the same as
+     * running the sections one after another.
+     * \param data The data to filter.  Either real or complex.
+     * \return Reference to "data".
+     */
+    template <class U>
+    Vector<U> & filter(Vector<U> & data);
+
+    /**
+     * \brief Filters a single sample, continuing from the current state.
+     *
+     * Use \ref filter when there is more than one sample to process.
+     * \return The filtered sample.
+     */
+    template <class U>
+    U filterSample(U sample) {
+        for (unsigned section=0; section<numSections(); section++) {
+            filterSection(section, &sample, 1);
+        }
+        return sample;
+    }
+};
+
+
+template <class T>
+template <typename U>
+void SosFilter<T>::setSections(const U *sos, unsigned numSections) {
+    assert(numSections > 0);
+    coefs.resize(numSections * SOS_COEFS_PER_SECTION);
+    for (unsigned i=0; i<numSections; i++) {
+        const U *section = sos + 6 * i;
+        assert(section[3] != 0);
+        T a0 = (T) section[3];
+        coefs[i * SOS_COEFS_PER_SECTION]     = ((T) section[0]) / a0;
+        coefs[i * SOS_COEFS_PER_SECTION + 1] = ((T) section[1]) / a0;
+        coefs[i * SOS_COEFS_PER_SECTION + 2] = ((T) section[2]) / a0;
+        coefs[i * SOS_COEFS_PER_SECTION + 3] = ((T) section[4]) / a0;
+        coefs[i * SOS_COEFS_PER_SECTION + 4] = ((T) section[5]) / a0;
+    }
+    reset();
+}
+
+/**
+ * \brief Finds the roots of a polynomial.
+ *
+ * Uses the Durand-Kerner (Weierstrass) iteration followed by a few Newton steps on each root.
+ * \param poly Coefficients in decreasing powers of z.  poly[0] must not be 0.
+ * \return The poly.size() - 1 roots.
+ */
+inline std::vector< std::complex<double> > polyRoots(const std::vector<double> & poly) {
+    int degree = poly.size() - 1;
+    std::vector< std::complex<double> > roots(degree > 0 ? degree : 0);
+    if (degree <= 0) {
+        return roots;
+    }
+
+    std::vector<double> monic(poly.size());
+    for (unsigned i=0; i<poly.size(); i++) {
+        monic[i] = poly[i] / poly[0];
+    }
+
+    // Start on a circle whose radius bounds the roots, at angles that aren't symmetric about the
+    // real axis so that conjugate pairs can separate.
+    double radius = 0;
+    for (int i=1; i<=degree; i++) {
+        radius = std::max(radius, std::pow(std::fabs(monic[i]), 1.0 / i));
+    }
+    radius = std::max(radius, 1e-3);
+    for (int i=0; i<degree; i++) {
+        roots[i] = std::polar(radius, 2 * M_PI * i / degree + 0.4);
+    }
+
+    for (int iteration=0; iteration<1000; iteration++) {
+        double maxChange = 0;
+        for (int i=0; i<degree; i++) {
+            std::complex<double> value = 1.0;
+            for (int j=1; j<=degree; j++) {
+                value = value * roots[i] + monic[j];
+            }
+            std::complex<double> denominator = 1.0;
+            for (int j=0; j<degree; j++) {
+                if (j != i) {
+                    denominator *= roots[i] - roots[j];
+                }
+            }
+            if (std::abs(denominator) == 0) {
+                denominator = 1e-12;
+            }
+            std::complex<double> change = value / denominator;
+            roots[i] -= change;
+            maxChange = std::max(maxChange, std::abs(change) / std::max(1.0, std::abs(roots[i])));
+        }
+        if (maxChange < 1e-15) {
+            break;
+        }
+    }
+
+    for (int i=0; i<degree; i++) {
+        for (int iteration=0; iteration<3; iteration++) {
+            std::complex<double> value = 1.0, derivative = 0.0;
+            for (int j=1; j<=degree; j++) {
+                derivative = derivative * roots[i] + value;
+                value = value * roots[i] + monic[j];
+            }
+            if (std::abs(derivative) == 0) {
+                break;
+            }
+            roots[i] -= value / derivative;
+        }
+    }
+    return roots;
+}
+
+/**
+ * \brief Groups roots into pairs that each make a real second-order polynomial.
+ *
+ * Complex roots are paired with their conjugates and real roots are paired with each other.  An
+ * odd real root left over is paired with a root at 0.
+ */
+inline std::vector< std::pair< std::complex<double>, std::complex<double> > >
+pairConjugateRoots(std::vector< std::complex<double> > roots) {
+    std::vector< std::pair< std::complex<double>, std::complex<double> > > pairs;
+    std::vector<double> realRoots;
+
+    while (!roots.empty()) {
+        std::complex<double> root = roots.back();
+        roots.pop_back();
+        if (std::fabs(root.imag()) <= 1e-8 * std::max(1.0, std::abs(root))) {
+            realRoots.push_back(root.real());
+            continue;
+        }
+        unsigned best = 0;
+        for (unsigned i=1; i<roots.size(); i++) {
+            if (std::abs(roots[i] - std::conj(root)) < std::abs(roots[best] - std::conj(root))) {
+                best = i;
+            }
+        }
+        assert(!roots.empty());
+        pairs.push_back(std::make_pair(root, std::conj(root)));
+        roots.erase(roots.begin() + best);
+    }
+
+    // Pair real roots of similar magnitude.
+    std::sort(realRoots.begin(), realRoots.end());
+    for (unsigned i=0; i<realRoots.size(); i+=2) {
+        std::complex<double> second = (i + 1 < realRoots.size()) ? realRoots[i + 1] : 0.0;
+        pairs.push_back(std::make_pair(std::complex<double>(realRoots[i]), second));
+    }
+    return pairs;
+}
+
+template <class T>
+template <typename U>
+void SosFilter<T>::setTransferFunction(const std::vector<U> & num, const std::vector<U> & den) {
+    typedef std::pair< std::complex<double>, std::complex<double> > RootPair;
+    assert(num.size() > 0 && den.size() > 0 && den[0] != 0);
+
+    // A numerator that starts with zeros is a pure delay times the rest of the numerator.
+    unsigned delay = 0;
+    while (delay < num.size() && num[delay] == 0) {
+        delay++;
+    }
+    assert(delay < num.size());
+    double gain = ((double) num[delay]) / den[0];
+
+    // Coefficients in increasing powers of z^-1 are the coefficients of a polynomial in z in
+    // decreasing powers, so the roots come straight out.  Trailing zeros are roots at the origin,
+    // which don't affect the response and are dropped.
+    std::vector<double> numPoly(num.begin() + delay, num.end());
+    std::vector<double> denPoly(den.begin(), den.end());
+    while (numPoly.size() > 1 && numPoly.back() == 0) {
+        numPoly.pop_back();
+    }
+    while (denPoly.size() > 1 && denPoly.back() == 0) {
+        denPoly.pop_back();
+    }
+    std::vector<RootPair> zeroPairs = pairConjugateRoots(polyRoots(numPoly));
+    std::vector<RootPair> polePairs = pairConjugateRoots(polyRoots(denPoly));
+    while (polePairs.size() < zeroPairs.size()) {
+        polePairs.push_back(RootPair(0.0, 0.0));
+    }
+
+    // Handle the pole pairs closest to the unit circle first, giving each one the nearest zero
+    // pair that's left.  Those sections go at the end of the cascade.
+    std::vector<unsigned> order(polePairs.size());
+    for (unsigned i=0; i<order.size(); i++) {
+        order[i] = i;
+    }
+    for (unsigned i=0; i<order.size(); i++) {
+        for (unsigned j=i+1; j<order.size(); j++) {
+            double magI = std::max(std::abs(polePairs[order[i]].first), std::abs(polePairs[order[i]].second));
+            double magJ = std::max(std::abs(polePairs[order[j]].first), std::abs(polePairs[order[j]].second));
+            if (magJ > magI) {
+                std::swap(order[i], order[j]);
+            }
+        }
+    }
+
+    unsigned numDelaySections = (delay + 1) / 2;
+    unsigned numRootSections = polePairs.size();
+    if (numRootSections == 0) {
+        numRootSections = 1;
+        polePairs.push_back(RootPair(0.0, 0.0));
+        order.push_back(0);
+    }
+    coefs.assign((numRootSections + numDelaySections) * SOS_COEFS_PER_SECTION, 0);
+
+    std::vector<bool> zeroUsed(zeroPairs.size(), false);
+    for (unsigned i=0; i<numRootSections; i++) {
+        const RootPair & poles = polePairs[order[i]];
+        RootPair zeros(0.0, 0.0);
+        int bestZero = -1;
+        for (unsigned j=0; j<zeroPairs.size(); j++) {
+            if (zeroUsed[j]) {
+                continue;
+            }
+            double distance = std::min(std::abs(zeroPairs[j].first - poles.first),
+                                       std::abs(zeroPairs[j].second - poles.first));
+            if (bestZero < 0 || distance < std::min(std::abs(zeroPairs[bestZero].first - poles.first),
+                                                    std::abs(zeroPairs[bestZero].second - poles.first))) {
+                bestZero = j;
+            }
+        }
+        if (bestZero >= 0) {
+            zeroUsed[bestZero] = true;
+            zeros = zeroPairs[bestZero];
+        }
+
+        T *section = VECTOR_TO_ARRAY(coefs) + (numRootSections - 1 - i) * SOS_COEFS_PER_SECTION;
+        section[0] = 1;
+        section[1] = (T) -(zeros.first + zeros.second).real();
+        section[2] = (T) (zeros.first * zeros.second).real();
+        section[3] = (T) -(poles.first + poles.second).real();
+        section[4] = (T) (poles.first * poles.second).real();
+    }
+    for (unsigned i=0; i<SOS_COEFS_PER_SECTION - 2; i++) {
+        coefs[i] *= (T) gain;
+    }
+
+    // Delay sections: z^-2, with a z^-1 section for an odd delay.
+    for (unsigned i=0; i<numDelaySections; i++) {
+        T *section = VECTOR_TO_ARRAY(coefs) + (numRootSections + i) * SOS_COEFS_PER_SECTION;
+        section[(i == 0 && delay % 2) ? 1 : 2] = 1;
+    }
+    reset();
+}
+
+template <class T>
+template <class U>
+void SosFilter<T>::filterSection(unsigned section, U *data, unsigned dataLen) {
+    const T *c = VECTOR_TO_ARRAY(coefs) + section * SOS_COEFS_PER_SECTION;
+    U *z = ((U *) VECTOR_TO_ARRAY(state)) + 2 * section;
+    const T sectionCoefs[SOS_COEFS_PER_SECTION] = {c[0], c[1], c[2], c[3], c[4]};
+    U z1 = z[0], z2 = z[1];
+
+    for (unsigned i=0; i<dataLen; i++) {
+        data[i] = biquad(data[i], sectionCoefs, z1, z2);
+    }
+    z[0] = z1;
+    z[1] = z2;
+}
+
+template <class T>
+template <unsigned NumStages, class U>
+void SosFilter<T>::filterPipelined(unsigned firstSection, U *data, unsigned dataLen) {
+    T c[NumStages][SOS_COEFS_PER_SECTION];
+    U z1[NumStages], z2[NumStages];
+    // between[k] holds section k's output for section k + 1 to take on the next step.
+    U between[NumStages];
+    U *z = ((U *) VECTOR_TO_ARRAY(state)) + 2 * firstSection;
+    for (unsigned k=0; k<NumStages; k++) {
+        for (unsigned i=0; i<SOS_COEFS_PER_SECTION; i++) {
+            c[k][i] = coefs[(firstSection + k) * SOS_COEFS_PER_SECTION + i];
+        }
+        z1[k] = z[2 * k];
+        z2[k] = z[2 * k + 1];
+        between[k] = U(0);
+    }
+
+    // On step t section k works on sample t - k.  The sections go last to first within a step so
+    // that each one takes the output its predecessor made on the step before.  Only the first and
+    // last NumStages - 1 steps have sections with no sample to work on.
+    const int lastStage = NumStages - 1;
+    int numSamples = dataLen;
+    // A step with only the sections that have a sample: those k with 0 <= t - k < numSamples.
+    auto partialStep = [&](int t) {
+        for (int k=std::min(t, lastStage); k>=0 && t-k<numSamples; k--) {
+            U y = biquad((k == 0) ? data[t] : between[k - 1], c[k], z1[k], z2[k]);
+            if (k == lastStage) {
+                data[t - k] = y;
+            }
+            else {
+                between[k] = y;
+            }
+        }
+    };
+    for (int t=0; t<std::min(lastStage, numSamples); t++) {
+        partialStep(t);
+    }
+    for (int t=lastStage; t<numSamples; t++) {
+        data[t - lastStage] = biquad(between[lastStage - 1], c[lastStage], z1[lastStage], z2[lastStage]);
+        for (int k=lastStage-1; k>0; k--) {
+            between[k] = biquad(between[k - 1], c[k], z1[k], z2[k]);
+        }
+        between[0] = biquad(data[t], c[0], z1[0], z2[0]);
+    }
+    for (int t=numSamples; t<numSamples+lastStage; t++) {
+        partialStep(t);
+    }
+
+    for (unsigned k=0; k<NumStages; k++) {
+        z[2 * k] = z1[k];
+        z[2 * k + 1] = z2[k];
+    }
+}
+
+template <class T>
+template <class U>
+Vector<U> & SosFilter<T>::filter(Vector<U> & data) {
+    unsigned dataLen = data.size();
+    if (dataLen == 0) {
+        return data;
+    }
+    U *samples = VECTOR_TO_ARRAY(data.vec);
+    unsigned section = 0;
+    for (; section + SOS_PIPELINE_SECTIONS <= numSections(); section += SOS_PIPELINE_SECTIONS) {
+        filterPipelined<SOS_PIPELINE_SECTIONS>(section, samples, dataLen);
+    }
+    switch (numSections() - section) {
+    case 3:
+        filterPipelined<3>(section, samples, dataLen);
+        break;
+    case 2:
+        filterPipelined<2>(section, samples, dataLen);
+        break;
+    case 1:
+        filterSection(section, samples, dataLen);
+        break;
+    }
+    return data;
+}
+
+/**
+ * \brief Filters "data" in place with "filt", continuing from the filter's current state.
+ *
+ * \return Reference to "data".
+ */
+template <class T, class U>
+Vector<U> & filter(Vector<U> & data, SosFilter<T> & filt) {
+    return filt.filter(data);
+}
+
+};
+
+#endif
@@ -0,0 +1,457 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+/**
+ * @file SpectralEstimator.h
+ *
+ * Definition of the template class SpectralEstimator.
+ */
+
+#ifndef NimbleDSP_SpectralEstimator_h
+#define NimbleDSP_SpectralEstimator_h
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "FftPlan.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Welch power spectral density, spectrogram and short time Fourier transform of real data.
+ *
+ * The data is cut into frames of \ref fftSize samples that start \ref hopSize samples apart, so
+ * consecutive frames overlap by fftSize - hopSize samples.  Each frame is multiplied by the
+ * window and transformed with the real FFT, giving \ref numBins bins (DC to Nyquist).
+ *
+ *  - \ref welch averages the frames' power spectra into a PSD that \ref psd returns.
+ *  - \ref spectrogram returns each frame's power spectrum.
+ *  - \ref stft returns each frame's complex spectrum.
+ *
+ * The power spectra are one-sided densities, scaled by 1 / (sampleRate * sum(window^2)) and
+ * doubled everywhere but DC and Nyquist, so that summing the PSD times the bin spacing gives the
+ * signal power.
+ *
+ * All three stream: data can arrive in blocks of any size, and frames that straddle two blocks
+ * are handled without the caller doing anything.  Only the samples of the unfinished frame are
+ * kept between calls.  An estimator keeps one stream, so don't mix the different methods on one
+ * object.  The window is computed once, when the estimator is made, and the work buffers are
+ * allocated then too.  The FFT plan comes from the calling thread's plan cache.
+ */
+template <class T>
+class SpectralEstimator {
+ protected:
+    /**
+     * \brief The window, \ref fftSize samples long.
+     */
+    RealVector<T> windowTable;
+    
+    /**
+     * \brief 1 / (sampleRate * sum(window^2)), the PSD scale factor.
+     */
+    T psdScale;
+    
+    unsigned hop;
+    
+    /**
+     * \brief The samples received so far of the frame that hasn't been finished.  The frame starts
+     *      at savedData[0].
+     */
+    std::vector<T> savedData;
+    unsigned numSavedSamples;
+    
+    /**
+     * \brief Samples still to be skipped before the next frame starts.  Only nonzero when
+     *      \ref hopSize is bigger than \ref fftSize.
+     */
+    unsigned samplesToSkip;
+    
+    /**
+     * \brief Work buffers for the windowed frame and its spectrum.
+     */
+    std::vector<T> frameBuf;
+    std::vector< std::complex<T> > spectrumBuf;
+    
+    /**
+     * \brief The running PSD average and how many frames went into it.
+     */
+    std::vector<T> psdAverage;
+    unsigned framesAveraged;
+    
+    T sampleRate;
+    
+    void initWindow(WindowType type, unsigned size);
+    void initState();
+    
+    /**
+     * \brief Power density of bin "bin" of \ref spectrumBuf.
+     */
+    T binPower(unsigned bin) const {
+        T power = std::norm(spectrumBuf[bin]) * psdScale;
+        return (bin == 0 || 2 * bin == fftSize()) ? power : 2 * power;
+    }
+    
+    /**
+     * \brief Windows and transforms every frame that "data" completes, calling "frameOp" after each
+     *      one with the spectrum in \ref spectrumBuf.
+     *
+     * \return The number of frames.
+     */
+    template <class FrameOp>
+    unsigned processFrames(const RealVector<T> & data, FrameOp & frameOp);
+    
+    struct WelchOp {
+        SpectralEstimator<T> *estimator;
+        void operator()(unsigned) {estimator->addToAverage();}
+    };
+    
+    struct PowerOp {
+        SpectralEstimator<T> *estimator;
+        T *out;
+        void operator()(unsigned frame) {
+            unsigned bins = estimator->numBins();
+            for (unsigned k=0; k<bins; k++) {
+                out[frame * bins + k] = estimator->binPower(k);
+            }
+        }
+    };
+    
+    struct ComplexOp {
+        SpectralEstimator<T> *estimator;
+        std::complex<T> *out;
+        void operator()(unsigned frame) {
+            std::copy(estimator->spectrumBuf.begin(), estimator->spectrumBuf.end(), out + frame * estimator->numBins());
+        }
+    };
+    
+    void addToAverage();
+    
+    /**
+     * \brief Returns the number of frames that "numSamples" more samples would complete.
+     */
+    unsigned framesIn(unsigned numSamples) const {
+        if (numSamples <= samplesToSkip) {
+            return 0;
+        }
+        unsigned available = numSavedSamples + numSamples - samplesToSkip;
+        return (available < fftSize()) ? 0 : (available - fftSize()) / hop + 1;
+    }
+    
+ public:
+    /**
+     * \brief How \ref welch combines the frames.
+     *
+     * NimbleDSP::LINEAR_AVERAGING is the mean of all the frames since the last \ref resetAverage.
+     *      This is the default, and is the Welch estimate.
+     * NimbleDSP::EXPONENTIAL_AVERAGING weights each new frame by \ref exponentialWeight and the
+     *      previous average by 1 - exponentialWeight, so the estimate tracks a changing spectrum.
+     * NimbleDSP::PEAK_HOLD keeps the largest value seen in each bin.
+     */
+    SpectralAveragingType averaging;
+    
+    /**
+     * \brief Weight of each new frame for NimbleDSP::EXPONENTIAL_AVERAGING.  Defaults to 0.1.
+     */
+    T exponentialWeight;
+    
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Standard window constructor.
+     *
+     * \param size Number of samples in each frame, which is also the FFT size.
+     * \param hopSize Number of samples from the start of one frame to the start of the next.
+     *      size/2 gives the usual 50% overlap.
+     * \param type Which window to use.  The windows are periodic (DFT-even), as is usual for
+     *      spectral analysis.  Defaults to NimbleDSP::HANN_WINDOW.
+     * \param sampleFreq Sample rate, used to scale the PSD.  Defaults to 1.
+     */
+    SpectralEstimator<T>(unsigned size, unsigned hopSize, WindowType type = HANN_WINDOW, T sampleFreq = 1) :
+            hop(hopSize), sampleRate(sampleFreq) {
+        initWindow(type, size);
+        initState();
+    }
+    
+    /**
+     * \brief Custom window constructor.
+     *
+     * \param window The window.  Its length is the frame and FFT size.
+     * \param hopSize Number of samples from the start of one frame to the start of the next.
+     * \param sampleFreq Sample rate, used to scale the PSD.  Defaults to 1.
+     */
+    template <typename U>
+    SpectralEstimator<T>(const std::vector<U> & window, unsigned hopSize, T sampleFreq = 1) :
+            windowTable(window), hop(hopSize), sampleRate(sampleFreq) {
+        initState();
+    }
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of samples in each frame.
+     */
+    unsigned fftSize() const {return windowTable.size();}
+    
+    /**
+     * \brief Returns the number of samples between the starts of consecutive frames.
+     */
+    unsigned hopSize() const {return hop;}
+    
+    /**
+     * \brief Returns the number of bins in each spectrum, fftSize()/2 + 1.
+     */
+    unsigned numBins() const {return fftSize() / 2 + 1;}
+    
+    /**
+     * \brief Returns the window.
+     */
+    const RealVector<T> & window() const {return windowTable;}
+    
+    /**
+     * \brief Returns the number of frames in the PSD average.
+     */
+    unsigned numAveraged() const {return framesAveraged;}
+    
+    /**
+     * \brief Starts a new PSD average.  The stream carries on where it was.
+     */
+    void resetAverage() {std::fill(psdAverage.begin(), psdAverage.end(), (T) 0); framesAveraged = 0;}
+    
+    /**
+     * \brief Starts a new stream and a new PSD average.
+     */
+    void reset() {numSavedSamples = 0; samplesToSkip = 0; resetAverage();}
+    
+    /**
+     * \brief Adds the frames that "data" completes to the PSD average.
+     *
+     * \return The number of frames added.
+     */
+    unsigned welch(const RealVector<T> & data) {
+        WelchOp op = {this};
+        return processFrames(data, op);
+    }
+    
+    /**
+     * \brief Puts the averaged PSD (\ref numBins bins) in "result".
+     *
+     * \return Reference to "result".
+     */
+    RealVector<T> & psd(RealVector<T> & result) const;
+    
+    /**
+     * \brief Computes the power spectra of the frames that "data" completes.
+     *
+     * \param data The next block of samples.
+     * \param frames Gets one row of \ref numBins power densities per frame, one after the other.
+     * \return The number of frames.
+     */
+    unsigned spectrogram(const RealVector<T> & data, RealVector<T> & frames) {
+        frames.vec.resize(framesIn(data.size()) * numBins());
+        PowerOp op = {this, frames.vec.data()};
+        return processFrames(data, op);
+    }
+    
+    /**
+     * \brief Computes the complex spectra (windowed FFTs, unscaled) of the frames that "data"
+     *      completes.
+     *
+     * \param data The next block of samples.
+     * \param frames Gets one row of \ref numBins bins per frame, one after the other.
+     * \return The number of frames.
+     */
+    unsigned stft(const RealVector<T> & data, ComplexVector<T> & frames) {
+        frames.vec.resize(framesIn(data.size()) * numBins());
+        frames.domain = FREQUENCY_DOMAIN;
+        ComplexOp op = {this, frames.vec.data()};
+        return processFrames(data, op);
+    }
+};
+
+
+template <class T>
+void SpectralEstimator<T>::initWindow(WindowType type, unsigned size) {
+    assert(size > 0);
+    windowTable.vec.resize(size);
+    for (unsigned n=0; n<size; n++) {
+        double phase = 2 * M_PI * n / size;
+        double value;
+        switch (type) {
+            case HANN_WINDOW:
+                value = 0.5 - 0.5 * std::cos(phase);
+                break;
+            case HAMMING_WINDOW:
+                value = 0.54 - 0.46 * std::cos(phase);
+                break;
+            case BLACKMAN_WINDOW:
+                value = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2 * phase);
+                break;
+            default:
+                value = 1;
+                break;
+        }
+        windowTable[n] = (T) value;
+    }
+}
+
+template <class T>
+void SpectralEstimator<T>::initState() {
+    assert(fftSize() > 0 && hop > 0);
+    T windowPower = 0;
+    for (unsigned n=0; n<fftSize(); n++) {
+        windowPower += windowTable[n] * windowTable[n];
+    }
+    psdScale = 1 / (sampleRate * windowPower);
+    
+    averaging = LINEAR_AVERAGING;
+    exponentialWeight = (T) 0.1;
+    savedData.resize(fftSize());
+    frameBuf.resize(fftSize());
+    spectrumBuf.resize(numBins());
+    psdAverage.resize(numBins());
+    reset();
+}
+
+template <class T>
+template <class FrameOp>
+unsigned SpectralEstimator<T>::processFrames(const RealVector<T> & data, FrameOp & frameOp) {
+    RealFftPlan<T> & plan = realFftPlan<T>(fftSize(), false);
+    unsigned size = fftSize();
+    unsigned dataLen = data.size();
+    unsigned skip = std::min(samplesToSkip, dataLen);
+    samplesToSkip -= skip;
+    
+    // Sample i of the stream from here on is savedData[i] for i < numSavedSamples and
+    // data[skip + i - numSavedSamples] after that.
+    const T *newData = data.vec.data() + skip;
+    unsigned totalLen = numSavedSamples + dataLen - skip;
+    unsigned frame = 0;
+    unsigned start = 0;
+    for (; start + size <= totalLen; start += hop, frame++) {
+        unsigned fromSaved = (start < numSavedSamples) ? numSavedSamples - start : 0;
+        for (unsigned n=0; n<fromSaved; n++) {
+            frameBuf[n] = savedData[start + n] * windowTable[n];
+        }
+        const T *frameData = newData + (start + fromSaved - numSavedSamples);
+        for (unsigned n=fromSaved; n<size; n++) {
+            frameBuf[n] = frameData[n - fromSaved] * windowTable[n];
+        }
+        plan.transform(VECTOR_TO_ARRAY(frameBuf), VECTOR_TO_ARRAY(spectrumBuf));
+        frameOp(frame);
+    }
+    
+    if (start >= totalLen) {
+        samplesToSkip += start - totalLen;
+        numSavedSamples = 0;
+    }
+    else {
+        // Keep the start of the unfinished frame.  It is shorter than a frame, so it fits.
+        unsigned keep = totalLen - start;
+        if (start < numSavedSamples) {
+            std::copy(savedData.begin() + start, savedData.begin() + numSavedSamples, savedData.begin());
+            std::copy(newData, newData + (dataLen - skip), savedData.begin() + (numSavedSamples - start));
+        }
+        else {
+            std::copy(newData + (start - numSavedSamples), newData + (dataLen - skip), savedData.begin());
+        }
+        numSavedSamples = keep;
+    }
+    return frame;
+}
+
+template <class T>
+void SpectralEstimator<T>::addToAverage() {
+    unsigned bins = numBins();
+    framesAveraged++;
+    for (unsigned k=0; k<bins; k++) {
+        T power = binPower(k);
+        if (framesAveraged == 1) {
+            psdAverage[k] = power;
+        }
+        else if (averaging == LINEAR_AVERAGING) {
+            psdAverage[k] += (power - psdAverage[k]) / (T) framesAveraged;
+        }
+        else if (averaging == EXPONENTIAL_AVERAGING) {
+            psdAverage[k] += exponentialWeight * (power - psdAverage[k]);
+        }
+        else {
+            psdAverage[k] = std::max(psdAverage[k], power);
+        }
+    }
+}
+
+template <class T>
+RealVector<T> & SpectralEstimator<T>::psd(RealVector<T> & result) const {
+    result.vec.assign(psdAverage.begin(), psdAverage.end());
+    return result;
+}
+
+/**
+ * \brief Adds the frames that "data" completes to the estimator's PSD average.
+ *
+ * \param data The next block of samples.
+ * \param estimator The spectral estimator.
+ * \return The number of frames added.
+ */
+template <class T>
+inline unsigned welch(const RealVector<T> & data, SpectralEstimator<T> & estimator) {
+    return estimator.welch(data);
+}
+
+/**
+ * \brief Computes the power spectra of the frames that "data" completes.
+ *
+ * \param data The next block of samples.
+ * \param frames Gets one row of power densities per frame.
+ * \param estimator The spectral estimator.
+ * \return The number of frames.
+ */
+template <class T>
+inline unsigned spectrogram(const RealVector<T> & data, RealVector<T> & frames, SpectralEstimator<T> & estimator) {
+    return estimator.spectrogram(data, frames);
+}
+
+/**
+ * \brief Computes the complex spectra of the frames that "data" completes.
+ *
+ * \param data The next block of samples.
+ * \param frames Gets one row of bins per frame.
+ * \param estimator The spectral estimator.
+ * \return The number of frames.
+ */
+template <class T>
+inline unsigned stft(const RealVector<T> & data, ComplexVector<T> & frames, SpectralEstimator<T> & estimator) {
+    return estimator.stft(data, frames);
+}
+
+};
+
+#endif
@@ -0,0 +1,344 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file SplitComplexVector.h
+ *
+ * Definition of the template class SplitComplexVector.
+ */
+
+#ifndef NimbleDSP_SplitComplexVector_h
+#define NimbleDSP_SplitComplexVector_h
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "ComplexVector.h"
+#include "FastMath.h"
+
+
+namespace NimbleDSP {
+
+template <class T> class Nco;
+
+/**
+ * \brief Complex vector that keeps the real and imaginary parts in separate arrays.
+ *
+ * ComplexVector stores std::complex elements, so the real and imaginary parts alternate in
+ * memory.  A SIMD register loaded from that holds a mix of the two, and complex arithmetic has to
+ * shuffle them apart and back together.  Here element i is re[i] + j*im[i], so every operation is
+ * the same arithmetic on whole registers of real parts and of imaginary parts, which the compiler
+ * vectorizes without any shuffles.
+ *
+ * Convert to and from ComplexVector at the edges of a processing chain (the constructor and
+ * \ref split, and \ref interleave), and keep the data split in between.  RealFirFilter::convSplit
+ * filters split data with real taps.
+ */
+template <class T>
+class SplitComplexVector {
+ public:
+    /**
+     * \brief The real parts.
+     */
+    std::vector<T> re;
+
+    /**
+     * \brief The imaginary parts.  Always the same size as \ref re.
+     */
+    std::vector<T> im;
+
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param size Number of elements, all initialized to zero.
+     */
+    SplitComplexVector<T>(unsigned size = 0) : re(size, 0), im(size, 0) {}
+
+    /**
+     * \brief Splits the elements of "data".
+     */
+    SplitComplexVector<T>(const ComplexVector<T> & data) {split(data);}
+
+    /**
+     * \brief Constructs the vector from separate real and imaginary parts, which must be the same
+     *      size.
+     */
+    template <typename U>
+    SplitComplexVector<T>(const std::vector<U> & realParts, const std::vector<U> & imagParts)
+            : re(realParts.begin(), realParts.end()), im(imagParts.begin(), imagParts.end())
+            {assert(re.size() == im.size());}
+
+    /*****************************************************************************************
+                                            Operators
+    *****************************************************************************************/
+    std::complex<T> operator[](unsigned index) const {return std::complex<T>(re[index], im[index]);}
+
+    SplitComplexVector<T> & operator+=(const SplitComplexVector<T> & rhs);
+    SplitComplexVector<T> & operator-=(const SplitComplexVector<T> & rhs);
+    SplitComplexVector<T> & operator*=(const SplitComplexVector<T> & rhs);
+    SplitComplexVector<T> & operator*=(const std::complex<T> & rhs);
+    SplitComplexVector<T> & operator*=(const T & rhs);
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    unsigned size() const {return re.size();}
+
+    /**
+     * \brief Changes the number of elements.  New elements are zero.
+     */
+    void resize(unsigned len) {re.resize(len, 0); im.resize(len, 0);}
+
+    /**
+     * \brief Sets element "index" to "val".
+     */
+    void set(unsigned index, const std::complex<T> & val) {re[index] = val.real(); im[index] = val.imag();}
+
+    /**
+     * \brief Replaces the contents with the elements of "data".
+     *
+     * \return Reference to "this".
+     */
+    SplitComplexVector<T> & split(const ComplexVector<T> & data);
+
+    /**
+     * \brief Copies the elements into "data" as std::complex.
+     *
+     * \return Reference to "data".
+     */
+    ComplexVector<T> & interleave(ComplexVector<T> & data) const;
+
+    /**
+     * \brief Conjugates the elements.
+     *
+     * \return Reference to "this".
+     */
+    SplitComplexVector<T> & conj();
+
+    /**
+     * \brief Sets each element to its magnitude squared.  The results are in \ref re, and \ref im
+     *      is zeroed.
+     *
+     * \return Reference to "this".
+     */
+    SplitComplexVector<T> & magSq();
+
+    /**
+     * \brief Sets each element to its angle.  The results are in \ref re, and \ref im is zeroed.
+     *
+     * \param accuracy NimbleDSP::FAST_MATH uses fastAtan2, which vectorizes, instead of std::atan2.
+     * \return Reference to "this".
+     */
+    SplitComplexVector<T> & angle(MathAccuracyType accuracy = EXACT_MATH);
+
+    /**
+     * \brief Modulates the data with a complex sinusoid.
+     *
+     * The tone comes from an \ref Nco, so there are no std::cos or std::sin calls and the phase
+     * doesn't lose precision as it grows.  Use Nco::modulate directly to mix a stream a block at a
+     * time.
+     *
+     * \param freq The modulating tone frequency.
+     * \param sampleFreq The sample frequency of the data.
+     * \param phase The modulating tone's starting phase, in radians.
+     * \return The next phase if the tone were to continue, in the range [0, 2*pi).
+     */
+    T modulate(T freq, T sampleFreq = 1.0, T phase = 0.0);
+};
+
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::operator+=(const SplitComplexVector<T> & rhs) {
+    assert(size() == rhs.size());
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    const T *rhsR = VECTOR_TO_ARRAY(rhs.re), *rhsI = VECTOR_TO_ARRAY(rhs.im);
+    for (unsigned n=0; n<size(); n++) {
+        r[n] += rhsR[n];
+        i[n] += rhsI[n];
+    }
+    return *this;
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::operator-=(const SplitComplexVector<T> & rhs) {
+    assert(size() == rhs.size());
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    const T *rhsR = VECTOR_TO_ARRAY(rhs.re), *rhsI = VECTOR_TO_ARRAY(rhs.im);
+    for (unsigned n=0; n<size(); n++) {
+        r[n] -= rhsR[n];
+        i[n] -= rhsI[n];
+    }
+    return *this;
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::operator*=(const SplitComplexVector<T> & rhs) {
+    assert(size() == rhs.size());
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    const T *rhsR = VECTOR_TO_ARRAY(rhs.re), *rhsI = VECTOR_TO_ARRAY(rhs.im);
+    for (unsigned n=0; n<size(); n++) {
+        T real = r[n] * rhsR[n] - i[n] * rhsI[n];
+        i[n] = r[n] * rhsI[n] + i[n] * rhsR[n];
+        r[n] = real;
+    }
+    return *this;
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::operator*=(const std::complex<T> & rhs) {
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    T rhsR = rhs.real(), rhsI = rhs.imag();
+    for (unsigned n=0; n<size(); n++) {
+        T real = r[n] * rhsR - i[n] * rhsI;
+        i[n] = r[n] * rhsI + i[n] * rhsR;
+        r[n] = real;
+    }
+    return *this;
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::operator*=(const T & rhs) {
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    for (unsigned n=0; n<size(); n++) {
+        r[n] *= rhs;
+        i[n] *= rhs;
+    }
+    return *this;
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::split(const ComplexVector<T> & data) {
+    re.resize(data.size());
+    im.resize(data.size());
+    for (unsigned n=0; n<data.size(); n++) {
+        re[n] = data.vec[n].real();
+        im[n] = data.vec[n].imag();
+    }
+    return *this;
+}
+
+template <class T>
+ComplexVector<T> & SplitComplexVector<T>::interleave(ComplexVector<T> & data) const {
+    data.vec.resize(size());
+    for (unsigned n=0; n<size(); n++) {
+        data.vec[n] = std::complex<T>(re[n], im[n]);
+    }
+    return data;
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::conj() {
+    T *i = VECTOR_TO_ARRAY(im);
+    for (unsigned n=0; n<size(); n++) {
+        i[n] = -i[n];
+    }
+    return *this;
+}
+
+/**
+ * \brief Conjugates the elements of "buffer".
+ *
+ * \return Reference to "buffer".
+ */
+template <class T>
+inline SplitComplexVector<T> & conj(SplitComplexVector<T> & buffer) {
+    return buffer.conj();
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::magSq() {
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    for (unsigned n=0; n<size(); n++) {
+        r[n] = r[n] * r[n] + i[n] * i[n];
+        i[n] = 0;
+    }
+    return *this;
+}
+
+/**
+ * \brief Sets each element of "buffer" to its magnitude squared.  See SplitComplexVector::magSq.
+ *
+ * \return Reference to "buffer".
+ */
+template <class T>
+inline SplitComplexVector<T> & magSq(SplitComplexVector<T> & buffer) {
+    return buffer.magSq();
+}
+
+template <class T>
+SplitComplexVector<T> & SplitComplexVector<T>::angle(MathAccuracyType accuracy) {
+    T *r = VECTOR_TO_ARRAY(re), *i = VECTOR_TO_ARRAY(im);
+    if (accuracy == FAST_MATH) {
+        for (unsigned n=0; n<size(); n++) {
+            r[n] = fastAtan2(i[n], r[n]);
+            i[n] = 0;
+        }
+    }
+    else {
+        for (unsigned n=0; n<size(); n++) {
+            r[n] = std::atan2(i[n], r[n]);
+            i[n] = 0;
+        }
+    }
+    return *this;
+}
+
+/**
+ * \brief Sets each element of "buffer" to its angle.  See SplitComplexVector::angle.
+ *
+ * \return Reference to "buffer".
+ */
+template <class T>
+inline SplitComplexVector<T> & angle(SplitComplexVector<T> & buffer, MathAccuracyType accuracy = EXACT_MATH) {
+    return buffer.angle(accuracy);
+}
+
+template <class T>
+T SplitComplexVector<T>::modulate(T freq, T sampleFreq, T phase) {
+    assert(sampleFreq > 0.0);
+    
+    Nco<T> nco(freq, sampleFreq, phase);
+    nco.modulate(*this);
+    return nco.getPhase();
+}
+
+/**
+ * \brief Modulates "data" with a complex sinusoid.  See SplitComplexVector::modulate.
+ *
+ * \return The next phase if the tone were to continue, in the range [0, 2*pi).
+ */
+template <class T>
+inline T modulate(SplitComplexVector<T> & data, T freq, T sampleFreq = 1.0, T phase = 0.0) {
+    return data.modulate(freq, sampleFreq, phase);
+}
+
+};
+
+// Nco uses SplitComplexVector, so it's included once SplitComplexVector is defined.
+#include "Nco.h"
+
+#endif
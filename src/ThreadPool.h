@@ -0,0 +1,209 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file ThreadPool.h
+ *
+ * Definition of the class ThreadPool, which splits loops across a fixed set of worker threads.
+ */
+
+#ifndef NimbleDSP_ThreadPool_h
+#define NimbleDSP_ThreadPool_h
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cassert>
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief A fixed set of worker threads for splitting up loops.
+ *
+ * Give a pool to a filter (see Vector::threadPool) and its one-shot convolutions split their
+ * outputs across the pool:
+ *
+ *      ThreadPool pool;                    // One thread per core
+ *      filter.threadPool = &pool;
+ *      conv(hugeCapture, filter, true);
+ *
+ * The thread that calls \ref parallelFor does a share of the work itself, so a pool of size N has
+ * N - 1 worker threads.  Threads waiting in parallelFor run other queued work while they wait, so
+ * parallelFor can be called from inside a parallelFor.  A pool can be shared by any number of
+ * objects and threads.
+ */
+class ThreadPool {
+ protected:
+    std::vector<std::thread> workers;
+    std::deque< std::function<void ()> > tasks;
+    std::mutex lock;
+    std::condition_variable taskReady;
+    std::condition_variable taskDone;
+    bool stopping;
+    
+    /**
+     * \brief Runs one queued task if there is one.  "guard" must hold \ref lock, and still does
+     *      when this returns.
+     */
+    bool runQueuedTask(std::unique_lock<std::mutex> & guard) {
+        if (tasks.empty()) {
+            return false;
+        }
+        std::function<void ()> task = tasks.front();
+        tasks.pop_front();
+        guard.unlock();
+        task();
+        guard.lock();
+        taskDone.notify_all();
+        return true;
+    }
+    
+    void workerLoop() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            if (!runQueuedTask(guard)) {
+                if (stopping) {
+                    return;
+                }
+                taskReady.wait(guard);
+            }
+        }
+    }
+    
+    ThreadPool(const ThreadPool &);
+    ThreadPool & operator=(const ThreadPool &);
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Basic constructor.
+     *
+     * \param numThreads Number of threads that share the work, including the one that calls
+     *      \ref parallelFor.  0 means one per core.
+     */
+    ThreadPool(unsigned numThreads = 0) : stopping(false) {
+        if (numThreads == 0) {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i=1; i<numThreads; i++) {
+            workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+        }
+    }
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (unsigned i=0; i<workers.size(); i++) {
+            workers[i].join();
+        }
+    }
+    
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of threads that share the work, including the caller.
+     */
+    unsigned size() const {return workers.size() + 1;}
+    
+    /**
+     * \brief Calls func(first, last) on contiguous pieces of [begin, end) in parallel, and returns
+     *      once they have all finished.
+     *
+     * \param begin Start of the range.
+     * \param end End of the range (exclusive).
+     * \param minChunk The smallest piece worth handing to another thread.
+     * \param func Called with the bounds of each piece.  The pieces don't overlap and together
+     *      cover the range.
+     */
+    template <class F>
+    void parallelFor(int begin, int end, int minChunk, F func);
+};
+
+
+template <class F>
+void ThreadPool::parallelFor(int begin, int end, int minChunk, F func) {
+    int len = end - begin;
+    if (len <= 0) {
+        return;
+    }
+    int numChunks = std::min((int) size(), std::max(1, len / std::max(1, minChunk)));
+    if (numChunks == 1) {
+        func(begin, end);
+        return;
+    }
+    
+    int remaining = numChunks - 1;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int chunk=1; chunk<numChunks; chunk++) {
+            int first = begin + (int) ((long long) len * chunk / numChunks);
+            int last = begin + (int) ((long long) len * (chunk + 1) / numChunks);
+            tasks.push_back([&func, &remaining, this, first, last]() {
+                func(first, last);
+                std::lock_guard<std::mutex> done(lock);
+                --remaining;
+            });
+        }
+    }
+    taskReady.notify_all();
+    
+    func(begin, begin + len / numChunks);
+    
+    std::unique_lock<std::mutex> guard(lock);
+    while (remaining > 0) {
+        if (!runQueuedTask(guard)) {
+            taskDone.wait(guard);
+        }
+    }
+}
+
+/**
+ * \brief Calls func(first, last) on pieces of [begin, end) using "pool", or just func(begin, end)
+ *      if "pool" is NULL.
+ */
+template <class F>
+inline void parallelFor(ThreadPool *pool, int begin, int end, int minChunk, F func) {
+    if (pool == NULL) {
+        if (end > begin) {
+            func(begin, end);
+        }
+    }
+    else {
+        pool->parallelFor(begin, end, minChunk, func);
+    }
+}
+
+};
+
+#endif
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include <vector>
 #include <algorithm>
+#include <utility>
 #include <cassert>
 #include <cstdlib>
 #include <cmath>
@@ -40,18 +41,65 @@ THE SOFTWARE.
 #include "kiss_fft.h"
 #include "kiss_fftr.h"
 #include "NimbleDspCommon.h"
+#include "Allocators.h"
+#include "Instrumentation.h"
 
 
 namespace NimbleDSP {
 
+class ThreadPool;
+
 const unsigned DEFAULT_BUF_LEN = 0;
 
 #ifndef SLICKDSP_FLOAT_TYPE
 #define SLICKDSP_FLOAT_TYPE    double
 #endif
 
+/**
+ * \brief The floating point type that statistics such as mean and var are accumulated and returned
+ *      in for vectors of T, and that pow's exponent is given in.
+ *
+ * Floating point vectors use their own type, so RealVector<float>::mean() sums in float instead of
+ * promoting every element to double.  Integer vectors use SLICKDSP_FLOAT_TYPE.  Specialize this
+ * for your own element types.  The statistics methods also take the type as a template parameter,
+ * e.g. buf.mean<double>(), for the occasional call that needs more precision than the default.
+ */
+template <class T>
+struct FloatTypeTraits {
+    typedef SLICKDSP_FLOAT_TYPE type;
+};
+
+template <>
+struct FloatTypeTraits<float> {
+    typedef float type;
+};
+
+template <>
+struct FloatTypeTraits<double> {
+    typedef double type;
+};
+
+template <>
+struct FloatTypeTraits<long double> {
+    typedef long double type;
+};
+
 #define VECTOR_TO_ARRAY(x)      (&((x)[0]))
 
+/**
+ * \brief Replaces the contents of "storage" with "results", a buffer borrowed from the workspace.
+ *
+ * The buffers are swapped when "storage" uses the default allocator.  Otherwise the results are copied
+ * so that "storage" keeps its own allocator.
+ */
+template <class T, class Allocator>
+inline void takeResults(std::vector<T, Allocator> & storage, std::vector<T> & results) {
+    storage.assign(results.begin(), results.end());
+}
+
+template <class T>
+inline void takeResults(std::vector<T> & storage, std::vector<T> & results) {storage.swap(results);}
+
 
 /**
  * \brief Base class for NimbleDSP.
@@ -62,8 +110,11 @@ const unsigned DEFAULT_BUF_LEN = 0;
  * functionality in each class.
  *
  * Derived classes: RealVector and ComplexVector.
+ *
+ * \tparam Allocator Allocator for \ref vec, e.g. AlignedAllocator or ArenaAllocator.  The scratch
+ *      buffers always use the default allocator.
  */
-template <class T>
+template <class T, class Allocator = std::allocator<T> >
 class Vector {
 
  protected:
@@ -75,7 +126,7 @@ class Vector {
     /** 
      * \brief Initializes vec to a given size and fills it with zeros.
      */
-    void initSize(unsigned size) {vec = std::vector<T>(size);}
+    void initSize(unsigned size) {vec = std::vector<T, Allocator>(size);}
     
     /** 
      * \brief Initializes vec with the size and contents of "array".
@@ -94,12 +145,27 @@ class Vector {
      * dynamic memory, have a rich set of support functions, are fast and efficient, and can
      * be accessed like a normal array when that is convenient.
      *****************************************************************************************/
-	std::vector<T> vec;
+	std::vector<T, Allocator> vec;
+    
+    /**
+     * \brief Thread pool that one-shot conv, decimate, interp and resample use when this object is
+     *      the filter.
+     *
+     * The output is split into contiguous ranges that are computed by the pool's threads.  NULL (the
+     * default) means all of the work is done by the calling thread.  The pool isn't owned, so it has
+     * to outlive the object.
+     */
+    ThreadPool *threadPool;
     
-    template <class U> friend class Vector;
-    template <class U> friend class RealVector;
+    template <class U, class UAllocator> friend class Vector;
+    template <class U, class UAllocator> friend class RealVector;
     template <class U> friend class RealFirFilter;
     template <class U> friend class ComplexFirFilter;
+    template <class U> friend class PolyphaseResampler;
+    template <class U> friend class MultiChannelFirFilter;
+    template <class U> friend class PfbChannelizer;
+    template <class U> friend class FarrowResampler;
+    template <class U> friend class Correlator;
     
     /*****************************************************************************************
                                         Constructors
@@ -113,10 +179,10 @@ class Vector {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
-    Vector<T>(unsigned size = 0, std::vector<T> *scratch = NULL) {initSize(size); scratchBuf = scratch;}
+    Vector<T, Allocator>(unsigned size = 0, std::vector<T> *scratch = NULL) {initSize(size); scratchBuf = scratch; threadPool = NULL;}
     
     /**
      * \brief Vector constructor.
@@ -128,11 +194,11 @@ class Vector {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     template <typename U>
-    Vector<T>(std::vector<U> data, std::vector<T> *scratch = NULL) {initArray(VECTOR_TO_ARRAY(data), data.size()); scratchBuf = scratch;}
+    Vector<T, Allocator>(std::vector<U> data, std::vector<T> *scratch = NULL) {initArray(VECTOR_TO_ARRAY(data), data.size()); scratchBuf = scratch; threadPool = NULL;}
     
     /**
      * \brief Array constructor.
@@ -145,20 +211,37 @@ class Vector {
      *      objects (in fact, I recommend it), but if there are multiple threads then it should
      *      be shared only by objects that are accessed by a single thread.  Objects in other
      *      threads should have a separate scratch buffer.  If no scratch buffer is provided
-     *      then one will be created in methods that require one and destroyed when the method
-     *      returns.
+     *      then methods that require one borrow one from the calling thread's workspace (see
+     *      ScratchBuffer).
      */
     template <typename U>
-    Vector<T>(U *data, unsigned dataLen, std::vector<T> *scratch = NULL) {initArray(data, dataLen); scratchBuf = scratch;}
+    Vector<T, Allocator>(U *data, unsigned dataLen, std::vector<T> *scratch = NULL) {initArray(data, dataLen); scratchBuf = scratch; threadPool = NULL;}
     
     /**
      * \brief Copy constructor.
      */
-    Vector<T>(const Vector<T>& other) {vec = other.vec; scratchBuf = other.scratchBuf;}
+    Vector<T, Allocator>(const Vector<T, Allocator>& other)
+            {vec = other.vec; scratchBuf = other.scratchBuf; threadPool = other.threadPool;}
+    
+    /**
+     * \brief Move constructor.  Takes over the contents of "other" without copying them.
+     */
+    Vector<T, Allocator>(Vector<T, Allocator>&& other) : scratchBuf(other.scratchBuf), vec(std::move(other.vec)),
+            threadPool(other.threadPool) {}
     
     /*****************************************************************************************
                                             Operators
     *****************************************************************************************/
+    /**
+     * \brief Assignment operator.
+     */
+    Vector<T, Allocator>& operator=(const Vector<T, Allocator>& rhs) {vec = rhs.vec; scratchBuf = rhs.scratchBuf; threadPool = rhs.threadPool; return *this;}
+    
+    /**
+     * \brief Move assignment operator.
+     */
+    Vector<T, Allocator>& operator=(Vector<T, Allocator>&& rhs) {vec = std::move(rhs.vec); scratchBuf = rhs.scratchBuf; threadPool = rhs.threadPool; return *this;}
+    
     /**
      * \brief Index assignment operator.
      */
@@ -194,17 +277,17 @@ class Vector {
 };
 
 
-template <class T>
+template <class T, class Allocator>
 template <class U>
-void Vector<T>::initArray(U *array, unsigned arrayLen) {
-    vec = std::vector<T>(arrayLen);
+void Vector<T, Allocator>::initArray(U *array, unsigned arrayLen) {
+    vec = std::vector<T, Allocator>(arrayLen);
     for (unsigned i=0; i<arrayLen; i++) {
         vec[i] = (T) array[i];
     }
 }
 
-template <class T>
-inline bool operator==(const Vector<T>& lhs, const Vector<T>& rhs) {
+template <class T, class Allocator>
+inline bool operator==(const Vector<T, Allocator>& lhs, const Vector<T, Allocator>& rhs) {
     if (lhs.size() != rhs.size())
         return false;
     
@@ -215,11 +298,11 @@ inline bool operator==(const Vector<T>& lhs, const Vector<T>& rhs) {
     return true;
 }
 
-template <class T>
-inline bool operator!=(const Vector<T>& lhs, const Vector<T>& rhs) {return !(lhs == rhs);}
+template <class T, class Allocator>
+inline bool operator!=(const Vector<T, Allocator>& lhs, const Vector<T, Allocator>& rhs) {return !(lhs == rhs);}
 
-template <class T>
-const int Vector<T>::find(const T val) const {
+template <class T, class Allocator>
+const int Vector<T, Allocator>::find(const T val) const {
     for (unsigned i=0; i<size(); i++) {
         if (vec[i] == val) {
             return (int) i;
@@ -236,13 +319,13 @@ const int Vector<T>::find(const T val) const {
  * \return Index of first instance of "val".  If there aren't any elements equal to "val"
  *      it returns -1.
  */
-template <class T>
-const int find(Vector<T> & vector, const T val) {
+template <class T, class Allocator>
+const int find(Vector<T, Allocator> & vector, const T val) {
     return vector.find(val);
 }
 
-template <class T>
-T Vector<T>::sum() const {
+template <class T, class Allocator>
+T Vector<T, Allocator>::sum() const {
 	assert(vec.size() > 0);
 	T vectorSum = 0;
 	for (unsigned i=0; i<vec.size(); i++) {
@@ -256,8 +339,8 @@ T Vector<T>::sum() const {
  *
  * \param vector Buffer to operate on.
  */
-template <class T>
-T sum(const Vector<T> & vector) {
+template <class T, class Allocator>
+T sum(const Vector<T, Allocator> & vector) {
 	return vector.sum();
 }
 
@@ -0,0 +1,340 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file VectorExpression.h
+ *
+ * Expression templates for lazily evaluated element-wise Vector arithmetic.
+ *
+ * The Vector operators and methods each make one pass over the data, so a chain like
+ * "buf *= k; buf += offset; buf.exp();" reads and writes the whole buffer three times.  Wrapping
+ * a Vector in \ref lazy instead builds an expression object that describes the arithmetic without
+ * doing any of it.  The work is done in one pass when the expression is assigned to a RealVector
+ * or ComplexVector (or passed to a method such as RealVector::cumsum that takes an expression):
+ *
+ *      buf = exp(lazy(buf) * k + offset);
+ *      cumsum(buf, lazy(buf) * k);
+ *
+ * Every operation is element-wise, so it is safe for the destination to appear in the expression.
+ * All of the vectors in an expression must be the same size.
+ */
+
+#ifndef NimbleDSP_VectorExpression_h
+#define NimbleDSP_VectorExpression_h
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <utility>
+#include "Vector.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief Base class of all expressions.  E is the derived class.
+ *
+ * Each expression class has a "value_type" typedef, a size() method, and an operator[] that
+ * computes one element.
+ */
+template <class E>
+class VectorExpression {
+ public:
+    /**
+     * \brief Returns "this" as the derived expression class.
+     */
+    const E & self() const {return static_cast<const E &>(*this);}
+};
+
+/**
+ * \brief Expression that reads the elements of a Vector or a VectorView.  Doesn't copy the data.
+ */
+template <class T>
+class VectorTerminal : public VectorExpression< VectorTerminal<T> > {
+ protected:
+    const T *data;
+    unsigned len;
+
+ public:
+    typedef T value_type;
+
+    template <class Allocator>
+    VectorTerminal<T>(const Vector<T, Allocator> & vector) : data(vector.vec.data()), len(vector.size()) {}
+    VectorTerminal<T>(const T *array, unsigned arrayLen) : data(array), len(arrayLen) {}
+
+    unsigned size() const {return len;}
+    const T & operator[](unsigned index) const {return data[index];}
+};
+
+/**
+ * \brief Expression that applies Op element by element to two expressions.
+ */
+template <class L, class R, class Op>
+class BinaryExpression : public VectorExpression< BinaryExpression<L, R, Op> > {
+ protected:
+    L lhs;
+    R rhs;
+
+ public:
+    typedef decltype(Op::apply(std::declval<typename L::value_type>(),
+                               std::declval<typename R::value_type>())) value_type;
+
+    BinaryExpression<L, R, Op>(const L & left, const R & right) : lhs(left), rhs(right)
+            {assert(lhs.size() == rhs.size());}
+
+    unsigned size() const {return lhs.size();}
+    value_type operator[](unsigned index) const {return Op::apply(lhs[index], rhs[index]);}
+};
+
+/**
+ * \brief Expression that applies Op element by element to an expression and a scalar.
+ *
+ * "scalarOnLeft" says which side of the operator the scalar goes on.
+ */
+template <class E, class S, class Op, bool scalarOnLeft>
+class ScalarExpression : public VectorExpression< ScalarExpression<E, S, Op, scalarOnLeft> > {
+ protected:
+    E expr;
+    S scalar;
+
+ public:
+    typedef decltype(Op::apply(std::declval<typename E::value_type>(), std::declval<S>())) value_type;
+
+    ScalarExpression<E, S, Op, scalarOnLeft>(const E & expression, const S & value) : expr(expression),
+            scalar(value) {}
+
+    unsigned size() const {return expr.size();}
+    value_type operator[](unsigned index) const
+            {return scalarOnLeft ? Op::apply(scalar, expr[index]) : Op::apply(expr[index], scalar);}
+};
+
+/**
+ * \brief Expression that applies Op to each element of an expression.
+ */
+template <class E, class Op>
+class UnaryExpression : public VectorExpression< UnaryExpression<E, Op> > {
+ protected:
+    E expr;
+
+ public:
+    typedef decltype(Op::apply(std::declval<typename E::value_type>())) value_type;
+
+    UnaryExpression<E, Op>(const E & expression) : expr(expression) {}
+
+    unsigned size() const {return expr.size();}
+    value_type operator[](unsigned index) const {return Op::apply(expr[index]);}
+};
+
+
+/*****************************************************************************************
+                                        Operations
+*****************************************************************************************/
+struct AddOperation {
+    template <class A, class B>
+    static auto apply(const A & a, const B & b) -> decltype(a + b) {return a + b;}
+};
+
+struct SubtractOperation {
+    template <class A, class B>
+    static auto apply(const A & a, const B & b) -> decltype(a - b) {return a - b;}
+};
+
+struct MultiplyOperation {
+    template <class A, class B>
+    static auto apply(const A & a, const B & b) -> decltype(a * b) {return a * b;}
+};
+
+struct DivideOperation {
+    template <class A, class B>
+    static auto apply(const A & a, const B & b) -> decltype(a / b) {return a / b;}
+};
+
+struct NegateOperation {
+    template <class A>
+    static A apply(const A & a) {return -a;}
+};
+
+struct AbsOperation {
+    template <class A>
+    static auto apply(const A & a) -> decltype(std::abs(a)) {return std::abs(a);}
+};
+
+struct ExpOperation {
+    template <class A>
+    static auto apply(const A & a) -> decltype(std::exp(a)) {return std::exp(a);}
+};
+
+struct LogOperation {
+    template <class A>
+    static auto apply(const A & a) -> decltype(std::log(a)) {return std::log(a);}
+};
+
+struct SqrtOperation {
+    template <class A>
+    static auto apply(const A & a) -> decltype(std::sqrt(a)) {return std::sqrt(a);}
+};
+
+struct ConjOperation {
+    template <class A>
+    static std::complex<A> apply(const std::complex<A> & a) {return std::conj(a);}
+};
+
+
+/*****************************************************************************************
+                                        Functions
+*****************************************************************************************/
+/**
+ * \brief Starts a lazily evaluated expression.
+ *
+ * The expression refers to "vector" rather than copying it, so "vector" has to outlive the
+ * expression.
+ */
+template <class T, class Allocator>
+inline VectorTerminal<T> lazy(const Vector<T, Allocator> & vector) {
+    return VectorTerminal<T>(vector);
+}
+
+/**
+ * \brief Evaluates "expr" into "out" in a single pass.
+ */
+template <class E, class T, class Allocator>
+void evaluate(const VectorExpression<E> & expr, std::vector<T, Allocator> & out) {
+    const E & e = expr.self();
+    unsigned len = e.size();
+    out.resize(len);
+    for (unsigned i=0; i<len; i++) {
+        out[i] = e[i];
+    }
+}
+
+/**
+ * \brief Combines the elements of "expr" into "out" with Op (e.g. out[i] += expr[i]) in a single
+ *      pass.
+ */
+template <class Op, class E, class T, class Allocator>
+void evaluateWith(const VectorExpression<E> & expr, std::vector<T, Allocator> & out) {
+    const E & e = expr.self();
+    unsigned len = e.size();
+    assert(out.size() == len);
+    for (unsigned i=0; i<len; i++) {
+        out[i] = Op::apply(out[i], e[i]);
+    }
+}
+
+#define NIMBLEDSP_EXPRESSION_BINARY_OPERATOR(op, Operation) \
+template <class L, class R> \
+inline BinaryExpression<L, R, Operation> operator op(const VectorExpression<L> & lhs, const VectorExpression<R> & rhs) { \
+    return BinaryExpression<L, R, Operation>(lhs.self(), rhs.self()); \
+} \
+template <class L, class U, class A> \
+inline BinaryExpression<L, VectorTerminal<U>, Operation> operator op(const VectorExpression<L> & lhs, const Vector<U, A> & rhs) { \
+    return BinaryExpression<L, VectorTerminal<U>, Operation>(lhs.self(), VectorTerminal<U>(rhs)); \
+} \
+template <class U, class A, class R> \
+inline BinaryExpression<VectorTerminal<U>, R, Operation> operator op(const Vector<U, A> & lhs, const VectorExpression<R> & rhs) { \
+    return BinaryExpression<VectorTerminal<U>, R, Operation>(VectorTerminal<U>(lhs), rhs.self()); \
+} \
+template <class E> \
+inline ScalarExpression<E, typename E::value_type, Operation, false> operator op(const VectorExpression<E> & lhs, \
+            const typename E::value_type & rhs) { \
+    return ScalarExpression<E, typename E::value_type, Operation, false>(lhs.self(), rhs); \
+} \
+template <class E> \
+inline ScalarExpression<E, typename E::value_type, Operation, true> operator op(const typename E::value_type & lhs, \
+            const VectorExpression<E> & rhs) { \
+    return ScalarExpression<E, typename E::value_type, Operation, true>(rhs.self(), lhs); \
+}
+
+NIMBLEDSP_EXPRESSION_BINARY_OPERATOR(+, AddOperation)
+NIMBLEDSP_EXPRESSION_BINARY_OPERATOR(-, SubtractOperation)
+NIMBLEDSP_EXPRESSION_BINARY_OPERATOR(*, MultiplyOperation)
+NIMBLEDSP_EXPRESSION_BINARY_OPERATOR(/, DivideOperation)
+
+#undef NIMBLEDSP_EXPRESSION_BINARY_OPERATOR
+
+/**
+ * \brief Lazy negation.
+ */
+template <class E>
+inline UnaryExpression<E, NegateOperation> operator-(const VectorExpression<E> & expr) {
+    return UnaryExpression<E, NegateOperation>(expr.self());
+}
+
+/**
+ * \brief Lazy absolute value.  The magnitude for complex expressions.
+ */
+template <class E>
+inline UnaryExpression<E, AbsOperation> abs(const VectorExpression<E> & expr) {
+    return UnaryExpression<E, AbsOperation>(expr.self());
+}
+
+/**
+ * \brief Lazy e^(element).
+ */
+template <class E>
+inline UnaryExpression<E, ExpOperation> exp(const VectorExpression<E> & expr) {
+    return UnaryExpression<E, ExpOperation>(expr.self());
+}
+
+/**
+ * \brief Lazy natural log.
+ */
+template <class E>
+inline UnaryExpression<E, LogOperation> log(const VectorExpression<E> & expr) {
+    return UnaryExpression<E, LogOperation>(expr.self());
+}
+
+/**
+ * \brief Lazy square root.
+ */
+template <class E>
+inline UnaryExpression<E, SqrtOperation> sqrt(const VectorExpression<E> & expr) {
+    return UnaryExpression<E, SqrtOperation>(expr.self());
+}
+
+/**
+ * \brief Lazy complex conjugate.
+ */
+template <class E>
+inline UnaryExpression<E, ConjOperation> conj(const VectorExpression<E> & expr) {
+    return UnaryExpression<E, ConjOperation>(expr.self());
+}
+
+/**
+ * \brief Sums the elements of an expression without storing them.
+ */
+template <class E>
+typename E::value_type sum(const VectorExpression<E> & expr) {
+    const E & e = expr.self();
+    assert(e.size() > 0);
+    typename E::value_type total = 0;
+    for (unsigned i=0; i<e.size(); i++) {
+        total += e[i];
+    }
+    return total;
+}
+
+};
+
+#endif
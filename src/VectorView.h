@@ -0,0 +1,235 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/**
+ * @file VectorView.h
+ *
+ * Definition of the template class VectorView.
+ */
+
+#ifndef NimbleDSP_VectorView_h
+#define NimbleDSP_VectorView_h
+
+#include <complex>
+#include <cassert>
+#include "Vector.h"
+#include "VectorExpression.h"
+
+
+namespace NimbleDSP {
+
+/**
+ * \brief A non-owning view of an array that somebody else owns.
+ *
+ * The vector classes own their data in a std::vector, so data that arrives in some other buffer
+ * (a DMA ring, a memory mapped file, the buffer fread wrote into) has to be copied into one
+ * before it can be processed.  A view is just a pointer and a length, so it can be pointed at
+ * such a buffer and processed where it is.  The element-wise operators work in place, expressions
+ * (see \ref lazy) can be assigned to a view, and the FIR filters' streaming conv, decimate and
+ * interp methods accept views.
+ *
+ * Copying or assigning one view to another copies the pointer, not the data.  The view is only
+ * valid while the memory it points at is; in particular a view of a Vector is invalidated by
+ * anything that resizes the Vector.  T is the element type, so a view of complex data is a
+ * VectorView< std::complex<float> >.
+ */
+template <class T>
+class VectorView {
+ protected:
+    T *buf;
+    unsigned len;
+
+ public:
+    /*****************************************************************************************
+                                        Constructors
+    *****************************************************************************************/
+    /**
+     * \brief Empty view.
+     */
+    VectorView<T>() : buf(NULL), len(0) {}
+
+    /**
+     * \brief Array constructor.
+     *
+     * \param data The array to view.  It isn't copied.
+     * \param dataLen Number of elements in "data".
+     */
+    VectorView<T>(T *data, unsigned dataLen) : buf(data), len(dataLen) {}
+
+    /**
+     * \brief Views the current contents of "vector".  Explicit so that passing a Vector to a method
+     *      with both Vector and view overloads never quietly picks the view.
+     */
+    explicit VectorView<T>(Vector<T> & vector) : buf(vector.vec.data()), len(vector.size()) {}
+
+    /*****************************************************************************************
+                                            Operators
+    *****************************************************************************************/
+    T& operator[](unsigned index) {return buf[index];}
+    const T& operator[](unsigned index) const {return buf[index];}
+
+    /**
+     * \brief Evaluates "expr" into the viewed elements in a single pass.  The expression must be
+     *      the same size as the view, and may refer to it.
+     */
+    template <class E>
+    VectorView<T> & operator=(const VectorExpression<E> & expr);
+
+    /**
+     * \brief Unary minus (negation) operator.  Negates the elements in place.
+     */
+    VectorView<T> & operator-();
+
+    template <class E>
+    VectorView<T> & operator+=(const VectorExpression<E> & rhs);
+    template <class E>
+    VectorView<T> & operator-=(const VectorExpression<E> & rhs);
+    template <class E>
+    VectorView<T> & operator*=(const VectorExpression<E> & rhs);
+    template <class E>
+    VectorView<T> & operator/=(const VectorExpression<E> & rhs);
+
+    template <class U>
+    VectorView<T> & operator+=(const Vector<U> & rhs) {return *this += VectorTerminal<U>(rhs);}
+    template <class U>
+    VectorView<T> & operator-=(const Vector<U> & rhs) {return *this -= VectorTerminal<U>(rhs);}
+    template <class U>
+    VectorView<T> & operator*=(const Vector<U> & rhs) {return *this *= VectorTerminal<U>(rhs);}
+    template <class U>
+    VectorView<T> & operator/=(const Vector<U> & rhs) {return *this /= VectorTerminal<U>(rhs);}
+
+    VectorView<T> & operator+=(const T & rhs);
+    VectorView<T> & operator-=(const T & rhs);
+    VectorView<T> & operator*=(const T & rhs);
+    VectorView<T> & operator/=(const T & rhs);
+
+    /*****************************************************************************************
+                                            Methods
+    *****************************************************************************************/
+    /**
+     * \brief Returns the number of elements in the view.
+     */
+    unsigned size() const {return len;}
+
+    /**
+     * \brief Returns a pointer to the first element.
+     */
+    T *data() const {return buf;}
+
+    /**
+     * \brief Returns a view of "length" elements starting at "start".
+     */
+    VectorView<T> subview(unsigned start, unsigned length) const
+            {assert(start + length <= len); return VectorView<T>(buf + start, length);}
+
+    /**
+     * \brief Finds the first instance of "val".
+     *
+     * \return Index of first instance of "val".  If there aren't any elements equal to "val"
+     *      it returns -1.
+     */
+    int find(const T val) const;
+
+    /**
+     * \brief Returns the sum of all the elements.
+     */
+    T sum() const;
+};
+
+
+/**
+ * \brief Starts a lazily evaluated expression from a view.  See the Vector version of lazy.
+ */
+template <class T>
+inline VectorTerminal<T> lazy(const VectorView<T> & view) {
+    return VectorTerminal<T>(view.data(), view.size());
+}
+
+template <class T>
+template <class E>
+VectorView<T> & VectorView<T>::operator=(const VectorExpression<E> & expr) {
+    const E & e = expr.self();
+    assert(e.size() == len);
+    for (unsigned i=0; i<len; i++) {
+        buf[i] = e[i];
+    }
+    return *this;
+}
+
+template <class T>
+VectorView<T> & VectorView<T>::operator-() {
+    for (unsigned i=0; i<len; i++) {
+        buf[i] = -buf[i];
+    }
+    return *this;
+}
+
+#define NIMBLEDSP_VIEW_ASSIGNMENT_OPERATOR(op) \
+template <class T> \
+template <class E> \
+VectorView<T> & VectorView<T>::operator op##=(const VectorExpression<E> & rhs) { \
+    const E & e = rhs.self(); \
+    assert(e.size() == len); \
+    for (unsigned i=0; i<len; i++) { \
+        buf[i] = buf[i] op e[i]; \
+    } \
+    return *this; \
+} \
+template <class T> \
+VectorView<T> & VectorView<T>::operator op##=(const T & rhs) { \
+    for (unsigned i=0; i<len; i++) { \
+        buf[i] = buf[i] op rhs; \
+    } \
+    return *this; \
+}
+
+NIMBLEDSP_VIEW_ASSIGNMENT_OPERATOR(+)
+NIMBLEDSP_VIEW_ASSIGNMENT_OPERATOR(-)
+NIMBLEDSP_VIEW_ASSIGNMENT_OPERATOR(*)
+NIMBLEDSP_VIEW_ASSIGNMENT_OPERATOR(/)
+
+#undef NIMBLEDSP_VIEW_ASSIGNMENT_OPERATOR
+
+template <class T>
+int VectorView<T>::find(const T val) const {
+    for (unsigned i=0; i<len; i++) {
+        if (buf[i] == val) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+template <class T>
+T VectorView<T>::sum() const {
+    assert(len > 0);
+    T viewSum = 0;
+    for (unsigned i=0; i<len; i++) {
+        viewSum += buf[i];
+    }
+    return viewSum;
+}
+
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Allocators.h"
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+
+TEST(Allocators, AlignedAllocator) {
+    for (unsigned len=1; len<100; len+=7) {
+        std::vector<float, AlignedAllocator<float> > buf(len, 1.5f);
+        EXPECT_EQ(0u, ((uintptr_t) buf.data()) % DEFAULT_ALIGNMENT);
+        EXPECT_EQ(1.5f, buf[len - 1]);
+    }
+
+    std::vector< std::complex<double>, AlignedAllocator<std::complex<double>, 128> > buf(3);
+    EXPECT_EQ(0u, ((uintptr_t) buf.data()) % 128);
+    buf.resize(1000);
+    EXPECT_EQ(0u, ((uintptr_t) buf.data()) % 128);
+}
+
+TEST(Allocators, ArenaRewind) {
+    BlockArena arena(1024);
+    void *first = arena.allocate(100);
+    EXPECT_EQ(0u, ((uintptr_t) first) % DEFAULT_ALIGNMENT);
+    EXPECT_EQ(0u, ((uintptr_t) arena.allocate(3, 16)) % 16);
+
+    BlockArena::Mark position = arena.mark();
+    void *second = arena.allocate(200);
+    void *big = arena.allocate(5000);
+    EXPECT_NE(first, second);
+    std::size_t capacity = arena.capacity();
+    EXPECT_LE(5000u, capacity);
+
+    arena.rewind(position);
+    EXPECT_EQ(second, arena.allocate(200));
+    EXPECT_EQ(big, arena.allocate(5000));
+    EXPECT_EQ(capacity, arena.capacity());
+
+    arena.reset();
+    EXPECT_EQ(first, arena.allocate(100));
+}
+
+TEST(Allocators, ArenaScope) {
+    BlockArena arena;
+    void *before;
+    {
+        ArenaScope scope(arena);
+        before = arena.allocate(64);
+        {
+            ArenaScope inner(arena);
+            arena.allocate(1000);
+        }
+        EXPECT_EQ((char *) before + 64, arena.allocate(64));
+    }
+    EXPECT_EQ(before, arena.allocate(64));
+}
+
+TEST(Allocators, ArenaAllocator) {
+    BlockArena arena;
+    BlockArena::Mark position = arena.mark();
+    {
+        ArenaAllocator<double> alloc(arena);
+        std::vector<double, ArenaAllocator<double> > buf(alloc);
+        buf.reserve(50);
+        for (unsigned i=0; i<50; i++) {
+            buf.push_back(i * 0.5);
+        }
+        EXPECT_EQ(0u, ((uintptr_t) buf.data()) % DEFAULT_ALIGNMENT);
+        EXPECT_EQ(24.5, buf[49]);
+        EXPECT_TRUE(alloc == ArenaAllocator<int>(arena));
+        EXPECT_TRUE(alloc != ArenaAllocator<double>());
+    }
+    arena.rewind(position);
+}
+
+TEST(Allocators, VectorAllocator) {
+    RealVector<double, AlignedAllocator<double> > aligned(37), alignedTaps(5);
+    RealVector<double> expected(37), taps(5);
+    for (unsigned i=0; i<expected.size(); i++) {
+        expected[i] = aligned[i] = std::sin(0.3 * i);
+    }
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] = alignedTaps[i] = 1.0 / (i + 1);
+    }
+    EXPECT_EQ(0u, ((uintptr_t) aligned.vec.data()) % DEFAULT_ALIGNMENT);
+
+    aligned += aligned * 2.0;
+    expected += expected * 2.0;
+    aligned = lazy(aligned) * 0.5 + 1.0;
+    expected = lazy(expected) * 0.5 + 1.0;
+    conv(aligned, alignedTaps);
+    conv(expected, taps);
+    ASSERT_EQ(expected.size(), aligned.size());
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], aligned[i]));
+    }
+    EXPECT_TRUE(FloatsEqual(expected.mean(), aligned.mean()));
+    EXPECT_EQ(0u, ((uintptr_t) aligned.vec.data()) % DEFAULT_ALIGNMENT);
+
+    // The storage comes from the thread's arena, so it's handed out again once the scope ends.
+    void *storage;
+    ComplexVector<double> spectrum(16);
+    for (unsigned i=0; i<spectrum.size(); i++) {
+        spectrum[i] = std::complex<double>(std::cos(0.7 * i), i % 3);
+    }
+    {
+        ArenaScope scope;
+        ComplexVector<double, ArenaAllocator< std::complex<double> > > arenaSpectrum(spectrum.size());
+        for (unsigned i=0; i<spectrum.size(); i++) {
+            arenaSpectrum[i] = spectrum[i];
+        }
+        storage = arenaSpectrum.vec.data();
+        fft(arenaSpectrum);
+        fft(spectrum);
+        EXPECT_EQ(storage, arenaSpectrum.vec.data());
+        for (unsigned i=0; i<spectrum.size(); i++) {
+            EXPECT_EQ(spectrum[i], arenaSpectrum[i]);
+        }
+    }
+    ArenaScope scope;
+    EXPECT_EQ(storage, threadArena().allocate(16 * sizeof(std::complex<double>)));
+}
+
+TEST(Allocators, WorkspaceReuse) {
+    Workspace<float> workspace;
+    std::vector<float> *buf = workspace.acquire();
+    buf->resize(100);
+    workspace.release(buf);
+    EXPECT_EQ(1u, workspace.numAvailable());
+
+    std::vector<float> *again = workspace.acquire();
+    EXPECT_EQ(buf, again);
+    EXPECT_LE(100u, again->capacity());
+    EXPECT_EQ(0u, workspace.numAvailable());
+    workspace.release(again);
+    workspace.clear();
+    EXPECT_EQ(0u, workspace.numAvailable());
+}
+
+TEST(Allocators, ScratchBuffer) {
+    std::vector<int> *outer;
+    {
+        ScratchBuffer<int> scratch;
+        outer = scratch.get();
+        scratch->resize(10);
+        ScratchBuffer<int> nested;
+        EXPECT_NE(outer, nested.get());
+    }
+    ScratchBuffer<int> scratch;
+    EXPECT_EQ(outer, scratch.get());
+    EXPECT_LE(10u, scratch->capacity());
+
+    // A vector without a scratch buffer of its own leaves the thread's buffers in the pool.
+    unsigned available = threadWorkspace<double>().numAvailable();
+    RealVector<double> data(16);
+    for (unsigned i=0; i<data.size(); i++) {
+        data[i] = (double) ((i * 7) % 16);
+    }
+    EXPECT_TRUE(FloatsEqual(7.5, data.median()));
+    EXPECT_LE(1u, threadWorkspace<double>().numAvailable());
+    EXPECT_LE(available, threadWorkspace<double>().numAvailable());
+}
+
+TEST(Allocators, ThreadLocal) {
+    BlockArena *mainArena = &threadArena();
+    Workspace<float> *mainWorkspace = &threadWorkspace<float>();
+    BlockArena *otherArena = NULL;
+    Workspace<float> *otherWorkspace = NULL;
+
+    std::thread worker([&]() {
+        otherArena = &threadArena();
+        otherWorkspace = &threadWorkspace<float>();
+    });
+    worker.join();
+
+    EXPECT_EQ(mainArena, &threadArena());
+    EXPECT_NE(mainArena, otherArena);
+    EXPECT_NE(mainWorkspace, otherWorkspace);
+}
@@ -0,0 +1,193 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "CicFilter.h"
+#include "RealFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+// The taps of a CIC filter: numStages boxcars of rate * diffDelay taps convolved together.
+static std::vector<double> CicTaps(int rate, int numStages, int diffDelay) {
+    std::vector<double> taps(1, 1);
+    for (int s=0; s<numStages; s++) {
+        std::vector<double> next(taps.size() + rate * diffDelay - 1, 0);
+        for (unsigned i=0; i<taps.size(); i++) {
+            for (int k=0; k<rate*diffDelay; k++) {
+                next[i + k] += taps[i];
+            }
+        }
+        taps = next;
+    }
+    return taps;
+}
+
+static double CicSample(unsigned n) {
+    return 0.6 * std::sin(0.013 * n) + 0.3 * std::cos(0.7 * n + 0.2);
+}
+
+
+TEST(CicFilter, BitGrowth) {
+    CicDecimator<int16_t> decimator(16, 4);
+    EXPECT_EQ(16, decimator.bitGrowth());
+    EXPECT_EQ(16, decimator.outputShift);
+    CicDecimator<int16_t> oddRate(10, 3, 2);
+    EXPECT_EQ(13, oddRate.bitGrowth());
+    CicInterpolator<int16_t> interpolator(16, 4);
+    EXPECT_EQ(12, interpolator.bitGrowth());
+    
+    EXPECT_TRUE(FloatsEqual(1, cicMagnitude(0, 3, 8, 1)));
+    EXPECT_TRUE(cicMagnitude(2, 3, 8, 1) < 1e-12);
+}
+
+TEST(CicFilter, FloatDecimatorMatchesFir) {
+    const int rate = 5, numStages = 3, diffDelay = 2;
+    std::vector<double> taps = CicTaps(rate, numStages, diffDelay);
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] /= std::pow((double) rate * diffDelay, numStages);
+    }
+    RealFirFilter<double> reference(taps);
+    CicDecimator<double> cic(rate, numStages, diffDelay);
+    
+    unsigned blockSizes[] = {1, 23, 7, 100, 4, 55};
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<double> expected(blockSizes[b]);
+        for (unsigned i=0; i<blockSizes[b]; i++) {
+            expected[i] = CicSample(start + i);
+        }
+        start += blockSizes[b];
+        RealVector<double> actual = expected;
+        decimate(expected, rate, reference);
+        decimate(actual, cic);
+        EXPECT_EQ(expected.size(), actual.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+        }
+    }
+    
+    // Samples beyond full scale are saturated.
+    cic.reset();
+    cic.fullScale = 0.5;
+    RealVector<double> overload(std::vector<double>(1000, 2.0));
+    decimate(overload, cic);
+    EXPECT_TRUE(FloatsEqual(0.5, overload[overload.size() - 1]));
+}
+
+TEST(CicFilter, IntegerDecimatorWrapsAround) {
+    // The integrators overflow 32 bits after a few thousand samples of a large DC input, but the
+    // outputs are still exact.
+    const int rate = 8, numStages = 4;
+    CicDecimator<int16_t, int32_t> cic(rate, numStages);
+    cic.outputShift = 10;
+    std::vector<double> taps = CicTaps(rate, numStages, 1);
+    
+    std::vector<int16_t> input;
+    for (unsigned n=0; n<20000; n++) {
+        input.push_back(n < 10000 ? 30000 : (int16_t) (20000 * CicSample(n)));
+    }
+    std::vector<int16_t> outputs;
+    for (unsigned start=0; start<input.size(); start+=1000) {
+        RealVector<int16_t> block(VECTOR_TO_ARRAY(input) + start, 1000);
+        decimate(block, cic);
+        outputs.insert(outputs.end(), block.vec.begin(), block.vec.end());
+    }
+    
+    EXPECT_EQ(input.size() / rate, outputs.size());
+    for (unsigned m=0; m<outputs.size(); m++) {
+        int64_t sum = 0;
+        for (unsigned k=0; k<taps.size() && k<=m*rate; k++) {
+            sum += (int64_t) taps[k] * input[m * rate - k];
+        }
+        int64_t expected = std::max((int64_t) -32767, std::min((int64_t) 32767, (sum + 512) >> 10));
+        EXPECT_EQ(expected, outputs[m]);
+    }
+}
+
+TEST(CicFilter, InterpolatorMatchesFir) {
+    const int rate = 4, numStages = 3;
+    std::vector<double> taps = CicTaps(rate, numStages, 1);
+    double gain = std::pow((double) rate, numStages) / rate;
+    CicInterpolator<double> cic(rate, numStages);
+    CicInterpolator<int32_t> integerCic(rate, numStages);
+    integerCic.outputShift = 0;
+    
+    unsigned blockSizes[] = {3, 1, 40, 17};
+    std::vector<double> input, interpolated;
+    std::vector<int32_t> integerInput, integerInterpolated;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<double> data(blockSizes[b]);
+        RealVector<int32_t> integerData(blockSizes[b]);
+        for (unsigned i=0; i<blockSizes[b]; i++) {
+            data[i] = CicSample(input.size() + i);
+            integerData[i] = (int32_t) (1000 * CicSample(input.size() + i));
+        }
+        input.insert(input.end(), data.vec.begin(), data.vec.end());
+        integerInput.insert(integerInput.end(), integerData.vec.begin(), integerData.vec.end());
+        interp(data, cic);
+        interp(integerData, integerCic);
+        EXPECT_EQ(blockSizes[b] * rate, data.size());
+        EXPECT_EQ(blockSizes[b] * rate, integerData.size());
+        interpolated.insert(interpolated.end(), data.vec.begin(), data.vec.end());
+        integerInterpolated.insert(integerInterpolated.end(), integerData.vec.begin(), integerData.vec.end());
+    }
+    
+    // Zero stuff and filter.
+    for (unsigned n=0; n<interpolated.size(); n++) {
+        double expected = 0, integerExpected = 0;
+        for (unsigned k=0; k<taps.size() && k<=n; k++) {
+            if ((n - k) % rate == 0) {
+                expected += taps[k] * input[(n - k) / rate];
+                integerExpected += taps[k] * integerInput[(n - k) / rate];
+            }
+        }
+        EXPECT_TRUE(FloatsEqual(expected / gain, interpolated[n]));
+        EXPECT_EQ((int32_t) integerExpected, integerInterpolated[n]);
+    }
+}
+
+TEST(CicFilter, CompensationFilter) {
+    const int rate = 16, numStages = 4;
+    CicDecimator<float> cic(rate, numStages);
+    RealFirFilter<double> compensator;
+    cic.compensationFilter(compensator, 31, 0.4, 0.6);
+    EXPECT_EQ(31, compensator.size());
+    
+    // The CIC filter droops by over 2 dB at the passband edge, and the cascade by much less.
+    EXPECT_TRUE(-20 * std::log10(cicMagnitude(0.4, numStages, rate, 1)) > 2);
+    double sum = 0;
+    for (unsigned i=0; i<compensator.size(); i++) {
+        sum += compensator[i];
+        EXPECT_EQ(compensator[i], compensator[compensator.size() - 1 - i]);
+    }
+    EXPECT_TRUE(FloatsEqual(1, sum));
+    for (double freq=0; freq<=0.4; freq+=0.01) {
+        std::complex<double> response = 0;
+        for (unsigned i=0; i<compensator.size(); i++) {
+            response += compensator[i] * std::polar(1.0, -M_PI * freq * i);
+        }
+        double cascade = std::abs(response) * cicMagnitude(freq, numStages, rate, 1);
+        EXPECT_TRUE(std::abs(20 * std::log10(cascade)) < 0.05);
+    }
+}
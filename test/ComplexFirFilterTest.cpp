@@ -27,6 +27,7 @@ THE SOFTWARE.
 using namespace NimbleDSP;
 
 extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
 
 
 TEST(ComplexFirFilter, ConvComplexOneShot) {
@@ -422,3 +423,167 @@ TEST(ComplexFirFilter, ResampleComplexStream2) {
     numResults += buf.size();
     EXPECT_LE(18*interpRate / decimateRate, numResults);
 }
+
+TEST(ComplexFirFilter, FftConvComplexStream) {
+    unsigned numTaps = 150;
+    unsigned blockSizes[] = {64, 1000, 7, 401};
+    NimbleDSP::ComplexFirFilter<double> fftFilter(numTaps);
+    for (unsigned i=0; i<numTaps; i++) {
+        fftFilter[i] = std::complex<double>(sin(0.37 * i), cos(0.19 * i)) / (i + 1.0);
+    }
+    NimbleDSP::ComplexFirFilter<double> directFilter = fftFilter;
+    fftFilter.convAlgorithm = FFT_CONVOLUTION;
+    directFilter.convAlgorithm = DIRECT_CONVOLUTION;
+
+    double t = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        NimbleDSP::ComplexVector<double> fftBuf(blockSizes[block]);
+        for (unsigned i=0; i<fftBuf.size(); i++, t++) {
+            fftBuf[i] = std::complex<double>(cos(0.3 * t), sin(0.07 * t));
+        }
+        NimbleDSP::ComplexVector<double> directBuf = fftBuf;
+        conv(fftBuf, fftFilter);
+        conv(directBuf, directFilter);
+        EXPECT_EQ(directBuf.size(), fftBuf.size());
+        for (unsigned i=0; i<fftBuf.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(directBuf[i].real(), fftBuf[i].real()));
+            EXPECT_TRUE(FloatsEqual(directBuf[i].imag(), fftBuf[i].imag()));
+        }
+    }
+}
+
+TEST(ComplexFirFilter, FftConvComplexOneShot) {
+    unsigned numTaps = 90;
+    unsigned numSamples = 333;
+    NimbleDSP::ComplexFirFilter<double> fftFilter(numTaps, ONE_SHOT_RETURN_ALL_RESULTS);
+    for (unsigned i=0; i<numTaps; i++) {
+        fftFilter[i] = std::complex<double>(cos(0.21 * i), 0.01 * i);
+    }
+    NimbleDSP::ComplexFirFilter<double> directFilter = fftFilter;
+    fftFilter.convAlgorithm = FFT_CONVOLUTION;
+    directFilter.convAlgorithm = DIRECT_CONVOLUTION;
+
+    NimbleDSP::ComplexVector<double> fftBuf(numSamples);
+    for (unsigned i=0; i<numSamples; i++) {
+        fftBuf[i] = std::complex<double>(sin(0.05 * i * i), 1.0);
+    }
+    NimbleDSP::ComplexVector<double> directBuf = fftBuf;
+    conv(fftBuf, fftFilter);
+    conv(directBuf, directFilter);
+    EXPECT_EQ(numSamples + numTaps - 1, fftBuf.size());
+    EXPECT_EQ(directBuf.size(), fftBuf.size());
+    for (unsigned i=0; i<fftBuf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(directBuf[i].real(), fftBuf[i].real()));
+        EXPECT_TRUE(FloatsEqual(directBuf[i].imag(), fftBuf[i].imag()));
+    }
+}
+
+TEST(ComplexFirFilter, ConvComplexStreamBlockSizes) {
+    std::complex<double> filterTaps[] = {std::complex<double>(1, 2), std::complex<double>(-1, 0),
+                                         std::complex<double>(0, 3), std::complex<double>(2, -2)};
+    unsigned blockSizes[] = {2, 1, 3, 9, 0, 5};
+    const unsigned numTaps = sizeof(filterTaps)/sizeof(filterTaps[0]);
+    std::vector< std::complex<double> > input;
+    for (unsigned i=0; i<20; i++) {
+        input.push_back(std::complex<double>(i % 7, 3.0 - i % 4));
+    }
+    
+    NimbleDSP::ComplexFirFilter<double> filter(filterTaps, numTaps);
+    filter.convAlgorithm = DIRECT_CONVOLUTION;
+    NimbleDSP::ComplexVector<double> buf;
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        buf = NimbleDSP::ComplexVector<double>(VECTOR_TO_ARRAY(input) + start, blockSizes[b]);
+        conv(buf, filter);
+        EXPECT_EQ(blockSizes[b], buf.size());
+        for (unsigned i=0; i<buf.size(); i++) {
+            std::complex<double> expected = 0;
+            for (unsigned k=0; k<numTaps && k<=start+i; k++) {
+                expected += filterTaps[k] * input[start + i - k];
+            }
+            EXPECT_TRUE(ComplexEqual(expected, buf[i]));
+        }
+        start += blockSizes[b];
+    }
+}
+
+TEST(ComplexFirFilter, SymmetricTapFolding) {
+    unsigned tapSetLens[] = {77, 84};
+    TapSymmetryType expectedSymmetry[] = {SYMMETRIC_TAPS, ANTISYMMETRIC_TAPS};
+    std::vector< std::complex<double> > tapSets[2];
+    for (unsigned t=0; t<2; t++) {
+        unsigned numTaps = tapSetLens[t];
+        tapSets[t].resize(numTaps);
+        for (unsigned i=0; i<numTaps/2; i++) {
+            std::complex<double> tap(std::cos(0.3 * i), 0.02 * i - 0.5);
+            tapSets[t][i] = tap;
+            tapSets[t][numTaps - 1 - i] = (expectedSymmetry[t] == ANTISYMMETRIC_TAPS) ? -tap : tap;
+        }
+        if (numTaps % 2) {
+            tapSets[t][numTaps / 2] = std::complex<double>(1.5, -0.25);
+        }
+    }
+    unsigned blockSizes[] = {2, 13, 1, 130, 40};
+    int rates[] = {2, 4, 7};
+    
+    for (unsigned t=0; t<2; t++) {
+        ComplexFirFilter<double> folded(tapSets[t]);
+        ComplexFirFilter<double> direct(tapSets[t]);
+        folded.convAlgorithm = direct.convAlgorithm = DIRECT_CONVOLUTION;
+        direct.symmetry = NO_SYMMETRY;
+        EXPECT_EQ(expectedSymmetry[t], folded.tapSymmetry());
+        
+        for (unsigned r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+            ComplexFirFilter<double> foldedConv(folded), directConv(direct);
+            ComplexFirFilter<double> foldedDecimate(folded), directDecimate(direct);
+            ComplexFirFilter<double> foldedInterp(folded), directInterp(direct);
+            unsigned start = 0;
+            for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+                ComplexVector<double> input(blockSizes[b]);
+                for (unsigned i=0; i<blockSizes[b]; i++) {
+                    input[i] = std::complex<double>(std::sin(0.29 * (start + i)), std::cos(0.61 * (start + i)));
+                }
+                start += blockSizes[b];
+                
+                ComplexVector<double> expected = input, actual = input;
+                conv(expected, directConv);
+                conv(actual, foldedConv);
+                EXPECT_EQ(expected.size(), actual.size());
+                for (unsigned i=0; i<expected.size(); i++) {
+                    EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+                }
+                
+                expected = input;
+                actual = input;
+                decimate(expected, rates[r], directDecimate);
+                decimate(actual, rates[r], foldedDecimate);
+                EXPECT_EQ(expected.size(), actual.size());
+                for (unsigned i=0; i<expected.size(); i++) {
+                    EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+                }
+                
+                expected = input;
+                actual = input;
+                interp(expected, rates[r], directInterp);
+                interp(actual, rates[r], foldedInterp);
+                EXPECT_EQ(expected.size(), actual.size());
+                for (unsigned i=0; i<expected.size(); i++) {
+                    EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+                }
+            }
+        }
+        
+        ComplexVector<double> input(140);
+        for (unsigned i=0; i<input.size(); i++) {
+            input[i] = std::complex<double>(0.05 * i, std::sin(0.5 * i));
+        }
+        folded.filtOperation = direct.filtOperation = ONE_SHOT_TRIM_TAILS;
+        ComplexVector<double> expected = input, actual = input;
+        conv(expected, direct);
+        conv(actual, folded);
+        EXPECT_EQ(expected.size(), actual.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+        }
+    }
+}
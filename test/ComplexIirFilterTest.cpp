@@ -21,6 +21,7 @@ THE SOFTWARE.
 */
 
 #include "ComplexIirFilter.h"
+#include "ThreadPool.h"
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -143,4 +144,72 @@ TEST(ComplexIirFilter, Filter4) {
     }
 }
 
+static std::complex<double> IirSample(unsigned n) {
+    return std::complex<double>(std::sin(0.013 * n) + 0.5 * std::cos(0.41 * n), std::cos(0.027 * n));
+}
+
+TEST(ComplexIirFilter, BlockMatchesSerial) {
+    std::complex<double> num[] = {std::complex<double>(0.3, 0.1), std::complex<double>(0.2, -0.2),
+                                  std::complex<double>(-0.1, 0)};
+    std::complex<double> den[] = {1, std::complex<double>(-0.9, 0.3), std::complex<double>(0.2, -0.1)};
+    ComplexIirFilter<double> serial(num, 3, den, 3);
+    ComplexIirFilter<double> block(num, 3, den, 3);
+    ThreadPool pool(3);
+    serial.filterAlgorithm = SERIAL_IIR;
+    block.filterAlgorithm = BLOCK_IIR;
+    block.threadPool = &pool;
+
+    unsigned blockSizes[] = {7000, 2, 12345};
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        ComplexVector<double> expected(blockSizes[b]);
+        for (unsigned n=0; n<expected.size(); n++) {
+            expected[n] = IirSample(start + n);
+        }
+        ComplexVector<double> data = expected;
+        filter(expected, serial);
+        filter(data, block);
+        for (unsigned n=0; n<data.size(); n++) {
+            EXPECT_TRUE(ComplexEqual(expected[n], data[n]));
+        }
+        start += blockSizes[b];
+    }
 
+    std::vector< std::complex<double> > serialState = serial.getState();
+    std::vector< std::complex<double> > blockState = block.getState();
+    ASSERT_EQ(2, blockState.size());
+    for (unsigned k=0; k<blockState.size(); k++) {
+        EXPECT_TRUE(ComplexEqual(serialState[k], blockState[k]));
+    }
+}
+
+TEST(ComplexIirFilter, State) {
+    std::complex<double> num[] = {1, .05, .04, .03, .01};
+    std::complex<double> den[] = {1, std::complex<double>(.2, .1)};
+    ComplexIirFilter<double> filt(num, 5, den, 2);
+    EXPECT_EQ(4, filt.order());
+
+    ComplexVector<double> first(50);
+    ComplexVector<double> second(50);
+    for (unsigned n=0; n<50; n++) {
+        first[n] = IirSample(n);
+        second[n] = IirSample(n + 50);
+    }
+    filter(first, filt);
+    std::vector< std::complex<double> > checkpoint = filt.getState();
+    ComplexVector<double> resumed = second;
+    filter(second, filt);
+
+    ComplexIirFilter<double> other(num, 5, den, 2);
+    other.setState(checkpoint);
+    filter(resumed, other);
+    for (unsigned n=0; n<50; n++) {
+        EXPECT_EQ(second[n], resumed[n]);
+    }
+
+    filt.reset();
+    std::vector< std::complex<double> > cleared = filt.getState();
+    for (unsigned k=0; k<cleared.size(); k++) {
+        EXPECT_EQ(std::complex<double>(0), cleared[k]);
+    }
+}
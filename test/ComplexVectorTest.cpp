@@ -912,5 +912,49 @@ TEST(ComplexVectorMethods, Modulate) {
     }
 }
 
+TEST(ComplexVectorMethods, Fft) {
+    std::complex<double> inputData[] = {std::complex<double>(1, 0), std::complex<double>(2, 0), std::complex<double>(3, 0), std::complex<double>(4, 0)};
+    std::complex<double> expectedData[] = {std::complex<double>(10, 0), std::complex<double>(-2, 2), std::complex<double>(-2, 0), std::complex<double>(-2, -2)};
+    unsigned numElements = sizeof(expectedData)/sizeof(expectedData[0]);
+	NimbleDSP::ComplexVector<double> buf(inputData, numElements);
+    
+    fft(buf);
+    EXPECT_EQ(NimbleDSP::FREQUENCY_DOMAIN, buf.domain);
+    EXPECT_EQ(numElements, buf.size());
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(expectedData[i], buf[i]));
+    }
+    
+    ifft(buf);
+    EXPECT_EQ(NimbleDSP::TIME_DOMAIN, buf.domain);
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(inputData[i] * (double) numElements, buf[i]));
+    }
+}
 
-
+TEST(ComplexVectorMethods, FftPlan) {
+    std::complex<double> inputData[] = {std::complex<double>(1, 5), std::complex<double>(0, 6), std::complex<double>(-1, 7), std::complex<double>(-2, 8), std::complex<double>(-3, 9), std::complex<double>(-4, 10)};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+    std::vector< std::complex<double> > scratch;
+	NimbleDSP::ComplexVector<double> buf(inputData, numElements, NimbleDSP::TIME_DOMAIN, &scratch);
+	NimbleDSP::ComplexVector<double> expected(inputData, numElements);
+    NimbleDSP::FftPlan<double> forwardPlan(numElements);
+    NimbleDSP::FftPlan<double> inversePlan(numElements, true);
+    
+    EXPECT_EQ(&NimbleDSP::fftPlan<double>(numElements), &NimbleDSP::fftPlan<double>(numElements, false));
+    EXPECT_NE(&NimbleDSP::fftPlan<double>(numElements), &NimbleDSP::fftPlan<double>(numElements, true));
+    
+    fft(expected);
+    fft(buf, forwardPlan);
+    EXPECT_EQ(numElements, buf.size());
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(expected[i], buf[i]));
+    }
+    
+    ifft(buf, inversePlan);
+    EXPECT_EQ(NimbleDSP::TIME_DOMAIN, buf.domain);
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(inputData[i] * (double) numElements, buf[i]));
+    }
+    NimbleDSP::clearFftPlanCache<double>();
+}
@@ -0,0 +1,206 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Correlator.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+static double Noise(long n) {
+    double x = std::sin(12.9898 * n + 78.233) * 43758.5453;
+    return 2 * (x - std::floor(x)) - 1;
+}
+
+static std::complex<double> ComplexNoise(long n) {
+    return std::complex<double>(Noise(n), Noise(n + 100003));
+}
+
+static std::vector< std::complex<double> > Preamble(int len) {
+    std::vector< std::complex<double> > preamble(len);
+    for (int k=0; k<len; k++) {
+        double angle = M_PI * k * k / len;
+        preamble[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+    return preamble;
+}
+
+static void CompareComplex(int referenceLen, ConvolutionAlgorithmType algorithm) {
+    unsigned blockSizes[] = {17, 1, 600, 3, 250};
+    std::vector< std::complex<double> > reference(referenceLen);
+    for (int k=0; k<referenceLen; k++) {
+        reference[k] = ComplexNoise(k + 5000);
+    }
+    Correlator<double> correlator(reference);
+    correlator.convAlgorithm = algorithm;
+    EXPECT_EQ(referenceLen, correlator.size());
+
+    std::vector< std::complex<double> > input;
+    long t = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        ComplexVector<double> buf(blockSizes[block]);
+        for (unsigned i=0; i<buf.size(); i++, t++) {
+            buf[i] = ComplexNoise(t);
+            input.push_back(buf[i]);
+        }
+        correlate(buf, correlator);
+        ASSERT_EQ(blockSizes[block], buf.size());
+        for (unsigned i=0; i<buf.size(); i++) {
+            long n = t - buf.size() + i;
+            std::complex<double> expected = 0;
+            for (int k=0; k<referenceLen; k++) {
+                long index = n - (referenceLen - 1) + k;
+                if (index >= 0) {
+                    expected += input[index] * std::conj(reference[k]);
+                }
+            }
+            EXPECT_LT(std::abs(expected - buf[i]), 1e-9);
+        }
+    }
+}
+
+TEST(Correlator, ComplexMatchesDefinition) {
+    CompareComplex(5, AUTO_CONVOLUTION);
+    CompareComplex(300, AUTO_CONVOLUTION);
+    CompareComplex(300, DIRECT_CONVOLUTION);
+    CompareComplex(37, FFT_CONVOLUTION);
+}
+
+TEST(Correlator, RealMatchesDefinition) {
+    ConvolutionAlgorithmType algorithms[] = {DIRECT_CONVOLUTION, FFT_CONVOLUTION};
+    for (int a=0; a<2; a++) {
+        std::vector<double> reference(90);
+        for (unsigned k=0; k<reference.size(); k++) {
+            reference[k] = Noise(k + 777);
+        }
+        Correlator<double> correlator(VECTOR_TO_ARRAY(reference), reference.size());
+        correlator.convAlgorithm = algorithms[a];
+
+        RealVector<double> data(1000);
+        for (unsigned n=0; n<data.size(); n++) {
+            data[n] = Noise(n);
+        }
+        RealVector<double> input = data;
+        RealVector<double> first(std::vector<double>(data.vec.begin(), data.vec.begin() + 400));
+        RealVector<double> second(std::vector<double>(data.vec.begin() + 400, data.vec.end()));
+        correlator.correlate(first);
+        correlator.correlate(second);
+        for (unsigned n=0; n<data.size(); n++) {
+            double expected = 0;
+            for (unsigned k=0; k<reference.size(); k++) {
+                long index = (long) n - (long) (reference.size() - 1) + k;
+                if (index >= 0) {
+                    expected += input[index] * reference[k];
+                }
+            }
+            double actual = (n < 400) ? first[n] : second[n - 400];
+            EXPECT_NEAR(expected, actual, 1e-9);
+        }
+    }
+}
+
+TEST(Correlator, DetectsPreambles) {
+    const int preambleLen = 127;
+    std::vector< std::complex<double> > preamble = Preamble(preambleLen);
+    long starts[] = {300, 1480, 2900};
+    double gains[] = {0.5, 3, 10};
+    const int numStarts = sizeof(starts) / sizeof(starts[0]);
+
+    std::vector< std::complex<double> > signal(4000);
+    for (long n=0; n<(long)signal.size(); n++) {
+        signal[n] = 0.2 * ComplexNoise(n);
+    }
+    for (int p=0; p<numStarts; p++) {
+        for (int k=0; k<preambleLen; k++) {
+            signal[starts[p] + k] += gains[p] * preamble[k];
+        }
+    }
+
+    // The block boundaries put the second preamble's peak in a different call than its start.
+    unsigned blockSizes[] = {1000, 550, 29, 2421};
+    bool normalizeModes[] = {true, false};
+    for (int mode=0; mode<2; mode++) {
+        Correlator<double> correlator(preamble);
+        std::vector<long> peaks;
+        unsigned start = 0;
+        for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+            ComplexVector<double> buf(std::vector< std::complex<double> >(signal.begin() + start,
+                                                                         signal.begin() + start + blockSizes[block]));
+            start += blockSizes[block];
+            double threshold = normalizeModes[mode] ? 0.5 : 0.25 * 0.25 * preambleLen * preambleLen;
+            int found = correlator.detect(buf, peaks, threshold, normalizeModes[mode]);
+            EXPECT_EQ(blockSizes[block], buf.size());
+            EXPECT_LE(0, found);
+        }
+        ASSERT_EQ(numStarts, peaks.size());
+        for (int p=0; p<numStarts; p++) {
+            EXPECT_EQ(starts[p], peaks[p]);
+        }
+    }
+}
+
+TEST(Correlator, DetectRealAndReset) {
+    std::vector<double> reference(64);
+    for (unsigned k=0; k<reference.size(); k++) {
+        reference[k] = (Noise(k + 50000) > 0) ? 1 : -1;
+    }
+    RealVector<double> data(1500);
+    for (unsigned n=0; n<data.size(); n++) {
+        data[n] = 0.1 * Noise(n);
+    }
+    for (unsigned k=0; k<reference.size(); k++) {
+        data[700 + k] += reference[k];
+    }
+
+    Correlator<double> correlator(reference);
+    for (int pass=0; pass<2; pass++) {
+        std::vector<long> peaks;
+        correlator.detect(data, peaks, 0.6);
+        ASSERT_EQ(1, peaks.size());
+        EXPECT_EQ(700, peaks[0]);
+        correlator.reset();
+    }
+}
+
+TEST(Correlator, FlushReportsPendingPeak) {
+    std::vector<double> reference(64);
+    for (unsigned k=0; k<reference.size(); k++) {
+        reference[k] = (Noise(k + 50000) > 0) ? 1 : -1;
+    }
+    // The preamble ends the stream, so its peak is still waiting for size() more start indices.
+    RealVector<double> data(1000);
+    for (unsigned n=0; n<data.size(); n++) {
+        data[n] = 0.1 * Noise(n);
+    }
+    for (unsigned k=0; k<reference.size(); k++) {
+        data[936 + k] += reference[k];
+    }
+
+    Correlator<double> correlator(reference);
+    std::vector<long> peaks;
+    EXPECT_EQ(0, correlator.detect(data, peaks, 0.6));
+    EXPECT_EQ(0, peaks.size());
+    EXPECT_EQ(1, correlator.flush(peaks));
+    ASSERT_EQ(1, peaks.size());
+    EXPECT_EQ(936, peaks[0]);
+    EXPECT_EQ(0, correlator.flush(peaks));
+    EXPECT_EQ(1, peaks.size());
+}
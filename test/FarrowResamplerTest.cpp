@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "FarrowResampler.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static double InputSample(long n) {
+    return std::cos(0.11 * n) + 0.5 * std::sin(0.53 * n);
+}
+
+TEST(FarrowResampler, LinearInterpolation) {
+    // Linear interpolation between the two newest inputs reproduces a ramp exactly.
+    double linear[] = {0, 1, 1, -1};
+    std::vector<double> branchTaps(linear, linear + 4);
+    FarrowResampler<double> resampler(branchTaps, 2, 0.3);
+    EXPECT_EQ(2, resampler.numTaps());
+    EXPECT_EQ(1, resampler.order());
+
+    unsigned blockSizes[] = {7, 1, 40, 3, 25};
+    double ratios[] = {0.3, 2.5, 1.0, 0.77, 4};
+    long start = 0;
+    double time = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        resampler.setRatio(ratios[block]);
+        EXPECT_EQ(ratios[block], resampler.ratio());
+        RealVector<double> buf(blockSizes[block]);
+        for (unsigned i=0; i<buf.size(); i++) {
+            buf[i] = start + i;
+        }
+        start += blockSizes[block];
+        resample(buf, resampler);
+        for (unsigned i=0; i<buf.size(); i++) {
+            // The first output interpolates between zero history and the first sample.
+            double expected = (time < 1) ? 0 : time - 1;
+            EXPECT_NEAR(expected, buf[i], 1e-9);
+            time += 1 / ratios[block];
+        }
+        EXPECT_GE(time, start - 1e-9);
+    }
+}
+
+static void CompareBlocks(double ratio) {
+    unsigned blockSizes[] = {17, 1, 250, 3, 64};
+    FarrowResampler<double> streaming(10, 5, 0.8, ratio);
+    FarrowResampler<double> oneShot(10, 5, 0.8, ratio);
+
+    RealVector<double> whole(335);
+    for (unsigned n=0; n<whole.size(); n++) {
+        whole[n] = InputSample(n);
+    }
+    std::vector<double> streamed;
+    unsigned start = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        RealVector<double> buf(std::vector<double>(whole.vec.begin() + start, whole.vec.begin() + start + blockSizes[block]));
+        start += blockSizes[block];
+        streaming.resample(buf);
+        streamed.insert(streamed.end(), buf.vec.begin(), buf.vec.end());
+    }
+    oneShot.resample(whole);
+    ASSERT_EQ(whole.size(), streamed.size());
+    for (unsigned n=0; n<whole.size(); n++) {
+        EXPECT_TRUE(FloatsEqual(whole[n], streamed[n]));
+    }
+}
+
+TEST(FarrowResampler, BlockSizesDontMatter) {
+    CompareBlocks(1.0);
+    CompareBlocks(0.4321);
+    CompareBlocks(3.14159);
+}
+
+static void CheckAccuracy(int numTaps, int order, double ratio, double freq, double tolerance) {
+    FarrowResampler<double> resampler(numTaps, order, 0.8, ratio);
+    RealVector<double> data(2000);
+    for (unsigned n=0; n<data.size(); n++) {
+        data[n] = std::cos(2 * M_PI * freq * n);
+    }
+    resample(data, resampler);
+
+    double maxError = 0;
+    for (unsigned m=0; m<data.size(); m++) {
+        double time = m / ratio - numTaps / 2;
+        if (time < numTaps) {
+            continue;
+        }
+        maxError = std::max(maxError, std::abs(std::cos(2 * M_PI * freq * time) - data[m]));
+    }
+    EXPECT_LT(maxError, tolerance);
+}
+
+TEST(FarrowResampler, Accuracy) {
+    // The error is mostly the passband ripple of the windowed sinc taps.
+    CheckAccuracy(8, 4, 1.37, 0.05, 1e-2);
+    CheckAccuracy(8, 4, 0.71, 0.1, 1e-2);
+    CheckAccuracy(16, 6, 1.0001, 0.2, 5e-3);
+    CheckAccuracy(4, 2, 2.5, 0.02, 3e-2);
+}
+
+TEST(FarrowResampler, ComplexData) {
+    FarrowResampler<double> realResampler(8, 3, 0.7, 1.7);
+    FarrowResampler<double> imagResampler(8, 3, 0.7, 1.7);
+    FarrowResampler<double> complexResampler(8, 3, 0.7, 1.7);
+
+    for (int block=0; block<3; block++) {
+        RealVector<double> re(50), im(50);
+        ComplexVector<double> data(50);
+        for (unsigned n=0; n<data.size(); n++) {
+            re[n] = InputSample(block * 50 + n);
+            im[n] = InputSample(block * 50 + n + 1000);
+            data[n] = std::complex<double>(re[n], im[n]);
+        }
+        resample(re, realResampler);
+        resample(im, imagResampler);
+        resample(data, complexResampler);
+        ASSERT_EQ(re.size(), data.size());
+        for (unsigned n=0; n<data.size(); n++) {
+            EXPECT_TRUE(ComplexEqual(std::complex<double>(re[n], im[n]), data[n]));
+        }
+    }
+
+}
+
+TEST(FarrowResampler, Reset) {
+    FarrowResampler<double> resampler(6, 3, 0.8, 0.9);
+    ComplexVector<double> first(60), second(60);
+    for (unsigned n=0; n<first.size(); n++) {
+        first[n] = second[n] = std::complex<double>(InputSample(n), -InputSample(n + 5));
+    }
+    resample(first, resampler);
+    resampler.reset();
+    resample(second, resampler);
+    ASSERT_EQ(first.size(), second.size());
+    for (unsigned n=0; n<first.size(); n++) {
+        EXPECT_TRUE(ComplexEqual(first[n], second[n]));
+    }
+}
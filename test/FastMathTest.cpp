@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "FastMath.h"
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+
+TEST(FastMath, Atan2) {
+    double maxError = 0;
+    for (int i=0; i<=3600; i++) {
+        double theta = -M_PI + 2 * M_PI * i / 3600;
+        for (double radius=1e-3; radius<1e4; radius*=31) {
+            double x = radius * std::cos(theta);
+            double y = radius * std::sin(theta);
+            maxError = std::max(maxError, std::abs(fastAtan2(y, x) - std::atan2(y, x)));
+            EXPECT_NEAR(std::atan2((float) y, (float) x), fastAtan2((float) y, (float) x), 5e-7);
+        }
+    }
+    EXPECT_LT(maxError, 5e-8);
+    EXPECT_EQ(0, fastAtan2(0.0, 0.0));
+    EXPECT_EQ(0, fastAtan2(0.0, 1.0));
+    EXPECT_NEAR(M_PI, fastAtan2(0.0, -1.0), 5e-8);
+    EXPECT_NEAR(-M_PI, fastAtan2(-0.0, -1.0), 5e-8);
+    EXPECT_NEAR(-M_PI / 2, fastAtan2(-2.0, 0.0), 5e-8);
+}
+
+TEST(FastMath, ExpLogPolar) {
+    for (double x=-700; x<700; x+=0.37) {
+        EXPECT_NEAR(1.0, fastExp(x) / std::exp(x), 1e-10);
+    }
+    for (float x=-80; x<80; x+=0.37f) {
+        EXPECT_NEAR(1.0, fastExp(x) / std::exp(x), 1e-6);
+    }
+    for (double x=1e-300; x<1e300; x*=3.3) {
+        EXPECT_NEAR(std::log(x), fastLog(x), 1e-11 * (1 + std::abs(std::log(x))));
+    }
+    for (float x=1e-30f; x<1e30f; x*=3.3f) {
+        EXPECT_NEAR(std::log(x), fastLog(x), 1e-6 * (1 + std::abs(std::log(x))));
+    }
+    for (double angle=-1000; angle<1000; angle+=0.173) {
+        std::complex<double> expected = std::polar(1.0, angle);
+        std::complex<double> actual = fastPolar(angle);
+        EXPECT_NEAR(expected.real(), actual.real(), 1e-11);
+        EXPECT_NEAR(expected.imag(), actual.imag(), 1e-11);
+    }
+}
+
+TEST(FastMath, VectorMethods) {
+    const unsigned len = 37;
+    ComplexVector<float> data(len);
+    RealVector<double> real(len);
+    for (unsigned i=0; i<len; i++) {
+        data[i] = std::complex<float>(std::cos(0.7 * i) * (i + 1), std::sin(1.3 * i) * (i + 0.5));
+        real[i] = 0.25 + 0.5 * i;
+    }
+    
+    ComplexVector<float> exact = data;
+    ComplexVector<float> fast = data;
+    angle(exact);
+    angle(fast, FAST_MATH);
+    for (unsigned i=0; i<len; i++) {
+        EXPECT_NEAR(exact[i].real(), fast[i].real(), 1e-6);
+        EXPECT_EQ(0, fast[i].imag());
+    }
+    
+    exact = data;
+    fast = data;
+    abs(exact);
+    abs(fast, FAST_MATH);
+    for (unsigned i=0; i<len; i++) {
+        EXPECT_NEAR(1.0, fast[i].real() / exact[i].real(), 1e-6);
+    }
+    
+    exact = data;
+    fast = data;
+    exact *= 0.1f;
+    fast *= 0.1f;
+    exp(exact);
+    exp(fast, FAST_MATH);
+    for (unsigned i=0; i<len; i++) {
+        EXPECT_NEAR(0, std::abs(exact[i] - fast[i]) / std::abs(exact[i]), 1e-6);
+    }
+    
+    exact = data;
+    fast = data;
+    log10(exact);
+    log10(fast, FAST_MATH);
+    for (unsigned i=0; i<len; i++) {
+        EXPECT_NEAR(exact[i].real(), fast[i].real(), 1e-6);
+        EXPECT_NEAR(exact[i].imag(), fast[i].imag(), 1e-6);
+    }
+    
+    RealVector<double> realExact = real;
+    RealVector<double> realFast = real;
+    log10(realExact);
+    log10(realFast, FAST_MATH);
+    exp(realExact);
+    exp(realFast, FAST_MATH);
+    for (unsigned i=0; i<len; i++) {
+        EXPECT_NEAR(1.0, realFast[i] / realExact[i], 1e-10);
+    }
+}
+
+TEST(FastMath, AngleDiff) {
+    const unsigned len = 1000;
+    double freq = 0.03;
+    ComplexVector<double> signal(len);
+    for (unsigned i=0; i<len; i++) {
+        // Frequency modulated, so the phase wraps through +/-pi many times.
+        double phase = 2 * M_PI * (freq * i + 0.5 * std::sin(0.01 * i));
+        signal[i] = std::polar(1.5, phase);
+    }
+    
+    MathAccuracyType accuracies[] = {EXACT_MATH, FAST_MATH};
+    for (unsigned a=0; a<2; a++) {
+        ComplexVector<double> whole = signal;
+        std::complex<double> previous(1, 0);
+        angleDiff(whole, previous, accuracies[a]);
+        EXPECT_EQ(signal[len - 1], previous);
+        for (unsigned i=1; i<len; i++) {
+            double expected = 2 * M_PI * (freq + 0.5 * (std::sin(0.01 * i) - std::sin(0.01 * (i - 1))));
+            EXPECT_NEAR(expected, whole[i].real(), 1e-7);
+            EXPECT_EQ(0, whole[i].imag());
+        }
+        
+        // Block by block gives the same results as all at once.
+        std::complex<double> state(1, 0);
+        unsigned blockSizes[] = {1, 300, 299, 400};
+        unsigned start = 0;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            ComplexVector<double> block(blockSizes[b]);
+            for (unsigned i=0; i<blockSizes[b]; i++) {
+                block[i] = signal[start + i];
+            }
+            angleDiff(block, state, accuracies[a]);
+            for (unsigned i=0; i<blockSizes[b]; i++) {
+                EXPECT_EQ(whole[start + i], block[i]);
+            }
+            start += blockSizes[b];
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "FixedFirFilter.h"
+#include "RealFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+static double TestSample(unsigned n) {
+    return std::cos(0.17 * n) + 0.25 * std::sin(1.9 * n) - 0.1;
+}
+
+// Streams blocks of several sizes, some shorter than the filter, through a FixedFirFilter
+// and a RealFirFilter with the same taps and checks that they agree.
+template <unsigned NumTaps>
+static void ExpectMatchesRealFirFilter() {
+    std::array<double, NumTaps> taps;
+    for (unsigned i=0; i<NumTaps; i++) {
+        taps[i] = std::sin(0.3 * i + 0.2) / (i + 1);
+    }
+    FixedFirFilter<double, NumTaps> fixed(taps);
+    RealFirFilter<double> reference(taps.data(), NumTaps);
+    EXPECT_EQ(NumTaps, fixed.size());
+    for (unsigned i=0; i<NumTaps; i++) {
+        EXPECT_EQ(taps[i], fixed.tap(i));
+    }
+
+    unsigned blockSizes[] = {1, NumTaps / 2 + 1, 3 * NumTaps + 1, NumTaps, 2, NumTaps + 1, 7};
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<double> data(blockSizes[b]);
+        for (unsigned n=0; n<data.size(); n++) {
+            data[n] = TestSample(start + n);
+        }
+        RealVector<double> expected = data;
+        conv(expected, reference);
+        conv(data, fixed);
+        ASSERT_EQ(expected.size(), data.size());
+        for (unsigned n=0; n<data.size(); n++) {
+            EXPECT_TRUE(FloatsEqual(expected[n], data[n]));
+        }
+        start += blockSizes[b];
+    }
+}
+
+TEST(FixedFirFilter, MatchesRealFirFilter) {
+    ExpectMatchesRealFirFilter<2>();
+    ExpectMatchesRealFirFilter<7>();
+    ExpectMatchesRealFirFilter<32>();
+    ExpectMatchesRealFirFilter<33>();
+    ExpectMatchesRealFirFilter<100>();
+}
+
+TEST(FixedFirFilter, ImpulseAndReset) {
+    static const float filterTaps[] = {1, 2, 3, 4, 5};
+    FixedFirFilter<float, 5> filt(filterTaps);
+
+    FixedRealVector<float, 8> impulse;
+    impulse[0] = 1;
+    conv(impulse, filt);
+    for (unsigned n=0; n<8; n++) {
+        EXPECT_EQ((n < 5) ? filterTaps[n] : 0, impulse[n]);
+    }
+
+    FixedRealVector<float, 8> zeros;
+    filt.conv(zeros);
+    EXPECT_EQ(0, zeros.sum());
+
+    impulse = FixedRealVector<float, 8>();
+    impulse[6] = 1;
+    filt.conv(impulse);
+    filt.reset();
+    RealVector<float> next(4);
+    conv(next, filt);
+    for (unsigned n=0; n<4; n++) {
+        EXPECT_EQ(0, next[n]);
+    }
+}
+
+TEST(FixedFirFilter, SingleTap) {
+    double gain = 2.5;
+    FixedFirFilter<double, 1> filt(&gain);
+    FixedRealVector<double, 3> data(2.0);
+    conv(data, filt);
+    for (unsigned n=0; n<3; n++) {
+        EXPECT_EQ(5, data[n]);
+    }
+}
+
+TEST(FixedFirFilter, View) {
+    std::array<float, 3> taps = {{0.5f, 0.25f, 0.25f}};
+    FixedFirFilter<float, 3> filt(taps);
+    float buf[] = {4, 8, 0, 0};
+    filt.conv(VectorView<float>(buf, 4));
+    EXPECT_EQ(2, buf[0]);
+    EXPECT_EQ(5, buf[1]);
+    EXPECT_EQ(3, buf[2]);
+    EXPECT_EQ(2, buf[3]);
+}
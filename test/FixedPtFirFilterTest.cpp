@@ -0,0 +1,214 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "FixedPtFirFilter.h"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <cstdlib>
+
+using namespace NimbleDSP;
+
+
+// Reference Q format filter output: round(sum / 2^fracBits), computed in double, then saturated.
+static int16_t ReferenceOutput(double sum, int fracBits, FixedPtRoundingType rounding) {
+    double scaled = sum / (double) (1 << fracBits);
+    double result;
+    if (rounding == ROUND_DOWN) {
+        result = std::floor(scaled);
+    }
+    else if (rounding == ROUND_HALF_UP) {
+        result = std::floor(scaled + 0.5);
+    }
+    else {
+        result = std::floor(scaled + 0.5);
+        if (result - scaled == 0.5 && std::fmod(result, 2.0) != 0) {
+            result -= 1;
+        }
+    }
+    if (result > 32767) result = 32767;
+    if (result < -32767) result = -32767;
+    return (int16_t) result;
+}
+
+// Full convolution of "data" with "taps", as the double sums before scaling.
+static std::vector<double> ReferenceConv(const std::vector<int16_t> & data, const std::vector<int16_t> & taps) {
+    std::vector<double> result(data.size() + taps.size() - 1, 0.0);
+    for (unsigned n=0; n<result.size(); n++) {
+        for (unsigned k=0; k<taps.size(); k++) {
+            if (n >= k && n - k < data.size()) {
+                result[n] += (double) taps[k] * data[n - k];
+            }
+        }
+    }
+    return result;
+}
+
+static std::vector<int16_t> RandomSamples(unsigned len, int amplitude) {
+    std::vector<int16_t> samples(len);
+    for (unsigned i=0; i<len; i++) {
+        samples[i] = (int16_t) (rand() % (2 * amplitude + 1) - amplitude);
+    }
+    return samples;
+}
+
+
+TEST(FixedPtFirFilter, DotProductAccumulate) {
+    srand(5);
+    for (int n=0; n<40; n++) {
+        std::vector<int16_t> x = RandomSamples(n + 1, 32767);
+        std::vector<int16_t> h = RandomSamples(n + 1, 32767);
+        int64_t expected = 0;
+        for (int i=0; i<n; i++) {
+            expected += (int64_t) x[i] * h[i];
+        }
+        // Sixteen full scale products can overflow 32 bits, so compare against a 64 bit sum only
+        // where it fits.
+        if (expected <= INT32_MAX && expected >= INT32_MIN) {
+            EXPECT_EQ(expected, dotProductAccumulate<int32_t>(&x[0], &h[0], n));
+        }
+        EXPECT_EQ(expected, dotProductAccumulate<int64_t>(&x[0], &h[0], n));
+    }
+}
+
+TEST(FixedPtFirFilter, StreamingConv) {
+    srand(11);
+    const int fracBits = 15;
+    std::vector<int16_t> taps = RandomSamples(37, 3000);
+    std::vector<int16_t> input = RandomSamples(300, 20000);
+    std::vector<double> expected = ReferenceConv(input, taps);
+    unsigned blockSizes[] = {1, 36, 5, 100, 158};
+
+    FixedPtFirFilter<int16_t> filt(taps, fracBits);
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<int16_t> data(&input[start], blockSizes[b]);
+        conv(data, filt);
+        EXPECT_EQ(blockSizes[b], data.size());
+        for (unsigned i=0; i<data.size(); i++) {
+            EXPECT_EQ(ReferenceOutput(expected[start + i], fracBits, ROUND_HALF_UP), data[i]);
+        }
+        start += blockSizes[b];
+    }
+    
+    filt.reset();
+    RealVector<int16_t> data(&input[0], 10);
+    conv(data, filt);
+    for (unsigned i=0; i<data.size(); i++) {
+        EXPECT_EQ(ReferenceOutput(expected[i], fracBits, ROUND_HALF_UP), data[i]);
+    }
+}
+
+TEST(FixedPtFirFilter, StreamingDecimate) {
+    srand(12);
+    const int fracBits = 12;
+    const int rate = 3;
+    std::vector<int16_t> taps = RandomSamples(20, 400);
+    std::vector<int16_t> input = RandomSamples(240, 30000);
+    std::vector<double> expected = ReferenceConv(input, taps);
+    unsigned blockSizes[] = {7, 2, 31, 200};
+
+    FixedPtFirFilter<int16_t> filt(taps, fracBits);
+    unsigned start = 0, outIndex = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<int16_t> data(&input[start], blockSizes[b]);
+        decimate(data, rate, filt);
+        for (unsigned i=0; i<data.size(); i++) {
+            EXPECT_EQ(ReferenceOutput(expected[outIndex * rate], fracBits, ROUND_HALF_UP), data[i]);
+            outIndex++;
+        }
+        start += blockSizes[b];
+    }
+    EXPECT_EQ(input.size() / rate, outIndex);
+}
+
+TEST(FixedPtFirFilter, OneShot) {
+    srand(13);
+    const int fracBits = 14;
+    std::vector<int16_t> taps = RandomSamples(9, 5000);
+    std::vector<int16_t> input = RandomSamples(50, 15000);
+    std::vector<double> expected = ReferenceConv(input, taps);
+    
+    for (int rate=1; rate<=4; rate++) {
+        FixedPtFirFilter<int16_t> filt(taps, fracBits, ONE_SHOT_RETURN_ALL_RESULTS);
+        RealVector<int16_t> data(input);
+        decimate(data, rate, filt);
+        EXPECT_EQ((expected.size() + rate - 1) / rate, data.size());
+        for (unsigned i=0; i<data.size(); i++) {
+            EXPECT_EQ(ReferenceOutput(expected[i * rate], fracBits, ROUND_HALF_UP), data[i]);
+        }
+        
+        filt.filtOperation = ONE_SHOT_TRIM_TAILS;
+        data = RealVector<int16_t>(input);
+        decimate(data, rate, filt);
+        EXPECT_EQ((input.size() + rate - 1) / rate, data.size());
+        for (unsigned i=0; i<data.size(); i++) {
+            EXPECT_EQ(ReferenceOutput(expected[(taps.size() - 1) / 2 + i * rate], fracBits, ROUND_HALF_UP), data[i]);
+        }
+    }
+}
+
+TEST(FixedPtFirFilter, RoundingAndSaturation) {
+    // Taps of 1 and 3 in Q2 (0.25 and 0.75) give outputs with every possible fraction.
+    int16_t taps[] = {1, 3};
+    int16_t input[] = {1, 1, 2, 0, -1, -1, -2, 0, 3, 5, 32767, 32767, -32767, -32767};
+    const unsigned inputLen = sizeof(input) / sizeof(input[0]);
+    std::vector<int16_t> inputVec(input, input + inputLen);
+    std::vector<int16_t> tapsVec(taps, taps + 2);
+    std::vector<double> expected = ReferenceConv(inputVec, tapsVec);
+    FixedPtRoundingType roundings[] = {ROUND_DOWN, ROUND_HALF_UP, ROUND_HALF_EVEN};
+    
+    for (unsigned r=0; r<3; r++) {
+        FixedPtFirFilter<int16_t> filt(taps, 2, 2);
+        filt.rounding = roundings[r];
+        RealVector<int16_t> data(input, inputLen);
+        conv(data, filt);
+        for (unsigned i=0; i<inputLen; i++) {
+            EXPECT_EQ(ReferenceOutput(expected[i], 2, roundings[r]), data[i]);
+        }
+    }
+    
+    // Gain of 2 saturates full scale input.
+    int16_t gainTaps[] = {1, 1};
+    FixedPtFirFilter<int16_t> filt(gainTaps, 2, 0);
+    RealVector<int16_t> data(input + 10, 4);
+    conv(data, filt);
+    EXPECT_EQ(32767, data[0]);
+    EXPECT_EQ(32767, data[1]);
+    EXPECT_EQ(0, data[2]);
+    EXPECT_EQ(-32767, data[3]);
+}
+
+TEST(FixedPtFirFilter, WideTypes) {
+    // int32_t samples with int16_t taps need a 64 bit accumulator.
+    int16_t taps[] = {16384, -8192, 4096};
+    int32_t input[] = {2000000000, -2000000000, 123456789, 7};
+    FixedPtFirFilter<int32_t, int16_t, int64_t> filt(taps, 3, 15);
+    RealVector<int32_t> data(input, 4);
+    conv(data, filt);
+    for (unsigned n=0; n<4; n++) {
+        int64_t sum = 0;
+        for (unsigned k=0; k<3 && k<=n; k++) {
+            sum += (int64_t) taps[k] * input[n - k];
+        }
+        EXPECT_EQ((int32_t) ((sum + (1 << 14)) >> 15), data[n]);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "FixedRealVector.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+
+TEST(FixedRealVector, Constructors) {
+    FixedRealVector<double, 4> zeros;
+    EXPECT_EQ(4u, zeros.size());
+    EXPECT_EQ(0, zeros.sum());
+
+    FixedRealVector<double, 3> twos(2.0);
+    EXPECT_EQ(6, twos.sum());
+
+    int array[] = {1, 2, 3};
+    FixedRealVector<double, 3> fromArray(array);
+    EXPECT_EQ(2, fromArray[1]);
+
+    RealVector<double> vector(array, 3);
+    FixedRealVector<double, 3> fromVector(vector);
+    EXPECT_EQ(3, fromVector[2]);
+
+    RealVector<double> back = fromVector.toVector();
+    EXPECT_EQ(3, back.size());
+    EXPECT_EQ(1, back[0]);
+}
+
+TEST(FixedRealVector, Operators) {
+    double input[] = {1, 2, 3, 4, 5};
+    FixedRealVector<double, 5> buf(input);
+    FixedRealVector<double, 5> other(2.0);
+
+    buf += other;
+    buf *= 3.0;
+    buf -= 1.0;
+    buf /= other;
+    for (unsigned i=0; i<5; i++) {
+        EXPECT_TRUE(FloatsEqual(((input[i] + 2) * 3 - 1) / 2, buf[i]));
+    }
+
+    buf *= other;
+    buf -= other;
+    buf += 1.0;
+    buf /= 2.0;
+    EXPECT_TRUE(FloatsEqual(sum(buf), 3 * (15 + 10) / 2.0 - 5.0));
+
+    FixedRealVector<double, 5> ramp(input);
+    EXPECT_TRUE(FloatsEqual(55, ramp.dot(ramp)));
+
+    VectorView<double> view = ramp.view();
+    view *= 2.0;
+    EXPECT_EQ(10, ramp[4]);
+}
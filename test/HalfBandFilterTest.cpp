@@ -0,0 +1,77 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HalfBandFilter.h"
+#include "RealFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+
+static void CompareWithFir(int numTaps, double passbandEdge) {
+    RealFirFilter<double> designer;
+    EXPECT_TRUE(designer.halfBandFilter(numTaps, passbandEdge));
+    EXPECT_EQ(numTaps, designer.size());
+    EXPECT_EQ(0.5, designer[numTaps / 2]);
+    for (int k=2; k<=numTaps/2; k+=2) {
+        EXPECT_EQ(0, designer[numTaps / 2 - k]);
+        EXPECT_EQ(0, designer[numTaps / 2 + k]);
+    }
+    EXPECT_NE(0, designer[0]);
+    RealFirFilter<double> reference(designer.vec);
+    HalfBandDecimator<double> halfBand(designer.vec);
+    EXPECT_EQ(numTaps, halfBand.numTaps());
+    
+    unsigned blockSizes[] = {1, 30, 7, 200, 2, 61};
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<double> expected(blockSizes[b]);
+        for (unsigned i=0; i<blockSizes[b]; i++) {
+            expected[i] = std::sin(0.05 * (start + i)) + 0.5 * std::cos(2.9 * (start + i));
+        }
+        start += blockSizes[b];
+        RealVector<double> actual = expected;
+        decimate(expected, 2, reference);
+        decimate(actual, halfBand);
+        EXPECT_EQ(expected.size(), actual.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+        }
+    }
+    
+    halfBand.reset();
+    RealVector<double> impulse(numTaps + 1);
+    impulse[0] = 1;
+    decimate(impulse, halfBand);
+    for (unsigned i=0; i<impulse.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(reference[2 * i], impulse[i]));
+    }
+}
+
+TEST(HalfBandFilter, MatchesRealFirFilter) {
+    CompareWithFir(11, 0.3);
+    CompareWithFir(43, 0.4);
+    // Long enough for the non-zero taps to be folded.
+    CompareWithFir(131, 0.45);
+}
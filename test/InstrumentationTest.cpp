@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "Instrumentation.h"
+#include "RealFirFilter.h"
+#include "RealIirFilter.h"
+#include "ComplexVector.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace NimbleDSP;
+
+
+TEST(Instrumentation, Scope) {
+    static OperationCounter counter("InstrumentationTest::scope");
+    InstrumentationCounts instance;
+    for (unsigned i=0; i<3; i++) {
+        InstrumentedScope scope(counter, 100 * (i + 1), &instance);
+    }
+
+    InstrumentationCounts counts = counter.counts();
+    EXPECT_EQ(3u, counts.calls);
+    EXPECT_EQ(600u, counts.samples);
+    EXPECT_EQ(0u, counts.allocations);
+    EXPECT_EQ(counts.calls, instance.calls);
+    EXPECT_EQ(counts.samples, instance.samples);
+    EXPECT_EQ(counts.nanoseconds, instance.nanoseconds);
+}
+
+TEST(Instrumentation, Allocations) {
+    static OperationCounter counter("InstrumentationTest::allocations");
+    {
+        InstrumentedScope scope(counter, 1);
+        std::vector<int> buf;
+        buf.reserve(100);
+        buf.reserve(1000);
+    }
+
+    InstrumentationCounts counts = counter.counts();
+    EXPECT_EQ(2u, counts.allocations);
+    EXPECT_EQ(1100 * sizeof(int), counts.allocatedBytes);
+}
+
+TEST(Instrumentation, VectorConvReusesScratch) {
+    // After the first pass has filled the thread's workspace, the one shot conv and decimate
+    // helpers shouldn't touch the heap.
+    static OperationCounter counter("InstrumentationTest::vectorConv");
+    RealVector<double> taps(9), data(200);
+    ComplexVector<double> complexTaps(9), complexData(200);
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] = 1.0 / (i + 1);
+        complexTaps[i] = std::complex<double>(taps[i], -taps[i]);
+    }
+    auto filterAll = [&]() {
+        conv(data, taps, true);
+        taps.decimate(data, 2, true);
+        data.resize(200);
+        conv(complexData, taps, true);
+        taps.decimateComplex(complexData, 2, true);
+        complexData.resize(200);
+        conv(complexData, complexTaps, true);
+        complexTaps.decimate(complexData, 2, true);
+        complexData.resize(200);
+    };
+    filterAll();
+    {
+        InstrumentedScope scope(counter, data.size());
+        filterAll();
+    }
+
+    EXPECT_EQ(1u, counter.counts().calls);
+    EXPECT_EQ(0u, counter.counts().allocations);
+}
+
+TEST(Instrumentation, Snapshot) {
+    // Counters with the same name, like the instantiations of one method for different types, are
+    // reported together.
+    static OperationCounter first("InstrumentationTest::snapshot");
+    static OperationCounter second("InstrumentationTest::snapshot");
+    InstrumentationCounts call;
+    call.calls = 1;
+    call.samples = 10;
+    call.nanoseconds = 5;
+    first.record(call);
+    second.record(call);
+    second.record(call);
+
+    InstrumentationSnapshot snapshot = instrumentationSnapshot();
+    ASSERT_EQ(1u, snapshot.operations.count("InstrumentationTest::snapshot"));
+    InstrumentationCounts counts = snapshot.operations["InstrumentationTest::snapshot"];
+    EXPECT_EQ(3u, counts.calls);
+    EXPECT_EQ(30u, counts.samples);
+    EXPECT_EQ(15u, counts.nanoseconds);
+    EXPECT_EQ(2e9, counts.samplesPerSecond());
+
+    resetInstrumentation();
+    snapshot = instrumentationSnapshot();
+    EXPECT_EQ(0u, snapshot.operations.count("InstrumentationTest::snapshot"));
+    EXPECT_EQ(0u, first.counts().calls);
+}
+
+#if defined(NIMBLEDSP_INSTRUMENTATION)
+TEST(Instrumentation, Filters) {
+    double taps[] = {1, 2, 3, 2, 1};
+    double num[] = {0.3, 0.2};
+    double den[] = {1, -0.5};
+    RealFirFilter<double> fir(taps, 5);
+    RealIirFilter<double> iir(num, 2, den, 2);
+    resetInstrumentation();
+
+    RealVector<double> data(100);
+    fir.conv(data);
+    fir.conv(data);
+    fir.decimate(data, 2);
+    filter(data, iir);
+    ComplexVector<double> spectrum(64);
+    fft(spectrum);
+
+    InstrumentationSnapshot snapshot = instrumentationSnapshot();
+    EXPECT_EQ(2u, snapshot.operations["RealFirFilter::conv"].calls);
+    EXPECT_EQ(200u, snapshot.operations["RealFirFilter::conv"].samples);
+    EXPECT_EQ(1u, snapshot.operations["RealFirFilter::decimate"].calls);
+    EXPECT_EQ(1u, snapshot.operations["RealIirFilter::filter"].calls);
+    EXPECT_EQ(50u, snapshot.operations["RealIirFilter::filter"].samples);
+    EXPECT_EQ(1u, snapshot.operations["ComplexVector::fft"].calls);
+    EXPECT_EQ(64u, snapshot.operations["ComplexVector::fft"].samples);
+
+    EXPECT_EQ(3u, fir.instrumentation.calls);
+    EXPECT_EQ(300u, fir.instrumentation.samples);
+    EXPECT_EQ(1u, iir.instrumentation.calls);
+}
+#endif
@@ -0,0 +1,260 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "MultiChannelFilter.h"
+#include "RealFirFilter.h"
+#include "ComplexFirFilter.h"
+#include "RealIirFilter.h"
+#include "ComplexIirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static double ChannelSample(unsigned channel, unsigned n) {
+    return std::sin(0.1 * (channel + 1) * n) + 0.01 * channel * n;
+}
+
+
+TEST(MultiChannelFilter, Interleave) {
+    std::vector< RealVector<double> > channels(3, RealVector<double>(4));
+    for (unsigned c=0; c<channels.size(); c++) {
+        for (unsigned n=0; n<4; n++) {
+            channels[c][n] = 10 * c + n;
+        }
+    }
+
+    RealVector<double> interleaved;
+    interleaveChannels(channels, interleaved);
+    EXPECT_EQ(12, interleaved.size());
+    for (unsigned n=0; n<4; n++) {
+        for (unsigned c=0; c<channels.size(); c++) {
+            EXPECT_EQ(10 * c + n, interleaved[n * 3 + c]);
+        }
+    }
+
+    std::vector< RealVector<double> > split(3);
+    deinterleaveChannels(interleaved, split);
+    for (unsigned c=0; c<split.size(); c++) {
+        EXPECT_EQ(4, split[c].size());
+        for (unsigned n=0; n<4; n++) {
+            EXPECT_EQ(channels[c][n], split[c][n]);
+        }
+    }
+}
+
+TEST(MultiChannelFilter, FirMatchesRealFirFilter) {
+    double filterTaps[] = {1, 2, 3, 4, 5, 4, 3};
+    const unsigned numTaps = sizeof(filterTaps) / sizeof(filterTaps[0]);
+    const unsigned numChannels = 5;
+    unsigned blockSizes[] = {1, 9, 4, 20};
+    std::vector<double> tapsVec(filterTaps, filterTaps + numTaps);
+
+    MultiChannelFirFilter<double> batch(filterTaps, numTaps, numChannels);
+    std::vector< RealFirFilter<double> > filters(numChannels, RealFirFilter<double>(tapsVec));
+    EXPECT_EQ(numChannels, batch.numChannels());
+
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<double> interleaved(blockSizes[b] * numChannels);
+        std::vector< RealVector<double> > expected(numChannels, RealVector<double>(blockSizes[b]));
+        for (unsigned n=0; n<blockSizes[b]; n++) {
+            for (unsigned c=0; c<numChannels; c++) {
+                interleaved[n * numChannels + c] = ChannelSample(c, start + n);
+                expected[c][n] = ChannelSample(c, start + n);
+            }
+        }
+        for (unsigned c=0; c<numChannels; c++) {
+            conv(expected[c], filters[c]);
+        }
+
+        filter(interleaved, batch);
+        EXPECT_EQ(blockSizes[b] * numChannels, interleaved.size());
+        for (unsigned n=0; n<blockSizes[b]; n++) {
+            for (unsigned c=0; c<numChannels; c++) {
+                EXPECT_TRUE(FloatsEqual(expected[c][n], interleaved[n * numChannels + c]));
+            }
+        }
+        start += blockSizes[b];
+    }
+
+    batch.reset();
+    RealVector<double> impulse(numTaps * numChannels);
+    for (unsigned c=0; c<numChannels; c++) {
+        impulse[c] = 1;
+    }
+    filter(impulse, batch);
+    for (unsigned n=0; n<numTaps; n++) {
+        for (unsigned c=0; c<numChannels; c++) {
+            EXPECT_EQ(filterTaps[n], impulse[n * numChannels + c]);
+        }
+    }
+}
+
+TEST(MultiChannelFilter, FirComplexTaps) {
+    std::complex<double> filterTaps[] = {std::complex<double>(1, 1), std::complex<double>(2, -1),
+                                         std::complex<double>(0, 3), std::complex<double>(-1, 0)};
+    const unsigned numTaps = sizeof(filterTaps) / sizeof(filterTaps[0]);
+    const unsigned numChannels = 3;
+    const unsigned numFrames = 11;
+    std::vector< std::complex<double> > tapsVec(filterTaps, filterTaps + numTaps);
+
+    MultiChannelFirFilter< std::complex<double> > batch(tapsVec, numChannels);
+    std::vector< ComplexVector<double> > channels(numChannels, ComplexVector<double>(numFrames));
+    std::vector< ComplexVector<double> > expected(numChannels, ComplexVector<double>(numFrames));
+    for (unsigned c=0; c<numChannels; c++) {
+        for (unsigned n=0; n<numFrames; n++) {
+            channels[c][n] = std::complex<double>(ChannelSample(c, n), ChannelSample(c + 7, n));
+        }
+        expected[c] = channels[c];
+        ComplexFirFilter<double> filt(tapsVec);
+        conv(expected[c], filt);
+    }
+
+    batch.filter(channels);
+    for (unsigned c=0; c<numChannels; c++) {
+        EXPECT_EQ(numFrames, channels[c].size());
+        for (unsigned n=0; n<numFrames; n++) {
+            EXPECT_TRUE(ComplexEqual(expected[c][n], channels[c][n]));
+        }
+    }
+}
+
+TEST(MultiChannelFilter, FirRealTapsComplexData) {
+    double filterTaps[] = {0.5, -1, 2, 0.25, 3};
+    const unsigned numTaps = sizeof(filterTaps) / sizeof(filterTaps[0]);
+    const unsigned numChannels = 2;
+    const unsigned numFrames = 13;
+    std::vector<double> tapsVec(filterTaps, filterTaps + numTaps);
+
+    MultiChannelFirFilter<double> batch(tapsVec, numChannels);
+    ComplexVector<double> interleaved(numFrames * numChannels);
+    for (unsigned n=0; n<numFrames; n++) {
+        for (unsigned c=0; c<numChannels; c++) {
+            interleaved[n * numChannels + c] = std::complex<double>(ChannelSample(c, n), -ChannelSample(c, n + 3));
+        }
+    }
+    ComplexVector<double> original = interleaved;
+
+    filter(interleaved, batch);
+    for (unsigned n=0; n<numFrames; n++) {
+        for (unsigned c=0; c<numChannels; c++) {
+            std::complex<double> sum = 0;
+            for (unsigned k=0; k<numTaps && k<=n; k++) {
+                sum += filterTaps[k] * original[(n - k) * numChannels + c];
+            }
+            EXPECT_TRUE(ComplexEqual(sum, interleaved[n * numChannels + c]));
+        }
+    }
+}
+
+TEST(MultiChannelFilter, IirMatchesRealIirFilter) {
+    double num[] = {0.2, 0.3, 0.1};
+    double den[] = {1, -0.5, 0.25, -0.1};
+    const unsigned numLen = sizeof(num) / sizeof(num[0]);
+    const unsigned denLen = sizeof(den) / sizeof(den[0]);
+    const unsigned numChannels = 7;
+    unsigned blockSizes[] = {5, 1, 17};
+
+    MultiChannelIirFilter<double> batch(num, numLen, den, denLen, numChannels);
+    EXPECT_EQ(3, batch.order());
+    std::vector< RealIirFilter<double> > filters(numChannels, RealIirFilter<double>(num, numLen, den, denLen));
+
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        std::vector< RealVector<double> > channels(numChannels, RealVector<double>(blockSizes[b]));
+        std::vector< RealVector<double> > expected(numChannels, RealVector<double>(blockSizes[b]));
+        for (unsigned c=0; c<numChannels; c++) {
+            for (unsigned n=0; n<blockSizes[b]; n++) {
+                channels[c][n] = ChannelSample(c, start + n);
+                expected[c][n] = ChannelSample(c, start + n);
+            }
+            filter(expected[c], filters[c]);
+        }
+
+        batch.filter(channels);
+        for (unsigned c=0; c<numChannels; c++) {
+            for (unsigned n=0; n<blockSizes[b]; n++) {
+                EXPECT_TRUE(FloatsEqual(expected[c][n], channels[c][n]));
+            }
+        }
+        start += blockSizes[b];
+    }
+}
+
+TEST(MultiChannelFilter, IirMatchesComplexIirFilter) {
+    std::complex<double> num[] = {std::complex<double>(0.5, 0.1), std::complex<double>(0.2, -0.3),
+                                  std::complex<double>(0, 0.4), std::complex<double>(0.1, 0)};
+    std::complex<double> den[] = {std::complex<double>(1, 0), std::complex<double>(-0.3, 0.2)};
+    const unsigned numLen = sizeof(num) / sizeof(num[0]);
+    const unsigned denLen = sizeof(den) / sizeof(den[0]);
+    const unsigned numChannels = 4;
+    const unsigned numFrames = 15;
+
+    MultiChannelIirFilter< std::complex<double> > batch(num, numLen, den, denLen, numChannels);
+    ComplexVector<double> interleaved(numFrames * numChannels);
+    std::vector< ComplexVector<double> > expected(numChannels, ComplexVector<double>(numFrames));
+    for (unsigned c=0; c<numChannels; c++) {
+        for (unsigned n=0; n<numFrames; n++) {
+            std::complex<double> x(ChannelSample(c, n), ChannelSample(c + 2, n));
+            interleaved[n * numChannels + c] = x;
+            expected[c][n] = x;
+        }
+        ComplexIirFilter<double> filt(num, numLen, den, denLen);
+        filter(expected[c], filt);
+    }
+
+    filter(interleaved, batch);
+    for (unsigned c=0; c<numChannels; c++) {
+        for (unsigned n=0; n<numFrames; n++) {
+            EXPECT_TRUE(ComplexEqual(expected[c][n], interleaved[n * numChannels + c]));
+        }
+    }
+}
+
+TEST(MultiChannelFilter, IirNormalizesAndResets) {
+    double num[] = {2, 4};
+    double den[] = {2, -1};
+    MultiChannelIirFilter<double> batch(num, 2, den, 2, 2);
+    EXPECT_EQ(1, batch.numerator[0]);
+    EXPECT_EQ(2, batch.numerator[1]);
+    EXPECT_EQ(1, batch.denominator[0]);
+    EXPECT_EQ(-0.5, batch.denominator[1]);
+
+    // y[n] = x[n] + 2*x[n-1] + 0.5*y[n-1] on two interleaved channels
+    double input[] = {1, 0, 0, 0, 2, 2, 0, 0};
+    double expected[] = {1, 0, 2.5, 0, 3.25, 2, 5.625, 5};
+    RealVector<double> data(input, 8);
+    filter(data, batch);
+    for (unsigned i=0; i<8; i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], data[i]));
+    }
+
+    batch.reset();
+    data = RealVector<double>(input, 8);
+    filter(data, batch);
+    for (unsigned i=0; i<8; i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], data[i]));
+    }
+}
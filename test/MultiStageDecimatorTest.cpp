@@ -0,0 +1,145 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "MultiStageDecimator.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+// Gain, in dB, of "decimator" for a tone at "freq" (where 1.0 is the output's Nyquist frequency),
+// measured from the RMS of the second half of the output.
+static double ToneGain(MultiStageDecimator<double> decimator, double freq) {
+    int rate = decimator.rate();
+    RealVector<double> data(400 * rate);
+    for (unsigned i=0; i<data.size(); i++) {
+        data[i] = 0.5 * std::cos(M_PI * freq * i / rate + 0.3);
+    }
+    decimate(data, decimator);
+    EXPECT_EQ(400, data.size());
+    double power = 0;
+    for (unsigned i=data.size()/2; i<data.size(); i++) {
+        power += data[i] * data[i];
+    }
+    power /= data.size() - data.size() / 2;
+    return 10 * std::log10(power / 0.125);
+}
+
+TEST(MultiStageDecimator, Plan) {
+    DecimationPlan plan;
+    EXPECT_TRUE(planDecimation(plan, 256, 0.8, 80));
+    EXPECT_EQ(256, plan.rate());
+    EXPECT_EQ(CIC_STAGE, plan.stages[0].type);
+    EXPECT_EQ(FIR_STAGE, plan.stages.back().type);
+    EXPECT_TRUE(plan.stages.back().rate >= 2);
+    for (unsigned s=1; s+1<plan.stages.size(); s++) {
+        EXPECT_EQ(HALF_BAND_STAGE, plan.stages[s].type);
+        EXPECT_EQ(2, plan.stages[s].rate);
+        EXPECT_EQ(3, plan.stages[s].numTaps % 4);
+    }
+    // A single filter would need thousands of taps, i.e. tens of multiplies per input sample.
+    EXPECT_TRUE(plan.cost < 5);
+    EXPECT_TRUE(plan.cost < estimateFirTaps(80, 0.2 / 512) / 256.0 / 4);
+    
+    DecimationPlan noCic;
+    EXPECT_TRUE(planDecimation(noCic, 256, 0.8, 80, false));
+    EXPECT_EQ(256, noCic.rate());
+    for (unsigned s=0; s<noCic.stages.size(); s++) {
+        EXPECT_NE(CIC_STAGE, noCic.stages[s].type);
+    }
+    EXPECT_TRUE(noCic.cost > plan.cost);
+    
+    DecimationPlan oddRate;
+    EXPECT_TRUE(planDecimation(oddRate, 1000, 0.8, 80));
+    EXPECT_EQ(1000, oddRate.rate());
+    
+    // 125 can only be done with a single FIR stage, which is too long.
+    EXPECT_FALSE(planDecimation(oddRate, 1000, 0.8, 80, false));
+}
+
+TEST(MultiStageDecimator, Response) {
+    int rates[] = {8, 96, 1024};
+    for (unsigned r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+        MultiStageDecimator<double> decimator;
+        EXPECT_TRUE(decimator.design(rates[r], 0.8, 70));
+        EXPECT_EQ(rates[r], decimator.rate());
+        
+        EXPECT_TRUE(std::abs(ToneGain(decimator, 0.1)) < 0.15);
+        EXPECT_TRUE(std::abs(ToneGain(decimator, 0.75)) < 0.15);
+        // Tones that would alias into the passband.
+        EXPECT_TRUE(ToneGain(decimator, 1.25) < -70);
+        EXPECT_TRUE(ToneGain(decimator, 1.9) < -70);
+        EXPECT_TRUE(ToneGain(decimator, 3.1) < -70);
+    }
+}
+
+TEST(MultiStageDecimator, Streaming) {
+    MultiStageDecimator<double> decimator;
+    EXPECT_TRUE(decimator.design(64, 0.5, 60));
+    MultiStageDecimator<double> streaming = decimator;
+    
+    RealVector<double> whole(64 * 50);
+    for (unsigned i=0; i<whole.size(); i++) {
+        whole[i] = 0.4 * std::sin(0.001 * i) + 0.1 * std::cos(0.3 * i);
+    }
+    RealVector<double> input = whole;
+    decimate(whole, decimator);
+    
+    unsigned blockSizes[] = {1, 63, 500, 7, 1000, 129};
+    unsigned start = 0;
+    std::vector<double> streamed;
+    for (unsigned b=0; start<input.size(); b++) {
+        unsigned len = std::min(blockSizes[b % 6], (unsigned) input.size() - start);
+        RealVector<double> block(VECTOR_TO_ARRAY(input.vec) + start, len);
+        decimate(block, streaming);
+        streamed.insert(streamed.end(), block.vec.begin(), block.vec.end());
+        start += len;
+    }
+    EXPECT_EQ(whole.size(), streamed.size());
+    for (unsigned i=0; i<whole.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(whole[i], streamed[i]));
+    }
+    
+    streaming.reset();
+    RealVector<double> again = input;
+    decimate(again, streaming);
+    for (unsigned i=0; i<whole.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(whole[i], again[i]));
+    }
+}
+
+TEST(MultiStageDecimator, ShortfallReported) {
+    DecimationPlan plan;
+    EXPECT_TRUE(planDecimation(plan, 4, 0.5, 60, false));
+    ASSERT_EQ(FIR_STAGE, plan.stages.back().type);
+    plan.stages.back().numTaps = 9;
+
+    // 9 to 23 taps can't reach 200 dB, so the longest one is kept and design says so.
+    MultiStageDecimator<double> decimator;
+    EXPECT_FALSE(decimator.design(plan, 200));
+    EXPECT_EQ(9 + 2 * (MAX_STAGE_DESIGN_ATTEMPTS - 1), decimator.plan().stages.back().numTaps);
+    EXPECT_EQ(4, decimator.rate());
+    RealVector<double> data(400);
+    decimate(data, decimator);
+    EXPECT_EQ(100, data.size());
+}
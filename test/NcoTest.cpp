@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "Nco.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+
+TEST(Nco, MatchesTone) {
+    double freq = 1234.5;
+    double sampleFreq = 48000;
+    double phase = 0.3;
+    ComplexVector<double> expected(5000);
+    tone(expected, freq, sampleFreq, phase);
+    
+    Nco<double> nco(freq, sampleFreq, phase);
+    ComplexVector<double> actual;
+    tone(actual, nco, 5000);
+    EXPECT_EQ(5000, actual.size());
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+    }
+    EXPECT_TRUE(FloatsEqual(freq, nco.getFrequency(sampleFreq)));
+}
+
+TEST(Nco, NegativeFrequency) {
+    Nco<double> nco(-0.125);
+    EXPECT_TRUE(FloatsEqual(0.875, nco.getFrequency()));
+    for (unsigned i=0; i<16; i++) {
+        std::complex<double> expected = std::polar(1.0, -2 * M_PI * 0.125 * i);
+        EXPECT_TRUE(ComplexEqual(expected, nco.next()));
+    }
+    EXPECT_TRUE(FloatsEqual(0, nco.getPhase()));
+}
+
+TEST(Nco, TinyNegativePhase) {
+    // -1e-18 cycles wraps to 1 - 1e-18, which rounds to 1.0.
+    Nco<double> nco(0.125, 1.0, -1e-18);
+    EXPECT_TRUE(FloatsEqual(0, nco.getPhase()));
+    nco.setPhase(-1e-18);
+    EXPECT_TRUE(FloatsEqual(0, nco.getPhase()));
+    EXPECT_TRUE(ComplexEqual(std::complex<double>(1, 0), nco.next()));
+}
+
+TEST(Nco, PhaseContinuousAcrossBlocks) {
+    double freq = 0.0123456789;
+    Nco<double> whole(freq, 1.0, 1.0);
+    Nco<double> blocks(freq, 1.0, 1.0);
+    
+    ComplexVector<double> expected(1000);
+    for (unsigned i=0; i<expected.size(); i++) {
+        expected[i] = std::complex<double>(1.0, -0.5 * (i % 7));
+    }
+    ComplexVector<double> actual = expected;
+    modulate(expected, whole);
+    
+    unsigned blockSizes[] = {1, 99, 300, 600};
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        blocks.modulate(VectorView< std::complex<double> >(VECTOR_TO_ARRAY(actual.vec) + start, blockSizes[b]));
+        start += blockSizes[b];
+    }
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+        EXPECT_TRUE(ComplexEqual(std::complex<double>(1.0, -0.5 * (i % 7)) * std::polar(1.0, 1.0 + 2 * M_PI * freq * i),
+                                 actual[i]));
+    }
+    EXPECT_TRUE(FloatsEqual(whole.getPhase(), blocks.getPhase()));
+}
+
+TEST(Nco, FloatPhaseDoesNotDrift) {
+    // After 10 million samples a float phase accumulator is off by whole radians.
+    float freq = 0.01f;
+    Nco<float> nco(freq);
+    ComplexVector<float> buf(1 << 16);
+    for (unsigned i=0; i<152; i++) {
+        tone(buf, nco);
+    }
+    double elapsed = 152.0 * (1 << 16);
+    double expectedPhase = 2 * M_PI * (((double) freq * elapsed) - std::floor((double) freq * elapsed));
+    EXPECT_NEAR(expectedPhase, nco.getPhase(), 1e-4);
+    std::complex<float> sample = nco.next();
+    EXPECT_NEAR(1.0, std::abs(sample), 1e-5);
+    EXPECT_NEAR(std::cos(expectedPhase), sample.real(), 1e-4);
+}
+
+TEST(Nco, ModulateDecimate) {
+    double filterTaps[] = {0.1, 0.2, 0.4, 0.2, 0.1, -0.05, 0.02};
+    std::vector<double> taps(filterTaps, filterTaps + sizeof(filterTaps)/sizeof(filterTaps[0]));
+    FilterOperationType operations[] = {STREAMING, ONE_SHOT_RETURN_ALL_RESULTS, ONE_SHOT_TRIM_TAILS};
+    unsigned blockSizes[] = {17, 40, 3};
+    
+    for (unsigned op=0; op<3; op++) {
+        RealFirFilter<double> separateFilter(taps, operations[op]);
+        RealFirFilter<double> fusedFilter(taps, operations[op]);
+        Nco<double> separateNco(-0.07, 1.0, 0.5);
+        Nco<double> fusedNco(-0.07, 1.0, 0.5);
+        
+        unsigned start = 0;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            ComplexVector<double> expected(blockSizes[b]);
+            for (unsigned i=0; i<blockSizes[b]; i++) {
+                expected[i] = std::complex<double>(std::sin(0.3 * (start + i)), 0.25);
+            }
+            ComplexVector<double> actual = expected;
+            
+            modulate(expected, separateNco);
+            decimate(expected, 3, separateFilter);
+            modulateDecimate(actual, 3, fusedNco, fusedFilter);
+            
+            ASSERT_EQ(expected.size(), actual.size());
+            for (unsigned i=0; i<expected.size(); i++) {
+                EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+            }
+            start += blockSizes[b];
+        }
+    }
+}
@@ -0,0 +1,180 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "PfbChannelizer.h"
+#include "RealFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static std::complex<double> InputSample(long n) {
+    return std::complex<double>(std::cos(0.11 * n) + 0.5 * std::sin(1.3 * n), std::sin(0.23 * n) - 0.2 * std::cos(2.9 * n));
+}
+
+// Channel k straight from the definition: mix down by k/numChannels, filter, keep every rate'th output.
+static std::complex<double> ReferenceOutput(const std::vector<double> & taps, int numChannels, int rate, int channel,
+                                            long frame) {
+    std::complex<double> sum = 0;
+    long newest = frame * rate;
+    for (long i=0; i<(long)taps.size() && i<=newest; i++) {
+        double angle = -2 * M_PI * channel * ((newest - i) % numChannels) / numChannels;
+        sum += taps[i] * InputSample(newest - i) * std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+    return sum;
+}
+
+static void CompareWithReference(int numTaps, int numChannels, int oversampling) {
+    unsigned blockSizes[] = {17, 1, 250, 3, 64, 5};
+    std::vector<double> taps(numTaps);
+    for (int i=0; i<numTaps; i++) {
+        taps[i] = std::sin(0.37 * i + 0.1) / (i + 1);
+    }
+    PfbChannelizer<double> channelizer(taps, numChannels, oversampling);
+    EXPECT_EQ(numChannels, channelizer.numChannels());
+    EXPECT_EQ(numChannels / oversampling, channelizer.decimateRate());
+    EXPECT_EQ(numTaps, channelizer.numTaps());
+
+    std::vector< std::complex<double> > output;
+    long t = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        ComplexVector<double> buf(blockSizes[block]);
+        for (unsigned i=0; i<buf.size(); i++, t++) {
+            buf[i] = InputSample(t);
+        }
+        channelize(buf, channelizer);
+        EXPECT_EQ(0, buf.size() % numChannels);
+        output.insert(output.end(), buf.vec.begin(), buf.vec.end());
+    }
+
+    long numFrames = (t + channelizer.decimateRate() - 1) / channelizer.decimateRate();
+    ASSERT_EQ(numFrames * numChannels, (long) output.size());
+    for (long frame=0; frame<numFrames; frame++) {
+        for (int k=0; k<numChannels; k++) {
+            EXPECT_TRUE(ComplexEqual(ReferenceOutput(taps, numChannels, channelizer.decimateRate(), k, frame),
+                                     output[frame * numChannels + k]));
+        }
+    }
+}
+
+TEST(PfbChannelizer, CriticallySampled) {
+    CompareWithReference(64, 8, 1);
+    CompareWithReference(37, 8, 1);
+    CompareWithReference(41, 5, 1);
+    CompareWithReference(3, 8, 1);
+}
+
+TEST(PfbChannelizer, Oversampled) {
+    CompareWithReference(64, 8, 2);
+    CompareWithReference(45, 16, 2);
+    CompareWithReference(23, 6, 2);
+    CompareWithReference(30, 12, 4);
+}
+
+TEST(PfbChannelizer, MatchesModulateAndDecimate) {
+    const int numChannels = 8;
+    const int rate = numChannels / 2;
+    std::vector<double> taps(53);
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] = std::cos(0.2 * i) / (i + 2);
+    }
+    ComplexVector<double> input(203);
+    for (unsigned i=0; i<input.size(); i++) {
+        input[i] = InputSample(i);
+    }
+
+    PfbChannelizer<double> channelizer(taps, numChannels, 2);
+    ComplexVector<double> data = input;
+    std::vector< ComplexVector<double> > channels;
+    channelizer.channelize(data, channels);
+    ASSERT_EQ(numChannels, channels.size());
+    for (int k=0; k<numChannels; k++) {
+        ComplexVector<double> expected = input;
+        expected.modulate(-(double) k / numChannels);
+        RealFirFilter<double> filter(taps);
+        filter.decimateComplex(expected, rate);
+        ASSERT_EQ(expected.size(), channels[k].size());
+        for (unsigned n=0; n<expected.size(); n++) {
+            EXPECT_TRUE(std::abs(expected[n] - channels[k][n]) < 1e-9);
+        }
+    }
+}
+
+TEST(PfbChannelizer, ToneLandsInItsChannel) {
+    const int numChannels = 16;
+    RealFirFilter<double> prototype;
+    double freqPoints[] = {0, 0.5 / numChannels, 1.5 / numChannels, 1};
+    double desired[] = {1, 0};
+    double weight[] = {1, 10};
+    prototype.firpm(10 * numChannels, 2, freqPoints, desired, weight);
+
+    for (int oversampling=1; oversampling<=2; oversampling*=2) {
+        PfbChannelizer<double> channelizer(prototype.vec, numChannels, oversampling);
+        ComplexVector<double> data(4096);
+        for (unsigned n=0; n<data.size(); n++) {
+            double angle = 2 * M_PI * 5.0 * n / numChannels;
+            data[n] = std::complex<double>(std::cos(angle), std::sin(angle));
+        }
+        std::vector< ComplexVector<double> > channels;
+        channelizer.channelize(data, channels);
+
+        // Skip the filter's start up transient.
+        unsigned settled = 2 * prototype.size() / channelizer.decimateRate();
+        for (int k=0; k<numChannels; k++) {
+            double power = 0;
+            for (unsigned n=settled; n<channels[k].size(); n++) {
+                power += std::norm(channels[k][n]);
+            }
+            power /= channels[k].size() - settled;
+            if (k == 5) {
+                EXPECT_NEAR(1.0, power, 0.05);
+            }
+            else if (k == 4 || k == 6) {
+                EXPECT_LT(power, 1e-2);
+            }
+            else {
+                EXPECT_LT(power, 1e-5);
+            }
+        }
+    }
+
+}
+
+TEST(PfbChannelizer, Reset) {
+    std::vector<double> taps(29);
+    for (unsigned i=0; i<taps.size(); i++) {
+        taps[i] = 1.0 / (i + 1);
+    }
+    PfbChannelizer<double> channelizer(taps, 4);
+    ComplexVector<double> first(100), second(100);
+    for (unsigned n=0; n<first.size(); n++) {
+        first[n] = second[n] = InputSample(n);
+    }
+    channelize(first, channelizer);
+    channelizer.reset();
+    channelize(second, channelizer);
+    ASSERT_EQ(first.size(), second.size());
+    for (unsigned n=0; n<first.size(); n++) {
+        EXPECT_TRUE(ComplexEqual(first[n], second[n]));
+    }
+}
@@ -0,0 +1,216 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "Pipeline.h"
+#include "RealFirFilter.h"
+#include "RealIirFilter.h"
+#include "ComplexVector.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static double RampSample(unsigned n) {
+    return std::sin(0.05 * n) + 0.001 * n;
+}
+
+class RampSource : public PipelineSource< RealVector<double> > {
+ public:
+    unsigned numBlocks, blockLen, blockCount;
+    RampSource(unsigned blocks, unsigned len) : numBlocks(blocks), blockLen(len), blockCount(0) {}
+    virtual bool generate(RealVector<double> & out) {
+        if (blockCount == numBlocks) {
+            return false;
+        }
+        out.resize(blockLen);
+        for (unsigned i=0; i<blockLen; i++) {
+            out[i] = RampSample(blockCount * blockLen + i);
+        }
+        blockCount++;
+        return true;
+    }
+};
+
+class CollectSink : public PipelineSink< ComplexVector<double> > {
+ public:
+    std::vector< std::complex<double> > samples;
+    bool finished;
+    CollectSink() : finished(false) {}
+    virtual void consume(ComplexVector<double> & in) {samples.insert(samples.end(), in.vec.begin(), in.vec.end());}
+    virtual void finish() {finished = true;}
+};
+
+/**
+ * Keeps its phase from block to block, like the modulator in the NarrowbandFM example.
+ */
+class PhaseModulator : public PipelineStage< RealVector<double>, ComplexVector<double> > {
+ public:
+    double lastPhase;
+    PhaseModulator() : lastPhase(0) {}
+    virtual void process(RealVector<double> & in, ComplexVector<double> & out) {
+        out.resize(in.size());
+        for (unsigned i=0; i<in.size(); i++) {
+            lastPhase += in[i];
+            out[i] = std::polar(1.0, lastPhase);
+        }
+    }
+};
+
+
+TEST(Pipeline, SpscRing) {
+    SpscRing<int> ring(3);
+    EXPECT_EQ(4, ring.capacity());
+    int value;
+    EXPECT_FALSE(ring.pop(value));
+    for (int i=0; i<4; i++) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(4));
+    for (int i=0; i<10; i++) {
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(i, value);
+        EXPECT_TRUE(ring.push(i + 4));
+    }
+}
+
+TEST(Pipeline, SpscRingThreads) {
+    SpscRing<unsigned> ring(16);
+    const unsigned numValues = 20000;
+    unsigned sum = 0;
+    std::thread consumer([&]() {
+        unsigned value, expected = 0;
+        while (expected < numValues) {
+            if (ring.pop(value)) {
+                EXPECT_EQ(expected, value);
+                sum += value;
+                expected++;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (unsigned i=0; i<numValues; ) {
+        if (ring.push(i)) {
+            i++;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    EXPECT_EQ(numValues / 2 * (numValues - 1), sum);
+}
+
+TEST(Pipeline, MatchesSerialProcessing) {
+    double filterTaps[] = {0.1, 0.2, 0.4, 0.2, 0.1, -0.05};
+    double num[] = {0.2, 0.3};
+    double den[] = {1, -0.5};
+    const unsigned numBlocks = 50;
+    const unsigned blockLen = 97;
+
+    RealFirFilter<double> fir(filterTaps, 6);
+    RealFirFilter<double> antiAlias(filterTaps, 5);
+    RealIirFilter<double> iir(num, 2, den, 2);
+    RampSource source(numBlocks, blockLen);
+    InterpStage<RealVector<double>, RealFirFilter<double> > upsample(fir, 3);
+    DecimateStage<RealVector<double>, RealFirFilter<double> > downsample(antiAlias, 2);
+    IirStage<RealVector<double>, RealIirFilter<double> > smooth(iir);
+    TransformStage< RealVector<double> > gain([](RealVector<double> & buf) {buf *= 0.5;});
+    PhaseModulator modulate;
+    CollectSink sink;
+
+    Pipeline pipeline(3);
+    pipeline.connect(source, upsample);
+    pipeline.connect(upsample, downsample);
+    pipeline.connect(downsample, smooth);
+    pipeline.connect(smooth, gain);
+    pipeline.connect(gain, modulate);
+    pipeline.connect(modulate, sink);
+    pipeline.run();
+    EXPECT_TRUE(sink.finished);
+
+    RealFirFilter<double> serialFir(filterTaps, 6);
+    RealFirFilter<double> serialAntiAlias(filterTaps, 5);
+    RealIirFilter<double> serialIir(num, 2, den, 2);
+    RampSource serialSource(numBlocks, blockLen);
+    double lastPhase = 0;
+    std::vector< std::complex<double> > expected;
+    RealVector<double> buf;
+    while (serialSource.generate(buf)) {
+        interp(buf, 3, serialFir);
+        decimate(buf, 2, serialAntiAlias);
+        filter(buf, serialIir);
+        buf *= 0.5;
+        for (unsigned i=0; i<buf.size(); i++) {
+            lastPhase += buf[i];
+            expected.push_back(std::polar(1.0, lastPhase));
+        }
+    }
+
+    ASSERT_EQ(expected.size(), sink.samples.size());
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(expected[i], sink.samples[i]));
+    }
+}
+
+TEST(Pipeline, FileStages) {
+    const char *inName = "PipelineTestIn.bin";
+    const char *outName = "PipelineTestOut.bin";
+    const unsigned numSamples = 10000;
+    {
+        FileSink<float> input(inName);
+        RealVector<float> ramp(numSamples);
+        for (unsigned i=0; i<numSamples; i++) {
+            ramp[i] = (float) RampSample(i);
+        }
+        input.write(ramp);
+    }
+
+    double filterTaps[] = {1, -1, 0.5};
+    RealFirFilter<double> fir(filterTaps, 3);
+    FileSourceStage<float, RealVector<double> > source(inName, 333, BUFFERED_FILE, true);
+    ConvStage<RealVector<double>, RealFirFilter<double> > filt(fir);
+    FileSinkStage<double, RealVector<double> > sink(outName, true);
+
+    Pipeline pipeline;
+    pipeline.connect(source, filt);
+    pipeline.connect(filt, sink);
+    pipeline.run();
+
+    FileSource<double> output(outName);
+    ASSERT_EQ(numSamples, output.size());
+    RealVector<double> result;
+    output.read(result, numSamples);
+    for (unsigned i=0; i<numSamples; i++) {
+        double expected = 0;
+        for (unsigned k=0; k<3 && k<=i; k++) {
+            expected += filterTaps[k] * (double) (float) RampSample(i - k);
+        }
+        EXPECT_TRUE(FloatsEqual(expected, result[i]));
+    }
+    remove(inName);
+    remove(outName);
+}
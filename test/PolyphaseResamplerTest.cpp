@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "PolyphaseResampler.h"
+#include "RealFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+// Resamples the whole stream directly from the definition: upsample, filter, downsample.
+static std::vector<double> ReferenceResample(const std::vector<double> & input, const std::vector<double> & taps,
+                                             int interpRate, int decimateRate) {
+    std::vector<double> output;
+    for (long m=0; m<(long)input.size()*interpRate; m+=decimateRate) {
+        double sum = 0;
+        for (long k=0; k<(long)taps.size(); k++) {
+            if (m - k >= 0 && (m - k) % interpRate == 0) {
+                sum += taps[k] * input[(m - k) / interpRate];
+            }
+        }
+        output.push_back(sum);
+    }
+    return output;
+}
+
+static void CompareWithReference(int numTaps, int interpRate, int decimateRate) {
+    unsigned blockSizes[] = {17, 1, 250, 3, 64};
+    std::vector<double> taps(numTaps);
+    for (int i=0; i<numTaps; i++) {
+        taps[i] = std::sin(0.37 * i + 0.1) / (i + 1);
+    }
+    NimbleDSP::PolyphaseResampler<double> resampler(taps, interpRate, decimateRate);
+
+    std::vector<double> input, resampledStream;
+    double t = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        NimbleDSP::RealVector<double> buf(blockSizes[block]);
+        for (unsigned i=0; i<buf.size(); i++, t++) {
+            buf[i] = std::cos(0.11 * t) + 0.5 * std::sin(1.3 * t);
+        }
+        input.insert(input.end(), buf.vec.begin(), buf.vec.end());
+        resample(buf, resampler);
+        resampledStream.insert(resampledStream.end(), buf.vec.begin(), buf.vec.end());
+        
+        // Every output whose newest input sample has arrived should have been produced.
+        std::vector<double> expected = ReferenceResample(input, taps, interpRate, decimateRate);
+        EXPECT_EQ(expected.size(), resampledStream.size());
+        for (unsigned i=0; i<expected.size() && i<resampledStream.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], resampledStream[i]));
+        }
+    }
+}
+
+TEST(PolyphaseResampler, Resample) {
+    CompareWithReference(31, 3, 2);
+    CompareWithReference(40, 2, 5);
+    CompareWithReference(1000, 147, 160);
+}
+
+TEST(PolyphaseResampler, InterpAndDecimate) {
+    CompareWithReference(25, 4, 1);
+    CompareWithReference(25, 1, 3);
+    CompareWithReference(5, 7, 1);
+}
+
+TEST(PolyphaseResampler, ResampleComplex) {
+    int interpRate = 4, decimateRate = 3;
+    int filterTaps[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    unsigned numTaps = sizeof(filterTaps)/sizeof(filterTaps[0]);
+    NimbleDSP::RealFirFilter<double> filter(filterTaps, numTaps);
+    NimbleDSP::PolyphaseResampler<double> resampler(filterTaps, numTaps, interpRate, decimateRate);
+
+    std::vector< std::complex<double> > expectedStream, resampledStream;
+    for (int block=0; block<3; block++) {
+        NimbleDSP::ComplexVector<double> expected(20 + block);
+        for (unsigned i=0; i<expected.size(); i++) {
+            expected[i] = std::complex<double>(i + block, 2.0 * i - block);
+        }
+        NimbleDSP::ComplexVector<double> buf = expected;
+        filter.resampleComplex(expected, interpRate, decimateRate);
+        resample(buf, resampler);
+        expectedStream.insert(expectedStream.end(), expected.vec.begin(), expected.vec.end());
+        resampledStream.insert(resampledStream.end(), buf.vec.begin(), buf.vec.end());
+        EXPECT_GE(resampledStream.size(), expectedStream.size());
+        EXPECT_LE(resampledStream.size(), expectedStream.size() + 1);
+    }
+    for (unsigned i=0; i<expectedStream.size(); i++) {
+        EXPECT_EQ(expectedStream[i], resampledStream[i]);
+    }
+}
+
+TEST(PolyphaseResampler, Reset) {
+    int filterTaps[] = {1, 2, 3, 4, 5};
+    NimbleDSP::PolyphaseResampler<double> resampler(filterTaps, 5, 2, 1);
+    double inputData[] = {1, 2, 3};
+    double expectedData[] = {1, 2, 5, 8, 14, 14};
+
+    for (int pass=0; pass<2; pass++) {
+        NimbleDSP::RealVector<double> buf(inputData, 3);
+        resample(buf, resampler);
+        EXPECT_EQ(6, buf.size());
+        for (unsigned i=0; i<buf.size(); i++) {
+            EXPECT_EQ(expectedData[i], buf[i]);
+        }
+        resampler.reset();
+    }
+}
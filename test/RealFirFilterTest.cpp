@@ -22,10 +22,12 @@ THE SOFTWARE.
 
 #include "RealFirFilter.h"
 #include "gtest/gtest.h"
+#include <thread>
 
 using namespace NimbleDSP;
 
 extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
 
 TEST(RealFirFilter, ConvStream1) {
     double inputData[] = {1, 0, -1, -2, -3, -4, -5, -6, -7};
@@ -839,6 +841,41 @@ TEST(RealFirFilter, ParksMcClellanBandPass2) {
     }
 }
 
+TEST(RealFirFilter, ParksMcClellanConcurrent) {
+    // The designs share no state, so designing on several threads at once gives the same taps as
+    // designing one at a time.
+    const unsigned numThreads = 4;
+    const int filterOrder = 60;
+    NimbleDSP::RealFirFilter<double> expected;
+    std::vector< NimbleDSP::RealFirFilter<double> > filters(numThreads);
+    std::vector<int> converged(numThreads);
+    double fx[] = {0, 1, 0};
+    double wtx[] = {1.0, 1.0, 1.0};
+    
+    double edge[] = {.0, .2, .3, .6, .7, 1.0};
+    EXPECT_TRUE(expected.firpm(filterOrder, 3, edge, fx, wtx));
+    
+    std::vector<std::thread> threads;
+    for (unsigned t=0; t<numThreads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            for (int repeat=0; repeat<20; repeat++) {
+                double threadEdge[] = {.0, .2, .3, .6, .7, 1.0};
+                converged[t] = filters[t].firpm(filterOrder, 3, threadEdge, fx, wtx);
+            }
+        }));
+    }
+    for (unsigned t=0; t<numThreads; t++) {
+        threads[t].join();
+    }
+    for (unsigned t=0; t<numThreads; t++) {
+        EXPECT_TRUE(converged[t]);
+        EXPECT_EQ(expected.size(), filters[t].size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_EQ(expected[i], filters[t][i]);
+        }
+    }
+}
+
 TEST(RealFirFilter, FractionalDelay) {
     double expectedData[] = {-0.00116094,0.00486943,-0.00748928,-0.00026934,0.02406753,-0.04510960,0.02197806,0.07024028,-0.19289691,0.22224736,0.98196301,0.49981301,-0.17929342,-0.00203095,0.06591779,-0.04789988,0.00909337,0.01074650,-0.00972201,0.00302875,0.00119630};
     
@@ -851,3 +888,450 @@ TEST(RealFirFilter, FractionalDelay) {
         EXPECT_TRUE(FloatsEqual(expectedData[i], filter[i]));
     }
 }
+
+TEST(RealFirFilter, FftConvStream) {
+    unsigned numTaps = 129;
+    unsigned blockSizes[] = {37, 300, 1, 1000};
+    NimbleDSP::RealFirFilter<double> fftFilter(numTaps);
+    for (unsigned i=0; i<numTaps; i++) {
+        fftFilter[i] = sin(0.37 * i) / (i + 1);
+    }
+    NimbleDSP::RealFirFilter<double> directFilter = fftFilter;
+    fftFilter.convAlgorithm = FFT_CONVOLUTION;
+    directFilter.convAlgorithm = DIRECT_CONVOLUTION;
+
+    double t = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        NimbleDSP::RealVector<double> fftBuf(blockSizes[block]);
+        for (unsigned i=0; i<fftBuf.size(); i++, t++) {
+            fftBuf[i] = cos(0.11 * t) + 0.5 * sin(1.3 * t);
+        }
+        NimbleDSP::RealVector<double> directBuf = fftBuf;
+        conv(fftBuf, fftFilter);
+        conv(directBuf, directFilter);
+        EXPECT_EQ(directBuf.size(), fftBuf.size());
+        for (unsigned i=0; i<fftBuf.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(directBuf[i], fftBuf[i]));
+        }
+    }
+}
+
+TEST(RealFirFilter, FftConvOneShot) {
+    unsigned numTaps = 100;
+    unsigned numSamples = 777;
+    NimbleDSP::RealFirFilter<double> fftFilter(numTaps, ONE_SHOT_RETURN_ALL_RESULTS);
+    for (unsigned i=0; i<numTaps; i++) {
+        fftFilter[i] = cos(0.21 * i) - 0.01 * i;
+    }
+    NimbleDSP::RealFirFilter<double> directFilter = fftFilter;
+    fftFilter.convAlgorithm = FFT_CONVOLUTION;
+    directFilter.convAlgorithm = DIRECT_CONVOLUTION;
+
+    NimbleDSP::RealVector<double> fftBuf(numSamples);
+    for (unsigned i=0; i<numSamples; i++) {
+        fftBuf[i] = sin(0.05 * i * i);
+    }
+    NimbleDSP::RealVector<double> directBuf = fftBuf;
+    conv(fftBuf, fftFilter);
+    conv(directBuf, directFilter);
+    EXPECT_EQ(numSamples + numTaps - 1, fftBuf.size());
+    EXPECT_EQ(directBuf.size(), fftBuf.size());
+    for (unsigned i=0; i<fftBuf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(directBuf[i], fftBuf[i]));
+    }
+    
+    fftFilter.filtOperation = ONE_SHOT_TRIM_TAILS;
+    directFilter.filtOperation = ONE_SHOT_TRIM_TAILS;
+    fftBuf.resize(numSamples);
+    for (unsigned i=0; i<numSamples; i++) {
+        fftBuf[i] = sin(0.05 * i * i);
+    }
+    directBuf = fftBuf;
+    conv(fftBuf, fftFilter);
+    conv(directBuf, directFilter);
+    EXPECT_EQ(numSamples, fftBuf.size());
+    for (unsigned i=0; i<fftBuf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(directBuf[i], fftBuf[i]));
+    }
+}
+
+TEST(RealFirFilter, FftConvComplexStream) {
+    unsigned numTaps = 80;
+    unsigned blockSizes[] = {500, 3, 250};
+    NimbleDSP::RealFirFilter<double> fftFilter(numTaps);
+    for (unsigned i=0; i<numTaps; i++) {
+        fftFilter[i] = sin(0.9 * i) * exp(-0.02 * i);
+    }
+    NimbleDSP::RealFirFilter<double> directFilter = fftFilter;
+    fftFilter.convAlgorithm = FFT_CONVOLUTION;
+    directFilter.convAlgorithm = DIRECT_CONVOLUTION;
+
+    double t = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        NimbleDSP::ComplexVector<double> fftBuf(blockSizes[block]);
+        for (unsigned i=0; i<fftBuf.size(); i++, t++) {
+            fftBuf[i] = std::complex<double>(cos(0.3 * t), sin(0.07 * t));
+        }
+        NimbleDSP::ComplexVector<double> directBuf = fftBuf;
+        fftFilter.convComplex(fftBuf);
+        directFilter.convComplex(directBuf);
+        EXPECT_EQ(directBuf.size(), fftBuf.size());
+        for (unsigned i=0; i<fftBuf.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(directBuf[i].real(), fftBuf[i].real()));
+            EXPECT_TRUE(FloatsEqual(directBuf[i].imag(), fftBuf[i].imag()));
+        }
+    }
+}
+
+TEST(RealFirFilter, ConvStreamBlockSizes) {
+    int filterTaps[] = {1, 2, 3, 4, 5, 6, 7};
+    unsigned blockSizes[] = {1, 3, 6, 7, 2, 25, 0, 4};
+    const unsigned numTaps = sizeof(filterTaps)/sizeof(filterTaps[0]);
+    std::vector<double> input;
+    for (unsigned i=0; i<48; i++) {
+        input.push_back(std::sin(0.3 * i) + i % 5);
+    }
+    
+    NimbleDSP::RealFirFilter<double> filter(filterTaps, numTaps);
+    filter.convAlgorithm = DIRECT_CONVOLUTION;
+    NimbleDSP::RealVector<double> buf;
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        buf = NimbleDSP::RealVector<double>(VECTOR_TO_ARRAY(input) + start, blockSizes[b]);
+        const double *bufStart = VECTOR_TO_ARRAY(buf.vec);
+        conv(buf, filter);
+        EXPECT_EQ(blockSizes[b], buf.size());
+        if (blockSizes[b] > 0) {
+            // Filtered in place
+            EXPECT_EQ(bufStart, VECTOR_TO_ARRAY(buf.vec));
+        }
+        for (unsigned i=0; i<buf.size(); i++) {
+            double expected = 0;
+            for (unsigned k=0; k<numTaps && k<=start+i; k++) {
+                expected += filterTaps[k] * input[start + i - k];
+            }
+            EXPECT_TRUE(FloatsEqual(expected, buf[i]));
+        }
+        start += blockSizes[b];
+    }
+}
+
+TEST(RealFirFilter, ResampleStreamBlockSizes) {
+    unsigned blockSizes[] = {1, 3, 0, 17, 2, 40, 5};
+    int rates[][2] = {{3, 2}, {2, 5}, {5, 1}, {1, 3}, {7, 7}};
+    std::vector<double> taps;
+    for (unsigned i=0; i<23; i++) {
+        taps.push_back(std::cos(0.2 * i) / (i + 1));
+    }
+    
+    for (unsigned r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+        int interpRate = rates[r][0];
+        int decimateRate = rates[r][1];
+        NimbleDSP::RealFirFilter<double> filter(taps);
+        std::vector<double> input, resampled;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            NimbleDSP::RealVector<double> buf(blockSizes[b]);
+            for (unsigned i=0; i<buf.size(); i++) {
+                buf[i] = std::sin(0.7 * input.size()) + 0.1 * (input.size() % 3);
+                input.push_back(buf[i]);
+            }
+            resample(buf, interpRate, decimateRate, filter);
+            resampled.insert(resampled.end(), buf.vec.begin(), buf.vec.end());
+            
+            // Every output whose newest input sample has arrived.
+            long numExpected = ((long) input.size() * interpRate + decimateRate - 1) / decimateRate;
+            EXPECT_EQ(numExpected, (long) resampled.size());
+        }
+        for (long m=0; m<(long) resampled.size(); m++) {
+            double expected = 0;
+            long n = m * decimateRate;
+            for (long k=0; k<(long) taps.size() && k<=n; k++) {
+                if ((n - k) % interpRate == 0) {
+                    expected += taps[k] * input[(n - k) / interpRate];
+                }
+            }
+            EXPECT_TRUE(FloatsEqual(expected, resampled[m]));
+        }
+    }
+}
+
+// The streaming resample loop from before RealFirFilter shared PolyphaseResampler's kernel, with a
+// plain dot product.  Only valid for decimateRate <= interpRate and blocks that aren't empty.
+static std::vector<double> LegacyResampleBlock(const std::vector<double> & taps, int interpRate, int decimateRate,
+                                               std::vector<double> & saved, int & phase,
+                                               const std::vector<double> & block) {
+    int filterLen = taps.size();
+    int numTaps = (filterLen + interpRate - 1) / interpRate;
+    if ((int) saved.size() >= numTaps) {
+        saved.resize(numTaps - 1);
+        phase = (numTaps - 1) * interpRate;
+    }
+    int numSaved = saved.size();
+    std::vector<double> work(saved);
+    work.insert(work.end(), block.begin(), block.end());
+
+    std::vector<double> out;
+    int dataStart = 0, filterStart = phase;
+    bool keepGoing = true;
+    while (keepGoing) {
+        double y = 0;
+        for (int j=0; filterStart>=0 && j<=filterStart/interpRate; j++) {
+            y += taps[filterStart - j * interpRate] * work[dataStart + j];
+        }
+        out.push_back(y);
+        filterStart += decimateRate;
+        while (filterStart >= filterLen) {
+            filterStart -= interpRate;
+            ++dataStart;
+        }
+        if ((int) work.size() - dataStart == numSaved) {
+            keepGoing = false;
+            phase = filterStart;
+        }
+    }
+    saved.assign(work.begin() + dataStart, work.end());
+    return out;
+}
+
+TEST(RealFirFilter, ResampleStreamMatchesLegacy) {
+    // The stream of outputs is the same as the old loop's and doesn't depend on the block sizes.
+    // The old loop held an output back until the first sample of its window arrived, so when
+    // the number of taps isn't a multiple of interpRate it returned some outputs a call later.
+    unsigned blockSizes[] = {1, 3, 17, 2, 40, 5, 1, 9};
+    int rates[][2] = {{3, 2}, {4, 3}, {2, 1}, {6, 6}};
+    unsigned tapLens[] = {23, 24};
+
+    for (unsigned t=0; t<2; t++) {
+        std::vector<double> taps;
+        for (unsigned i=0; i<tapLens[t]; i++) {
+            taps.push_back(std::cos(0.2 * i) / (i + 1));
+        }
+        for (unsigned r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+            int interpRate = rates[r][0];
+            int decimateRate = rates[r][1];
+            bool wholePhases = (tapLens[t] % interpRate == 0);
+            NimbleDSP::RealFirFilter<double> chunked(taps);
+            std::vector<double> legacySaved(taps.size() - 1, 0.0);
+            int legacyPhase = 0;
+            std::vector<double> input, resampled, legacy;
+            for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+                NimbleDSP::RealVector<double> buf(blockSizes[b]);
+                for (unsigned i=0; i<buf.size(); i++) {
+                    buf[i] = std::sin(0.7 * input.size()) + 0.1 * (input.size() % 3);
+                    input.push_back(buf[i]);
+                }
+                std::vector<double> legacyBlock = LegacyResampleBlock(taps, interpRate, decimateRate, legacySaved,
+                                                                      legacyPhase, buf.vec);
+                resample(buf, interpRate, decimateRate, chunked);
+                if (wholePhases) {
+                    EXPECT_EQ(legacyBlock.size(), buf.size());
+                }
+                resampled.insert(resampled.end(), buf.vec.begin(), buf.vec.end());
+                legacy.insert(legacy.end(), legacyBlock.begin(), legacyBlock.end());
+                EXPECT_LE(legacy.size(), resampled.size());
+                EXPECT_GE(legacy.size() + 1, resampled.size());
+            }
+
+            NimbleDSP::RealFirFilter<double> whole(taps);
+            NimbleDSP::RealVector<double> all(input);
+            resample(all, interpRate, decimateRate, whole);
+            ASSERT_EQ(all.size(), resampled.size());
+            for (unsigned i=0; i<resampled.size(); i++) {
+                EXPECT_TRUE(FloatsEqual(all[i], resampled[i]));
+                if (i < legacy.size()) {
+                    EXPECT_TRUE(FloatsEqual(legacy[i], resampled[i]));
+                }
+            }
+        }
+    }
+}
+
+TEST(RealFirFilter, DecimateInterpStreamBlockSizes) {
+    // Block sizes on both sides of the history length, and a decimation rate longer than the filter.
+    unsigned blockSizes[] = {1, 3, 0, 17, 2, 40, 5, 60};
+    int rates[] = {1, 2, 3, 5, 30};
+    std::vector<double> taps;
+    for (unsigned i=0; i<23; i++) {
+        taps.push_back(std::cos(0.2 * i) / (i + 1));
+    }
+    long numTaps = taps.size();
+
+    for (unsigned r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+        int rate = rates[r];
+        NimbleDSP::RealFirFilter<double> decimator(taps);
+        NimbleDSP::RealFirFilter<double> interpolator(taps);
+        std::vector<double> input, decimated, interpolated;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            NimbleDSP::RealVector<double> buf(blockSizes[b]);
+            for (unsigned i=0; i<buf.size(); i++) {
+                buf[i] = std::sin(0.7 * input.size()) + 0.1 * (input.size() % 3);
+                input.push_back(buf[i]);
+            }
+            NimbleDSP::RealVector<double> buf2 = buf;
+            decimate(buf, rate, decimator);
+            decimated.insert(decimated.end(), buf.vec.begin(), buf.vec.end());
+            interp(buf2, rate, interpolator);
+            interpolated.insert(interpolated.end(), buf2.vec.begin(), buf2.vec.end());
+
+            // Every output whose newest input sample has arrived.
+            EXPECT_EQ(((long) input.size() + rate - 1) / rate, (long) decimated.size());
+            long numTapsPerPhase = (numTaps + rate - 1) / rate;
+            EXPECT_EQ((long) input.size() * rate - (numTapsPerPhase * rate - numTaps), (long) interpolated.size());
+        }
+        for (long m=0; m<(long) decimated.size(); m++) {
+            double expected = 0;
+            long n = m * rate;
+            for (long k=0; k<numTaps && k<=n; k++) {
+                expected += taps[k] * input[n - k];
+            }
+            EXPECT_TRUE(FloatsEqual(expected, decimated[m]));
+        }
+        for (long n=0; n<(long) interpolated.size(); n++) {
+            double expected = 0;
+            for (long k=0; k<numTaps && k<=n; k++) {
+                if ((n - k) % rate == 0) {
+                    expected += taps[k] * input[(n - k) / rate];
+                }
+            }
+            EXPECT_TRUE(FloatsEqual(expected, interpolated[n]));
+        }
+    }
+}
+
+TEST(RealFirFilter, SymmetricTapFolding) {
+    // Long enough for conv and decimate to fold, and 69 and 72 taps are multiples of some of the
+    // interpolation rates but not all of them.
+    unsigned tapSetLens[] = {69, 72, 69, 72};
+    TapSymmetryType expectedSymmetry[] = {SYMMETRIC_TAPS, SYMMETRIC_TAPS, ANTISYMMETRIC_TAPS, ANTISYMMETRIC_TAPS};
+    std::vector<double> tapSets[4];
+    for (unsigned t=0; t<4; t++) {
+        unsigned numTaps = tapSetLens[t];
+        tapSets[t].resize(numTaps);
+        for (unsigned i=0; i<(numTaps + 1)/2; i++) {
+            double tap = std::sin(0.4 * i + 0.1) + 0.05 * i;
+            tapSets[t][i] = tap;
+            tapSets[t][numTaps - 1 - i] = (expectedSymmetry[t] == ANTISYMMETRIC_TAPS) ? -tap : tap;
+        }
+        if (expectedSymmetry[t] == ANTISYMMETRIC_TAPS && numTaps % 2) {
+            tapSets[t][numTaps / 2] = 0;
+        }
+    }
+    unsigned blockSizes[] = {1, 17, 5, 140, 3, 60};
+    int rates[] = {2, 3, 4};
+    
+    for (unsigned t=0; t<4; t++) {
+        RealFirFilter<double> folded(tapSets[t]);
+        RealFirFilter<double> direct(tapSets[t]);
+        folded.convAlgorithm = direct.convAlgorithm = DIRECT_CONVOLUTION;
+        direct.symmetry = NO_SYMMETRY;
+        EXPECT_EQ(expectedSymmetry[t], folded.tapSymmetry());
+        EXPECT_EQ(NO_SYMMETRY, direct.tapSymmetry());
+        
+        for (unsigned r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+            RealFirFilter<double> foldedConv(folded), directConv(direct);
+            RealFirFilter<double> foldedDecimate(folded), directDecimate(direct);
+            RealFirFilter<double> foldedInterp(folded), directInterp(direct);
+            RealFirFilter<double> foldedComplex(folded), directComplex(direct);
+            unsigned start = 0;
+            for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+                RealVector<double> input(blockSizes[b]);
+                ComplexVector<double> complexInput(blockSizes[b]);
+                for (unsigned i=0; i<blockSizes[b]; i++) {
+                    input[i] = std::sin(0.37 * (start + i)) + ((start + i) % 3);
+                    complexInput[i] = std::complex<double>(input[i], std::cos(0.21 * (start + i)));
+                }
+                start += blockSizes[b];
+                
+                RealVector<double> expected = input, actual = input;
+                conv(expected, directConv);
+                conv(actual, foldedConv);
+                EXPECT_EQ(expected.size(), actual.size());
+                for (unsigned i=0; i<expected.size(); i++) {
+                    EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+                }
+                
+                expected = input;
+                actual = input;
+                decimate(expected, rates[r], directDecimate);
+                decimate(actual, rates[r], foldedDecimate);
+                EXPECT_EQ(expected.size(), actual.size());
+                for (unsigned i=0; i<expected.size(); i++) {
+                    EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+                }
+                
+                expected = input;
+                actual = input;
+                interp(expected, rates[r], directInterp);
+                interp(actual, rates[r], foldedInterp);
+                EXPECT_EQ(expected.size(), actual.size());
+                for (unsigned i=0; i<expected.size(); i++) {
+                    EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+                }
+                
+                ComplexVector<double> complexExpected = complexInput, complexActual = complexInput;
+                interp(complexExpected, rates[r], directComplex);
+                interp(complexActual, rates[r], foldedComplex);
+                EXPECT_EQ(complexExpected.size(), complexActual.size());
+                for (unsigned i=0; i<complexExpected.size(); i++) {
+                    EXPECT_TRUE(ComplexEqual(complexExpected[i], complexActual[i]));
+                }
+            }
+        }
+        
+        RealVector<double> input(150);
+        ComplexVector<double> complexInput(150);
+        for (unsigned i=0; i<input.size(); i++) {
+            input[i] = std::cos(0.45 * i) - 0.1 * i;
+            complexInput[i] = std::complex<double>(input[i], std::sin(0.8 * i));
+        }
+        FilterOperationType operations[] = {ONE_SHOT_RETURN_ALL_RESULTS, ONE_SHOT_TRIM_TAILS};
+        for (unsigned op=0; op<2; op++) {
+            folded.filtOperation = direct.filtOperation = operations[op];
+            RealVector<double> expected = input, actual = input;
+            conv(expected, direct);
+            conv(actual, folded);
+            EXPECT_EQ(expected.size(), actual.size());
+            for (unsigned i=0; i<expected.size(); i++) {
+                EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+            }
+            
+            ComplexVector<double> complexExpected = complexInput, complexActual = complexInput;
+            decimate(complexExpected, 3, direct);
+            decimate(complexActual, 3, folded);
+            EXPECT_EQ(complexExpected.size(), complexActual.size());
+            for (unsigned i=0; i<complexExpected.size(); i++) {
+                EXPECT_TRUE(ComplexEqual(complexExpected[i], complexActual[i]));
+            }
+        }
+    }
+}
+
+TEST(RealFirFilter, DeclaredTapSymmetry) {
+    // Declaring the symmetry skips the check, so only one half of the taps matters.
+    const unsigned numTaps = 64;
+    std::vector<double> taps(numTaps), mirrored(numTaps);
+    for (unsigned i=0; i<numTaps; i++) {
+        taps[i] = i + 1;
+        mirrored[i] = (i < numTaps / 2) ? numTaps - i : i + 1;
+    }
+    RealFirFilter<double> declared(taps);
+    RealFirFilter<double> reference(mirrored);
+    declared.convAlgorithm = reference.convAlgorithm = DIRECT_CONVOLUTION;
+    declared.symmetry = SYMMETRIC_TAPS;
+    EXPECT_EQ(SYMMETRIC_TAPS, declared.tapSymmetry());
+    EXPECT_EQ(SYMMETRIC_TAPS, reference.tapSymmetry());
+    
+    RealVector<double> expected(100), actual(100);
+    for (unsigned i=0; i<expected.size(); i++) {
+        expected[i] = actual[i] = (i % 7) - 3.0;
+    }
+    conv(expected, reference);
+    conv(actual, declared);
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+    }
+    
+    declared = RealVector<double>(taps);
+    EXPECT_EQ(DETECT_SYMMETRY, declared.symmetry);
+    EXPECT_EQ(NO_SYMMETRY, declared.tapSymmetry());
+}
@@ -21,6 +21,7 @@ THE SOFTWARE.
 */
 
 #include "RealIirFilter.h"
+#include "ThreadPool.h"
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -144,3 +145,87 @@ TEST(RealIirFilter, Filter4) {
 }
 
 
+
+static double IirSample(unsigned n) {
+    return std::sin(0.07 * n) + 0.5 * std::cos(1.3 * n + 0.2) - 0.25;
+}
+
+// Two stable sections, poles at radius 0.9 and 0.5, multiplied out.
+static double blockDen[] = {1, -1.1, 0.26, 0.005, 0.2025};
+
+static void ExpectBlockMatchesSerial(std::vector<double> num, ThreadPool *pool) {
+    std::vector<double> den(blockDen, blockDen + sizeof(blockDen) / sizeof(blockDen[0]));
+    RealIirFilter<double> serial(num, den);
+    RealIirFilter<double> block(num, den);
+    serial.filterAlgorithm = SERIAL_IIR;
+    block.filterAlgorithm = BLOCK_IIR;
+    block.threadPool = pool;
+
+    unsigned blockSizes[] = {5000, 3, 9001, 1025, 20000};
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        Vector<double> expected(blockSizes[b]);
+        for (unsigned n=0; n<expected.size(); n++) {
+            expected[n] = IirSample(start + n);
+        }
+        Vector<double> data = expected;
+        filter(expected, serial);
+        filter(data, block);
+        for (unsigned n=0; n<data.size(); n++) {
+            EXPECT_TRUE(FloatsEqual(expected[n], data[n]));
+        }
+        start += blockSizes[b];
+    }
+
+    std::vector<double> serialState = serial.getState();
+    std::vector<double> blockState = block.getState();
+    ASSERT_EQ(serial.order(), blockState.size());
+    for (unsigned k=0; k<blockState.size(); k++) {
+        EXPECT_TRUE(FloatsEqual(serialState[k], blockState[k]));
+    }
+}
+
+TEST(RealIirFilter, BlockMatchesSerial) {
+    double shortNum[] = {0.3, 0.2, -0.1};
+    double longNum[] = {0.1, 0.2, 0.3, 0.2, 0.1, 0.05};
+    ExpectBlockMatchesSerial(std::vector<double>(shortNum, shortNum + 3), NULL);
+    ExpectBlockMatchesSerial(std::vector<double>(longNum, longNum + 6), NULL);
+}
+
+TEST(RealIirFilter, BlockThreadPool) {
+    double num[] = {0.3, 0.2, -0.1};
+    ThreadPool pool(4);
+    ExpectBlockMatchesSerial(std::vector<double>(num, num + 3), &pool);
+}
+
+TEST(RealIirFilter, State) {
+    double num[] = {0.3, 0.2, -0.1};
+    RealIirFilter<double> filt(num, 3, blockDen, sizeof(blockDen) / sizeof(blockDen[0]));
+    EXPECT_EQ(4, filt.order());
+    EXPECT_EQ(4, filt.getState().size());
+
+    Vector<double> first(100);
+    Vector<double> second(100);
+    for (unsigned n=0; n<100; n++) {
+        first[n] = IirSample(n);
+        second[n] = IirSample(n + 100);
+    }
+    filter(first, filt);
+    std::vector<double> checkpoint = filt.getState();
+    Vector<double> resumed = second;
+    filter(second, filt);
+
+    // Resuming a fresh filter from the checkpoint carries on where the stream left off.
+    RealIirFilter<double> other(num, 3, blockDen, sizeof(blockDen) / sizeof(blockDen[0]));
+    other.setState(checkpoint);
+    filter(resumed, other);
+    for (unsigned n=0; n<100; n++) {
+        EXPECT_EQ(second[n], resumed[n]);
+    }
+
+    filt.reset();
+    std::vector<double> cleared = filt.getState();
+    for (unsigned k=0; k<cleared.size(); k++) {
+        EXPECT_EQ(0, cleared[k]);
+    }
+}
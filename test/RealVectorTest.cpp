@@ -55,6 +55,38 @@ TEST(RealVectorInit, Vector) {
     }
 }
 
+TEST(RealVectorInit, CopyKeepsScratch) {
+    double array[] = {1, 3, 5, 7.12};
+    std::vector<double> scratch;
+	NimbleDSP::RealVector<double> buf(array, 4, &scratch);
+	NimbleDSP::RealVector<double> copy(buf);
+    
+    EXPECT_TRUE(buf == copy);
+    
+    // Convolution copies the data into the scratch buffer, if there is one.
+	NimbleDSP::RealVector<double> filter(array, 2);
+    conv(copy, filter);
+    EXPECT_EQ(4, scratch.size());
+}
+
+TEST(RealVectorInit, Move) {
+    double array[] = {1, 3, 5, 7.12, 2, 4, 6, 8};
+	NimbleDSP::RealVector<double> buf(array, 8);
+    const double *data = VECTOR_TO_ARRAY(buf.vec);
+    
+	NimbleDSP::RealVector<double> moved(std::move(buf));
+    EXPECT_EQ(8, moved.size());
+    EXPECT_EQ(data, VECTOR_TO_ARRAY(moved.vec));
+    
+	NimbleDSP::RealVector<double> assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(8, assigned.size());
+    EXPECT_EQ(data, VECTOR_TO_ARRAY(assigned.vec));
+    for (unsigned i=0; i<assigned.size(); i++) {
+        EXPECT_EQ(array[i], assigned[i]);
+    }
+}
+
 // Operator tests
 TEST(RealVectorOperators, PlusEqualsBuf) {
     double inputData[] = {1, 3, 5, 7.12, 2, 4, 6, 8};
@@ -356,6 +388,24 @@ TEST(RealVectorStatistics, StdDev) {
     EXPECT_TRUE(FloatsEqual(244.9664736827704, stdDev(buf)));
 }
 
+TEST(RealVectorStatistics, AccumulationType) {
+    float inputData[] = {100, 300, 500, 700.12f, 200, 400, 600, 800};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+	NimbleDSP::RealVector<float> buf(inputData, numElements);
+    
+    // Float vectors accumulate and return float unless asked for something wider.
+    float floatMean = mean(buf);
+    EXPECT_NEAR(450.015, floatMean, 1e-3);
+    EXPECT_NEAR(60008.57322857144, buf.var(), 1e-1);
+    EXPECT_NEAR(450.015, buf.mean<double>(), 1e-4);
+    EXPECT_NEAR(244.9664736827704, buf.stdDev<double>(), 1e-4);
+    
+    // Integer vectors still use SLICKDSP_FLOAT_TYPE.
+    int intData[] = {1, 2, 3, 4};
+	NimbleDSP::RealVector<int> intBuf(intData, 4);
+    EXPECT_TRUE(FloatsEqual(2.5, mean(intBuf)));
+}
+
 TEST(RealVectorStatistics, Median) {
     double inputData[] = {100, 300, 500, 700.12, 200, 400, 600, 800};
     unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
@@ -366,6 +416,28 @@ TEST(RealVectorStatistics, Median) {
     EXPECT_EQ(400, median(buf));
 }
 
+TEST(RealVectorStatistics, MedianSelection) {
+    srand(3);
+    for (unsigned len=1; len<40; len++) {
+        std::vector<double> input(len);
+        for (unsigned i=0; i<len; i++) {
+            input[i] = (double) (rand() % 20);
+        }
+        std::vector<double> sorted = input;
+        std::sort(sorted.begin(), sorted.end());
+        double expected = (len & 1) ? sorted[len/2] : (sorted[len/2] + sorted[len/2 - 1]) / 2;
+
+        NimbleDSP::RealVector<double> buf(input);
+        EXPECT_EQ(expected, median(buf));
+        for (unsigned i=0; i<len; i++) {
+            EXPECT_EQ(input[i], buf[i]);
+        }
+        std::vector<double> scratch;
+        NimbleDSP::RealVector<double> scratchBuf(input, &scratch);
+        EXPECT_EQ(expected, scratchBuf.median());
+    }
+}
+
 TEST(RealVectorMethods, Rotate) {
     double inputData[] = {2, 4, 6, 8.37, 3, 5, 7, 9};
     unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
@@ -892,3 +964,52 @@ TEST(RealVectorMethods, Modulate) {
     }
 }
 
+TEST(RealVectorMethods, Fft) {
+    double inputData[] = {1, 2, 3, 4, 0, -1, -2, 5};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+	NimbleDSP::RealVector<double> buf(inputData, numElements);
+	NimbleDSP::ComplexVector<double> expected(inputData, numElements);
+	NimbleDSP::ComplexVector<double> spectrum;
+    
+    fft(expected);
+    fft(buf, spectrum);
+    EXPECT_EQ(NimbleDSP::FREQUENCY_DOMAIN, spectrum.domain);
+    EXPECT_EQ(numElements/2 + 1, spectrum.size());
+    for (unsigned i=0; i<spectrum.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i].real(), spectrum[i].real()));
+        EXPECT_TRUE(FloatsEqual(expected[i].imag(), spectrum[i].imag()));
+    }
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_EQ(inputData[i], buf[i]);
+    }
+    
+    NimbleDSP::RealVector<double> result;
+    ifft(result, spectrum);
+    EXPECT_EQ(numElements, result.size());
+    for (unsigned i=0; i<result.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(inputData[i] * numElements, result[i]));
+    }
+}
+
+TEST(RealVectorMethods, FftOddSize) {
+    double inputData[] = {1, 2, 3, 4, 0, -1, -2};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+	NimbleDSP::RealVector<double> buf(inputData, numElements);
+	NimbleDSP::ComplexVector<double> expected(inputData, numElements);
+	NimbleDSP::ComplexVector<double> spectrum;
+    
+    fft(expected);
+    fft(buf, spectrum);
+    EXPECT_EQ(numElements/2 + 1, spectrum.size());
+    for (unsigned i=0; i<spectrum.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i].real(), spectrum[i].real()));
+        EXPECT_TRUE(FloatsEqual(expected[i].imag(), spectrum[i].imag()));
+    }
+    
+    NimbleDSP::RealVector<double> result;
+    ifft(result, spectrum, numElements);
+    EXPECT_EQ(numElements, result.size());
+    for (unsigned i=0; i<result.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(inputData[i] * numElements, result[i]));
+    }
+}
@@ -0,0 +1,138 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "RunningStatistics.h"
+#include "gtest/gtest.h"
+#include <cstdlib>
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+// Input with plenty of repeated values so that ties get exercised.
+static std::vector<double> TestSignal(unsigned len) {
+    std::vector<double> signal(len);
+    for (unsigned i=0; i<len; i++) {
+        signal[i] = (double) (rand() % 50) - 25;
+    }
+    return signal;
+}
+
+// The statistic of the window ending at sample "n", computed with the RealVector methods.
+static RealVector<double> Window(const std::vector<double> & signal, unsigned n, unsigned windowLen) {
+    unsigned start = (n + 1 >= windowLen) ? n + 1 - windowLen : 0;
+    return RealVector<double>(std::vector<double>(signal.begin() + start, signal.begin() + n + 1));
+}
+
+
+TEST(RunningStatistics, Median) {
+    srand(4);
+    unsigned windowLens[] = {1, 2, 5, 8, 31};
+    unsigned blockSizes[] = {1, 3, 40, 7, 100};
+    std::vector<double> signal = TestSignal(151);
+    
+    for (unsigned w=0; w<sizeof(windowLens)/sizeof(windowLens[0]); w++) {
+        RunningMedian<double> runningMedian(windowLens[w]);
+        EXPECT_EQ(windowLens[w], runningMedian.windowLength());
+        unsigned start = 0;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            RealVector<double> data(std::vector<double>(signal.begin() + start, signal.begin() + start + blockSizes[b]));
+            filter(data, runningMedian);
+            for (unsigned i=0; i<data.size(); i++) {
+                RealVector<double> window = Window(signal, start + i, windowLens[w]);
+                EXPECT_EQ(median(window), data[i]);
+            }
+            start += blockSizes[b];
+        }
+    }
+}
+
+TEST(RunningStatistics, MedianRemovesImpulses) {
+    float input[] = {1, 1, 1, 90, 1, 1, -80, 1, 1, 1};
+    RealVector<float> data(input, 10);
+    RunningMedian<float> runningMedian(3);
+    filter(data, runningMedian);
+    for (unsigned i=1; i<data.size(); i++) {
+        EXPECT_EQ(1, data[i]);
+    }
+    
+    runningMedian.reset();
+    data = RealVector<float>(input + 3, 1);
+    filter(data, runningMedian);
+    EXPECT_EQ(90, data[0]);
+}
+
+TEST(RunningStatistics, MinMax) {
+    srand(5);
+    unsigned windowLens[] = {1, 2, 6, 25};
+    unsigned blockSizes[] = {2, 50, 1, 97};
+    std::vector<double> signal = TestSignal(150);
+    
+    for (unsigned w=0; w<sizeof(windowLens)/sizeof(windowLens[0]); w++) {
+        RunningMax<double> runningMax(windowLens[w]);
+        RunningMin<double> runningMin(windowLens[w]);
+        unsigned start = 0;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            RealVector<double> maxData(std::vector<double>(signal.begin() + start, signal.begin() + start + blockSizes[b]));
+            RealVector<double> minData = maxData;
+            filter(maxData, runningMax);
+            filter(minData, runningMin);
+            for (unsigned i=0; i<maxData.size(); i++) {
+                RealVector<double> window = Window(signal, start + i, windowLens[w]);
+                EXPECT_EQ(window.max(), maxData[i]);
+                EXPECT_EQ(window.min(), minData[i]);
+            }
+            start += blockSizes[b];
+        }
+    }
+}
+
+TEST(RunningStatistics, MeanVar) {
+    srand(6);
+    const unsigned windowLen = 9;
+    unsigned blockSizes[] = {4, 1, 30, 65};
+    std::vector<double> signal = TestSignal(100);
+    RunningMean<double> runningMean(windowLen);
+    RunningVar<double> runningVar(windowLen);
+    
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        RealVector<double> meanData(std::vector<double>(signal.begin() + start, signal.begin() + start + blockSizes[b]));
+        RealVector<double> varData = meanData;
+        filter(meanData, runningMean);
+        filter(varData, runningVar);
+        for (unsigned i=0; i<meanData.size(); i++) {
+            RealVector<double> window = Window(signal, start + i, windowLen);
+            EXPECT_TRUE(FloatsEqual(window.mean(), meanData[i]));
+            if (window.size() > 1) {
+                EXPECT_TRUE(FloatsEqual(window.var(), varData[i]));
+            }
+            else {
+                EXPECT_EQ(0, varData[i]);
+            }
+        }
+        start += blockSizes[b];
+    }
+    RealVector<double> last = Window(signal, signal.size() - 1, windowLen);
+    EXPECT_TRUE(FloatsEqual(last.mean(), runningVar.mean()));
+    EXPECT_TRUE(FloatsEqual(last.var(), runningMean.var()));
+}
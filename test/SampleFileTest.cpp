@@ -0,0 +1,188 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include "SampleFile.h"
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+static const char *TEST_FILE_NAME = "SampleFileTest.bin";
+
+static void WriteIqFile(unsigned numSamples) {
+    std::vector<int16_t> iq(2 * numSamples);
+    for (unsigned i=0; i<numSamples; i++) {
+        iq[2 * i] = (int16_t) ((int) i * 7 - 20000);
+        iq[2 * i + 1] = (int16_t) (3000 - (int) i * 5);
+    }
+    FILE *file = fopen(TEST_FILE_NAME, "wb");
+    fwrite(VECTOR_TO_ARRAY(iq), sizeof(int16_t), iq.size(), file);
+    fclose(file);
+}
+
+
+TEST(SampleFile, ReadInt16IqAsComplexFloat) {
+    const unsigned numSamples = 5000;
+    WriteIqFile(numSamples);
+    unsigned blockSizes[] = {1, 999, 4096, 100000};
+
+    for (int access=0; access<2; access++) {
+        for (int async=0; async<2; async++) {
+            FileSource< std::complex<int16_t> > source(TEST_FILE_NAME, access ? BUFFERED_FILE : MEMORY_MAPPED_FILE,
+                                                       async == 1, 1024);
+            ASSERT_TRUE(source.isOpen());
+            EXPECT_EQ(numSamples, source.size());
+            source.scale = 1.0 / 32768;
+
+            ComplexVector<float> buf;
+            unsigned index = 0;
+            for (unsigned b=0; !source.eof(); b = (b + 1) % 4) {
+                unsigned numRead = source.read(buf, blockSizes[b]);
+                EXPECT_EQ(std::min(blockSizes[b], numSamples - index), numRead);
+                EXPECT_EQ(numRead, buf.size());
+                for (unsigned i=0; i<numRead; i++, index++) {
+                    EXPECT_EQ((float) ((int) index * 7 - 20000) / 32768, buf[i].real());
+                    EXPECT_EQ((float) (3000 - (int) index * 5) / 32768, buf[i].imag());
+                }
+            }
+            EXPECT_EQ(numSamples, index);
+            EXPECT_EQ(0, source.read(buf, 10));
+            EXPECT_EQ(0, buf.size());
+
+            source.seek(4321);
+            EXPECT_EQ(4321, source.position());
+            std::complex<float> array[3];
+            EXPECT_EQ(3, source.read(VectorView< std::complex<float> >(array, 3)));
+            EXPECT_EQ((float) (4321 * 7 - 20000) / 32768, array[0].real());
+            EXPECT_EQ((float) (3000 - 4323 * 5) / 32768, array[2].imag());
+        }
+    }
+    remove(TEST_FILE_NAME);
+}
+
+TEST(SampleFile, WriteComplexFloatAsInt16Iq) {
+    const unsigned numSamples = 3001;
+    for (int async=0; async<2; async++) {
+        ComplexVector<double> data(numSamples);
+        for (unsigned i=0; i<numSamples; i++) {
+            data[i] = std::complex<double>(std::sin(0.01 * i), std::cos(0.01 * i));
+        }
+        data[5] = std::complex<double>(2, -2);   // Out of range, so it saturates
+
+        {
+            FileSink< std::complex<int16_t> > sink(TEST_FILE_NAME, async == 1, 512);
+            ASSERT_TRUE(sink.isOpen());
+            sink.scale = 32767;
+            sink.write(VectorView< std::complex<double> >(VECTOR_TO_ARRAY(data), 1000));
+            sink.write(VectorView< std::complex<double> >(VECTOR_TO_ARRAY(data) + 1000, numSamples - 1000));
+            EXPECT_EQ(numSamples, sink.size());
+            EXPECT_TRUE(sink.good());
+        }
+
+        FileSource< std::complex<int16_t> > source(TEST_FILE_NAME);
+        EXPECT_EQ(numSamples, source.size());
+        ComplexVector<int16_t> readBack;
+        source.read(readBack, numSamples);
+        for (unsigned i=0; i<numSamples; i++) {
+            if (i == 5) {
+                EXPECT_EQ(32767, readBack[i].real());
+                EXPECT_EQ(-32768, readBack[i].imag());
+            }
+            else {
+                EXPECT_EQ((int16_t) std::floor(32767 * data[i].real() + 0.5), readBack[i].real());
+                EXPECT_EQ((int16_t) std::floor(32767 * data[i].imag() + 0.5), readBack[i].imag());
+            }
+        }
+    }
+    remove(TEST_FILE_NAME);
+}
+
+TEST(SampleFile, RealRoundTrip) {
+    RealVector<float> data(777);
+    for (unsigned i=0; i<data.size(); i++) {
+        data[i] = 0.25f * i - 10;
+    }
+
+    FileSink<float> sink(TEST_FILE_NAME);
+    sink.write(data);
+    sink.flush();
+    sink.write(VectorView<float>(VECTOR_TO_ARRAY(data), 10));
+    sink.close();
+    EXPECT_FALSE(sink.isOpen());
+
+    FileSource<float> source(TEST_FILE_NAME, BUFFERED_FILE);
+    EXPECT_FALSE(source.isMemoryMapped());
+    RealVector<double> readBack;
+    EXPECT_EQ(787, source.read(readBack, 1000));
+    for (unsigned i=0; i<787; i++) {
+        EXPECT_EQ(data[i % 777], readBack[i]);
+    }
+    source.close();
+    remove(TEST_FILE_NAME);
+
+    FileSource<float> missing("SampleFileTestMissing.bin");
+    EXPECT_FALSE(missing.isOpen());
+    EXPECT_EQ(0, missing.read(readBack, 10));
+}
+
+TEST(SampleFile, AsyncManySmallChunks) {
+    // 5 floats round up to a 64 byte chunk, so both sides go through their background thread
+    // hundreds of times.
+    RealVector<float> data(3333);
+    for (unsigned i=0; i<data.size(); i++) {
+        data[i] = 0.5f * i - 100;
+    }
+    {
+        FileSink<float> sink(TEST_FILE_NAME, true, 5);
+        for (unsigned i=0; i<data.size(); i+=7) {
+            sink.write(VectorView<float>(VECTOR_TO_ARRAY(data) + i, std::min(7u, data.size() - i)));
+        }
+        sink.flush();
+        EXPECT_TRUE(sink.good());
+        EXPECT_EQ(data.size(), sink.size());
+    }
+
+    FileSource<float> source(TEST_FILE_NAME, BUFFERED_FILE, true, 5);
+    RealVector<float> readBack;
+    EXPECT_EQ(data.size(), source.read(readBack, 10000));
+    for (unsigned i=0; i<data.size(); i++) {
+        EXPECT_EQ(data[i], readBack[i]);
+    }
+
+    unsigned seekPoints[] = {3, 1000, 17, 3332};
+    for (unsigned s=0; s<4; s++) {
+        source.seek(seekPoints[s]);
+        float buf[40];
+        unsigned numRead = source.read(buf, 40);
+        EXPECT_EQ(std::min(40u, (unsigned) data.size() - seekPoints[s]), numRead);
+        for (unsigned i=0; i<numRead; i++) {
+            EXPECT_EQ(data[seekPoints[s] + i], buf[i]);
+        }
+    }
+    source.close();
+    remove(TEST_FILE_NAME);
+}
@@ -0,0 +1,169 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include "SimdKernels.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+static bool FloatsClose(double float1, double float2) {
+    return std::fabs(float1 - float2) < 1e-4;
+}
+
+TEST(SimdKernels, RealDotProduct) {
+    std::vector<float> xf(37), hf(37);
+    std::vector<double> xd(37), hd(37);
+    for (unsigned i=0; i<xf.size(); i++) {
+        xd[i] = xf[i] = (float) std::sin(0.3 * i);
+        hd[i] = hf[i] = (float) std::cos(0.7 * i);
+    }
+    for (int n=0; n<=(int)xf.size(); n++) {
+        double expected = 0;
+        for (int i=0; i<n; i++) {
+            expected += xd[i] * hd[i];
+        }
+        EXPECT_TRUE(FloatsEqual(expected, dotProduct(&xd[0], &hd[0], n)));
+        EXPECT_TRUE(FloatsClose(expected, dotProduct(&xf[0], &hf[0], n)));
+    }
+}
+
+TEST(SimdKernels, ComplexRealDotProduct) {
+    std::vector< std::complex<float> > xf(37);
+    std::vector< std::complex<double> > xd(37);
+    std::vector<float> hf(37);
+    std::vector<double> hd(37);
+    for (unsigned i=0; i<xf.size(); i++) {
+        xd[i] = xf[i] = std::complex<float>((float) std::sin(0.3 * i), (float) std::cos(1.1 * i));
+        hd[i] = hf[i] = (float) std::cos(0.7 * i);
+    }
+    for (int n=0; n<=(int)xf.size(); n++) {
+        std::complex<double> expected = 0;
+        for (int i=0; i<n; i++) {
+            expected += xd[i] * hd[i];
+        }
+        std::complex<double> resultD = dotProduct(&xd[0], &hd[0], n);
+        std::complex<float> resultF = dotProduct(&xf[0], &hf[0], n);
+        EXPECT_TRUE(FloatsEqual(expected.real(), resultD.real()));
+        EXPECT_TRUE(FloatsEqual(expected.imag(), resultD.imag()));
+        EXPECT_TRUE(FloatsClose(expected.real(), resultF.real()));
+        EXPECT_TRUE(FloatsClose(expected.imag(), resultF.imag()));
+    }
+}
+
+TEST(SimdKernels, ComplexDotProduct) {
+    std::vector< std::complex<float> > xf(37), hf(37);
+    std::vector< std::complex<double> > xd(37), hd(37);
+    for (unsigned i=0; i<xf.size(); i++) {
+        xd[i] = xf[i] = std::complex<float>((float) std::sin(0.3 * i), (float) std::cos(1.1 * i));
+        hd[i] = hf[i] = std::complex<float>((float) std::cos(0.7 * i), (float) std::sin(0.2 * i));
+    }
+    for (int n=0; n<=(int)xf.size(); n++) {
+        std::complex<double> expected = 0;
+        for (int i=0; i<n; i++) {
+            expected += xd[i] * hd[i];
+        }
+        std::complex<double> resultD = dotProduct(&xd[0], &hd[0], n);
+        std::complex<float> resultF = dotProduct(&xf[0], &hf[0], n);
+        EXPECT_TRUE(FloatsEqual(expected.real(), resultD.real()));
+        EXPECT_TRUE(FloatsEqual(expected.imag(), resultD.imag()));
+        EXPECT_TRUE(FloatsClose(expected.real(), resultF.real()));
+        EXPECT_TRUE(FloatsClose(expected.imag(), resultF.imag()));
+    }
+}
+
+TEST(SimdKernels, IntegerDotProduct) {
+    int x[] = {1, -2, 3, -4, 5, -6, 7};
+    int h[] = {7, 6, 5, 4, 3, 2, 1};
+    EXPECT_EQ(7 - 12 + 15 - 16 + 15 - 12 + 7, dotProduct(x, h, 7));
+}
+
+TEST(SimdKernels, FoldedDotProduct) {
+    std::vector<float> xf(41), hf(41);
+    std::vector<double> xd(41), hd(41);
+    std::vector< std::complex<float> > cxf(41);
+    std::vector< std::complex<double> > cxd(41);
+    for (unsigned i=0; i<xf.size(); i++) {
+        xd[i] = xf[i] = (float) std::sin(0.3 * i);
+        cxd[i] = cxf[i] = std::complex<float>((float) std::cos(0.9 * i), (float) std::sin(1.3 * i));
+    }
+    for (int n=0; n<=(int)xf.size(); n++) {
+        for (int antisymmetric=0; antisymmetric<2; antisymmetric++) {
+            for (int i=0; i<n; i++) {
+                hd[i] = hf[i] = (float) std::cos(0.7 * std::min(i, n - 1 - i)) *
+                                  ((antisymmetric && i >= n/2) ? -1 : 1);
+            }
+            if (antisymmetric && n % 2) {
+                hd[n/2] = hf[n/2] = 0;
+            }
+            
+            double expected = 0;
+            std::complex<double> complexExpected = 0;
+            for (int i=0; i<n; i++) {
+                expected += xd[i] * hd[i];
+                complexExpected += cxd[i] * hd[i];
+            }
+            EXPECT_TRUE(FloatsEqual(expected, foldedDotProduct(&xd[0], &hd[0], n, antisymmetric)));
+            EXPECT_TRUE(FloatsClose(expected, foldedDotProduct(&xf[0], &hf[0], n, antisymmetric)));
+            std::complex<double> resultD = foldedDotProduct(&cxd[0], &hd[0], n, antisymmetric);
+            std::complex<float> resultF = foldedDotProduct(&cxf[0], &hf[0], n, antisymmetric);
+            EXPECT_TRUE(FloatsEqual(complexExpected.real(), resultD.real()));
+            EXPECT_TRUE(FloatsEqual(complexExpected.imag(), resultD.imag()));
+            EXPECT_TRUE(FloatsClose(complexExpected.real(), resultF.real()));
+            EXPECT_TRUE(FloatsClose(complexExpected.imag(), resultF.imag()));
+            
+            std::vector< std::complex<double> > complexTaps(n + 1);
+            std::complex<double> complexTapsExpected = 0;
+            for (int i=0; i<n; i++) {
+                complexTaps[i] = hd[i] * std::complex<double>(1, -0.5);
+                complexTapsExpected += cxd[i] * complexTaps[i];
+            }
+            resultD = foldedDotProduct(&cxd[0], &complexTaps[0], n, antisymmetric);
+            EXPECT_TRUE(FloatsEqual(complexTapsExpected.real(), resultD.real()));
+            EXPECT_TRUE(FloatsEqual(complexTapsExpected.imag(), resultD.imag()));
+        }
+    }
+}
+
+TEST(SimdKernels, DetectTapSymmetry) {
+    double symmetricOdd[] = {1, 2, 3, 2, 1};
+    double symmetricEven[] = {1, 2, 2, 1};
+    double antisymmetricOdd[] = {1, -2, 0, 2, -1};
+    double antisymmetricEven[] = {1, 2, -2, -1};
+    double neither[] = {1, 2, 3, 2, 1.5};
+    double oddWithMiddle[] = {1, 2, 3, -2, -1};
+    std::complex<double> complexSymmetric[] = {std::complex<double>(1, 2), std::complex<double>(0, 1),
+                                              std::complex<double>(1, 2)};
+    
+    EXPECT_EQ(SYMMETRIC_TAPS, detectTapSymmetry(symmetricOdd, 5));
+    EXPECT_EQ(SYMMETRIC_TAPS, detectTapSymmetry(symmetricEven, 4));
+    EXPECT_EQ(ANTISYMMETRIC_TAPS, detectTapSymmetry(antisymmetricOdd, 5));
+    EXPECT_EQ(ANTISYMMETRIC_TAPS, detectTapSymmetry(antisymmetricEven, 4));
+    EXPECT_EQ(NO_SYMMETRY, detectTapSymmetry(neither, 5));
+    EXPECT_EQ(NO_SYMMETRY, detectTapSymmetry(oddWithMiddle, 5));
+    EXPECT_EQ(NO_SYMMETRY, detectTapSymmetry(neither, 0));
+    EXPECT_EQ(SYMMETRIC_TAPS, detectTapSymmetry(complexSymmetric, 3));
+}
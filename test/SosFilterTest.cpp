@@ -0,0 +1,236 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SosFilter.h"
+#include "RealIirFilter.h"
+#include "ComplexVector.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+
+// Three sections: zeros at -1, on the unit circle and at 0.5; poles at .9, .95 and .5 radius.
+static double sosData[] = {0.25, 0.5, 0.25, 1.0, -1.5590, 0.8100,
+                           1.0, 0.8323, 1.0, 2.0, -2.1987, 1.8050,
+                           1.0, -0.5, 0.0, 1.0, -0.5, 0.0};
+static unsigned numSections = 3;
+
+static std::vector<double> PolyMultiply(const std::vector<double> & a, const double *b, unsigned bLen) {
+    std::vector<double> result(a.size() + bLen - 1);
+    for (unsigned i=0; i<a.size(); i++) {
+        for (unsigned j=0; j<bLen; j++) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+    return result;
+}
+
+TEST(SosFilter, ConstructorSize) {
+    SosFilter<double> filt(4);
+    
+    EXPECT_EQ(4, filt.numSections());
+    EXPECT_EQ(4 * SOS_COEFS_PER_SECTION, filt.coefs.size());
+    
+    double inputData[] = {1, 2, 3, 4};
+	NimbleDSP::Vector<double> buf(inputData, 4);
+    filter(buf, filt);
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_EQ(inputData[i], buf[i]);
+    }
+}
+
+TEST(SosFilter, MatchesCascade) {
+    NimbleDSP::SosFilter<double> filt(sosData, numSections);
+    EXPECT_EQ(numSections, filt.numSections());
+    
+    NimbleDSP::Vector<double> buf(200);
+    buf[0] = 1;
+    NimbleDSP::Vector<double> expected = buf;
+    filter(buf, filt);
+    for (unsigned section=0; section<numSections; section++) {
+        NimbleDSP::RealIirFilter<double> stage(sosData + 6*section, 3, sosData + 6*section + 3, 3);
+        for (unsigned i=0; i<3; i++) {
+            stage.numerator[i] /= sosData[6*section + 3];
+            stage.denominator[i] /= sosData[6*section + 3];
+        }
+        filter(expected, stage);
+    }
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], buf[i]));
+    }
+}
+
+TEST(SosFilter, Streaming) {
+    NimbleDSP::SosFilter<double> oneBlock(sosData, numSections);
+    NimbleDSP::SosFilter<double> streaming(sosData, numSections);
+    unsigned blockSizes[] = {1, 7, 30, 2};
+    
+    NimbleDSP::Vector<double> expected(40);
+    for (unsigned i=0; i<expected.size(); i++) {
+        expected[i] = std::sin(0.3 * i) + 1;
+    }
+    NimbleDSP::Vector<double> input = expected;
+    filter(expected, oneBlock);
+    
+    unsigned offset = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        NimbleDSP::Vector<double> buf(VECTOR_TO_ARRAY(input.vec) + offset, blockSizes[block]);
+        filter(buf, streaming);
+        for (unsigned i=0; i<buf.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[offset + i], buf[i]));
+        }
+        offset += blockSizes[block];
+    }
+    
+    streaming.reset();
+    EXPECT_TRUE(FloatsEqual(expected[0], streaming.filterSample(input[0])));
+    EXPECT_TRUE(FloatsEqual(expected[1], streaming.filterSample(input[1])));
+}
+
+TEST(SosFilter, TransferFunction) {
+    std::vector<double> num(1, 1.0), den(1, 1.0);
+    for (unsigned section=0; section<numSections; section++) {
+        num = PolyMultiply(num, sosData + 6*section, 3);
+        den = PolyMultiply(den, sosData + 6*section + 3, 3);
+    }
+    NimbleDSP::SosFilter<double> reference(sosData, numSections);
+    NimbleDSP::SosFilter<double> converted(num, den);
+    EXPECT_EQ(numSections, converted.numSections());
+    
+    NimbleDSP::Vector<double> buf(300);
+    buf[0] = 1;
+    NimbleDSP::Vector<double> expected = buf;
+    filter(expected, reference);
+    filter(buf, converted);
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], buf[i]));
+    }
+}
+
+TEST(SosFilter, FromRealIirFilter) {
+    double num[] = {0, 0, 0.5, 0.25};
+    double den[] = {1, -0.5, 0.06};
+    NimbleDSP::RealIirFilter<double> polyFilter(num, 4, den, 3);
+    NimbleDSP::SosFilter<double> filt(polyFilter);
+    
+    NimbleDSP::Vector<double> buf(50);
+    for (unsigned i=0; i<buf.size(); i++) {
+        buf[i] = (i % 5) - 2.0;
+    }
+    NimbleDSP::Vector<double> expected = buf;
+    filter(expected, polyFilter);
+    filter(buf, filt);
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], buf[i]));
+    }
+}
+
+TEST(SosFilter, HighOrder) {
+    // 12th order: six pole pairs at radius .97 spread across the band, zeros on the unit circle.
+    std::vector<double> num(1, 1.0), den(1, 1.0);
+    std::vector<double> sos;
+    for (int i=0; i<6; i++) {
+        double poleAngle = 0.2 + 0.1 * i;
+        double zeroAngle = 1.5 + 0.25 * i;
+        double b[] = {1.0, -2 * std::cos(zeroAngle), 1.0};
+        double a[] = {1.0, -2 * 0.97 * std::cos(poleAngle), 0.97 * 0.97};
+        num = PolyMultiply(num, b, 3);
+        den = PolyMultiply(den, a, 3);
+        sos.insert(sos.end(), b, b + 3);
+        sos.insert(sos.end(), a, a + 3);
+    }
+    NimbleDSP::SosFilter<double> reference(VECTOR_TO_ARRAY(sos), 6);
+    NimbleDSP::SosFilter<double> converted(num, den);
+    
+    NimbleDSP::Vector<double> buf(500);
+    buf[0] = 1;
+    NimbleDSP::Vector<double> expected = buf;
+    filter(expected, reference);
+    filter(buf, converted);
+    
+    // The peak gain is around 4e7 and the 12th order polynomial only pins its roots down to about
+    // 1e-8, so compare relative to the largest output.
+    double maxVal = 0;
+    for (unsigned i=0; i<expected.size(); i++) {
+        maxVal = std::max(maxVal, std::fabs(expected[i]));
+    }
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(std::fabs(expected[i] - buf[i]) < 1e-6 * maxVal);
+    }
+}
+
+TEST(SosFilter, ComplexData) {
+    NimbleDSP::SosFilter<double> filt(sosData, numSections);
+    NimbleDSP::SosFilter<double> realFilt(sosData, numSections);
+    NimbleDSP::SosFilter<double> imagFilt(sosData, numSections);
+    
+    NimbleDSP::ComplexVector<double> buf(60);
+    NimbleDSP::Vector<double> re(60), im(60);
+    for (unsigned i=0; i<buf.size(); i++) {
+        re[i] = std::cos(0.2 * i);
+        im[i] = (i % 3) - 1.0;
+        buf[i] = std::complex<double>(re[i], im[i]);
+    }
+    filter(buf, filt);
+    filter(re, realFilt);
+    filter(im, imagFilt);
+    for (unsigned i=0; i<buf.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(re[i], buf[i].real()));
+        EXPECT_TRUE(FloatsEqual(im[i], buf[i].imag()));
+    }
+}
+
+TEST(SosFilter, PipelinedSectionCounts) {
+    // Enough sections for a full pipeline group plus each size of partial group, streamed in
+    // blocks shorter than, equal to and longer than a group.
+    unsigned blockSizes[] = {1, 2, 0, 3, 4, 5, 37, 1, 64};
+    for (unsigned numStages=1; numStages<=9; numStages++) {
+        std::vector<double> sos;
+        for (unsigned section=0; section<numStages; section++) {
+            double radius = 0.5 + 0.05 * section;
+            double angle = 0.3 + 0.2 * section;
+            double coefs[] = {0.3, 0.1 * section, -0.2, 1.0, -2 * radius * std::cos(angle), radius * radius};
+            sos.insert(sos.end(), coefs, coefs + 6);
+        }
+        SosFilter<double> blockFilter(VECTOR_TO_ARRAY(sos), numStages);
+        SosFilter<double> sampleFilter(VECTOR_TO_ARRAY(sos), numStages);
+        
+        unsigned offset = 0;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            NimbleDSP::Vector<double> buf(blockSizes[b]);
+            for (unsigned i=0; i<buf.size(); i++) {
+                buf[i] = std::sin(0.37 * (offset + i)) + ((offset + i) % 5 == 0);
+            }
+            NimbleDSP::Vector<double> expected = buf;
+            for (unsigned i=0; i<expected.size(); i++) {
+                expected[i] = sampleFilter.filterSample(expected[i]);
+            }
+            filter(buf, blockFilter);
+            for (unsigned i=0; i<buf.size(); i++) {
+                EXPECT_TRUE(FloatsEqual(expected[i], buf[i]));
+            }
+            offset += buf.size();
+        }
+    }
+}
@@ -0,0 +1,210 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SpectralEstimator.h"
+#include "gtest/gtest.h"
+#include <cstdlib>
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static std::vector<double> NoiseSignal(unsigned len) {
+    std::vector<double> signal(len);
+    for (unsigned i=0; i<len; i++) {
+        signal[i] = (double) rand() / RAND_MAX - 0.5 + std::sin(0.3 * i);
+    }
+    return signal;
+}
+
+// Windowed DFT of the frame starting at "start", by brute force.
+static std::vector< std::complex<double> > FrameSpectrum(const std::vector<double> & signal, unsigned start,
+                                                         const RealVector<double> & window) {
+    unsigned size = window.size();
+    std::vector< std::complex<double> > spectrum(size / 2 + 1);
+    for (unsigned k=0; k<spectrum.size(); k++) {
+        for (unsigned n=0; n<size; n++) {
+            spectrum[k] += signal[start + n] * window[n] * std::polar(1.0, -2 * M_PI * k * n / size);
+        }
+    }
+    return spectrum;
+}
+
+static double WindowPower(const RealVector<double> & window) {
+    double power = 0;
+    for (unsigned n=0; n<window.size(); n++) {
+        power += window[n] * window[n];
+    }
+    return power;
+}
+
+
+TEST(SpectralEstimator, Windows) {
+    SpectralEstimator<double> hann(8, 4);
+    double expectedHann[] = {0, 0.1464466094067262, 0.5, 0.8535533905932737, 1, 0.8535533905932737, 0.5, 0.1464466094067262};
+    EXPECT_EQ(8, hann.fftSize());
+    EXPECT_EQ(5, hann.numBins());
+    for (unsigned n=0; n<8; n++) {
+        EXPECT_TRUE(FloatsEqual(expectedHann[n], hann.window()[n]));
+    }
+    
+    SpectralEstimator<double> rect(4, 4, RECTANGULAR_WINDOW);
+    SpectralEstimator<double> hamming(4, 4, HAMMING_WINDOW);
+    SpectralEstimator<double> blackman(4, 4, BLACKMAN_WINDOW);
+    double expectedHamming[] = {0.08, 0.54, 1, 0.54};
+    double expectedBlackman[] = {0, 0.34, 1, 0.34};
+    for (unsigned n=0; n<4; n++) {
+        EXPECT_EQ(1, rect.window()[n]);
+        EXPECT_TRUE(FloatsEqual(expectedHamming[n], hamming.window()[n]));
+        EXPECT_TRUE(FloatsEqual(expectedBlackman[n], blackman.window()[n]));
+    }
+}
+
+TEST(SpectralEstimator, StftStreaming) {
+    srand(21);
+    unsigned sizes[] = {16, 15, 8};
+    unsigned hops[] = {5, 15, 12};
+    unsigned blockSizes[] = {3, 40, 1, 17, 120};
+    std::vector<double> signal = NoiseSignal(181);
+    
+    for (unsigned s=0; s<3; s++) {
+        SpectralEstimator<double> estimator(sizes[s], hops[s], BLACKMAN_WINDOW);
+        unsigned start = 0, frame = 0;
+        for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+            RealVector<double> block(std::vector<double>(signal.begin() + start, signal.begin() + start + blockSizes[b]));
+            ComplexVector<double> frames;
+            unsigned numFrames = stft(block, frames, estimator);
+            EXPECT_EQ(numFrames * estimator.numBins(), frames.size());
+            for (unsigned f=0; f<numFrames; f++, frame++) {
+                std::vector< std::complex<double> > expected = FrameSpectrum(signal, frame * hops[s], estimator.window());
+                for (unsigned k=0; k<expected.size(); k++) {
+                    EXPECT_TRUE(ComplexEqual(expected[k], frames[f * estimator.numBins() + k]));
+                }
+            }
+            start += blockSizes[b];
+        }
+        EXPECT_EQ((signal.size() - sizes[s]) / hops[s] + 1, frame);
+    }
+}
+
+TEST(SpectralEstimator, SpectrogramAndWelch) {
+    srand(22);
+    const unsigned size = 32, hop = 16;
+    const double sampleRate = 1000;
+    std::vector<double> signal = NoiseSignal(400);
+    SpectralEstimator<double> welchEstimator(size, hop, HANN_WINDOW, sampleRate);
+    SpectralEstimator<double> specEstimator(size, hop, HANN_WINDOW, sampleRate);
+    double scale = 1 / (sampleRate * WindowPower(welchEstimator.window()));
+    
+    RealVector<double> first(std::vector<double>(signal.begin(), signal.begin() + 150));
+    RealVector<double> second(std::vector<double>(signal.begin() + 150, signal.end()));
+    RealVector<double> frames1, frames2;
+    unsigned numFrames = spectrogram(first, frames1, specEstimator);
+    numFrames += spectrogram(second, frames2, specEstimator);
+    EXPECT_EQ(welch(first, welchEstimator) + welch(second, welchEstimator), numFrames);
+    EXPECT_EQ(numFrames, welchEstimator.numAveraged());
+    frames1.vec.insert(frames1.vec.end(), frames2.vec.begin(), frames2.vec.end());
+    
+    std::vector<double> expectedPsd(size / 2 + 1);
+    for (unsigned f=0; f<numFrames; f++) {
+        std::vector< std::complex<double> > spectrum = FrameSpectrum(signal, f * hop, welchEstimator.window());
+        for (unsigned k=0; k<spectrum.size(); k++) {
+            double power = std::norm(spectrum[k]) * scale * ((k == 0 || k == size / 2) ? 1 : 2);
+            EXPECT_TRUE(FloatsEqual(power, frames1[f * spectrum.size() + k]));
+            expectedPsd[k] += power / numFrames;
+        }
+    }
+    RealVector<double> psd;
+    welchEstimator.psd(psd);
+    EXPECT_EQ(size / 2 + 1, psd.size());
+    for (unsigned k=0; k<psd.size(); k++) {
+        EXPECT_TRUE(FloatsEqual(expectedPsd[k], psd[k]));
+    }
+}
+
+TEST(SpectralEstimator, PsdScaling) {
+    // The density of a sinusoid summed over the bins, times the bin spacing, is its power.
+    const unsigned size = 64;
+    const double sampleRate = 8000, amplitude = 3;
+    SpectralEstimator<float> estimator(size, size / 4, HANN_WINDOW, (float) sampleRate);
+    RealVector<float> data(1024);
+    for (unsigned n=0; n<data.size(); n++) {
+        data[n] = (float) (amplitude * std::cos(2 * M_PI * 10 * n / size + 0.3));
+    }
+    welch(data, estimator);
+    RealVector<float> psd;
+    estimator.psd(psd);
+    double power = 0;
+    for (unsigned k=0; k<psd.size(); k++) {
+        power += psd[k] * sampleRate / size;
+    }
+    EXPECT_NEAR(amplitude * amplitude / 2, power, 1e-4);
+    EXPECT_GT(psd[10], 100 * psd[5]);
+}
+
+TEST(SpectralEstimator, Averaging) {
+    const unsigned size = 4;
+    SpectralEstimator<double> estimator(size, size, RECTANGULAR_WINDOW);
+    double levels[] = {1, 3, 2};
+    
+    estimator.averaging = PEAK_HOLD;
+    for (unsigned i=0; i<3; i++) {
+        estimator.welch(RealVector<double>(std::vector<double>(size, levels[i])));
+    }
+    RealVector<double> psd;
+    estimator.psd(psd);
+    // DC bin of a constant c frame is (4c)^2 / 4.
+    EXPECT_TRUE(FloatsEqual(9 * size, psd[0]));
+    
+    estimator.resetAverage();
+    estimator.averaging = EXPONENTIAL_AVERAGING;
+    estimator.exponentialWeight = 0.5;
+    for (unsigned i=0; i<3; i++) {
+        estimator.welch(RealVector<double>(std::vector<double>(size, levels[i])));
+    }
+    estimator.psd(psd);
+    EXPECT_TRUE(FloatsEqual(size * (0.5 * (0.5 * 1 + 0.5 * 9) + 0.5 * 4), psd[0]));
+    EXPECT_EQ(3, estimator.numAveraged());
+    
+    estimator.reset();
+    EXPECT_EQ(0, estimator.numAveraged());
+}
+
+TEST(SpectralEstimator, HopLongerThanFrame) {
+    srand(23);
+    std::vector<double> signal = NoiseSignal(100);
+    SpectralEstimator<double> estimator(6, 10, HAMMING_WINDOW);
+    unsigned frame = 0;
+    for (unsigned start=0; start<signal.size(); start+=7) {
+        unsigned len = std::min(7u, (unsigned) signal.size() - start);
+        ComplexVector<double> frames;
+        unsigned numFrames = estimator.stft(RealVector<double>(std::vector<double>(signal.begin() + start, signal.begin() + start + len)), frames);
+        for (unsigned f=0; f<numFrames; f++, frame++) {
+            std::vector< std::complex<double> > expected = FrameSpectrum(signal, frame * 10, estimator.window());
+            for (unsigned k=0; k<expected.size(); k++) {
+                EXPECT_TRUE(ComplexEqual(expected[k], frames[f * 4 + k]));
+            }
+        }
+    }
+    EXPECT_EQ(10, frame);
+}
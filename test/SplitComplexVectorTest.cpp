@@ -0,0 +1,180 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "SplitComplexVector.h"
+#include "RealFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static ComplexVector<double> TestSignal(unsigned len, unsigned offset = 0) {
+    ComplexVector<double> signal(len);
+    for (unsigned n=0; n<len; n++) {
+        signal[n] = std::complex<double>(std::cos(0.11 * (n + offset)) + 0.3, std::sin(0.53 * (n + offset)) - 0.7);
+    }
+    return signal;
+}
+
+static void ExpectSame(const ComplexVector<double> & expected, const SplitComplexVector<double> & actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    ASSERT_EQ(actual.re.size(), actual.im.size());
+    for (unsigned n=0; n<expected.size(); n++) {
+        EXPECT_TRUE(ComplexEqual(expected[n], actual[n]));
+    }
+}
+
+TEST(SplitComplexVector, Conversion) {
+    ComplexVector<double> data = TestSignal(37);
+    SplitComplexVector<double> split(data);
+    ExpectSame(data, split);
+    for (unsigned n=0; n<data.size(); n++) {
+        EXPECT_EQ(data[n].real(), split.re[n]);
+        EXPECT_EQ(data[n].imag(), split.im[n]);
+    }
+
+    ComplexVector<double> back;
+    split.interleave(back);
+    ExpectSame(back, split);
+
+    SplitComplexVector<double> fromParts(split.re, split.im);
+    ExpectSame(data, fromParts);
+
+    SplitComplexVector<double> zeros(5);
+    EXPECT_EQ(5, zeros.size());
+    zeros.set(2, std::complex<double>(1, -2));
+    EXPECT_TRUE(ComplexEqual(std::complex<double>(1, -2), zeros[2]));
+    zeros.resize(8);
+    EXPECT_TRUE(ComplexEqual(std::complex<double>(0, 0), zeros[7]));
+}
+
+TEST(SplitComplexVector, ElementWise) {
+    ComplexVector<double> a = TestSignal(41), b = TestSignal(41, 100);
+    SplitComplexVector<double> splitA(a), splitB(b);
+
+    ComplexVector<double> expected = a;
+    SplitComplexVector<double> actual = splitA;
+    expected += b;
+    actual += splitB;
+    ExpectSame(expected, actual);
+
+    expected -= a;
+    actual -= splitA;
+    ExpectSame(expected, actual);
+
+    expected *= a;
+    actual *= splitA;
+    ExpectSame(expected, actual);
+
+    expected *= std::complex<double>(0.5, -1.5);
+    actual *= std::complex<double>(0.5, -1.5);
+    ExpectSame(expected, actual);
+
+    for (unsigned n=0; n<expected.size(); n++) {
+        expected[n] *= 3.0;
+    }
+    actual *= 3.0;
+    ExpectSame(expected, actual);
+
+    conj(expected);
+    conj(actual);
+    ExpectSame(expected, actual);
+
+    ComplexVector<double> phases = expected;
+    SplitComplexVector<double> splitPhases = actual;
+    angle(phases);
+    angle(splitPhases);
+    ExpectSame(phases, splitPhases);
+    phases = expected;
+    splitPhases = actual;
+    angle(phases, FAST_MATH);
+    angle(splitPhases, FAST_MATH);
+    for (unsigned n=0; n<phases.size(); n++) {
+        EXPECT_NEAR(phases[n].real(), splitPhases.re[n], 1e-7);
+        EXPECT_EQ(0, splitPhases.im[n]);
+    }
+
+    magSq(expected);
+    magSq(actual);
+    ExpectSame(expected, actual);
+}
+
+TEST(SplitComplexVector, Modulate) {
+    ComplexVector<double> expected = TestSignal(30);
+    SplitComplexVector<double> actual(expected);
+    double expectedPhase = expected.modulate(0.13, 1.0, 0.4);
+    double actualPhase = modulate(actual, 0.13, 1.0, 0.4);
+    // The Nco's phase wraps to [0, 2*pi).
+    EXPECT_TRUE(FloatsEqual(std::fmod(expectedPhase, 2 * M_PI), actualPhase));
+    ExpectSame(expected, actual);
+
+    // A stream mixed a block at a time by one Nco.
+    ComplexVector<double> whole = TestSignal(60);
+    ComplexVector<double> firstExpected = TestSignal(30), secondExpected = TestSignal(30, 30);
+    SplitComplexVector<double> first(firstExpected), second(secondExpected);
+    Nco<double> wholeNco(-0.21, 1.0, 1.1), blockNco(-0.21, 1.0, 1.1);
+    modulate(whole, wholeNco);
+    modulate(first, blockNco);
+    modulate(second, blockNco);
+    for (unsigned n=0; n<30; n++) {
+        firstExpected[n] = whole[n];
+        secondExpected[n] = whole[n + 30];
+    }
+    ExpectSame(firstExpected, first);
+    ExpectSame(secondExpected, second);
+    EXPECT_TRUE(FloatsEqual(wholeNco.getPhase(), blockNco.getPhase()));
+}
+
+static void CompareConv(unsigned numTaps, FilterOperationType operation) {
+    std::vector<double> taps(numTaps);
+    for (unsigned i=0; i<numTaps; i++) {
+        taps[i] = std::sin(0.37 * i + 0.1) / (i + 1);
+    }
+    RealFirFilter<double> complexFilter(taps, operation);
+    RealFirFilter<double> splitFilter(taps, operation);
+
+    unsigned blockSizes[] = {17, 1, 300, 3, 64};
+    unsigned offset = 0;
+    for (unsigned block=0; block<sizeof(blockSizes)/sizeof(blockSizes[0]); block++) {
+        ComplexVector<double> expected = TestSignal(blockSizes[block], offset);
+        SplitComplexVector<double> actual(expected);
+        offset += blockSizes[block];
+
+        complexFilter.convComplex(expected);
+        conv(actual, splitFilter);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (unsigned n=0; n<expected.size(); n++) {
+            EXPECT_LT(std::abs(expected[n] - actual[n]), 1e-9);
+        }
+    }
+}
+
+TEST(SplitComplexVector, RealFirFilterConv) {
+    CompareConv(7, STREAMING);
+    CompareConv(100, STREAMING);
+    CompareConv(7, ONE_SHOT_RETURN_ALL_RESULTS);
+    CompareConv(100, ONE_SHOT_RETURN_ALL_RESULTS);
+    CompareConv(8, ONE_SHOT_TRIM_TAILS);
+    CompareConv(101, ONE_SHOT_TRIM_TAILS);
+}
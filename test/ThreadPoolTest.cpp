@@ -0,0 +1,221 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "ThreadPool.h"
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "RealFirFilter.h"
+#include "ComplexFirFilter.h"
+#include <atomic>
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+static RealVector<double> TestSignal(unsigned len) {
+    RealVector<double> signal(len);
+    for (unsigned i=0; i<len; i++) {
+        signal[i] = std::sin(0.01 * i) + 0.001 * (i % 17);
+    }
+    return signal;
+}
+
+static ComplexVector<double> ComplexTestSignal(unsigned len) {
+    ComplexVector<double> signal(len);
+    for (unsigned i=0; i<len; i++) {
+        signal[i] = std::complex<double>(std::sin(0.01 * i), std::cos(0.03 * i) - 0.002 * (i % 5));
+    }
+    return signal;
+}
+
+static RealVector<double> TestTaps(unsigned len) {
+    RealVector<double> taps(len);
+    for (unsigned i=0; i<len; i++) {
+        taps[i] = 1.0 / (1 + i) - 0.01 * i;
+    }
+    return taps;
+}
+
+static void ExpectEqual(RealVector<double> & expected, RealVector<double> & actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], actual[i]));
+    }
+}
+
+static void ExpectEqual(ComplexVector<double> & expected, ComplexVector<double> & actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (unsigned i=0; i<expected.size(); i++) {
+        EXPECT_TRUE(ComplexEqual(expected[i], actual[i]));
+    }
+}
+
+
+TEST(ThreadPool, ParallelForCoversRange) {
+    ThreadPool pool(4);
+    EXPECT_EQ(4, pool.size());
+    
+    std::vector<int> hits(1000, 0);
+    pool.parallelFor(0, hits.size(), 1, [&hits](int first, int last) {
+        for (int i=first; i<last; i++) {
+            hits[i]++;
+        }
+    });
+    for (unsigned i=0; i<hits.size(); i++) {
+        EXPECT_EQ(1, hits[i]);
+    }
+    
+    // Ranges too short to be worth splitting are run by the caller in one piece.
+    int calls = 0;
+    pool.parallelFor(10, 20, 100, [&calls](int first, int last) {
+        EXPECT_EQ(10, first);
+        EXPECT_EQ(20, last);
+        calls++;
+    });
+    EXPECT_EQ(1, calls);
+    
+    calls = 0;
+    parallelFor(NULL, 5, 9, 1, [&calls](int first, int last) {
+        EXPECT_EQ(5, first);
+        EXPECT_EQ(9, last);
+        calls++;
+    });
+    EXPECT_EQ(1, calls);
+}
+
+TEST(ThreadPool, NestedParallelFor) {
+    ThreadPool pool(3);
+    std::atomic<int> total(0);
+    pool.parallelFor(0, 6, 1, [&pool, &total](int first, int last) {
+        for (int i=first; i<last; i++) {
+            pool.parallelFor(0, 100, 1, [&total](int innerFirst, int innerLast) {
+                total += innerLast - innerFirst;
+            });
+        }
+    });
+    EXPECT_EQ(600, total.load());
+}
+
+TEST(ThreadPool, RealVectorOneShot) {
+    ThreadPool pool(4);
+    unsigned dataLens[] = {5, 40, 20000};
+    for (unsigned d=0; d<sizeof(dataLens)/sizeof(dataLens[0]); d++) {
+        for (int trim=0; trim<2; trim++) {
+            RealVector<double> serialFilter = TestTaps(31);
+            RealVector<double> parallelFilter = TestTaps(31);
+            parallelFilter.threadPool = &pool;
+            
+            RealVector<double> expected = TestSignal(dataLens[d]);
+            RealVector<double> actual = TestSignal(dataLens[d]);
+            conv(expected, serialFilter, trim);
+            conv(actual, parallelFilter, trim);
+            ExpectEqual(expected, actual);
+            if (!trim) {
+                RealVector<double> signal = TestSignal(dataLens[d]);
+                for (unsigned n=0; n<actual.size(); n+=97) {
+                    double sum = 0;
+                    for (unsigned k=0; k<serialFilter.size(); k++) {
+                        if (n >= k && n - k < signal.size()) {
+                            sum += serialFilter[k] * signal[n - k];
+                        }
+                    }
+                    EXPECT_TRUE(FloatsEqual(sum, actual[n]));
+                }
+            }
+            
+            expected = TestSignal(dataLens[d]);
+            actual = TestSignal(dataLens[d]);
+            decimate(expected, 3, serialFilter, trim);
+            decimate(actual, 3, parallelFilter, trim);
+            ExpectEqual(expected, actual);
+            
+            expected = TestSignal(dataLens[d]);
+            actual = TestSignal(dataLens[d]);
+            interp(expected, 4, serialFilter, trim);
+            interp(actual, 4, parallelFilter, trim);
+            ExpectEqual(expected, actual);
+            
+            expected = TestSignal(dataLens[d]);
+            actual = TestSignal(dataLens[d]);
+            resample(expected, 5, 3, serialFilter, trim);
+            resample(actual, 5, 3, parallelFilter, trim);
+            ExpectEqual(expected, actual);
+            
+            ComplexVector<double> complexExpected = ComplexTestSignal(dataLens[d]);
+            ComplexVector<double> complexActual = ComplexTestSignal(dataLens[d]);
+            resample(complexExpected, 3, 7, serialFilter, trim);
+            resample(complexActual, 3, 7, parallelFilter, trim);
+            ExpectEqual(complexExpected, complexActual);
+        }
+    }
+}
+
+TEST(ThreadPool, FirFilterOneShot) {
+    ThreadPool pool(4);
+    unsigned dataLens[] = {7, 20000};
+    for (unsigned d=0; d<sizeof(dataLens)/sizeof(dataLens[0]); d++) {
+        for (int trim=0; trim<2; trim++) {
+            FilterOperationType operation = trim ? ONE_SHOT_TRIM_TAILS : ONE_SHOT_RETURN_ALL_RESULTS;
+            RealVector<double> taps = TestTaps(25);
+            RealFirFilter<double> serialFilter(taps.vec, operation);
+            RealFirFilter<double> parallelFilter(taps.vec, operation);
+            parallelFilter.threadPool = &pool;
+            serialFilter.convAlgorithm = DIRECT_CONVOLUTION;
+            parallelFilter.convAlgorithm = DIRECT_CONVOLUTION;
+            
+            RealVector<double> expected = TestSignal(dataLens[d]);
+            RealVector<double> actual = TestSignal(dataLens[d]);
+            decimate(expected, 4, serialFilter, trim);
+            decimate(actual, 4, parallelFilter, trim);
+            ExpectEqual(expected, actual);
+            
+            expected = TestSignal(dataLens[d]);
+            actual = TestSignal(dataLens[d]);
+            interp(expected, 3, serialFilter, trim);
+            interp(actual, 3, parallelFilter, trim);
+            ExpectEqual(expected, actual);
+            
+            ComplexVector<double> complexExpected = ComplexTestSignal(dataLens[d]);
+            ComplexVector<double> complexActual = ComplexTestSignal(dataLens[d]);
+            conv(complexExpected, serialFilter, trim);
+            conv(complexActual, parallelFilter, trim);
+            ExpectEqual(complexExpected, complexActual);
+            
+            std::vector< std::complex<double> > complexTaps(taps.size());
+            for (unsigned i=0; i<taps.size(); i++) {
+                complexTaps[i] = std::complex<double>(taps[i], -0.5 * taps[i]);
+            }
+            ComplexFirFilter<double> serialComplexFilter(complexTaps, operation);
+            ComplexFirFilter<double> parallelComplexFilter(complexTaps, operation);
+            parallelComplexFilter.threadPool = &pool;
+            
+            complexExpected = ComplexTestSignal(dataLens[d]);
+            complexActual = ComplexTestSignal(dataLens[d]);
+            resample(complexExpected, 2, 3, serialComplexFilter, trim);
+            resample(complexActual, 2, 3, parallelComplexFilter, trim);
+            ExpectEqual(complexExpected, complexActual);
+        }
+    }
+}
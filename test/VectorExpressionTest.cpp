@@ -0,0 +1,121 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "RealVector.h"
+#include "ComplexVector.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+
+TEST(VectorExpression, Arithmetic) {
+    double inputData[] = {1, 3, 5, 7.12, 2, 4, 6, 8};
+    double inputData2[] = {-2, 0.5, 1, 4, -3, 2, 9, 0.25};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+	RealVector<double> buf1(inputData, numElements);
+	RealVector<double> buf2(inputData2, numElements);
+    
+	RealVector<double> result = lazy(buf1) * 2.0 + buf2 / lazy(buf1) - 1;
+    EXPECT_EQ(numElements, result.size());
+    for (unsigned i=0; i<numElements; i++) {
+        EXPECT_TRUE(FloatsEqual(inputData[i] * 2 + inputData2[i] / inputData[i] - 1, result[i]));
+    }
+    
+    result = 3.0 - lazy(buf1) * lazy(buf2);
+    for (unsigned i=0; i<numElements; i++) {
+        EXPECT_TRUE(FloatsEqual(3 - inputData[i] * inputData2[i], result[i]));
+    }
+    
+    EXPECT_TRUE(FloatsEqual(buf1.sum() * 2, sum(lazy(buf1) * 2)));
+}
+
+TEST(VectorExpression, Functions) {
+    double inputData[] = {1, -3, 5, 7.12, -2, 4, 6, 8};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+	RealVector<double> buf(inputData, numElements);
+    
+    buf = exp(abs(-lazy(buf)) * 0.1);
+    for (unsigned i=0; i<numElements; i++) {
+        EXPECT_TRUE(FloatsEqual(std::exp(std::abs(inputData[i]) * 0.1), buf[i]));
+    }
+    
+    buf = sqrt(log(lazy(buf) + 1.0));
+    for (unsigned i=0; i<numElements; i++) {
+        EXPECT_TRUE(FloatsEqual(std::sqrt(std::log(std::exp(std::abs(inputData[i]) * 0.1) + 1)), buf[i]));
+    }
+}
+
+TEST(VectorExpression, CompoundAssignment) {
+    double inputData[] = {1, 3, 5, 7.12};
+    double inputData2[] = {-2, 0.5, 1, 4};
+	RealVector<double> buf1(inputData, 4);
+	RealVector<double> buf2(inputData2, 4);
+    
+    buf1 += lazy(buf2) * 2;
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_TRUE(FloatsEqual(inputData[i] + 2 * inputData2[i], buf1[i]));
+    }
+    buf1 *= lazy(buf2) - 1;
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_TRUE(FloatsEqual((inputData[i] + 2 * inputData2[i]) * (inputData2[i] - 1), buf1[i]));
+    }
+}
+
+TEST(VectorExpression, Cumsum) {
+    double inputData[] = {1, 3, 5, 7.12, 2, 4, 6, 8};
+    unsigned numElements = sizeof(inputData)/sizeof(inputData[0]);
+	RealVector<double> buf(inputData, numElements);
+	RealVector<double> expected(inputData, numElements);
+    
+    expected *= 3.0;
+    cumsum(expected, 1.0);
+    cumsum(buf, lazy(buf) * 3.0, 1.0);
+    for (unsigned i=0; i<numElements; i++) {
+        EXPECT_TRUE(FloatsEqual(expected[i], buf[i]));
+    }
+}
+
+TEST(VectorExpression, Complex) {
+    std::complex<double> inputData[] = {std::complex<double>(1, 2), std::complex<double>(-3, 0.5),
+                                        std::complex<double>(0, -1), std::complex<double>(4, 4)};
+    double realData[] = {2, -1, 0.5, 3};
+	ComplexVector<double> buf(inputData, 4);
+	RealVector<double> realBuf(realData, 4);
+    
+	ComplexVector<double> result = conj(lazy(buf)) * std::complex<double>(0, 1) + 2.0;
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_TRUE(ComplexEqual(std::conj(inputData[i]) * std::complex<double>(0, 1) + 2.0, result[i]));
+    }
+    
+    result = lazy(buf) * lazy(realBuf);
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_TRUE(ComplexEqual(inputData[i] * realData[i], result[i]));
+    }
+    
+	RealVector<double> magnitude = abs(lazy(buf));
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_TRUE(FloatsEqual(std::abs(inputData[i]), magnitude[i]));
+    }
+}
@@ -0,0 +1,227 @@
+/*
+Copyright (c) 2014, James Clay
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "VectorView.h"
+#include "RealFirFilter.h"
+#include "ComplexFirFilter.h"
+#include "gtest/gtest.h"
+
+using namespace NimbleDSP;
+
+extern bool FloatsEqual(double float1, double float2);
+extern bool ComplexEqual(std::complex<double> c1, std::complex<double> c2);
+
+
+TEST(VectorView, Operators) {
+    double array[] = {1, 2, 3, 4, 5, 6};
+    VectorView<double> view(array + 1, 4);
+    EXPECT_EQ(4, view.size());
+    EXPECT_EQ(array + 1, view.data());
+    EXPECT_EQ(2, view[0]);
+
+    view *= 2;
+    view += 1;
+    double expected[] = {1, 5, 7, 9, 11, 6};
+    for (unsigned i=0; i<6; i++) {
+        EXPECT_EQ(expected[i], array[i]);
+    }
+    EXPECT_EQ(32, view.sum());
+    EXPECT_EQ(2, view.find(9));
+    EXPECT_EQ(-1, view.find(1));
+
+    double ones[] = {1, 1, 1, 1};
+    RealVector<double> offsets(ones, 4);
+    view -= offsets;
+    -view;
+    EXPECT_EQ(-4, array[1]);
+    EXPECT_EQ(-10, array[4]);
+    EXPECT_EQ(6, array[5]);
+
+    VectorView<double> sub = view.subview(1, 2);
+    EXPECT_EQ(2, sub.size());
+    EXPECT_EQ(-6, sub[0]);
+    sub[1] = 0;
+    EXPECT_EQ(0, array[3]);
+}
+
+TEST(VectorView, Expressions) {
+    double array[] = {1, 2, 3, 4};
+    RealVector<double> other(array, 4);
+    VectorView<double> view(array, 4);
+
+    view = lazy(view) * 2.0 + other;
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_EQ(3 * (i + 1), array[i]);
+    }
+    view /= lazy(other);
+    for (unsigned i=0; i<4; i++) {
+        EXPECT_EQ(3, array[i]);
+    }
+    EXPECT_EQ(12, sum(lazy(view)));
+
+    RealVector<double> copy = lazy(view) - 1.0;
+    EXPECT_EQ(4, copy.size());
+    EXPECT_EQ(2, copy[3]);
+
+    RealVector<double> viewed(other);
+    VectorView<double> vectorView(viewed);
+    vectorView += 1;
+    EXPECT_EQ(5, viewed[3]);
+}
+
+TEST(VectorView, RealFilterMatchesVector) {
+    double filterTaps[] = {1, 2, 3, 4, 5, 4, 3, 2, 1};
+    const unsigned numTaps = sizeof(filterTaps) / sizeof(filterTaps[0]);
+    unsigned blockSizes[] = {1, 6, 11, 3, 20};
+    RealFirFilter<double> vectorFilter(filterTaps, numTaps);
+    RealFirFilter<double> viewFilter(filterTaps, numTaps);
+    RealFirFilter<double> vectorDecimator(filterTaps, numTaps);
+    RealFirFilter<double> viewDecimator(filterTaps, numTaps);
+    RealFirFilter<double> vectorInterpolator(filterTaps, numTaps);
+    RealFirFilter<double> viewInterpolator(filterTaps, numTaps);
+
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        std::vector<double> input(blockSizes[b]);
+        for (unsigned i=0; i<input.size(); i++) {
+            input[i] = std::sin(0.3 * (start + i)) + 0.1 * (start + i);
+        }
+        start += blockSizes[b];
+
+        RealVector<double> expected(input);
+        std::vector<double> buf(input);
+        conv(expected, vectorFilter);
+        VectorView<double> result = conv(VectorView<double>(VECTOR_TO_ARRAY(buf), buf.size()), viewFilter);
+        EXPECT_EQ(expected.size(), result.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], result[i]));
+        }
+
+        expected = RealVector<double>(input);
+        buf = input;
+        decimate(expected, 3, vectorDecimator);
+        result = decimate(VectorView<double>(VECTOR_TO_ARRAY(buf), buf.size()), 3, viewDecimator);
+        EXPECT_EQ(expected.size(), result.size());
+        EXPECT_EQ(VECTOR_TO_ARRAY(buf), result.data());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], result[i]));
+        }
+
+        expected = RealVector<double>(input);
+        std::vector<double> interpBuf(input.size() * 4);
+        interp(expected, 4, vectorInterpolator);
+        result = interp(VectorView<double>(VECTOR_TO_ARRAY(input), input.size()), 4,
+                        VectorView<double>(VECTOR_TO_ARRAY(interpBuf), interpBuf.size()), viewInterpolator);
+        EXPECT_EQ(expected.size(), result.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], result[i]));
+        }
+    }
+}
+
+TEST(VectorView, ComplexFilterMatchesVector) {
+    std::complex<double> complexTaps[] = {std::complex<double>(1, 1), std::complex<double>(2, -1),
+                                          std::complex<double>(0, 3), std::complex<double>(-1, 0),
+                                          std::complex<double>(0.5, 0.5)};
+    double realTaps[] = {1, -2, 3, 0.5, 2, 1};
+    unsigned blockSizes[] = {7, 2, 13};
+    ComplexFirFilter<double> vectorFilter(complexTaps, 5);
+    ComplexFirFilter<double> viewFilter(complexTaps, 5);
+    ComplexFirFilter<double> vectorDecimator(complexTaps, 5);
+    ComplexFirFilter<double> viewDecimator(complexTaps, 5);
+    RealFirFilter<double> vectorRealFilter(realTaps, 6);
+    RealFirFilter<double> viewRealFilter(realTaps, 6);
+    RealFirFilter<double> vectorInterpolator(realTaps, 6);
+    RealFirFilter<double> viewInterpolator(realTaps, 6);
+
+    unsigned start = 0;
+    for (unsigned b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); b++) {
+        std::vector< std::complex<double> > input(blockSizes[b]);
+        for (unsigned i=0; i<input.size(); i++) {
+            input[i] = std::complex<double>(std::cos(0.2 * (start + i)), 0.05 * (start + i));
+        }
+        start += blockSizes[b];
+        typedef VectorView< std::complex<double> > ComplexView;
+
+        ComplexVector<double> expected(input);
+        std::vector< std::complex<double> > buf(input);
+        conv(expected, vectorFilter);
+        ComplexView result = conv(ComplexView(VECTOR_TO_ARRAY(buf), buf.size()), viewFilter);
+        EXPECT_EQ(expected.size(), result.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(ComplexEqual(expected[i], result[i]));
+        }
+
+        expected = ComplexVector<double>(input);
+        buf = input;
+        decimate(expected, 2, vectorDecimator);
+        result = decimate(ComplexView(VECTOR_TO_ARRAY(buf), buf.size()), 2, viewDecimator);
+        EXPECT_EQ(expected.size(), result.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(ComplexEqual(expected[i], result[i]));
+        }
+
+        expected = ComplexVector<double>(input);
+        buf = input;
+        conv(expected, vectorRealFilter);
+        result = conv(ComplexView(VECTOR_TO_ARRAY(buf), buf.size()), viewRealFilter);
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(ComplexEqual(expected[i], result[i]));
+        }
+
+        // Interpolate in place, with the input at the start of a buffer big enough for the results
+        expected = ComplexVector<double>(input);
+        buf = input;
+        buf.resize(input.size() * 3);
+        interp(expected, 3, vectorInterpolator);
+        result = interp(ComplexView(VECTOR_TO_ARRAY(buf), input.size()), 3,
+                        ComplexView(VECTOR_TO_ARRAY(buf), buf.size()), viewInterpolator);
+        EXPECT_EQ(expected.size(), result.size());
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(ComplexEqual(expected[i], result[i]));
+        }
+    }
+}
+
+TEST(VectorView, FftPathMatchesVector) {
+    RealFirFilter<double> vectorFilter(100);
+    RealFirFilter<double> viewFilter(100);
+    for (unsigned i=0; i<100; i++) {
+        vectorFilter[i] = viewFilter[i] = 1.0 / (1 + i);
+    }
+    vectorFilter.convAlgorithm = FFT_CONVOLUTION;
+    viewFilter.convAlgorithm = FFT_CONVOLUTION;
+
+    for (unsigned b=0; b<3; b++) {
+        std::vector<double> input(257);
+        for (unsigned i=0; i<input.size(); i++) {
+            input[i] = std::sin(0.01 * (b * 257 + i));
+        }
+        RealVector<double> expected(input);
+        conv(expected, vectorFilter);
+        VectorView<double> result = conv(VectorView<double>(VECTOR_TO_ARRAY(input), input.size()), viewFilter);
+        for (unsigned i=0; i<expected.size(); i++) {
+            EXPECT_TRUE(FloatsEqual(expected[i], result[i]));
+        }
+    }
+}